@@ -21,8 +21,11 @@ struct ScannerOptions {
   ScanStrategy strategy;
   int32_t bucket_cnt;  // When strategy=kTabletShared, this available
   int32_t bucket_id;   // When strategy=kTabletShared, this available
+  // Rows of a scan window locked and read together, 1 handles rows one by one
+  int32_t batch_size;
 
-  ScannerOptions() : strategy(ScanStrategy::kRandom), bucket_cnt(1), bucket_id(0) {}
+  ScannerOptions()
+      : strategy(ScanStrategy::kRandom), bucket_cnt(1), bucket_id(0), batch_size(1) {}
 };
 
 class ScanHook {
@@ -12,6 +12,7 @@
 #define TERA_TERA_H_
 
 #include "tera/client.h"
+#include "tera/completion_queue.h"
 #include "tera/error_code.h"
 #include "tera/mutation.h"
 #include "tera/batch_mutation.h"
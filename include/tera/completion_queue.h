@@ -0,0 +1,78 @@
+// Copyright (c) 2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A CompletionQueue collects the results of asynchronous operations, so that
+// the application can submit many requests and reap the finished ones in
+// batches from its own thread or event loop, instead of running callbacks in
+// the sdk thread pool or blocking a thread per request.
+//
+//   CompletionQueue* cq = CompletionQueue::NewCompletionQueue();
+//   cq->Get(table, reader, tag);
+//   ...
+//   Completion events[64];
+//   int32_t n = cq->Next(events, 64, 10);
+//   for (int32_t i = 0; i < n; ++i) {
+//     // events[i].reader->GetError(), events[i].tag ...
+//   }
+
+#ifndef TERA_COMPLETION_QUEUE_H_
+#define TERA_COMPLETION_QUEUE_H_
+
+#include <stdint.h>
+
+#pragma GCC visibility push(default)
+namespace tera {
+
+class Table;
+class RowReader;
+class RowMutation;
+
+struct Completion {
+  enum Type {
+    kRead,
+    kMutation,
+  };
+  Type type;
+  void* tag;              // user tag passed on submit
+  RowReader* reader;      // valid if type == kRead
+  RowMutation* mutation;  // valid if type == kMutation
+};
+
+class CompletionQueue {
+ public:
+  static CompletionQueue* NewCompletionQueue();
+
+  CompletionQueue() {}
+  // All submitted operations must be reaped before the queue is deleted.
+  virtual ~CompletionQueue() {}
+
+  // Submit operations, never wait for rpc.
+  // The operation must not have a callback, and must not be deleted before it
+  // is returned by Next().
+  virtual void Get(Table* table, RowReader* reader, void* tag) = 0;
+  virtual void ApplyMutation(Table* table, RowMutation* mutation, void* tag) = 0;
+
+  // Fill at most 'max_num' finished operations into 'completions' and return
+  // the number filled.
+  // Wait at most 'timeout_ms' if no operation is finished,
+  // 0 means return immediately, < 0 means wait until any one is finished.
+  virtual int32_t Next(Completion* completions, int32_t max_num, int64_t timeout_ms) = 0;
+
+  // A file descriptor which becomes readable while finished operations are
+  // waiting to be reaped, for epoll/select based event loops.
+  // Never read or close it, call Next() instead.
+  virtual int NotifyFd() = 0;
+
+  // Number of submitted operations which are not returned by Next() yet.
+  virtual int64_t PendingNum() = 0;
+
+ private:
+  CompletionQueue(const CompletionQueue&);
+  void operator=(const CompletionQueue&);
+};
+
+}  // namespace tera
+#pragma GCC visibility pop
+
+#endif  // TERA_COMPLETION_QUEUE_H_
@@ -115,6 +115,12 @@ class ScanDescriptor {
 
   bool SetFilter(const filter::FilterPtr& filter);
 
+  // Scan at most 'parallelism' tablets concurrently, each of them buffers its results
+  // in its own slots. If 'ordered' is true, results are returned in key order,
+  // otherwise in the order they arrive, which gives higher throughput.
+  // Default: 1, scan tablets one by one.
+  void SetParallelism(int32_t parallelism, bool ordered = true);
+
   ScanDescImpl* GetImpl() const;
 
   // DEVELOPING
@@ -220,6 +220,12 @@ class TableDescriptor {
   uint32_t BloomFilterBitsPerKey() const;
   void SetBloomFilterBitsPerKey(uint32_t val);
 
+  // Set/get the weight of this table when tabletnode schedules read/write/scan
+  // of colocated tables, a table of weight 200 gets twice the rpc threads of
+  // a table of the default weight 100 when they are both busy.
+  uint32_t ScheduleWeight() const;
+  void SetScheduleWeight(uint32_t val);
+
   // DEPRECATED
   LocalityGroupDescriptor* DefaultLocalityGroup();
   ColumnFamilyDescriptor* DefaultColumnFamily();
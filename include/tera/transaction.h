@@ -51,6 +51,9 @@ public:
     /// 提交事务
     /// 同步模式下，Commit()的返回值代表了提交操作的结果(成功 或者 失败及其原因)
     /// 异步模式下，通过GetError()获取提交结果
+    /// 全局事务开启--tera_gtxn_async_commit_secondaries(默认关闭)时, primary提交后即返回,
+    /// 其余行在后台提交, 事务对象被删除后仍可能在使用写入的Table,
+    /// 因此全局事务写过的Table须与Client保持相同的生命周期, 不可提前delete
     virtual ErrorCode Commit() = 0;
 
     /// 获取事务开始时间戳
@@ -212,7 +212,8 @@ const char* builtin_cmd_list[] = {
         get                                                                                       \n\
             show the current limit of all procedures                                              \n\
         set <procedure> <limit>                                                                   \n\
-            procedure = [kMerge, kSplit, kMove, kLoad, kUnload]                                   \n\
+            procedure = [kMerge, kSplit, kMove, kLoad, kUnload, kNode, kTable]                    \n\
+            kNode/kTable limit procedures on one tabletnode/table, 0 means no limit               \n\
             limit shoud be a non-negative number",
 
     "help",
@@ -0,0 +1,70 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "io/compaction_debt_controller.h"
+
+namespace tera {
+namespace io {
+
+// rate is cut by 20% each update the debt grows, and raised by 25% each
+// update it shrinks, so a grow and a shrink cancel out
+static const double kRateDecrease = 0.8;
+static const double kRateIncrease = 1.25;
+
+CompactionDebtController::CompactionDebtController(int level0_limit,
+                                                   uint64_t pending_bytes_limit,
+                                                   double slowdown_ratio, int64_t min_rate)
+    : level0_limit_(level0_limit),
+      pending_bytes_limit_(pending_bytes_limit),
+      slowdown_ratio_(slowdown_ratio),
+      min_rate_(min_rate > 0 ? min_rate : 1),
+      last_update_ms_(0),
+      debt_(0),
+      write_rate_(0) {}
+
+CompactionDebtController::~CompactionDebtController() {}
+
+void CompactionDebtController::Update(int level0_files, uint64_t pending_bytes,
+                                      uint64_t written_bytes, int64_t now_ms) {
+  double debt = 0;
+  if (level0_limit_ > 0) {
+    debt = static_cast<double>(level0_files) / level0_limit_;
+  }
+  if (pending_bytes_limit_ > 0) {
+    double bytes_debt = static_cast<double>(pending_bytes) / pending_bytes_limit_;
+    debt = bytes_debt > debt ? bytes_debt : debt;
+  }
+  int64_t elapsed_ms = now_ms - last_update_ms_;
+  bool first_update = (last_update_ms_ == 0);
+  last_update_ms_ = now_ms;
+  double last_debt = debt_;
+  debt_ = debt;
+
+  if (slowdown_ratio_ <= 0 || debt < slowdown_ratio_) {
+    write_rate_ = 0;
+    return;
+  }
+  double rate;
+  if (write_rate_ == 0) {
+    // start from what the tablet is writing now
+    rate = (first_update || elapsed_ms <= 0) ? 0 : written_bytes * 1000.0 / elapsed_ms;
+  } else if (debt > last_debt) {
+    rate = write_rate_ * kRateDecrease;
+  } else if (debt < last_debt) {
+    rate = write_rate_ * kRateIncrease;
+  } else {
+    rate = write_rate_;
+  }
+  write_rate_ = rate > min_rate_ ? static_cast<int64_t>(rate) : min_rate_;
+}
+
+int64_t CompactionDebtController::DelayMs(uint64_t bytes) const {
+  if (write_rate_ <= 0) {
+    return 0;
+  }
+  return static_cast<int64_t>(bytes * 1000 / write_rate_);
+}
+
+}  // namespace io
+}  // namespace tera
@@ -0,0 +1,57 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TERA_IO_COMPACTION_DEBT_CONTROLLER_H_
+#define TERA_IO_COMPACTION_DEBT_CONTROLLER_H_
+
+#include <stdint.h>
+
+namespace tera {
+namespace io {
+
+// Write rate of a tablet driven by its compaction debt.
+//
+// Debt is the larger of level0 files over |level0_limit| and pending
+// compaction bytes over |pending_bytes_limit|. Below |slowdown_ratio| writes
+// are not limited. Above it the rate starts from the throughput just
+// observed, and is cut while the debt keeps growing and raised while
+// compactions pay it back, never below |min_rate|. So the tablet writes at
+// about the speed compactions drain, rather than running at full speed into
+// the level0 limit and then being rejected.
+//
+// Not thread safe, it's driven by the writer thread of the tablet.
+class CompactionDebtController {
+ public:
+  CompactionDebtController(int level0_limit, uint64_t pending_bytes_limit, double slowdown_ratio,
+                           int64_t min_rate);
+  ~CompactionDebtController();
+
+  // debt measured at |now_ms|, and bytes written since last update
+  void Update(int level0_files, uint64_t pending_bytes, uint64_t written_bytes, int64_t now_ms);
+
+  // allowed bytes per second, 0 means no limit
+  int64_t WriteRate() const { return write_rate_; }
+
+  double Debt() const { return debt_; }
+
+  // how long to hold the next write after writing |bytes|. It's not capped,
+  // the writer buffers pending writes up to its pending limit meanwhile, and
+  // a cap would let a full buffer through faster than the rate.
+  int64_t DelayMs(uint64_t bytes) const;
+
+ private:
+  const int level0_limit_;
+  const uint64_t pending_bytes_limit_;
+  const double slowdown_ratio_;
+  const int64_t min_rate_;
+
+  int64_t last_update_ms_;
+  double debt_;
+  int64_t write_rate_;
+};
+
+}  // namespace io
+}  // namespace tera
+
+#endif  // TERA_IO_COMPACTION_DEBT_CONTROLLER_H_
@@ -9,6 +9,7 @@ DEFINE_int32(tera_leveldb_slow_down_level0_score_limit, 100,
              "control level 0 score compute, score / 2 or sqrt(score / 2)");
 DEFINE_int32(tera_leveldb_max_background_compactions, 8, "multi-thread compaction number");
 DEFINE_int32(tera_tablet_max_sub_parallel_compaction, 10, "max sub compaction in parallel");
+DEFINE_int32(tera_tablet_max_parallel_lg_recover, 8, "max lg recovered in parallel on tablet load");
 DEFINE_bool(tera_leveldb_ignore_corruption_in_open, false, "ignore fs error when open db");
 DEFINE_int32(tera_tablet_del_percentage, 20,
              "percentage of del tag in sst file begin to trigger compaction");
@@ -21,6 +22,15 @@ DEFINE_int32(tera_asyncwriter_pending_limit, 10000,
 DEFINE_int32(tera_asyncwriter_sync_interval, 10,
              "the interval (in ms) to sync write buffer to disk");
 DEFINE_bool(tera_enable_level0_limit, true, "enable level0 limit");
+DEFINE_double(tera_tablet_write_slowdown_debt_ratio, 0.5,
+              "slow down writes of a tablet once its compaction debt reaches this ratio of "
+              "level0 file limit or pending compaction limit, 0 means disabled");
+DEFINE_int64(tera_tablet_pending_compaction_limit_mb, 4096,
+             "the pending compaction bytes (in MB) of a tablet counted as full debt");
+DEFINE_int64(tera_tablet_min_write_rate_kb, 1024,
+             "the min write rate (in KB/s) of a tablet slowed down by compaction debt");
+DEFINE_int32(tera_tablet_compaction_debt_check_interval, 1000,
+             "the interval (in ms) to check compaction debt and adjust tablet write rate");
 DEFINE_int32(tera_tabletnode_scanner_cache_size, 5,
              "default tablet scanner manager cache no more than 100 stream");
 DEFINE_uint64(tera_tabletnode_prefetch_scan_size, 1 << 20, "Max size for prefetch scan");
@@ -83,6 +93,11 @@ DEFINE_uint64(tera_leveldb_table_builder_write_batch_size, 256 << 10,
               "table builder's batch write size, 0 means disable table builder "
               "batch write");
 
+DEFINE_int32(tera_tablet_key_sample_size, 256,
+             "max row keys kept in the access sample of a tablet, for hotspot split");
+DEFINE_int32(tera_tablet_key_sample_interval, 16, "sample one of every N row key accesses");
+DEFINE_int64(tera_tablet_key_sample_window_ms, 60000, "window of tablet row key access sampling");
+
 DEFINE_int32(tera_tablet_unload_count_limit, 3,
              "the upper bound of try unload, broken this limit will speed up unloading");
 DEFINE_int32(tera_leveldb_memtable_shard_num, 4, "shard memtable num");
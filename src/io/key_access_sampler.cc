@@ -0,0 +1,84 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "io/key_access_sampler.h"
+
+#include <algorithm>
+
+#include "common/timer.h"
+
+namespace tera {
+namespace io {
+
+// a median from fewer samples is too noisy to split on
+static const size_t kMinSamplesForMedian = 16;
+
+KeyAccessSampler::KeyAccessSampler(uint32_t capacity, uint32_t sample_interval, int64_t window_ms)
+    : capacity_(std::max(capacity, 1U)),
+      sample_interval_(std::max(sample_interval, 1U)),
+      window_ms_(std::max(window_ms, 1L)),
+      access_count_(0),
+      sampled_count_(0),
+      window_start_ms_(get_millis()),
+      random_state_(static_cast<uint32_t>(get_micros()) | 1),
+      last_access_qps_(0) {}
+
+KeyAccessSampler::~KeyAccessSampler() {}
+
+void KeyAccessSampler::Record(const std::string& row_key) {
+  uint64_t count = access_count_.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (count % sample_interval_ != 0) {
+    return;
+  }
+  MutexLock lock(&mutex_);
+  MaybeSwitchWindow(get_millis());
+  ++sampled_count_;
+  if (reservoir_.size() < capacity_) {
+    reservoir_.push_back(row_key);
+    return;
+  }
+  uint64_t pos = NextRandom() % sampled_count_;
+  if (pos < capacity_) {
+    reservoir_[pos] = row_key;
+  }
+}
+
+void KeyAccessSampler::GetHotness(uint64_t* access_qps, std::string* median_key) {
+  MutexLock lock(&mutex_);
+  MaybeSwitchWindow(get_millis());
+  *access_qps = last_access_qps_;
+  *median_key = last_median_key_;
+}
+
+void KeyAccessSampler::MaybeSwitchWindow(int64_t now_ms) {
+  mutex_.AssertHeld();
+  int64_t elapsed_ms = now_ms - window_start_ms_;
+  if (elapsed_ms < window_ms_) {
+    return;
+  }
+  uint64_t count = access_count_.exchange(0, std::memory_order_relaxed);
+  last_access_qps_ = count * 1000 / elapsed_ms;
+  last_median_key_.clear();
+  if (reservoir_.size() >= kMinSamplesForMedian) {
+    std::vector<std::string>::iterator median = reservoir_.begin() + reservoir_.size() / 2;
+    std::nth_element(reservoir_.begin(), median, reservoir_.end());
+    last_median_key_ = *median;
+  }
+  reservoir_.clear();
+  sampled_count_ = 0;
+  window_start_ms_ = now_ms;
+}
+
+uint32_t KeyAccessSampler::NextRandom() {
+  // xorshift32
+  uint32_t x = random_state_;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  random_state_ = x;
+  return x;
+}
+
+}  // namespace io
+}  // namespace tera
@@ -0,0 +1,62 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TERA_IO_KEY_ACCESS_SAMPLER_H_
+#define TERA_IO_KEY_ACCESS_SAMPLER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "common/mutex.h"
+
+namespace tera {
+namespace io {
+
+// Sampled row key access histogram of a tablet.
+//
+// Every |sample_interval| accesses one row key is offered to a reservoir of
+// |capacity| keys, so the reservoir is an uniform sample of the accesses in
+// current window. When a window of |window_ms| ends, the access qps and the
+// median of sampled keys are kept as the hotness of last window. The median
+// splits the load of the tablet into two halves, rather than its data size.
+class KeyAccessSampler {
+ public:
+  KeyAccessSampler(uint32_t capacity, uint32_t sample_interval, int64_t window_ms);
+  ~KeyAccessSampler();
+
+  void Record(const std::string& row_key);
+
+  // Hotness of last finished window. |median_key| is empty if too few
+  // accesses are sampled to tell.
+  void GetHotness(uint64_t* access_qps, std::string* median_key);
+
+ private:
+  // REQUIRES: mutex_ held
+  void MaybeSwitchWindow(int64_t now_ms);
+  uint32_t NextRandom();
+
+ private:
+  const uint32_t capacity_;
+  const uint32_t sample_interval_;
+  const int64_t window_ms_;
+
+  std::atomic<uint64_t> access_count_;
+
+  Mutex mutex_;
+  std::vector<std::string> reservoir_;
+  uint64_t sampled_count_;
+  int64_t window_start_ms_;
+  uint32_t random_state_;
+
+  uint64_t last_access_qps_;
+  std::string last_median_key_;
+};
+
+}  // namespace io
+}  // namespace tera
+
+#endif  // TERA_IO_KEY_ACCESS_SAMPLER_H_
@@ -58,6 +58,9 @@ DECLARE_string(tera_master_meta_table_name);
 DECLARE_string(tera_tabletnode_path_prefix);
 DECLARE_uint64(tera_leveldb_manifest_switch_size_MB);
 DECLARE_string(tera_leveldb_compact_strategy);
+DECLARE_int32(tera_tablet_key_sample_size);
+DECLARE_int32(tera_tablet_key_sample_interval);
+DECLARE_int64(tera_tablet_key_sample_window_ms);
 DECLARE_bool(tera_leveldb_verify_checksums);
 DECLARE_bool(tera_leveldb_ignore_corruption_in_compaction);
 DECLARE_bool(tera_leveldb_use_file_lock);
@@ -77,6 +80,7 @@ DECLARE_bool(tera_leveldb_ignore_corruption_in_open);
 DECLARE_int32(tera_leveldb_slow_down_level0_score_limit);
 DECLARE_int32(tera_leveldb_max_background_compactions);
 DECLARE_int32(tera_tablet_max_sub_parallel_compaction);
+DECLARE_int32(tera_tablet_max_parallel_lg_recover);
 DECLARE_int32(tera_tablet_unload_count_limit);
 
 DECLARE_bool(debug_tera_tablet_unload);
@@ -188,7 +192,10 @@ TabletIO::TabletIO(const std::string& key_start, const std::string& key_end,
       kv_only_(false),
       key_operator_(NULL),
       try_unload_count_(0),
+      last_write_ts_(0),
       counter_(short_path_),
+      key_sampler_(FLAGS_tera_tablet_key_sample_size, FLAGS_tera_tablet_key_sample_interval,
+                   FLAGS_tera_tablet_key_sample_window_ms),
       mock_env_(NULL) {}
 
 TabletIO::~TabletIO() {
@@ -243,6 +250,10 @@ RawKey TabletIO::RawKeyType() const {
 
 TabletIO::StatCounter& TabletIO::GetCounter() { return counter_; }
 
+void TabletIO::GetHotness(uint64_t* access_qps, std::string* median_key) {
+  key_sampler_.GetHotness(access_qps, median_key);
+}
+
 void TabletIO::SetMemoryCache(leveldb::Cache* cache) { m_memory_cache = cache; }
 
 bool TabletIO::Load(const TableSchema& schema, const std::string& path,
@@ -309,6 +320,7 @@ bool TabletIO::Load(const TableSchema& schema, const std::string& path,
   ldb_options_.key_end = raw_end_key_;
   ldb_options_.l0_slowdown_writes_trigger = FLAGS_tera_tablet_level0_file_limit;
   ldb_options_.max_sub_parallel_compaction = FLAGS_tera_tablet_max_sub_parallel_compaction;
+  ldb_options_.max_parallel_lg_recover = FLAGS_tera_tablet_max_parallel_lg_recover;
   ldb_options_.ttl_percentage = FLAGS_tera_tablet_ttl_percentage;
   ldb_options_.del_percentage = FLAGS_tera_tablet_del_percentage;
   ldb_options_.block_size = FLAGS_tera_tablet_write_block_size * 1024;
@@ -407,6 +419,8 @@ bool TabletIO::Load(const TableSchema& schema, const std::string& path,
     status_ = kReady;
     // reset try unload count to 0 for ready
     try_unload_count_ = 0;
+    // data may be changed by other tabletnode before this load
+    last_write_ts_ = get_micros();
     db_ref_count_--;
   }
 
@@ -695,6 +709,22 @@ bool TabletIO::Workload(double* write_workload) {
   return true;
 }
 
+bool TabletIO::CompactionDebt(int* level0_files, uint64_t* pending_compaction_bytes) {
+  {
+    MutexLock lock(&mutex_);
+    if (status_ != kReady) {
+      return false;
+    }
+    db_ref_count_++;
+  }
+  db_->CompactionDebt(level0_files, pending_compaction_bytes);
+  {
+    MutexLock lock(&mutex_);
+    db_ref_count_--;
+  }
+  return true;
+}
+
 bool TabletIO::SnapshotIDToSeq(uint64_t snapshot_id, uint64_t* snapshot_sequence) {
   std::map<uint64_t, uint64_t>::iterator it = id_to_snapshot_num_.find(snapshot_id);
   if (it == id_to_snapshot_num_.end()) {
@@ -1358,6 +1388,7 @@ bool TabletIO::ReadCells(const RowReaderInfo& row_reader, RowResult* values, uin
     }
     db_ref_count_++;
   }
+  key_sampler_.Record(row_reader.key());
 
   int64_t start_read_us = get_micros();
 
@@ -1516,6 +1547,9 @@ bool TabletIO::Write(std::vector<const RowMutationSequence*>* row_mutation_vec,
     }
     db_ref_count_++;
   }
+  for (size_t i = 0; i < row_mutation_vec->size(); ++i) {
+    key_sampler_.Record((*row_mutation_vec)[i]->row_key());
+  }
   bool ret = async_writer_->Write(row_mutation_vec, status_vec, is_instant, callback, status);
   if (!ret) {
     counter_.write_reject_rows.Add(row_mutation_vec->size());
@@ -16,6 +16,7 @@
 #include "common/base/scoped_ptr.h"
 #include "common/metric/metric_counter.h"
 #include "common/mutex.h"
+#include "io/key_access_sampler.h"
 #include "io/tablet_scanner.h"
 #include "leveldb/db.h"
 #include "leveldb/options.h"
@@ -121,6 +122,8 @@ class TabletIO {
   std::string GetEndKey() const;
   int64_t CreateTime() const { return ctime_; }
   uint64_t Version() const { return version_; }
+  // time(us) of the latest write applied, or of tablet load if no write yet
+  int64_t LastWriteTime() const { return last_write_ts_.load(); }
 
   const std::string& GetMetricLabel() const;
   virtual CompactStatus GetCompactStatus() const;
@@ -128,6 +131,9 @@ class TabletIO {
   RawKey RawKeyType() const;
   bool KvOnly() const { return kv_only_; }
   StatCounter& GetCounter();
+  // Access qps and the median row key of sampled accesses in last window,
+  // used by master to split a hot tablet at its load center.
+  void GetHotness(uint64_t* access_qps, std::string* median_key);
   // Set independent cache for memory table.
   void SetMemoryCache(leveldb::Cache* cache);
   // tablet
@@ -148,6 +154,7 @@ class TabletIO {
 
   bool IsBusy();
   bool Workload(double* write_workload);
+  bool CompactionDebt(int* level0_files, uint64_t* pending_compaction_bytes);
 
   bool SnapshotIDToSeq(uint64_t snapshot_id, uint64_t* snapshot_sequence);
 
@@ -316,7 +323,9 @@ class TabletIO {
 
   // accept unload request for this tablet will inc this count
   std::atomic<int> try_unload_count_;
+  std::atomic<int64_t> last_write_ts_;
   StatCounter counter_;
+  KeyAccessSampler key_sampler_;
   mutable Mutex schema_mutex_;
 
   leveldb::Env* mock_env_;  // mock env for testing
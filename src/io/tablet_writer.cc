@@ -28,6 +28,11 @@
 
 DECLARE_int32(tera_asyncwriter_pending_limit);
 DECLARE_bool(tera_enable_level0_limit);
+DECLARE_int32(tera_tablet_level0_file_limit);
+DECLARE_double(tera_tablet_write_slowdown_debt_ratio);
+DECLARE_int64(tera_tablet_pending_compaction_limit_mb);
+DECLARE_int64(tera_tablet_min_write_rate_kb);
+DECLARE_int32(tera_tablet_compaction_debt_check_interval);
 DECLARE_int32(tera_asyncwriter_sync_interval);
 DECLARE_int32(tera_asyncwriter_sync_size_threshold);
 DECLARE_int32(tera_asyncwriter_batch_size);
@@ -70,7 +75,16 @@ TabletWriter::TabletWriter(TabletIO* tablet_io)
       sync_timestamp_(0),
       active_buffer_instant_(false),
       active_buffer_size_(0),
-      tablet_busy_(false) {
+      tablet_busy_(false),
+      sealed_buffer_size_(0),
+      debt_controller_(FLAGS_tera_tablet_level0_file_limit,
+                       FLAGS_tera_tablet_pending_compaction_limit_mb << 20,
+                       FLAGS_tera_tablet_write_slowdown_debt_ratio,
+                       FLAGS_tera_tablet_min_write_rate_kb << 10),
+      debt_check_timestamp_(0),
+      written_size_(0),
+      last_flush_timestamp_(0),
+      last_flush_size_(0) {
   active_buffer_ = new WriteTaskBuffer;
   sealed_buffer_ = new WriteTaskBuffer;
 }
@@ -177,6 +191,16 @@ void TabletWriter::DoWork() {
   }
 
   while (!stopped_) {
+    UpdateWriteRate();
+    // hold is computed by the current rate, so a changed rate applies at once
+    int64_t hold_duration = last_flush_timestamp_ + debt_controller_.DelayMs(last_flush_size_) -
+                            GetTimeStampInMs();
+    if (hold_duration > 0) {
+      // 限速中, 写请求留在active_buffer, 最多等到下次检查compaction债务
+      write_event_.TimeWait(std::min<int64_t>(
+          hold_duration, std::max(FLAGS_tera_tablet_compaction_debt_check_interval, 1)));
+      continue;
+    }
     int64_t sleep_duration = sync_timestamp_ + sync_interval - GetTimeStampInMs();
     // 如果没数据, 等
     if (!SwapActiveBuffer(sleep_duration <= 0)) {
@@ -192,6 +216,9 @@ void TabletWriter::DoWork() {
     sync_timestamp_ = GetTimeStampInMs();
     FlushToDiskBatch(sealed_buffer_);
     sealed_buffer_->clear();
+    written_size_ += sealed_buffer_size_;
+    last_flush_timestamp_ = sync_timestamp_;
+    last_flush_size_ = sealed_buffer_size_;
   }
   LOG(INFO) << "AsyncWriter::DoWork done";
 }
@@ -223,12 +250,35 @@ bool TabletWriter::SwapActiveBuffer(bool force) {
   sealed_buffer_ = temp;
   CHECK_EQ(0U, active_buffer_->size());
 
+  sealed_buffer_size_ = active_buffer_size_;
   active_buffer_size_ = 0;
   active_buffer_instant_ = false;
 
   return true;
 }
 
+void TabletWriter::UpdateWriteRate() {
+  int64_t now = GetTimeStampInMs();
+  if (now - debt_check_timestamp_ < FLAGS_tera_tablet_compaction_debt_check_interval) {
+    return;
+  }
+  debt_check_timestamp_ = now;
+  int level0_files = 0;
+  uint64_t pending_bytes = 0;
+  if (!tablet_->CompactionDebt(&level0_files, &pending_bytes)) {
+    return;
+  }
+  int64_t last_rate = debt_controller_.WriteRate();
+  debt_controller_.Update(level0_files, pending_bytes, written_size_, now);
+  written_size_ = 0;
+  int64_t rate = debt_controller_.WriteRate();
+  if (rate != last_rate) {
+    VLOG(6) << "[" << tablet_->GetTablePath() << "] level0 files " << level0_files
+            << ", pending compaction " << (pending_bytes >> 20) << "MB, debt "
+            << debt_controller_.Debt() << ", write rate " << (rate >> 10) << "KB/s";
+  }
+}
+
 void TabletWriter::BatchRequest(WriteTaskBuffer* task_buffer, leveldb::WriteBatch* batch) {
   auto table_schema = tablet_->GetSchema();
   int64_t timestamp_old = 0;
@@ -351,6 +401,7 @@ void TabletWriter::BatchRequest(WriteTaskBuffer* task_buffer, leveldb::WriteBatc
 }
 
 void TabletWriter::FinishTask(WriteTaskBuffer* task_buffer, StatusCode status) {
+  tablet_->last_write_ts_ = get_micros();
   for (uint32_t task_idx = 0; task_idx < task_buffer->size(); ++task_idx) {
     WriteTask& task = (*task_buffer)[task_idx];
     tablet_->GetCounter().write_rows.Add(task.row_mutation_vec->size());
@@ -12,6 +12,7 @@
 
 #include "common/event.h"
 #include "common/mutex.h"
+#include "io/compaction_debt_controller.h"
 
 #include "proto/status_code.pb.h"
 #include "proto/tabletnode_rpc.pb.h"
@@ -56,6 +57,8 @@ class TabletWriter {
  private:
   void DoWork();
   bool SwapActiveBuffer(bool force);
+  /// 按compaction债务调整写速率
+  void UpdateWriteRate();
   /// 把一个request打到一个leveldbbatch里去, request是原子的, batch也是, so ..
   void BatchRequest(WriteTaskBuffer* task_buffer, leveldb::WriteBatch* batch);
   bool CheckSingleRowTxnConflict(const RowMutationSequence& row_mu,
@@ -87,6 +90,13 @@ class TabletWriter {
   bool active_buffer_instant_;   ///< active_buffer包含instant请求
   uint64_t active_buffer_size_;  ///< active_buffer的数据大小
   bool tablet_busy_;             ///< tablet处于忙碌状态
+  uint64_t sealed_buffer_size_;  ///< sealed_buffer的数据大小
+
+  CompactionDebtController debt_controller_;
+  int64_t debt_check_timestamp_;  ///< 上次检查compaction债务的时间
+  uint64_t written_size_;         ///< 上次检查以来写入的数据大小
+  int64_t last_flush_timestamp_;  ///< 上次写入开始的时间
+  uint64_t last_flush_size_;      ///< 上次写入的数据大小, 限速时据此计算下次写入时间
 };
 
 }  // namespace tabletnode
@@ -0,0 +1,105 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "io/compaction_debt_controller.h"
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+namespace tera {
+namespace io {
+
+static const uint64_t kMB = 1 << 20;
+
+TEST(CompactionDebtControllerTest, NoLimitBelowSlowdown) {
+  CompactionDebtController controller(20, 1024 * kMB, 0.5, kMB);
+  controller.Update(5, 100 * kMB, 100 * kMB, 1000);
+  controller.Update(9, 500 * kMB, 100 * kMB, 2000);
+  EXPECT_EQ(controller.WriteRate(), 0);
+  EXPECT_EQ(controller.DelayMs(100 * kMB), 0);
+}
+
+TEST(CompactionDebtControllerTest, StartFromObservedThroughput) {
+  CompactionDebtController controller(20, 1024 * kMB, 0.5, kMB);
+  controller.Update(2, 0, 0, 1000);
+  // either level0 files or pending bytes may be the debt
+  controller.Update(2, 600 * kMB, 50 * kMB, 2000);
+  EXPECT_EQ(controller.WriteRate(), static_cast<int64_t>(50 * kMB));
+  EXPECT_EQ(controller.DelayMs(25 * kMB), 500);
+  EXPECT_EQ(controller.DelayMs(500 * kMB), 10000);
+}
+
+TEST(CompactionDebtControllerTest, FollowDebt) {
+  CompactionDebtController controller(20, 0, 0.5, kMB);
+  controller.Update(2, 0, 0, 1000);
+  controller.Update(10, 0, 100 * kMB, 2000);
+  int64_t rate = controller.WriteRate();
+  EXPECT_EQ(rate, static_cast<int64_t>(100 * kMB));
+
+  // debt grows, slow down
+  controller.Update(12, 0, 100 * kMB, 3000);
+  EXPECT_LT(controller.WriteRate(), rate);
+  rate = controller.WriteRate();
+
+  // debt stays, keep the rate
+  controller.Update(12, 0, 80 * kMB, 4000);
+  EXPECT_EQ(controller.WriteRate(), rate);
+
+  // debt is paid back, speed up
+  controller.Update(11, 0, 80 * kMB, 5000);
+  EXPECT_GT(controller.WriteRate(), rate);
+
+  // debt is cleared, no limit
+  controller.Update(4, 0, 80 * kMB, 6000);
+  EXPECT_EQ(controller.WriteRate(), 0);
+}
+
+TEST(CompactionDebtControllerTest, MinRate) {
+  CompactionDebtController controller(20, 0, 0.5, kMB);
+  controller.Update(2, 0, 0, 1000);
+  for (int i = 0; i < 50; ++i) {
+    controller.Update(10 + i, 0, 0, 2000 + i * 1000);
+    EXPECT_GE(controller.WriteRate(), static_cast<int64_t>(kMB));
+  }
+  EXPECT_EQ(controller.WriteRate(), static_cast<int64_t>(kMB));
+}
+
+// the writer flushes its whole buffer once the hold of last flush passes,
+// while clients keep the buffer full up to the pending limit
+TEST(CompactionDebtControllerTest, HoldMinRate) {
+  CompactionDebtController controller(20, 0, 0.5, kMB);
+  controller.Update(2, 0, 0, 1000);
+  controller.Update(20, 0, 0, 2000);
+  ASSERT_EQ(controller.WriteRate(), static_cast<int64_t>(kMB));
+
+  const uint64_t pending_limit = 10 * kMB;
+  const uint64_t offered_per_ms = 10 * kMB / 1000;
+  uint64_t buffer = 0;
+  uint64_t written = 0;
+  int64_t last_flush_ms = 0;
+  uint64_t last_flush_size = 0;
+  for (int64_t now_ms = 2000; now_ms < 62000; ++now_ms) {
+    buffer = std::min(buffer + offered_per_ms, pending_limit);
+    if (now_ms >= last_flush_ms + controller.DelayMs(last_flush_size)) {
+      written += buffer;
+      last_flush_ms = now_ms;
+      last_flush_size = buffer;
+      buffer = 0;
+    }
+  }
+  // 60s at 1MB/s, plus the buffer flushed last
+  EXPECT_LE(written, 60 * kMB + pending_limit);
+  EXPECT_GE(written, 50 * kMB);
+}
+
+TEST(CompactionDebtControllerTest, Disabled) {
+  CompactionDebtController controller(20, 1024 * kMB, 0, kMB);
+  controller.Update(2, 0, 0, 1000);
+  controller.Update(100, 10240 * kMB, 100 * kMB, 2000);
+  EXPECT_EQ(controller.WriteRate(), 0);
+}
+
+}  // namespace io
+}  // namespace tera
@@ -0,0 +1,80 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "io/key_access_sampler.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+namespace tera {
+namespace io {
+
+static std::string RowKey(int i) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "key%04d", i);
+  return buf;
+}
+
+TEST(KeyAccessSamplerTest, NoHotnessInFirstWindow) {
+  KeyAccessSampler sampler(256, 1, 3600 * 1000);
+  for (int i = 0; i < 1000; ++i) {
+    sampler.Record(RowKey(i));
+  }
+  uint64_t qps = 1;
+  std::string median_key = "x";
+  sampler.GetHotness(&qps, &median_key);
+  ASSERT_EQ(qps, 0U);
+  ASSERT_TRUE(median_key.empty());
+}
+
+TEST(KeyAccessSamplerTest, TooFewSamples) {
+  KeyAccessSampler sampler(256, 1, 50);
+  for (int i = 0; i < 8; ++i) {
+    sampler.Record(RowKey(i));
+  }
+  usleep(100 * 1000);
+  uint64_t qps = 0;
+  std::string median_key;
+  sampler.GetHotness(&qps, &median_key);
+  ASSERT_GT(qps, 0U);
+  ASSERT_TRUE(median_key.empty());
+}
+
+TEST(KeyAccessSamplerTest, MedianFollowsLoad) {
+  KeyAccessSampler sampler(256, 2, 200);
+  // key0000 ~ key0899 are accessed once, key0900 ~ key0999 are accessed 20
+  // times each, so more than 2/3 accesses hit the last 100 keys and the
+  // load median lies among them, while the size median is about key0500
+  for (int i = 0; i < 900; ++i) {
+    sampler.Record(RowKey(i));
+  }
+  for (int round = 0; round < 20; ++round) {
+    for (int i = 900; i < 1000; ++i) {
+      sampler.Record(RowKey(i));
+    }
+  }
+  usleep(300 * 1000);
+  uint64_t qps = 0;
+  std::string median_key;
+  sampler.GetHotness(&qps, &median_key);
+  ASSERT_GT(qps, 0U);
+  ASSERT_GE(median_key, RowKey(900));
+  ASSERT_LE(median_key, RowKey(999));
+
+  // next window has no access
+  usleep(300 * 1000);
+  sampler.GetHotness(&qps, &median_key);
+  ASSERT_EQ(qps, 0U);
+  ASSERT_TRUE(median_key.empty());
+}
+
+}  // namespace io
+}  // namespace tera
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <mutex>
+#include <set>
 #include <string>
 
 #include <gflags/gflags.h>
@@ -28,6 +29,7 @@
 #include "leveldb/env_flash.h"
 #include "leveldb/env_inmem.h"
 #include "leveldb/env_mock.h"
+#include "leveldb/filter_policy.h"
 #include "leveldb/table_utils.h"
 #include "common/timer.h"
 #include "leveldb/persistent_cache.h"
@@ -580,5 +582,35 @@ leveldb::Status GetPersistentCache(std::shared_ptr<leveldb::PersistentCache>* ca
   return status;
 }
 
+static const leveldb::FilterPolicy* PersistentCacheSketchPolicy() {
+  static const leveldb::FilterPolicy* policy = leveldb::NewBloomFilterPolicy(10);
+  return policy;
+}
+
+void BuildPersistentCacheSketch(const std::vector<std::string>& cache_keys, std::string* sketch) {
+  // key format in persistent cache: table_name/tablet_name/lg_num/xxxxxxxx.sst
+  std::set<std::string> tablet_paths;
+  for (const auto& key : cache_keys) {
+    size_t pos = key.find('/');
+    if (pos == std::string::npos || (pos = key.find('/', pos + 1)) == std::string::npos) {
+      continue;
+    }
+    tablet_paths.insert(key.substr(0, pos));
+  }
+  sketch->clear();
+  if (tablet_paths.empty()) {
+    return;
+  }
+  std::vector<leveldb::Slice> keys(tablet_paths.begin(), tablet_paths.end());
+  PersistentCacheSketchPolicy()->CreateFilter(&keys[0], keys.size(), sketch);
+}
+
+bool PersistentCacheSketchMayContain(const std::string& sketch, const std::string& tablet_path) {
+  if (sketch.empty()) {
+    return false;
+  }
+  return PersistentCacheSketchPolicy()->KeyMayMatch(tablet_path, sketch);
+}
+
 }  // namespace io
 }  // namespace leveldb
@@ -56,6 +56,11 @@ const std::vector<std::string>& GetCachePaths();
 const std::vector<std::string>& GetPersistentCachePaths();
 
 leveldb::Status GetPersistentCache(std::shared_ptr<leveldb::PersistentCache>* cache);
+
+// Sketch of the tablets having sst files in persistent cache, a bloom filter
+// of tablet paths "table_name/tablet_name" cut from the persistent cache keys.
+void BuildPersistentCacheSketch(const std::vector<std::string>& cache_keys, std::string* sketch);
+bool PersistentCacheSketchMayContain(const std::string& sketch, const std::string& tablet_path);
 }  // namespace io
 }  // namespace tera
 
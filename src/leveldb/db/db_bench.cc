@@ -9,11 +9,16 @@
 #include <sys/types.h>
 #include <stdio.h>
 #include <stdlib.h>
+
+#include <set>
+#include <string>
+
 #include "db/db_impl.h"
 #include "db/version_set.h"
 #include "leveldb/cache.h"
 #include "leveldb/db.h"
 #include "leveldb/env.h"
+#include "leveldb/lg_coding.h"
 #include "leveldb/write_batch.h"
 #include "port/port.h"
 #include "util/crc32c.h"
@@ -45,6 +50,7 @@
 //      acquireload   -- load N*1000 times
 //   Meta operations:
 //      compact     -- Compact the entire DB
+//      recover     -- Reopen the DB, replaying the log not dumped yet
 //      stats       -- Print DB stats
 //      sstables    -- Print sstable info
 //      heapprofile -- Dump a heap profile (if supported by this port)
@@ -127,6 +133,13 @@ static bool FLAGS_use_existing_db = false;
 // Use the db with the following name.
 static const char* FLAGS_db = NULL;
 
+// Number of locality groups, keys of fill* and readrandom are spread over
+// them round robin.
+static int FLAGS_lg_num = 1;
+
+// Number of locality groups recovered in parallel by "recover".
+static int FLAGS_lg_recover_threads = 1;
+
 namespace leveldb {
 
 namespace {
@@ -331,6 +344,7 @@ class Benchmark {
   WriteOptions write_options_;
   int reads_;
   int heap_counter_;
+  std::set<uint32_t> lg_list_;
 
   void PrintHeader() {
     const int kKeySize = 16;
@@ -416,8 +430,13 @@ class Benchmark {
         Env::Default()->DeleteFile(std::string(FLAGS_db) + "/" + files[i]);
       }
     }
+    for (int i = 0; i < FLAGS_lg_num; ++i) {
+      lg_list_.insert(i);
+    }
     if (!FLAGS_use_existing_db) {
-      DestroyDB(FLAGS_db, Options());
+      Options options;
+      options.exist_lg_list = new std::set<uint32_t>(lg_list_);
+      DestroyDB(FLAGS_db, options);
     }
   }
 
@@ -502,6 +521,8 @@ class Benchmark {
         method = &Benchmark::ReadWhileWriting;
       } else if (name == Slice("compact")) {
         method = &Benchmark::Compact;
+      } else if (name == Slice("recover")) {
+        Recover();
       } else if (name == Slice("crc32c")) {
         method = &Benchmark::Crc32c;
       } else if (name == Slice("acquireload")) {
@@ -824,6 +845,10 @@ class Benchmark {
     options.filter_policy = filter_policy_;
     options.block_size = FLAGS_block_size;
     options.compression = NumToCompressionType(FLAGS_compress);
+    // leave memtables to the log, so "recover" has something to replay
+    options.dump_mem_on_shutdown = false;
+    options.exist_lg_list = &lg_list_;
+    options.max_parallel_lg_recover = FLAGS_lg_recover_threads;
     Status log_s = Env::Default()->NewLogger("./ldblog", LogOption::LogOptionBuilder().Build(),
                                              &options.info_log);
     if (FLAGS_env == NULL) {
@@ -844,6 +869,27 @@ class Benchmark {
     }
   }
 
+  // key |k| in lg k % FLAGS_lg_num
+  std::string LGKey(int k) {
+    std::string key;
+    if (FLAGS_lg_num > 1) {
+      PutFixed32LGId(&key, k % FLAGS_lg_num);
+    }
+    char buf[100];
+    snprintf(buf, sizeof(buf), "%016d", k);
+    key.append(buf);
+    return key;
+  }
+
+  void Recover() {
+    delete db_;
+    db_ = NULL;
+    uint64_t start = Env::Default()->NowMicros();
+    Open();
+    fprintf(stdout, "%-12s : %11.3f ms; %d lgs, %d recover threads\n", "recover",
+            (Env::Default()->NowMicros() - start) * 1e-3, FLAGS_lg_num, FLAGS_lg_recover_threads);
+  }
+
   void WriteSeq(ThreadState* thread) { DoWrite(thread, true); }
 
   void WriteRandom(ThreadState* thread) { DoWrite(thread, false); }
@@ -863,10 +909,9 @@ class Benchmark {
       batch.Clear();
       for (int j = 0; j < entries_per_batch_; j++) {
         const int k = seq ? i + j : (thread->rand.Next() % FLAGS_num);
-        char key[100];
-        snprintf(key, sizeof(key), "%016d", k);
+        const std::string key = LGKey(k);
         batch.Put(key, gen.Generate(value_size_));
-        bytes += value_size_ + strlen(key);
+        bytes += value_size_ + key.size();
         thread->stats.FinishedSingleOp();
       }
       s = db_->Write(write_options_, &batch);
@@ -909,10 +954,8 @@ class Benchmark {
     std::string value;
     int found = 0;
     for (int i = 0; i < reads_; i++) {
-      char key[100];
       const int k = thread->rand.Next() % FLAGS_num;
-      snprintf(key, sizeof(key), "%016d", k);
-      if (db_->Get(options, key, &value).ok()) {
+      if (db_->Get(options, LGKey(k), &value).ok()) {
         found++;
       }
       thread->stats.FinishedSingleOp();
@@ -1094,6 +1137,10 @@ int main(int argc, char** argv) {
       FLAGS_open_files = n;
     } else if (sscanf(argv[i], "--block_size=%d%c", &n, &junk) == 1) {
       FLAGS_block_size = n;
+    } else if (sscanf(argv[i], "--lg_num=%d%c", &n, &junk) == 1 && n > 0) {
+      FLAGS_lg_num = n;
+    } else if (sscanf(argv[i], "--lg_recover_threads=%d%c", &n, &junk) == 1 && n > 0) {
+      FLAGS_lg_recover_threads = n;
     } else if (strncmp(argv[i], "--env=", 6) == 0) {
       FLAGS_env = argv[i] + 6;
     } else if (strncmp(argv[i], "--db=", 5) == 0) {
@@ -1837,6 +1837,12 @@ void DBImpl::Workload(double* write_workload) {
   }
 }
 
+void DBImpl::CompactionDebt(int* level0_files, uint64_t* pending_compaction_bytes) {
+  MutexLock l(&mutex_);
+  *level0_files = versions_->NumLevelFiles(0);
+  *pending_compaction_bytes = versions_->PendingCompactionBytes();
+}
+
 Status DBImpl::Write(const WriteOptions& options, WriteBatch* my_batch) {
   Writer w(&mutex_);
   w.batch = my_batch;
@@ -63,6 +63,7 @@ class DBImpl : public DB {
   // tera-specific
   virtual bool BusyWrite();
   virtual void Workload(double* write_workload);
+  virtual void CompactionDebt(int* level0_files, uint64_t* pending_compaction_bytes);
 
   bool FindSplitKey(double ratio, std::string* split_key);
   bool FindKeyRange(std::string* smallest_key, std::string* largest_key);
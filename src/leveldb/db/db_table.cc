@@ -8,7 +8,11 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <thread>
 #include <vector>
 
 #include "db/db_impl.h"
@@ -243,6 +247,28 @@ DBTable::~DBTable() {
   }
 }
 
+// Runs |func| for every lg in |lgs|, at most |parallelism| lgs at a time,
+// the calling thread included.
+static void ParallelForEachLG(const std::set<uint32_t>& lgs, int parallelism,
+                              const std::function<void(uint32_t)>& func) {
+  std::vector<uint32_t> lg_ids(lgs.begin(), lgs.end());
+  std::atomic<size_t> next_lg(0);
+  auto worker = [&]() {
+    for (size_t i = next_lg++; i < lg_ids.size(); i = next_lg++) {
+      func(lg_ids[i]);
+    }
+  };
+  size_t thread_num = std::min(static_cast<size_t>(std::max(parallelism, 1)), lg_ids.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_num; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].join();
+  }
+}
+
 Status DBTable::Init() {
   std::vector<VersionEdit*> lg_edits;
   LEVELDB_LOG(options_.info_log, "[%s] start Init()", dbname_.c_str());
@@ -272,13 +298,23 @@ Status DBTable::Init() {
     for (; rollback_it != rollbacks.end(); ++rollback_it) {
       impl->Rollback(rollback_it->first, rollback_it->second);
     }
+  }
 
-    // recover SST
+  // recover SST, lgs are independent of each other
+  std::vector<Status> lg_status(lg_list_.size());
+  ParallelForEachLG(*options_.exist_lg_list, options_.max_parallel_lg_recover, [&](uint32_t i) {
+    DBImpl* impl = lg_list_[i];
     LEVELDB_LOG(options_.info_log, "[%s] start Recover lg%d, last_seq= %lu", dbname_.c_str(), i,
                 impl->GetLastSequence());
-    s = impl->Recover(lg_edits[i]);
+    lg_status[i] = impl->Recover(lg_edits[i]);
     LEVELDB_LOG(options_.info_log, "[%s] end Recover lg%d, last_seq= %lu", dbname_.c_str(), i,
                 impl->GetLastSequence());
+  });
+  for (std::set<uint32_t>::iterator it = options_.exist_lg_list->begin();
+       it != options_.exist_lg_list->end(); ++it) {
+    uint32_t i = *it;
+    DBImpl* impl = lg_list_[i];
+    s = lg_status[i];
     if (s.ok()) {
       uint64_t last_seq = impl->GetLastSequence();
 
@@ -327,12 +363,15 @@ Status DBTable::Init() {
   }
 
   LEVELDB_LOG(options_.info_log, "[%s] start RecoverLogToLevel0Table", dbname_.c_str());
-  std::set<uint32_t>::iterator it = options_.exist_lg_list->begin();
-  for (; it != options_.exist_lg_list->end(); ++it) {
-    uint32_t i = *it;
-    DBImpl* impl = lg_list_[i];
-    s = impl->RecoverLastDumpToLevel0(lg_edits[i]);
+  ParallelForEachLG(*options_.exist_lg_list, options_.max_parallel_lg_recover, [&](uint32_t i) {
+    lg_status[i] = lg_list_[i]->RecoverLastDumpToLevel0(lg_edits[i]);
     delete lg_edits[i];
+  });
+  // the first failed lg fails the whole table
+  s = Status::OK();
+  std::set<uint32_t>::iterator it = options_.exist_lg_list->begin();
+  for (; it != options_.exist_lg_list->end() && s.ok(); ++it) {
+    s = lg_status[*it];
   }
 
   if (s.ok()) {
@@ -416,6 +455,22 @@ void DBTable::Workload(double* write_workload) {
   }
 }
 
+void DBTable::CompactionDebt(int* level0_files, uint64_t* pending_compaction_bytes) {
+  *level0_files = 0;
+  *pending_compaction_bytes = 0;
+  MutexLock l(&mutex_);
+  for (std::set<uint32_t>::iterator it = options_.exist_lg_list->begin();
+       it != options_.exist_lg_list->end(); ++it) {
+    int lg_level0_files = 0;
+    uint64_t lg_pending_bytes = 0;
+    lg_list_[*it]->CompactionDebt(&lg_level0_files, &lg_pending_bytes);
+    if (lg_level0_files > *level0_files) {
+      *level0_files = lg_level0_files;
+    }
+    *pending_compaction_bytes += lg_pending_bytes;
+  }
+}
+
 Status DBTable::Write(const WriteOptions& options, WriteBatch* my_batch) {
   RecordWriter w(&mutex_);
   w.batch = my_batch;
@@ -893,6 +948,108 @@ Status DBTable::GatherLogFile(uint64_t begin_num, std::vector<uint64_t>* logfile
   return s;
 }
 
+// Inserts the lg batches of recovered log records into lg memtables on
+// several threads. All batches of an lg go to the same thread in the order
+// they are added, so every lg still replays its records in log order.
+class DBTable::LGReplayer {
+ public:
+  LGReplayer(const std::vector<DBImpl*>& lgs, std::vector<VersionEdit*>* edits,
+             uint32_t thread_num, Logger* info_log)
+      : lgs_(lgs),
+        edits_(edits),
+        info_log_(info_log),
+        work_cv_(&mutex_),
+        done_cv_(&mutex_),
+        queues_(thread_num),
+        pending_num_(0),
+        finished_(false) {
+    for (uint32_t i = 0; i < thread_num; ++i) {
+      threads_.emplace_back(&LGReplayer::Work, this, i);
+    }
+  }
+
+  ~LGReplayer() { Finish(); }
+
+  // Takes the ownership of |batch|, blocks while too many batches are
+  // pending. Returns the first insert failure so far.
+  Status Add(uint32_t lg_id, WriteBatch* batch) {
+    MutexLock lock(&mutex_);
+    while (pending_num_ >= kMaxPendingBatchNum) {
+      done_cv_.Wait();
+    }
+    queues_[lg_id % queues_.size()].push_back(std::make_pair(lg_id, batch));
+    ++pending_num_;
+    work_cv_.SignalAll();
+    return status_;
+  }
+
+  // Waits for all added batches to be inserted.
+  Status Finish() {
+    mutex_.Lock();
+    finished_ = true;
+    work_cv_.SignalAll();
+    mutex_.Unlock();
+    for (size_t i = 0; i < threads_.size(); ++i) {
+      threads_[i].join();
+    }
+    threads_.clear();
+    MutexLock lock(&mutex_);
+    return status_;
+  }
+
+ private:
+  void Work(uint32_t queue_id) {
+    std::deque<std::pair<uint32_t, WriteBatch*> >& queue = queues_[queue_id];
+    MutexLock lock(&mutex_);
+    while (true) {
+      while (queue.empty() && !finished_) {
+        work_cv_.Wait();
+      }
+      if (queue.empty()) {
+        break;
+      }
+      uint32_t lg_id = queue.front().first;
+      WriteBatch* batch = queue.front().second;
+      queue.pop_front();
+      // once an insert fails, the remaining batches are dropped
+      bool skip = !status_.ok();
+      mutex_.Unlock();
+      Status s;
+      if (!skip) {
+        s = lgs_[lg_id]->RecoverInsertMem(batch, (*edits_)[lg_id]);
+        if (!s.ok()) {
+          uint64_t first = WriteBatchInternal::Sequence(batch);
+          LEVELDB_LOG(info_log_, "recover log fail lg %u batch first= %lu, last= %lu\n", lg_id,
+                      first, first + WriteBatchInternal::Count(batch) - 1);
+        }
+      }
+      delete batch;
+      mutex_.Lock();
+      if (!s.ok() && status_.ok()) {
+        status_ = s;
+      }
+      --pending_num_;
+      done_cv_.SignalAll();
+    }
+  }
+
+  // bounds the memory of decoded but not yet inserted batches
+  static const size_t kMaxPendingBatchNum = 1024;
+
+  const std::vector<DBImpl*>& lgs_;
+  std::vector<VersionEdit*>* edits_;
+  Logger* info_log_;
+
+  port::Mutex mutex_;
+  port::CondVar work_cv_;
+  port::CondVar done_cv_;
+  std::vector<std::deque<std::pair<uint32_t, WriteBatch*> > > queues_;
+  size_t pending_num_;
+  bool finished_;
+  Status status_;
+  std::vector<std::thread> threads_;
+};
+
 Status DBTable::RecoverLogFile(uint64_t log_number, uint64_t recover_limit,
                                std::vector<VersionEdit*>* edit_list) {
   struct LogReporter : public log::Reader::Reporter {
@@ -929,6 +1086,15 @@ Status DBTable::RecoverLogFile(uint64_t log_number, uint64_t recover_limit,
   LEVELDB_LOG(options_.info_log, "[%s] Recovering log #%lx, sequence limit %lu", dbname_.c_str(),
               log_number, recover_limit);
 
+  // this thread reads and separates the records, lg inserts may be
+  // dispatched to replayer threads
+  std::unique_ptr<LGReplayer> replayer;
+  uint32_t replay_thread_num =
+      std::min(static_cast<size_t>(std::max(options_.max_parallel_lg_recover, 1)), lg_list_.size());
+  if (replay_thread_num > 1) {
+    replayer.reset(new LGReplayer(lg_list_, edit_list, replay_thread_num, options_.info_log));
+  }
+
   // Read all the records and add to a memtable
   std::string scratch;
   Slice record;
@@ -970,7 +1136,6 @@ Status DBTable::RecoverLogFile(uint64_t log_number, uint64_t recover_limit,
     }
 
     if (status.ok()) {
-      // TODO: should be multi-thread distributed
       for (uint32_t i = 0; i < lg_updates.size(); ++i) {
         if (lg_updates[i] == NULL) {
           continue;
@@ -978,6 +1143,12 @@ Status DBTable::RecoverLogFile(uint64_t log_number, uint64_t recover_limit,
         if (last_seq <= lg_list_[i]->GetLastSequence()) {
           continue;
         }
+        if (replayer) {
+          // lg_updates are separated copies here, the replayer owns them
+          status = replayer->Add(i, lg_updates[i]);
+          lg_updates[i] = NULL;
+          continue;
+        }
         uint64_t first = WriteBatchInternal::Sequence(lg_updates[i]);
         uint64_t last = first + WriteBatchInternal::Count(lg_updates[i]) - 1;
         // LEVELDB_LOG(options_.info_log, "[%s] recover log batch first= %lu,
@@ -1002,6 +1173,12 @@ Status DBTable::RecoverLogFile(uint64_t log_number, uint64_t recover_limit,
       }
     }
   }
+  if (replayer) {
+    Status replay_status = replayer->Finish();
+    if (status.ok()) {
+      status = replay_status;
+    }
+  }
   delete file;
   return status;
 }
@@ -51,6 +51,9 @@ class DBTable : public DB {
 
   virtual void Workload(double* write_workload);
 
+  // Max level0 files of all lgs, and sum of their pending compaction bytes.
+  virtual void CompactionDebt(int* level0_files, uint64_t* pending_compaction_bytes);
+
   // Apply the specified updates to the database.
   // Returns OK on success, non-OK on failure.
   // Note: consider setting options.sync = true.
@@ -158,6 +161,7 @@ class DBTable : public DB {
  private:
   struct RecordWriter;
   WriteBatch* GroupWriteBatch(RecordWriter** last_writer);
+  class LGReplayer;
 
   Status RecoverLogFile(uint64_t log_number, uint64_t recover_limit,
                         std::vector<VersionEdit*>* edit_list);
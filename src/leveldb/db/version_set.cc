@@ -2116,6 +2116,27 @@ int64_t VersionSet::NumLevelBytes(int level) const {
   return TotalFileSize(current_->files_[level]);
 }
 
+uint64_t VersionSet::PendingCompactionBytes() const {
+  uint64_t pending_bytes = 0;
+  // bytes pushed down by compactions of upper levels add to the next level
+  uint64_t incoming_bytes = 0;
+  if (current_->files_[0].size() >= static_cast<size_t>(config::kL0_CompactionTrigger)) {
+    incoming_bytes = TotalFileSize(current_->files_[0]);
+    pending_bytes += incoming_bytes;
+  }
+  for (int level = 1; level < config::kNumLevels - 1; level++) {
+    uint64_t level_bytes = TotalFileSize(current_->files_[level]) + incoming_bytes;
+    double max_bytes = MaxBytesForLevel(level, options_->sst_size);
+    if (level_bytes <= max_bytes) {
+      incoming_bytes = 0;
+      continue;
+    }
+    incoming_bytes = level_bytes - static_cast<uint64_t>(max_bytes);
+    pending_bytes += incoming_bytes;
+  }
+  return pending_bytes;
+}
+
 int64_t VersionSet::MaxNextLevelOverlappingBytes() {
   int64_t result = 0;
   std::vector<FileMetaData*> overlaps;
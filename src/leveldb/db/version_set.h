@@ -237,6 +237,10 @@ class VersionSet {
   // Return the combined file size of all files at the specified level.
   int64_t NumLevelBytes(int level) const;
 
+  // Return the estimated bytes compactions have to rewrite to bring level0
+  // under compaction trigger and every other level under its size limit.
+  uint64_t PendingCompactionBytes() const;
+
   // Return the last sequence number.
   uint64_t LastSequence() const { return last_sequence_; }
 
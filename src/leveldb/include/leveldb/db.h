@@ -160,6 +160,10 @@ class DB {
 
   virtual void Workload(double* write_workload) = 0;
 
+  // Number of level0 files, and bytes to compact before every level is
+  // within its size limit.
+  virtual void CompactionDebt(int* level0_files, uint64_t* pending_compaction_bytes) = 0;
+
   virtual bool FindSplitKey(double ratio, std::string* split_key) = 0;
   virtual bool FindKeyRange(std::string* smallest_key = NULL, std::string* largest_key = NULL) = 0;
 
@@ -352,6 +352,9 @@ struct Options {
   // parallel compaction
   int max_sub_parallel_compaction;
 
+  // max number of lgs recovered in parallel when opening a tablet
+  int max_parallel_lg_recover;
+
   bool use_direct_io_read;
   bool use_direct_io_write;
   uint64_t posix_write_buffer_size;
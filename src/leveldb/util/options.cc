@@ -56,6 +56,7 @@ Options::Options()
       max_background_compactions(5),
       slow_down_level0_score_limit(30),
       max_sub_parallel_compaction(10),
+      max_parallel_lg_recover(1),
       use_direct_io_read(false),
       use_direct_io_write(false),
       posix_write_buffer_size(512 << 10),
@@ -33,6 +33,7 @@ Cluster::Cluster(const std::vector<std::shared_ptr<LBTabletNode>>& lb_nodes,
   tablet_node_num_ = 0;
   tablet_num_ = 0;
   tablet_moved_num_ = 0;
+  tablet_cold_moved_num_ = 0;
 
   for (const auto& node : lb_nodes_) {
     uint32_t node_index = nodes_.size();
@@ -136,6 +137,7 @@ void Cluster::DebugCluster() {
   LOG(INFO) << "tablet_node_num_:" << tablet_node_num_;
   LOG(INFO) << "tablet_num_:" << tablet_num_;
   LOG(INFO) << "tablet_moved_num_:" << tablet_moved_num_;
+  LOG(INFO) << "tablet_cold_moved_num_:" << tablet_cold_moved_num_;
 
   LOG(INFO) << "[table_index -> table]:";
   for (const auto& table : tables_) {
@@ -715,13 +717,32 @@ void Cluster::MoveTablet(uint32_t tablet_index, uint32_t source_node_index,
                          uint32_t dest_node_index) {
   tablet_index_to_node_index_[tablet_index] = dest_node_index;
 
-  if (initial_tablet_index_to_node_index_[tablet_index] == source_node_index) {
+  uint32_t initial_node_index = initial_tablet_index_to_node_index_[tablet_index];
+  if (initial_node_index == source_node_index) {
     ++tablet_moved_num_;
-  } else if (initial_tablet_index_to_node_index_[tablet_index] == dest_node_index) {
+  } else if (initial_node_index == dest_node_index) {
     // tablet moved back
     --tablet_moved_num_;
     assert(tablet_moved_num_ >= 0);
   }
+
+  // the cache sketch of a node may be replaced by heartbeat during the search,
+  // so take back exactly what was counted when the tablet moved in
+  if (cold_moved_tablets_.erase(tablet_index) > 0) {
+    --tablet_cold_moved_num_;
+  }
+  if (dest_node_index != initial_node_index && IsCacheCold(tablet_index, dest_node_index)) {
+    cold_moved_tablets_.insert(tablet_index);
+    ++tablet_cold_moved_num_;
+  }
+}
+
+bool Cluster::IsCacheCold(uint32_t tablet_index, uint32_t node_index) {
+  const tera::master::TabletPtr& tablet = tablets_[tablet_index]->tablet_ptr;
+  if (tablet->GetDataSizeOnFlash() <= 0) {
+    return false;
+  }
+  return !nodes_[node_index]->tablet_node_ptr->MayCacheTablet(tablet->GetPath());
 }
 
 }  // namespace load_balancer
@@ -83,6 +83,10 @@ class Cluster {
 
   bool IsProperTargetTablet(uint32_t tablet_index);
 
+  // whether the tablet has flash data and the node may not hold its files in
+  // persistent cache
+  bool IsCacheCold(uint32_t tablet_index, uint32_t node_index);
+
  private:
   void RegisterTablet(const std::shared_ptr<LBTablet>& tablet, uint32_t tablet_index,
                       uint32_t node_index);
@@ -97,6 +101,10 @@ class Cluster {
   uint32_t tablet_node_num_;
   uint32_t tablet_num_;
   uint32_t tablet_moved_num_;
+  // moved tablets which are cache cold on their current node
+  uint32_t tablet_cold_moved_num_;
+  // tablets counted in tablet_cold_moved_num_
+  std::unordered_set<uint32_t> cold_moved_tablets_;
 
   // table_index -> table
   std::map<uint32_t, std::string> tables_;
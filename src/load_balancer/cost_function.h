@@ -31,6 +31,10 @@ class CostFunction {
 
   virtual void Init(const std::shared_ptr<Cluster>& cluster) { cluster_ = cluster; }
 
+  // Called after |action| has been applied to the cluster, cost functions
+  // which cache cluster state should refresh it here.
+  virtual void OnAction(const std::shared_ptr<Action>& action) {}
+
   double GetWeight() const { return weight_; }
 
   void SetWeight(double w) { weight_ = w; }
@@ -62,12 +66,23 @@ class CostFunction {
       LOG(INFO) << "[lb] stats:" << line;
     }
 
-    double total_cost = 0;
     double total = GetSum(stats);
-
     double count = stats.size();
     double mean = total / count;
 
+    double total_cost = 0;
+    for (size_t i = 0; i < stats.size(); i++) {
+      double n = stats[i];
+      double diff = std::abs(mean - n);
+      total_cost += diff;
+    }
+
+    return ScaleFromStats(count, total, total_cost);
+  }
+
+  // |deviation| is the sum of |mean - stat| of all |count| stats
+  double ScaleFromStats(double count, double total, double deviation) {
+    double mean = total / count;
     double max = ((count - 1) * mean) + (total - mean);
 
     double min;
@@ -80,13 +95,8 @@ class CostFunction {
       min = (num_high * (ceil(mean) - mean)) + (num_low * (mean - floor(mean)));
     }
     min = std::max(0.0, min);
-    for (size_t i = 0; i < stats.size(); i++) {
-      double n = stats[i];
-      double diff = std::abs(mean - n);
-      total_cost += diff;
-    }
 
-    return Scale(min, max, total_cost);
+    return Scale(min, max, deviation);
   }
 
  private:
@@ -100,10 +110,10 @@ class CostFunction {
 
  protected:
   std::shared_ptr<Cluster> cluster_;
+  LBOptions lb_options_;
 
  private:
   double weight_;
-  LBOptions lb_options_;
   std::string name_;
 };
 
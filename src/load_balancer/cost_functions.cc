@@ -5,148 +5,211 @@
 #include "load_balancer/cost_functions.h"
 
 #include <algorithm>
+#include <cmath>
 #include <vector>
 
+#include "load_balancer/actions.h"
+
 namespace tera {
 namespace load_balancer {
 
+// relative change of mean treated as float noise by incremental deviation
+static const double kMeanEpsilon = 1e-9;
+
 MoveCountCostFunction::MoveCountCostFunction(const LBOptions& options)
     : CostFunction(options, "MoveCountCostFunction"),
       kExpensiveCost(1000000),
-      tablet_max_move_num_(options.tablet_max_move_num) {
+      tablet_max_move_num_(options.tablet_max_move_num),
+      cache_miss_move_cost_(options.cache_miss_move_cost) {
   SetWeight(options.move_count_cost_weight);
 }
 
 MoveCountCostFunction::~MoveCountCostFunction() {}
 
 double MoveCountCostFunction::Cost() {
-  double cost = cluster_->tablet_moved_num_;
-  if (cost > static_cast<double>(tablet_max_move_num_)) {
+  if (cluster_->tablet_moved_num_ > tablet_max_move_num_) {
     // return an expensive cost
     VLOG(20) << "[lb] reach max move num limit: " << tablet_max_move_num_;
     return kExpensiveCost;
   }
 
+  // a move to a node without the tablet in persistent cache costs more, as
+  // reads go to dfs until the cache is warm again
+  double cost =
+      cluster_->tablet_moved_num_ + cache_miss_move_cost_ * cluster_->tablet_cold_moved_num_;
   return Scale(0, std::max(cluster_->tablet_num_, tablet_max_move_num_), cost);
 }
 
+NodeStatCostFunction::NodeStatCostFunction(const LBOptions& options, const std::string& name)
+    : CostFunction(options, name), count_(0), total_(0), deviation_(0) {}
+
+NodeStatCostFunction::~NodeStatCostFunction() {}
+
+void NodeStatCostFunction::Init(const std::shared_ptr<Cluster>& cluster) {
+  CostFunction::Init(cluster);
+
+  stats_.assign(cluster_->tablet_node_num_, 0);
+  counted_.assign(cluster_->tablet_node_num_, false);
+  count_ = 0;
+  total_ = 0;
+  for (uint32_t i = 0; i < cluster_->tablet_node_num_; ++i) {
+    double stat = 0;
+    if (GetNodeStat(i, &stat)) {
+      stats_[i] = stat;
+      counted_[i] = true;
+      ++count_;
+      total_ += stat;
+    }
+  }
+  ComputeDeviation();
+}
+
+void NodeStatCostFunction::OnAction(const std::shared_ptr<Action>& action) {
+  if (action->GetType() != Action::Type::MOVE) {
+    return;
+  }
+  MoveAction* move_action = dynamic_cast<MoveAction*>(action.get());
+  RefreshNodes(move_action->source_node_index_, move_action->dest_node_index_);
+}
+
+void NodeStatCostFunction::RefreshNodes(uint32_t source_node_index, uint32_t dest_node_index) {
+  double old_mean = total_ / count_;
+  const uint32_t nodes[2] = {source_node_index, dest_node_index};
+  for (uint32_t node_index : nodes) {
+    if (node_index >= stats_.size() || !counted_[node_index]) {
+      continue;
+    }
+    deviation_ -= std::abs(old_mean - stats_[node_index]);
+    double stat = 0;
+    GetNodeStat(node_index, &stat);
+    total_ += stat - stats_[node_index];
+    stats_[node_index] = stat;
+  }
+
+  double new_mean = total_ / count_;
+  if (std::abs(new_mean - old_mean) > kMeanEpsilon * std::max(std::abs(old_mean), 1.0)) {
+    ComputeDeviation();
+    return;
+  }
+  for (uint32_t node_index : nodes) {
+    if (node_index < stats_.size() && counted_[node_index]) {
+      deviation_ += std::abs(new_mean - stats_[node_index]);
+    }
+  }
+}
+
+void NodeStatCostFunction::ComputeDeviation() {
+  double mean = total_ / count_;
+  deviation_ = 0;
+  for (uint32_t i = 0; i < stats_.size(); ++i) {
+    if (counted_[i]) {
+      deviation_ += std::abs(mean - stats_[i]);
+    }
+  }
+}
+
+double NodeStatCostFunction::Cost() {
+  if (lb_options_.debug_mode_enabled) {
+    std::vector<double> stats;
+    for (uint32_t i = 0; i < stats_.size(); ++i) {
+      if (counted_[i]) {
+        stats.emplace_back(stats_[i]);
+      }
+    }
+    return ScaleFromArray(stats);
+  }
+  return ScaleFromStats(count_, total_, deviation_);
+}
+
 TabletCountCostFunction::TabletCountCostFunction(const LBOptions& options)
-    : CostFunction(options, "TabletCountCostFunction") {
+    : NodeStatCostFunction(options, "TabletCountCostFunction") {
   SetWeight(options.tablet_count_cost_weight);
 }
 
 TabletCountCostFunction::~TabletCountCostFunction() {}
 
-double TabletCountCostFunction::Cost() {
-  std::vector<double> tablet_nums_per_node;
-  for (uint32_t i = 0; i < cluster_->tablet_node_num_; ++i) {
-    tablet_nums_per_node.emplace_back(cluster_->tablets_per_node_[i].size());
-  }
-
-  return ScaleFromArray(tablet_nums_per_node);
+bool TabletCountCostFunction::GetNodeStat(uint32_t node_index, double* stat) {
+  *stat = cluster_->tablets_per_node_[node_index].size();
+  return true;
 }
 
 SizeCostFunction::SizeCostFunction(const LBOptions& options)
-    : CostFunction(options, "SizeCostFunction") {
+    : NodeStatCostFunction(options, "SizeCostFunction") {
   SetWeight(options.size_cost_weight);
 }
 
 SizeCostFunction::~SizeCostFunction() {}
 
-double SizeCostFunction::Cost() {
-  std::vector<double> size_per_node;
-  for (uint32_t i = 0; i < cluster_->tablet_node_num_; ++i) {
-    size_per_node.emplace_back(cluster_->size_per_node_[i]);
-  }
-
-  return ScaleFromArray(size_per_node);
+bool SizeCostFunction::GetNodeStat(uint32_t node_index, double* stat) {
+  *stat = cluster_->size_per_node_[node_index];
+  return true;
 }
 
 FlashSizeCostFunction::FlashSizeCostFunction(const LBOptions& options)
-    : CostFunction(options, "FlashSizeCostFunction") {
+    : NodeStatCostFunction(options, "FlashSizeCostFunction") {
   SetWeight(options.flash_size_cost_weight);
 }
 
 FlashSizeCostFunction::~FlashSizeCostFunction() {}
 
-double FlashSizeCostFunction::Cost() {
-  std::vector<double> flash_size_percent_per_node;
-  for (uint32_t i = 0; i < cluster_->tablet_node_num_; ++i) {
-    uint64_t node_flash_capacity = cluster_->nodes_[i]->tablet_node_ptr->GetPersistentCacheSize();
-    if (node_flash_capacity == 0) {
-      // skip the node which does not has ssd
-      continue;
-    }
-    assert(node_flash_capacity > 0);
-    flash_size_percent_per_node.emplace_back(100.0 * cluster_->flash_size_per_node_[i] /
-                                             node_flash_capacity);
+bool FlashSizeCostFunction::GetNodeStat(uint32_t node_index, double* stat) {
+  uint64_t node_flash_capacity =
+      cluster_->nodes_[node_index]->tablet_node_ptr->GetPersistentCacheSize();
+  if (node_flash_capacity == 0) {
+    // skip the node which does not has ssd
+    return false;
   }
-
-  return ScaleFromArray(flash_size_percent_per_node);
+  assert(node_flash_capacity > 0);
+  *stat = 100.0 * cluster_->flash_size_per_node_[node_index] / node_flash_capacity;
+  return true;
 }
 
 ReadLoadCostFunction::ReadLoadCostFunction(const LBOptions& options)
-    : CostFunction(options, "ReadLoadCostFunction") {
+    : NodeStatCostFunction(options, "ReadLoadCostFunction") {
   SetWeight(options.read_load_cost_weight);
 }
 
 ReadLoadCostFunction::~ReadLoadCostFunction() {}
 
-double ReadLoadCostFunction::Cost() {
-  std::vector<double> read_load_per_node;
-  for (uint32_t i = 0; i < cluster_->tablet_node_num_; ++i) {
-    read_load_per_node.emplace_back(cluster_->read_load_per_node_[i]);
-  }
-
-  return ScaleFromArray(read_load_per_node);
+bool ReadLoadCostFunction::GetNodeStat(uint32_t node_index, double* stat) {
+  *stat = cluster_->read_load_per_node_[node_index];
+  return true;
 }
 
 WriteLoadCostFunction::WriteLoadCostFunction(const LBOptions& options)
-    : CostFunction(options, "WriteLoadCostFunction") {
+    : NodeStatCostFunction(options, "WriteLoadCostFunction") {
   SetWeight(options.write_load_cost_weight);
 }
 
 WriteLoadCostFunction::~WriteLoadCostFunction() {}
 
-double WriteLoadCostFunction::Cost() {
-  std::vector<double> write_load_per_node;
-  for (uint32_t i = 0; i < cluster_->tablet_node_num_; ++i) {
-    write_load_per_node.emplace_back(cluster_->write_load_per_node_[i]);
-  }
-
-  return ScaleFromArray(write_load_per_node);
+bool WriteLoadCostFunction::GetNodeStat(uint32_t node_index, double* stat) {
+  *stat = cluster_->write_load_per_node_[node_index];
+  return true;
 }
 
 ScanLoadCostFunction::ScanLoadCostFunction(const LBOptions& options)
-    : CostFunction(options, "ScanLoadCostFunction") {
+    : NodeStatCostFunction(options, "ScanLoadCostFunction") {
   SetWeight(options.scan_load_cost_weight);
 }
 
 ScanLoadCostFunction::~ScanLoadCostFunction() {}
 
-double ScanLoadCostFunction::Cost() {
-  std::vector<double> scan_load_per_node;
-  for (uint32_t i = 0; i < cluster_->tablet_node_num_; ++i) {
-    scan_load_per_node.emplace_back(cluster_->scan_load_per_node_[i]);
-  }
-
-  return ScaleFromArray(scan_load_per_node);
+bool ScanLoadCostFunction::GetNodeStat(uint32_t node_index, double* stat) {
+  *stat = cluster_->scan_load_per_node_[node_index];
+  return true;
 }
 
 LReadCostFunction::LReadCostFunction(const LBOptions& options)
-    : CostFunction(options, "LReadCostFunction") {
+    : NodeStatCostFunction(options, "LReadCostFunction") {
   SetWeight(options.lread_cost_weight);
 }
 
 LReadCostFunction::~LReadCostFunction() {}
 
-double LReadCostFunction::Cost() {
-  std::vector<double> lread_per_node;
-  for (uint32_t i = 0; i < cluster_->tablet_node_num_; ++i) {
-    lread_per_node.emplace_back(cluster_->lread_per_node_[i]);
-  }
-
-  return ScaleFromArray(lread_per_node);
+bool LReadCostFunction::GetNodeStat(uint32_t node_index, double* stat) {
+  *stat = cluster_->lread_per_node_[node_index];
+  return true;
 }
 
 }  // namespace load_balancer
@@ -5,6 +5,8 @@
 #ifndef TERA_LOAD_BALANCER_COST_FUNCTIONS_H_
 #define TERA_LOAD_BALANCER_COST_FUNCTIONS_H_
 
+#include <vector>
+
 #include "load_balancer/cost_function.h"
 
 namespace tera {
@@ -20,62 +22,105 @@ class MoveCountCostFunction : public CostFunction {
  private:
   const double kExpensiveCost;
   uint32_t tablet_max_move_num_;
+  double cache_miss_move_cost_;
+};
+
+// Cost of how uneven a per node stat is spread.
+//
+// Per node stats are cached at Init(), after a move only the source and dest
+// node are refreshed. As long as the total of all nodes is kept by the move,
+// the mean is unchanged and the deviation is updated in O(1), otherwise it is
+// recomputed from the cached stats.
+class NodeStatCostFunction : public CostFunction {
+ public:
+  NodeStatCostFunction(const LBOptions& options, const std::string& name);
+  virtual ~NodeStatCostFunction();
+
+  virtual void Init(const std::shared_ptr<Cluster>& cluster) override;
+
+  virtual void OnAction(const std::shared_ptr<Action>& action) override;
+
+  virtual double Cost() override;
+
+ protected:
+  // return false if the node should not be taken into account
+  virtual bool GetNodeStat(uint32_t node_index, double* stat) = 0;
+
+ private:
+  void RefreshNodes(uint32_t source_node_index, uint32_t dest_node_index);
+  void ComputeDeviation();
+
+ private:
+  // node_index -> stat of the node
+  std::vector<double> stats_;
+  std::vector<bool> counted_;
+  uint32_t count_;
+  double total_;
+  // sum of |mean - stat| of counted nodes
+  double deviation_;
 };
 
-class TabletCountCostFunction : public CostFunction {
+class TabletCountCostFunction : public NodeStatCostFunction {
  public:
   TabletCountCostFunction(const LBOptions& options);
   virtual ~TabletCountCostFunction();
 
-  virtual double Cost() override;
+ protected:
+  virtual bool GetNodeStat(uint32_t node_index, double* stat) override;
 };
 
-class SizeCostFunction : public CostFunction {
+class SizeCostFunction : public NodeStatCostFunction {
  public:
   SizeCostFunction(const LBOptions& options);
   virtual ~SizeCostFunction();
 
-  virtual double Cost() override;
+ protected:
+  virtual bool GetNodeStat(uint32_t node_index, double* stat) override;
 };
 
-class FlashSizeCostFunction : public CostFunction {
+class FlashSizeCostFunction : public NodeStatCostFunction {
  public:
   FlashSizeCostFunction(const LBOptions& options);
   virtual ~FlashSizeCostFunction();
 
-  virtual double Cost() override;
+ protected:
+  virtual bool GetNodeStat(uint32_t node_index, double* stat) override;
 };
 
-class ReadLoadCostFunction : public CostFunction {
+class ReadLoadCostFunction : public NodeStatCostFunction {
  public:
   ReadLoadCostFunction(const LBOptions& options);
   virtual ~ReadLoadCostFunction();
 
-  virtual double Cost() override;
+ protected:
+  virtual bool GetNodeStat(uint32_t node_index, double* stat) override;
 };
 
-class WriteLoadCostFunction : public CostFunction {
+class WriteLoadCostFunction : public NodeStatCostFunction {
  public:
   WriteLoadCostFunction(const LBOptions& options);
   virtual ~WriteLoadCostFunction();
 
-  virtual double Cost() override;
+ protected:
+  virtual bool GetNodeStat(uint32_t node_index, double* stat) override;
 };
 
-class ScanLoadCostFunction : public CostFunction {
+class ScanLoadCostFunction : public NodeStatCostFunction {
  public:
   ScanLoadCostFunction(const LBOptions& options);
   virtual ~ScanLoadCostFunction();
 
-  virtual double Cost() override;
+ protected:
+  virtual bool GetNodeStat(uint32_t node_index, double* stat) override;
 };
 
-class LReadCostFunction : public CostFunction {
+class LReadCostFunction : public NodeStatCostFunction {
  public:
   LReadCostFunction(const LBOptions& options);
   virtual ~LReadCostFunction();
 
-  virtual double Cost() override;
+ protected:
+  virtual bool GetNodeStat(uint32_t node_index, double* stat) override;
 };
 
 }  // namespace load_balancer
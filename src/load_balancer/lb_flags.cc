@@ -26,8 +26,13 @@ DEFINE_int32(tera_lb_max_compute_time_ms, 30000,
 DEFINE_double(tera_lb_min_cost_need_balance, 0.02, "min cost needed for balance");
 DEFINE_double(tera_lb_bad_node_safemode_percent, 0.5,
               "if bad node num percent is higher than this, skip balance");
+DEFINE_int32(tera_lb_parallel_search_num, 1,
+             "number of independent balance searches run in parallel, "
+             "the plan of lowest cost is taken");
 
 DEFINE_double(tera_lb_move_count_cost_weight, 1, "move cost weight");
+DEFINE_double(tera_lb_cache_miss_move_cost, 1,
+              "extra move count of moving a tablet to a node without its persistent cache");
 DEFINE_int32(tera_lb_tablet_max_move_num, 2,
              "default tablet max move num for one balance procedure");
 
@@ -30,7 +30,9 @@ DECLARE_int32(tera_lb_max_compute_steps_per_tablet);
 DECLARE_int32(tera_lb_max_compute_time_ms);
 DECLARE_double(tera_lb_min_cost_need_balance);
 DECLARE_double(tera_lb_bad_node_safemode_percent);
+DECLARE_int32(tera_lb_parallel_search_num);
 DECLARE_double(tera_lb_move_count_cost_weight);
+DECLARE_double(tera_lb_cache_miss_move_cost);
 DECLARE_int32(tera_lb_meta_balance_max_move_num);
 DECLARE_int32(tera_lb_tablet_max_move_num);
 DECLARE_int32(tera_lb_tablet_move_too_frequently_threshold_s);
@@ -106,7 +108,9 @@ void LBImpl::InitOptions() {
   lb_options_.max_compute_time_ms = FLAGS_tera_lb_max_compute_time_ms;
   lb_options_.min_cost_need_balance = FLAGS_tera_lb_min_cost_need_balance;
   lb_options_.bad_node_safemode_percent = FLAGS_tera_lb_bad_node_safemode_percent;
+  lb_options_.parallel_search_num = std::max(FLAGS_tera_lb_parallel_search_num, 1);
   lb_options_.move_count_cost_weight = FLAGS_tera_lb_move_count_cost_weight;
+  lb_options_.cache_miss_move_cost = FLAGS_tera_lb_cache_miss_move_cost;
   lb_options_.meta_balance_max_move_num = FLAGS_tera_lb_meta_balance_max_move_num;
   lb_options_.tablet_max_move_num = FLAGS_tera_lb_tablet_max_move_num;
   lb_options_.tablet_move_too_frequently_threshold_s =
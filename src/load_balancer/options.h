@@ -17,7 +17,16 @@ struct LBOptions {
   double min_cost_need_balance;
   double bad_node_safemode_percent;
 
+  // run this many independent searches on cloned clusters in parallel,
+  // and take the plan of the lowest cost
+  uint32_t parallel_search_num;
+  // seed of the searches, 0 means seeded by time
+  uint32_t random_seed;
+
   double move_count_cost_weight;
+  // extra move count of moving a tablet to a node without its files in
+  // persistent cache
+  double cache_miss_move_cost;
   uint32_t meta_balance_max_move_num;
   uint32_t tablet_max_move_num;
 
@@ -58,8 +67,11 @@ struct LBOptions {
         max_compute_time_ms(30 * 1000),
         min_cost_need_balance(0.02),
         bad_node_safemode_percent(0.5),
+        parallel_search_num(1),
+        random_seed(0),
 
         move_count_cost_weight(1),
+        cache_miss_move_cost(1),
         meta_balance_max_move_num(1),
         tablet_max_move_num(1),
 
@@ -8,7 +8,9 @@
 #include <assert.h>
 
 #include <ctime>
+#include <functional>
 #include <random>
+#include <thread>
 
 #include "common/timer.h"
 
@@ -53,11 +55,24 @@ class Random {
     return rand % (b - a) + a;
   }
 
+  // reset the state of Rand() in current thread, so the following sequence
+  // is reproducible
+  static void Seed(uint32_t seed) { State() = (seed == 0 ? 1 : seed); }
+
  private:
+  // each thread owns a state, so parallel searches don't share one sequence
+  static uint32_t& State() {
+    static thread_local uint32_t state =
+        (static_cast<uint32_t>(time(NULL)) ^
+         static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()))) |
+        1;
+    return state;
+  }
+
   /* The state word must be initialized to non-zero */
   static uint32_t xorshift32() {
     /* Algorithm "xor" from p. 4 of Marsaglia, "Xorshift RNGs" */
-    static uint32_t state = time(NULL);
+    uint32_t& state = State();
     uint32_t x = state;
     x ^= x << 13;
     x ^= x >> 17;
@@ -10,6 +10,7 @@
 #include "load_balancer/cluster.h"
 #include "load_balancer/lb_node.h"
 #include "common/timer.h"
+#include "io/utils_leveldb.h"
 
 namespace tera {
 namespace load_balancer {
@@ -690,6 +691,64 @@ TEST_F(ClusterTest, MoveTabletTest) {
   ASSERT_EQ(0, cluster_->tablet_moved_num_);
 }
 
+TEST_F(ClusterTest, MoveTabletCacheColdTest) {
+  TabletMeta tablet_meta;
+  tablet_meta.set_path("table/tablet00000001");
+  tera::master::TabletPtr tablet_ptr(new tera::master::Tablet(tablet_meta));
+  tablet_ptr->SetDataSizeOnFlash(100);
+  std::shared_ptr<LBTablet> lb_tablet = std::make_shared<LBTablet>();
+  lb_tablet->tablet_ptr = tablet_ptr;
+
+  // node 1 holds the tablet in persistent cache, node 0 and 2 do not
+  std::string warm_sketch;
+  io::BuildPersistentCacheSketch({"table/tablet00000001/0/00000012.sst"}, &warm_sketch);
+  for (uint32_t i = 0; i < 3; ++i) {
+    tera::master::TabletNodePtr node_ptr(new tera::master::TabletNode());
+    if (i == 1) {
+      node_ptr->info_.set_persistent_cache_sketch(warm_sketch);
+    }
+    std::shared_ptr<LBTabletNode> lb_node = std::make_shared<LBTabletNode>();
+    lb_node->tablet_node_ptr = node_ptr;
+    cluster_->nodes_[i] = lb_node;
+  }
+
+  uint32_t tablet_index = 0;
+  cluster_->tablets_[tablet_index] = lb_tablet;
+  cluster_->tablet_moved_num_ = 0;
+  cluster_->tablet_cold_moved_num_ = 0;
+  cluster_->initial_tablet_index_to_node_index_[tablet_index] = 0;
+  cluster_->tablet_index_to_node_index_[tablet_index] = 0;
+
+  ASSERT_FALSE(cluster_->IsCacheCold(tablet_index, 1));
+  ASSERT_TRUE(cluster_->IsCacheCold(tablet_index, 2));
+
+  cluster_->MoveTablet(tablet_index, 0, 1);
+  ASSERT_EQ(1, cluster_->tablet_moved_num_);
+  ASSERT_EQ(0, cluster_->tablet_cold_moved_num_);
+
+  cluster_->MoveTablet(tablet_index, 1, 2);
+  ASSERT_EQ(1, cluster_->tablet_moved_num_);
+  ASSERT_EQ(1, cluster_->tablet_cold_moved_num_);
+
+  cluster_->MoveTablet(tablet_index, 2, 0);
+  ASSERT_EQ(0, cluster_->tablet_moved_num_);
+  ASSERT_EQ(0, cluster_->tablet_cold_moved_num_);
+
+  // sketch of node 2 is replaced by heartbeat while the tablet is counted cold
+  // there, moving it away takes back what was counted
+  cluster_->MoveTablet(tablet_index, 0, 2);
+  ASSERT_EQ(1, cluster_->tablet_cold_moved_num_);
+  cluster_->nodes_[2]->tablet_node_ptr->info_.set_persistent_cache_sketch(warm_sketch);
+  ASSERT_FALSE(cluster_->IsCacheCold(tablet_index, 2));
+  cluster_->MoveTablet(tablet_index, 2, 0);
+  ASSERT_EQ(0, cluster_->tablet_moved_num_);
+  ASSERT_EQ(0, cluster_->tablet_cold_moved_num_);
+
+  // a tablet without flash data is never cache cold
+  tablet_ptr->SetDataSizeOnFlash(0);
+  ASSERT_FALSE(cluster_->IsCacheCold(tablet_index, 2));
+}
+
 }  // namespace load_balancer
 }  // namespace tera
 
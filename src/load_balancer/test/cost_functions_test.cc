@@ -6,6 +6,7 @@
 #include "glog/logging.h"
 #include "gtest/gtest.h"
 
+#include "load_balancer/actions.h"
 #include "load_balancer/cost_functions.h"
 #include "load_balancer/random.h"
 
@@ -157,8 +158,54 @@ TEST_F(MoveCountCostFunctionTest, CostTest) {
   ASSERT_DOUBLE_EQ(move_cost_function_->kExpensiveCost, move_cost_function_->Cost());
 }
 
+TEST_F(MoveCountCostFunctionTest, CacheColdCostTest) {
+  move_cost_function_->tablet_max_move_num_ = 10;
+  move_cost_function_->cache_miss_move_cost_ = 2;
+  cluster_->tablet_num_ = 10;
+
+  cluster_->tablet_moved_num_ = 2;
+  cluster_->tablet_cold_moved_num_ = 0;
+  ASSERT_DOUBLE_EQ(0.2, move_cost_function_->Cost());
+
+  // one of the moved tablets is cache cold on its new node
+  cluster_->tablet_cold_moved_num_ = 1;
+  ASSERT_DOUBLE_EQ(0.4, move_cost_function_->Cost());
+
+  cluster_->tablet_moved_num_ = 6;
+  cluster_->tablet_cold_moved_num_ = 3;
+  ASSERT_DOUBLE_EQ(1, move_cost_function_->Cost());
+}
+
 TEST_F(TabletCountCostFunctionTest, CostTest) {}
 
+TEST_F(SizeCostFunctionTest, IncrementalCostTest) {
+  const uint32_t node_num = 10;
+  cluster_->tablet_node_num_ = node_num;
+  for (uint32_t i = 0; i < node_num; ++i) {
+    cluster_->size_per_node_[i] = Random::Rand(0, 1000);
+  }
+  size_cost_function_->Init(cluster_);
+
+  for (size_t step = 0; step < 1000; ++step) {
+    uint32_t source = Random::Rand(0, node_num);
+    uint32_t dest = Random::Rand(0, node_num);
+    if (source == dest || cluster_->size_per_node_[source] == 0) {
+      continue;
+    }
+    uint64_t size = Random::Rand(0, cluster_->size_per_node_[source] + 1);
+    cluster_->size_per_node_[source] -= size;
+    cluster_->size_per_node_[dest] += size;
+    std::shared_ptr<Action> action(new MoveAction(0, source, dest, "test"));
+    size_cost_function_->OnAction(action);
+
+    std::vector<double> stats;
+    for (uint32_t i = 0; i < node_num; ++i) {
+      stats.emplace_back(cluster_->size_per_node_[i]);
+    }
+    ASSERT_NEAR(size_cost_function_->ScaleFromArray(stats), size_cost_function_->Cost(), 1e-9);
+  }
+}
+
 TEST_F(SizeCostFunctionTest, CostTest) {}
 
 }  // namespace load_balancer
@@ -0,0 +1,110 @@
+// Copyright (c) 2015, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <limits>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "common/timer.h"
+#include "load_balancer/lb_node.h"
+#include "load_balancer/unity_balancer.h"
+
+namespace tera {
+namespace load_balancer {
+
+class UnityBalancerTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    options_.max_compute_steps = 20000;
+    options_.max_compute_steps_per_tablet = 1000;
+    options_.max_compute_time_ms = std::numeric_limits<uint32_t>::max();
+    options_.tablet_max_move_num = 100;
+    options_.meta_table_isolate_enabled = false;
+    options_.read_load_cost_weight = 0;
+    options_.write_load_cost_weight = 0;
+    options_.scan_load_cost_weight = 0;
+    options_.lread_cost_weight = 0;
+    options_.random_seed = 1;
+
+    // a skewed cluster, node i holds (i + 1) * 4 tablets with pseudo random
+    // sizes, the same for every run
+    uint32_t size_seed = 1;
+    for (uint32_t i = 0; i < kNodeNum; ++i) {
+      tera::master::TabletNodePtr node_ptr(
+          new tera::master::TabletNode("127.0.0.1:" + std::to_string(2000 + i), ""));
+      node_ptr->state_ = tera::master::kReady;
+      std::shared_ptr<LBTabletNode> lb_node = std::make_shared<LBTabletNode>();
+      lb_node->tablet_node_ptr = node_ptr;
+      for (uint32_t j = 0; j < (i + 1) * 4; ++j) {
+        size_seed = size_seed * 1103515245 + 12345;
+        TabletMeta meta;
+        meta.set_table_name("test");
+        meta.set_path("test/tablet" + std::to_string(i) + "_" + std::to_string(j));
+        meta.set_size(size_seed % 1000 + 1);
+        meta.set_status(TabletMeta::kTabletReady);
+        std::shared_ptr<LBTablet> lb_tablet = std::make_shared<LBTablet>();
+        lb_tablet->tablet_ptr.reset(new tera::master::Tablet(meta));
+        lb_node->tablets.emplace_back(lb_tablet);
+      }
+      lb_nodes_.emplace_back(lb_node);
+    }
+  }
+
+  virtual void TearDown() {}
+
+  std::shared_ptr<Cluster> NewCluster() {
+    return std::make_shared<Cluster>(lb_nodes_, options_, false);
+  }
+
+ private:
+  const uint32_t kNodeNum = 20;
+  LBOptions options_;
+  std::vector<std::shared_ptr<LBTabletNode>> lb_nodes_;
+};
+
+TEST_F(UnityBalancerTest, SameSeedSamePlan) {
+  UnityBalancer balancer(options_);
+  std::vector<uint32_t> weights(balancer.action_generators_.size(), 1);
+
+  UnityBalancer::SearchResult result_0;
+  balancer.Search(NewCluster(), options_.random_seed, weights, &result_0);
+  UnityBalancer::SearchResult result_1;
+  balancer.Search(NewCluster(), options_.random_seed, weights, &result_1);
+
+  ASSERT_LT(result_0.cost, result_0.init_cost);
+  ASSERT_DOUBLE_EQ(result_0.cost, result_1.cost);
+  ASSERT_EQ(result_0.steps, result_1.steps);
+  ASSERT_EQ(result_0.cluster->tablet_index_to_node_index_,
+            result_1.cluster->tablet_index_to_node_index_);
+}
+
+TEST_F(UnityBalancerTest, ParallelSearchBenchmark) {
+  UnityBalancer single_balancer(options_);
+  std::vector<uint32_t> weights(single_balancer.action_generators_.size(), 1);
+  UnityBalancer::SearchResult single_result;
+  int64_t start_us = get_micros();
+  single_balancer.Search(NewCluster(), options_.random_seed, weights, &single_result);
+  int64_t single_us = get_micros() - start_us;
+
+  for (uint32_t search_num : {2, 4, 8}) {
+    options_.parallel_search_num = search_num;
+    UnityBalancer parallel_balancer(options_);
+    UnityBalancer::SearchResult parallel_result;
+    start_us = get_micros();
+    parallel_balancer.ParallelSearch(NewCluster(), &parallel_result);
+    int64_t parallel_us = get_micros() - start_us;
+
+    LOG(INFO) << "[lb] benchmark init cost: " << single_result.init_cost
+              << ", single search cost: " << single_result.cost << " in " << single_us
+              << "us, " << search_num << " parallel searches cost: " << parallel_result.cost
+              << " in " << parallel_us << "us";
+    // the first parallel search runs the same seed as the single one
+    ASSERT_LE(parallel_result.cost, single_result.cost);
+  }
+}
+
+}  // namespace load_balancer
+}  // namespace tera
@@ -9,6 +9,7 @@
 
 #include "glog/logging.h"
 #include "load_balancer/random.h"
+#include "common/mutex.h"
 #include "common/timer.h"
 
 namespace tera {
@@ -18,52 +19,70 @@ using tera::master::TabletNodePtr;
 using tera::master::TabletPtr;
 
 UnityBalancer::UnityBalancer(const LBOptions& options) : lb_options_(options) {
-  if (lb_options_.move_count_cost_weight > 0) {
-    cost_functions_.emplace_back(new MoveCountCostFunction(options));
-    VLOG(20) << "[lb] " << cost_functions_[cost_functions_.size() - 1]->Name() << " enabled";
+  CreateCostFunctions(&cost_functions_);
+  for (const auto& cost_func : cost_functions_) {
+    VLOG(20) << "[lb] " << cost_func->Name() << " enabled";
   }
+
   if (lb_options_.tablet_count_cost_weight > 0) {
-    cost_functions_.emplace_back(new TabletCountCostFunction(options));
-    VLOG(20) << "[lb] " << cost_functions_[cost_functions_.size() - 1]->Name() << " enabled";
     action_generators_.emplace_back(new TabletCountActionGenerator());
     VLOG(20) << "[lb] " << action_generators_[action_generators_.size() - 1]->Name() << " enabled";
   }
   if (lb_options_.size_cost_weight > 0) {
-    cost_functions_.emplace_back(new SizeCostFunction(options));
-    VLOG(20) << "[lb] " << cost_functions_[cost_functions_.size() - 1]->Name() << " enabled";
     action_generators_.emplace_back(new SizeActionGenerator());
     VLOG(20) << "[lb] " << action_generators_[action_generators_.size() - 1]->Name() << " enabled";
   }
   if (lb_options_.flash_size_cost_weight > 0) {
-    cost_functions_.emplace_back(new FlashSizeCostFunction(options));
-    VLOG(20) << "[lb] " << cost_functions_[cost_functions_.size() - 1]->Name() << " enabled";
     action_generators_.emplace_back(new FlashSizeActionGenerator());
     VLOG(20) << "[lb] " << action_generators_[action_generators_.size() - 1]->Name() << " enabled";
   }
   if (lb_options_.read_load_cost_weight > 0) {
-    cost_functions_.emplace_back(new ReadLoadCostFunction(options));
-    VLOG(20) << "[lb] " << cost_functions_[cost_functions_.size() - 1]->Name() << " enabled";
     action_generators_.emplace_back(new ReadLoadActionGenerator());
     VLOG(20) << "[lb] " << action_generators_[action_generators_.size() - 1]->Name() << " enabled";
   }
   if (lb_options_.write_load_cost_weight > 0) {
-    cost_functions_.emplace_back(new WriteLoadCostFunction(options));
-    VLOG(20) << "[lb] " << cost_functions_[cost_functions_.size() - 1]->Name() << " enabled";
     action_generators_.emplace_back(new WriteLoadActionGenerator());
     VLOG(20) << "[lb] " << action_generators_[action_generators_.size() - 1]->Name() << " enabled";
   }
   if (lb_options_.scan_load_cost_weight > 0) {
-    cost_functions_.emplace_back(new ScanLoadCostFunction(options));
-    VLOG(20) << "[lb] " << cost_functions_[cost_functions_.size() - 1]->Name() << " enabled";
     action_generators_.emplace_back(new ScanLoadActionGenerator());
     VLOG(20) << "[lb] " << action_generators_[action_generators_.size() - 1]->Name() << " enabled";
   }
   if (lb_options_.lread_cost_weight > 0) {
-    cost_functions_.emplace_back(new LReadCostFunction(options));
-    VLOG(20) << "[lb] " << cost_functions_[cost_functions_.size() - 1]->Name() << " enabled";
     action_generators_.emplace_back(new LReadActionGenerator());
     VLOG(20) << "[lb] " << action_generators_[action_generators_.size() - 1]->Name() << " enabled";
   }
+
+  if (lb_options_.parallel_search_num > 1) {
+    search_thread_pool_.reset(new ThreadPool(lb_options_.parallel_search_num));
+  }
+}
+
+void UnityBalancer::CreateCostFunctions(CostFunctionList* cost_functions) {
+  if (lb_options_.move_count_cost_weight > 0) {
+    cost_functions->emplace_back(new MoveCountCostFunction(lb_options_));
+  }
+  if (lb_options_.tablet_count_cost_weight > 0) {
+    cost_functions->emplace_back(new TabletCountCostFunction(lb_options_));
+  }
+  if (lb_options_.size_cost_weight > 0) {
+    cost_functions->emplace_back(new SizeCostFunction(lb_options_));
+  }
+  if (lb_options_.flash_size_cost_weight > 0) {
+    cost_functions->emplace_back(new FlashSizeCostFunction(lb_options_));
+  }
+  if (lb_options_.read_load_cost_weight > 0) {
+    cost_functions->emplace_back(new ReadLoadCostFunction(lb_options_));
+  }
+  if (lb_options_.write_load_cost_weight > 0) {
+    cost_functions->emplace_back(new WriteLoadCostFunction(lb_options_));
+  }
+  if (lb_options_.scan_load_cost_weight > 0) {
+    cost_functions->emplace_back(new ScanLoadCostFunction(lb_options_));
+  }
+  if (lb_options_.lread_cost_weight > 0) {
+    cost_functions->emplace_back(new LReadCostFunction(lb_options_));
+  }
 }
 
 UnityBalancer::~UnityBalancer() {}
@@ -90,39 +109,69 @@ bool UnityBalancer::BalanceCluster(const std::string& table_name,
     cluster->DebugCluster();
   }
 
-  InitCostFunctions(cluster);
+  InitCostFunctions(cost_functions_, cluster);
 
   if (!NeedBalance(cluster)) {
     return true;
   }
 
+  SearchResult result;
+  if (search_thread_pool_) {
+    ParallelSearch(cluster, &result);
+  } else {
+    uint32_t seed = lb_options_.random_seed != 0 ? lb_options_.random_seed : get_micros();
+    std::vector<uint32_t> generator_weights(action_generators_.size(), 1);
+    Search(cluster, seed, generator_weights, &result);
+  }
+
+  if (result.cost < result.init_cost) {
+    CreatePlans(result.cluster, plans);
+    VLOG(5) << "[lb] balance plan size:" << plans->size();
+  } else {
+    VLOG(5) << "[lb] no better balance plan";
+  }
+
+  VLOG(5) << "[lb] BalanceCluster for table:" << table_name << " end";
+
+  return true;
+}
+
+void UnityBalancer::Search(const std::shared_ptr<Cluster>& cluster, uint32_t seed,
+                           const std::vector<uint32_t>& generator_weights,
+                           SearchResult* result) {
+  Random::Seed(seed);
+  CostFunctionList cost_functions;
+  CreateCostFunctions(&cost_functions);
+  InitCostFunctions(cost_functions, cluster);
+
   uint64_t max_steps = std::min(
       lb_options_.max_compute_steps,
       static_cast<uint64_t>(lb_options_.max_compute_steps_per_tablet * cluster->tablet_num_));
-  double init_cost = ComputeCost(std::numeric_limits<double>::max());
+  double init_cost = ComputeCost(cost_functions, std::numeric_limits<double>::max());
   double current_cost = init_cost;
 
-  VLOG(5) << "[lb] compute begin, max_steps:" << max_steps << " init total cost:" << init_cost;
+  VLOG(5) << "[lb] compute begin, seed:" << seed << " max_steps:" << max_steps
+          << " init total cost:" << init_cost;
 
   int64_t start_time_ns = get_micros();
   int64_t cost_time_ms = 0;
   uint64_t step = 0;
   uint32_t success_step = 0;
   for (step = 0; step < max_steps; ++step) {
-    std::shared_ptr<Action> action(NextAction(cluster));
+    std::shared_ptr<Action> action(NextAction(cluster, generator_weights));
     VLOG(20) << "[lb] step:" << step << " action:" << action->ToString();
 
     if (!cluster->ValidAction(action)) {
       continue;
     }
 
-    cluster->DoAction(action);
+    DoAction(cost_functions, cluster, action);
 
     if (lb_options_.debug_mode_enabled) {
       cluster->DebugCluster();
     }
 
-    double new_cost = ComputeCost(current_cost);
+    double new_cost = ComputeCost(cost_functions, current_cost);
     if (new_cost < current_cost) {
       VLOG(10) << "[lb] step " << step << " got lower cost " << new_cost << " by "
                << action->GetGeneratorName();
@@ -131,7 +180,7 @@ bool UnityBalancer::BalanceCluster(const std::string& table_name,
     } else {
       std::shared_ptr<Action> undo_action(action->UndoAction());
       VLOG(20) << "[lb] undo action:" << undo_action->ToString();
-      cluster->DoAction(undo_action);
+      DoAction(cost_functions, cluster, undo_action);
 
       if (lb_options_.debug_mode_enabled) {
         cluster->DebugCluster();
@@ -152,19 +201,63 @@ bool UnityBalancer::BalanceCluster(const std::string& table_name,
     }
   }
 
-  VLOG(5) << "[lb] compute end, compute time(ms):" << cost_time_ms << " compute steps:" << step
-          << " init total cost:" << init_cost << " new total cost:" << current_cost;
+  VLOG(5) << "[lb] compute end, seed:" << seed << " compute time(ms):" << cost_time_ms
+          << " compute steps:" << step << " init total cost:" << init_cost
+          << " new total cost:" << current_cost;
 
-  if (current_cost < init_cost) {
-    CreatePlans(cluster, plans);
-    VLOG(5) << "[lb] balance plan size:" << plans->size();
-  } else {
-    VLOG(5) << "[lb] no better balance plan";
-  }
+  result->init_cost = init_cost;
+  result->cost = current_cost;
+  result->steps = step;
+  result->cluster = cluster;
+}
 
-  VLOG(5) << "[lb] BalanceCluster for table:" << table_name << " end";
+void UnityBalancer::ParallelSearch(const std::shared_ptr<Cluster>& cluster,
+                                   SearchResult* result) {
+  uint32_t search_num = lb_options_.parallel_search_num;
+  uint32_t base_seed = lb_options_.random_seed != 0 ? lb_options_.random_seed : get_micros();
+  std::vector<SearchResult> results(search_num);
+
+  Mutex mutex;
+  CondVar cond(&mutex);
+  uint32_t running = search_num;
+  for (uint32_t i = 0; i < search_num; ++i) {
+    // the first search runs with the plain settings, others vary generator
+    // weights to explore different directions
+    uint32_t seed = base_seed + i * 0x9E3779B9;
+    std::vector<uint32_t> generator_weights(action_generators_.size(), 1);
+    if (i > 0) {
+      Random::Seed(seed ^ 0x5bd1e995);
+      for (auto& weight : generator_weights) {
+        weight = Random::Rand(1, 11);
+      }
+    }
+    std::shared_ptr<Cluster> search_cluster = std::make_shared<Cluster>(*cluster);
+    SearchResult* search_result = &results[i];
+    search_thread_pool_->AddTask([=, &mutex, &cond, &running](int64_t) {
+      Search(search_cluster, seed, generator_weights, search_result);
+      MutexLock lock(&mutex);
+      if (--running == 0) {
+        cond.Signal();
+      }
+    });
+  }
+  {
+    MutexLock lock(&mutex);
+    while (running > 0) {
+      cond.Wait();
+    }
+  }
 
-  return true;
+  uint32_t best = 0;
+  for (uint32_t i = 1; i < search_num; ++i) {
+    if (results[i].cost < results[best].cost) {
+      best = i;
+    }
+  }
+  VLOG(5) << "[lb] parallel search done, search num:" << search_num << " best search:" << best
+          << " init total cost:" << results[best].init_cost
+          << " best total cost:" << results[best].cost;
+  *result = results[best];
 }
 
 bool UnityBalancer::NeedBalance(const std::shared_ptr<Cluster>& cluster) {
@@ -219,17 +312,27 @@ bool UnityBalancer::NeedBalance(const std::shared_ptr<Cluster>& cluster) {
   }
 }
 
-void UnityBalancer::InitCostFunctions(const std::shared_ptr<Cluster>& cluster) {
-  for (const auto& cost_func : cost_functions_) {
+void UnityBalancer::InitCostFunctions(const CostFunctionList& cost_functions,
+                                      const std::shared_ptr<Cluster>& cluster) {
+  for (const auto& cost_func : cost_functions) {
     cost_func->Init(cluster);
   }
 }
 
-double UnityBalancer::ComputeCost(double previous_cost) {
+void UnityBalancer::DoAction(const CostFunctionList& cost_functions,
+                             const std::shared_ptr<Cluster>& cluster,
+                             const std::shared_ptr<Action>& action) {
+  cluster->DoAction(action);
+  for (const auto& cost_func : cost_functions) {
+    cost_func->OnAction(action);
+  }
+}
+
+double UnityBalancer::ComputeCost(const CostFunctionList& cost_functions, double previous_cost) {
   VLOG(20) << "[lb] ComputeCost begin, previous total cost:" << previous_cost;
   double total_cost = 0.0;
 
-  for (const auto& cost_func : cost_functions_) {
+  for (const auto& cost_func : cost_functions) {
     double weight = cost_func->GetWeight();
     if (weight <= 0) {
       continue;
@@ -246,9 +349,19 @@ double UnityBalancer::ComputeCost(double previous_cost) {
   return total_cost;
 }
 
-Action* UnityBalancer::NextAction(const std::shared_ptr<Cluster>& cluster) {
-  uint32_t rand = Random::Rand(0, action_generators_.size());
-  return action_generators_[rand]->Generate(cluster);
+Action* UnityBalancer::NextAction(const std::shared_ptr<Cluster>& cluster,
+                                  const std::vector<uint32_t>& generator_weights) {
+  uint32_t total_weight = 0;
+  for (uint32_t weight : generator_weights) {
+    total_weight += weight;
+  }
+  uint32_t rand = Random::Rand(0, total_weight);
+  uint32_t i = 0;
+  while (rand >= generator_weights[i]) {
+    rand -= generator_weights[i];
+    ++i;
+  }
+  return action_generators_[i]->Generate(cluster);
 }
 
 void UnityBalancer::CreatePlans(const std::shared_ptr<Cluster>& cluster, std::vector<Plan>* plans) {
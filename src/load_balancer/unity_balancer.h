@@ -8,6 +8,7 @@
 #include <memory>
 #include <vector>
 
+#include "common/thread_pool.h"
 #include "load_balancer/action_generators.h"
 #include "load_balancer/actions.h"
 #include "load_balancer/balancer.h"
@@ -36,19 +37,49 @@ class UnityBalancer : public Balancer {
   virtual std::string GetName() override;
 
  protected:
-  void InitCostFunctions(const std::shared_ptr<Cluster>& cluster);
+  typedef std::vector<std::shared_ptr<CostFunction>> CostFunctionList;
 
-  double ComputeCost(double previous_cost);
+  struct SearchResult {
+    double init_cost;
+    double cost;
+    uint64_t steps;
+    std::shared_ptr<Cluster> cluster;
 
-  Action* NextAction(const std::shared_ptr<Cluster>& cluster);
+    SearchResult() : init_cost(0), cost(0), steps(0) {}
+  };
+
+  void CreateCostFunctions(CostFunctionList* cost_functions);
+
+  void InitCostFunctions(const CostFunctionList& cost_functions,
+                         const std::shared_ptr<Cluster>& cluster);
+
+  // Run one stochastic local search on |cluster| in current thread.
+  // Actions are drawn from generators by |generator_weights|.
+  void Search(const std::shared_ptr<Cluster>& cluster, uint32_t seed,
+              const std::vector<uint32_t>& generator_weights, SearchResult* result);
+
+  // Run lb_options_.parallel_search_num searches on clones of |cluster| with
+  // different seeds and generator weights, output the lowest cost one.
+  void ParallelSearch(const std::shared_ptr<Cluster>& cluster, SearchResult* result);
+
+  // apply |action| to |cluster| and let cost functions update incrementally
+  void DoAction(const CostFunctionList& cost_functions, const std::shared_ptr<Cluster>& cluster,
+                const std::shared_ptr<Action>& action);
+
+  double ComputeCost(const CostFunctionList& cost_functions, double previous_cost);
+
+  Action* NextAction(const std::shared_ptr<Cluster>& cluster,
+                     const std::vector<uint32_t>& generator_weights);
 
   // diff the initial cluster state with the current cluster state, then create
   // plans
   void CreatePlans(const std::shared_ptr<Cluster>& cluster, std::vector<Plan>* plans);
 
  private:
-  std::vector<std::shared_ptr<CostFunction>> cost_functions_;
+  // only used by NeedBalance(), each search owns its cost functions
+  CostFunctionList cost_functions_;
   std::vector<std::shared_ptr<ActionGenerator>> action_generators_;
+  std::unique_ptr<ThreadPool> search_thread_pool_;
 
   LBOptions lb_options_;
 };
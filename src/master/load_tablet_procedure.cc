@@ -109,6 +109,7 @@ void LoadTabletProcedure::LoadTabletAsync(TabletNodePtr dest_node) {
   request->set_session_id(dest_node->uuid_);
   request->set_create_time(tablet_->CreateTime());
   request->set_version(tablet_->Version());
+  request->set_recent_qps(tablet_->GetQps());
   TablePtr table = tablet_->GetTable();
   TabletMeta meta;
   tablet_->ToMeta(&meta);
@@ -42,6 +42,10 @@ class LoadTabletProcedure : public Procedure,
     }
   }
 
+  virtual std::string GetLockNode() override { return dest_node_ ? dest_node_->GetAddr() : ""; }
+
+  virtual std::string GetLockTable() override { return tablet_->GetTableName(); }
+
  private:
   typedef std::function<void(LoadTabletProcedure*, const TabletEvent&)> TabletLoadEventHandler;
 
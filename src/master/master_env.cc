@@ -5,6 +5,8 @@
 #include <glog/logging.h>
 #include "master/master_impl.h"
 #include "master/master_env.h"
+#include "master/meta_snapshot.h"
+#include "master/meta_write_coalescer.h"
 #include "master/tabletnode_manager.h"
 #include "master/tablet_manager.h"
 #include "proto/master_rpc.pb.h"
@@ -16,6 +18,9 @@
 #include "utils/string_util.h"
 
 DECLARE_string(tera_master_meta_table_name);
+DECLARE_bool(tera_master_meta_write_coalesce_enabled);
+DECLARE_int32(tera_master_meta_write_batch_size);
+DECLARE_bool(tera_master_meta_snapshot_enabled);
 
 using namespace std::placeholders;
 namespace tera {
@@ -42,6 +47,14 @@ struct ScanTask {
 std::mutex TeraMasterEnv::meta_task_mutex_;
 std::queue<MetaTask*> TeraMasterEnv::meta_task_queue_;
 Counter TeraMasterEnv::sequence_id_;
+Counter TeraMasterEnv::meta_journal_seq_;
+Counter TeraMasterEnv::committed_meta_journal_seq_;
+
+static MetaWriteCoalescer& MetaWriter() {
+  static MetaWriteCoalescer coalescer(TeraMasterEnv::CommitMetaRecords,
+                                      FLAGS_tera_master_meta_write_batch_size);
+  return coalescer;
+}
 
 void TeraMasterEnv::BatchWriteMetaTableAsync(MetaWriteRecord record, UpdateMetaClosure done,
                                              int32_t left_try_times) {
@@ -57,6 +70,28 @@ void TeraMasterEnv::BatchWriteMetaTableAsync(std::vector<MetaWriteRecord> meta_e
     SuspendMetaOperation(meta_entries, done, left_try_times);
     return;
   }
+  if (meta_entries.empty()) {
+    return;
+  }
+
+  UpdateMetaClosure meta_done =
+      std::bind(TeraMasterEnv::UpdateMetaCallback, meta_entries, done, left_try_times, _1);
+  if (FLAGS_tera_master_meta_write_coalesce_enabled) {
+    MetaWriter().Write(meta_entries, meta_done);
+  } else {
+    CommitMetaRecords(meta_entries, meta_done);
+  }
+}
+
+void TeraMasterEnv::CommitMetaRecords(const std::vector<MetaWriteRecord>& records,
+                                      UpdateMetaClosure done) {
+  std::string meta_addr;
+  if (!MasterEnv().GetTabletManager()->GetMetaTabletAddr(&meta_addr)) {
+    LOG(WARNING) << "meta tablet is not ready, fail to write " << records.size()
+                 << " meta records";
+    done(false);
+    return;
+  }
 
   WriteTabletRequest* request = new WriteTabletRequest;
   WriteTabletResponse* response = new WriteTabletResponse;
@@ -65,51 +100,82 @@ void TeraMasterEnv::BatchWriteMetaTableAsync(std::vector<MetaWriteRecord> meta_e
   request->set_is_sync(true);
   request->set_is_instant(true);
   MasterEnv().GetAccessBuilder()->BuildInternalGroupRequest(request);
-  for (size_t i = 0; i < meta_entries.size(); ++i) {
-    std::string packed_key = meta_entries[i].key;
-    std::string packed_value = meta_entries[i].value;
-    bool is_delete = meta_entries[i].is_delete;
-    // bool is_delete = meta_entries[i](&packed_key, &packed_value);
+  for (size_t i = 0; i < records.size(); ++i) {
     RowMutationSequence* mu_seq = request->add_row_list();
-    mu_seq->set_row_key(packed_key);
+    mu_seq->set_row_key(records[i].key);
     Mutation* mutation = mu_seq->add_mutation_sequence();
-    if (!is_delete) {
+    if (!records[i].is_delete) {
       mutation->set_type(kPut);
-      mutation->set_value(packed_value);
+      mutation->set_value(records[i].value);
     } else {
       mutation->set_type(kDeleteRow);
     }
   }
-  if (request->row_list_size() == 0) {
-    delete request;
-    delete response;
-    return;
-  } else {
-    LOG(INFO) << "WriteMetaTableAsync id: " << request->sequence_id();
+  if (MetaJournalEnabled()) {
+    // the journal row goes in the same request, so it is persisted together
+    // with the records. Coalescer keeps one batch in flight, journals are
+    // committed in seq order.
+    int64_t journal_seq = meta_journal_seq_.Inc();
+    RowMutationSequence* mu_seq = request->add_row_list();
+    mu_seq->set_row_key(MetaJournal::Key(journal_seq));
+    Mutation* mutation = mu_seq->add_mutation_sequence();
+    mutation->set_type(kPut);
+    MetaJournal::Encode(records, mutation->mutable_value());
+    UpdateMetaClosure user_done = done;
+    done = [journal_seq, user_done](bool succ) {
+      if (succ) {
+        committed_meta_journal_seq_.Set(journal_seq);
+      }
+      user_done(succ);
+    };
   }
+  LOG(INFO) << "WriteMetaTableAsync id: " << request->sequence_id()
+            << ", records: " << records.size();
 
-  WriteClosure meta_done = std::bind(TeraMasterEnv::UpdateMetaCallback, meta_entries, done,
-                                     left_try_times, _1, _2, _3, _4);
+  WriteClosure meta_done = std::bind(TeraMasterEnv::CommitMetaCallback, done, _1, _2, _3, _4);
 
   tabletnode::TabletNodeClient meta_node_client(MasterEnv().GetThreadPool().get(), meta_addr);
   meta_node_client.WriteTablet(request, response, meta_done);
 }
 
-void TeraMasterEnv::UpdateMetaCallback(std::vector<MetaWriteRecord> records, UpdateMetaClosure done,
-                                       int32_t left_try_times, WriteTabletRequest* request,
-                                       WriteTabletResponse* response, bool failed, int error_code) {
+bool TeraMasterEnv::MetaJournalEnabled() {
+  return FLAGS_tera_master_meta_snapshot_enabled && FLAGS_tera_master_meta_write_coalesce_enabled;
+}
+
+void TeraMasterEnv::ResetMetaJournalSeq(int64_t last_seq) {
+  meta_journal_seq_.Set(last_seq);
+  committed_meta_journal_seq_.Set(last_seq);
+}
+
+void TeraMasterEnv::CommitMetaCallback(UpdateMetaClosure done, WriteTabletRequest* request,
+                                       WriteTabletResponse* response, bool failed,
+                                       int error_code) {
+  std::unique_ptr<WriteTabletRequest> request_holder(request);
+  std::unique_ptr<WriteTabletResponse> response_holder(response);
   StatusCode status = response->status();
   if (!failed && status == kTabletNodeOk) {
-    // all the row status should be the same
-    CHECK_GT(response->row_status_list_size(), 0);
-    status = response->row_status_list(0);
+    CHECK_EQ(response->row_status_list_size(), request->row_list_size());
+    for (int i = 0; i < response->row_status_list_size(); ++i) {
+      if (response->row_status_list(i) != kTabletNodeOk) {
+        status = response->row_status_list(i);
+        break;
+      }
+    }
   }
-  std::unique_ptr<WriteTabletRequest> request_holder(request);
-  std::unique_ptr<WriteTabletResponse> response_holder(response);
   if (failed || status != kTabletNodeOk) {
     std::string errmsg =
         failed ? sofa::pbrpc::RpcErrorCodeToString(error_code) : StatusCodeToString(status);
-    LOG(ERROR) << "fail to update meta tablet: error_msg: " << errmsg << ", will retry later";
+    LOG(ERROR) << "fail to update meta tablet, id: " << request->sequence_id()
+               << ", error_msg: " << errmsg;
+    done(false);
+    return;
+  }
+  done(true);
+}
+
+void TeraMasterEnv::UpdateMetaCallback(std::vector<MetaWriteRecord> records, UpdateMetaClosure done,
+                                       int32_t left_try_times, bool succ) {
+  if (!succ) {
     for (auto it = records.begin(); it != records.end(); ++it) {
       std::string op = (it->is_delete ? "DEL" : "PUT");
       LOG(WARNING) << "update meta records suspended and retry later, "
@@ -121,9 +121,21 @@ class TeraMasterEnv {
                                        UpdateMetaClosure done, int32_t left_try_times = -1);
 
   static void UpdateMetaCallback(std::vector<MetaWriteRecord> records, UpdateMetaClosure done,
-                                 int32_t left_try_times, WriteTabletRequest* request,
+                                 int32_t left_try_times, bool succ);
+
+  // write a batch of records to meta tablet in one WriteTabletRequest
+  static void CommitMetaRecords(const std::vector<MetaWriteRecord>& records,
+                                UpdateMetaClosure done);
+
+  static void CommitMetaCallback(UpdateMetaClosure done, WriteTabletRequest* request,
                                  WriteTabletResponse* response, bool failed, int error_code);
 
+  // meta journal is written along with meta records when meta snapshot is
+  // enabled, see meta_snapshot.h
+  static bool MetaJournalEnabled();
+  static void ResetMetaJournalSeq(int64_t last_seq);
+  static int64_t CommittedMetaJournalSeq() { return committed_meta_journal_seq_.Get(); }
+
   static void ScanMetaTableAsync(const std::string& table_name, const std::string& tablet_key_start,
                                  const std::string& tablet_key_end, ScanClosure done);
 
@@ -155,6 +167,8 @@ class TeraMasterEnv {
   static std::mutex meta_task_mutex_;
   static std::queue<MetaTask*> meta_task_queue_;
   static Counter sequence_id_;
+  static Counter meta_journal_seq_;
+  static Counter committed_meta_journal_seq_;
 };
 
 inline TeraMasterEnv& MasterEnv() {
@@ -14,11 +14,26 @@ DEFINE_int32(tera_master_connect_timeout_period, 5000,
              "the timeout period (in ms) for each master connection");
 DEFINE_int32(tera_master_query_tabletnode_period, 10000,
              "the period (in ms) for query tabletnode status");
+DEFINE_bool(tera_master_query_delta_enabled, true,
+            "only ask tabletnodes for tablets changed since last query");
+DEFINE_int32(tera_master_query_full_sync_period, 10,
+             "force a full tablet list query every N query rounds if delta query enabled");
 DEFINE_int32(tera_master_common_retry_period, 1000, "the period (in ms) for common operation");
 DEFINE_int32(tera_master_meta_retry_times, 5, "the max retry times when master read/write meta");
+DEFINE_bool(tera_master_meta_write_coalesce_enabled, true,
+            "coalesce concurrent meta table writes into one batch");
+DEFINE_int32(tera_master_meta_write_batch_size, 1000, "max records of a meta table write batch");
 DEFINE_bool(tera_master_meta_recovery_enabled, false, "whether recovery meta tablet at startup");
 DEFINE_string(tera_master_meta_recovery_file, "../data/meta.bak",
               "path of meta table recovery file");
+DEFINE_bool(tera_master_meta_snapshot_enabled, false,
+            "load meta table from snapshot and journal at startup, "
+            "delete the snapshot file after meta table is modified by offline tools");
+DEFINE_string(tera_master_meta_snapshot_file, "meta.snapshot",
+              "meta table snapshot file under --tera_tabletnode_path_prefix, "
+              "shared by all masters");
+DEFINE_int32(tera_master_meta_snapshot_period_s, 600, "period of meta table snapshot in seconds");
+DEFINE_int32(tera_master_meta_load_thread_num, 8, "threads to load tablet meta at startup");
 
 DEFINE_bool(tera_master_cache_check_enabled, true, "enable the periodic check & release cache");
 DEFINE_int32(tera_master_cache_release_period, 180, "the period (in sec) to try release cache");
@@ -43,6 +58,9 @@ DEFINE_double(tera_master_workload_split_threshold, 9999,
 DEFINE_int64(tera_master_min_split_size, 64, "the size (in MB) of tablet to trigger split");
 DEFINE_double(tera_master_min_split_ratio, 0.5,
               "min ratio of split size of tablet schema to trigger split");
+DEFINE_int64(tera_master_hotspot_split_qps, 50000,
+             "split tablet at the median of its sampled row key accesses if its access qps "
+             "is higher than this value, 0 means disable");
 DEFINE_int64(tera_master_split_history_time_interval, 600000, "minimal split time interval(ms)");
 
 DEFINE_int32(tera_master_max_split_concurrency, 1,
@@ -126,6 +144,11 @@ DEFINE_int64(delay_add_node_schedule_period_s, 60,
 DEFINE_string(tera_cluster_name, "anonymous", "name of tera cluster for prometheus query");
 
 DEFINE_bool(tera_master_support_isomerism, false, "tera master support isomerism");
+DEFINE_bool(tera_master_cache_aware_placement_enabled, true,
+            "prefer tabletnodes holding the tablet's files in persistent cache on load/move");
+DEFINE_double(tera_master_cache_aware_placement_ratio, 1.2,
+              "a cache warm tabletnode is taken if its size and pending are within this ratio "
+              "of the best tabletnode");
 DEFINE_int64(tera_master_dfs_write_bytes_quota_in_MB, -1,
              "Total cluster dfs write quota, which will trigger slowdown write mode when exceeded");
 DEFINE_int64(tera_master_dfs_qps_quota, -1,
@@ -137,3 +160,9 @@ DEFINE_int32(master_split_procedure_limit, 10, "split procedure limit");
 DEFINE_int32(master_move_procedure_limit, 100, "move procedure limit");
 DEFINE_int32(master_load_procedure_limit, 300, "load procedure limit");
 DEFINE_int32(master_unload_procedure_limit, 100, "unload procedure limit");
+DEFINE_int32(master_node_procedure_limit, 0,
+             "limited load/unload procedures working on one tabletnode at the same time, "
+             "0 means no limit");
+DEFINE_int32(master_table_procedure_limit, 0,
+             "limited load/unload procedures working on one table at the same time, "
+             "0 means no limit");
@@ -25,6 +25,7 @@
 #include "master/load_tablet_procedure.h"
 #include "master/master_zk_adapter.h"
 #include "master/merge_tablet_procedure.h"
+#include "master/meta_snapshot.h"
 #include "master/move_tablet_procedure.h"
 #include "master/split_tablet_procedure.h"
 #include "master/unload_tablet_procedure.h"
@@ -42,8 +43,13 @@
 #include "utils/utils_cmd.h"
 
 DECLARE_string(tera_master_port);
+DECLARE_bool(tera_master_query_delta_enabled);
+DECLARE_int32(tera_master_query_full_sync_period);
 DECLARE_bool(tera_master_meta_recovery_enabled);
 DECLARE_string(tera_master_meta_recovery_file);
+DECLARE_string(tera_master_meta_snapshot_file);
+DECLARE_int32(tera_master_meta_snapshot_period_s);
+DECLARE_int32(tera_master_meta_load_thread_num);
 
 DECLARE_bool(tera_master_cache_check_enabled);
 DECLARE_int32(tera_master_cache_release_period);
@@ -70,6 +76,7 @@ DECLARE_double(tera_master_workload_merge_threshold);
 DECLARE_int64(tera_master_split_tablet_size);
 DECLARE_int64(tera_master_min_split_size);
 DECLARE_double(tera_master_min_split_ratio);
+DECLARE_int64(tera_master_hotspot_split_qps);
 DECLARE_int64(tera_master_merge_tablet_size);
 DECLARE_bool(tera_master_kick_tabletnode_enabled);
 DECLARE_int32(tera_master_kick_tabletnode_query_fail_times);
@@ -151,6 +158,9 @@ MasterImpl::MasterImpl(const std::shared_ptr<auth::AccessEntry> &access_entry,
       gc_enabled_(false),
       gc_timer_id_(kInvalidTimerId),
       gc_query_enable_(false),
+      meta_snapshot_enabled_(false),
+      meta_snapshot_timer_id_(kInvalidTimerId),
+      last_meta_snapshot_seq_(-1),
       executor_(new ProcedureExecutor),
       tablet_availability_(new TabletAvailability(tablet_manager_)),
       access_entry_(access_entry),
@@ -578,79 +588,331 @@ bool MasterImpl::CheckUserPermissionOnTable(const std::string &token, TablePtr t
 
 bool MasterImpl::LoadMetaTable(const std::string &meta_tablet_addr, StatusCode *ret_status) {
   tablet_manager_->ClearTableList();
+  TabletNodePtr meta_node = tabletnode_manager_->FindTabletNode(meta_tablet_addr, NULL);
+  meta_tablet_ = tablet_manager_->AddMetaTablet(meta_node, zk_adapter_);
+  if (TeraMasterEnv::MetaJournalEnabled() && LoadMetaTableFromSnapshot(meta_tablet_addr)) {
+    return true;
+  }
+
+  uint64_t max_journal_seq = 0;
+  std::vector<MetaWriteRecord> journal_rows;
+  auto load_record = [&](const std::string &key, const std::string &value) {
+    uint64_t seq = 0, snapshot_id = 0;
+    if (key == MetaJournal::kFloorKey) {
+      journal_rows.emplace_back(key, "", true);
+      if (MetaJournal::DecodeFloor(value, &seq, &snapshot_id)) {
+        max_journal_seq = std::max(max_journal_seq, seq);
+      }
+    } else if (MetaJournal::ParseKey(key, &seq)) {
+      journal_rows.emplace_back(key, "", true);
+      max_journal_seq = std::max(max_journal_seq, seq);
+    } else {
+      LoadMetaRecord(key, value);
+    }
+  };
+  if (!ScanMetaTable(meta_tablet_addr, "", "", load_record, ret_status)) {
+    LOG(ERROR) << "fail to load meta table";
+    tablet_manager_->ClearTableList();
+    return false;
+  }
+
+  if (TeraMasterEnv::MetaJournalEnabled()) {
+    // journals continue after the ones in meta table, until next snapshot
+    // covers them and sets the floor
+    TeraMasterEnv::ResetMetaJournalSeq(max_journal_seq);
+  } else if (!journal_rows.empty()) {
+    // meta table will be modified without journal, drop the floor so that no
+    // snapshot can be replayed later
+    if (!WriteMetaTableSync(meta_tablet_addr, journal_rows, ret_status)) {
+      LOG(ERROR) << "fail to drop meta journal";
+      tablet_manager_->ClearTableList();
+      return false;
+    }
+    LOG(INFO) << "drop meta journal, " << journal_rows.size() << " rows";
+  }
+  LOG(INFO) << "load meta table success";
+  return true;
+}
+
+bool MasterImpl::ScanMetaTable(
+    const std::string &meta_tablet_addr, const std::string &start, const std::string &end,
+    const std::function<void(const std::string &, const std::string &)> &callback,
+    StatusCode *ret_status) {
   ScanTabletRequest request;
   ScanTabletResponse response;
   request.set_sequence_id(this_sequence_id_.Inc());
   request.set_table_name(FLAGS_tera_master_meta_table_name);
-  request.set_start("");
-  request.set_end("");
-  TabletNodePtr meta_node = tabletnode_manager_->FindTabletNode(meta_tablet_addr, NULL);
-  meta_tablet_ = tablet_manager_->AddMetaTablet(meta_node, zk_adapter_);
+  request.set_start(start);
+  request.set_end(end);
   access_builder_->BuildInternalGroupRequest(&request);
   tabletnode::TabletNodeClient meta_node_client(thread_pool_.get(), meta_tablet_addr);
   while (meta_node_client.ScanTablet(&request, &response)) {
     if (response.status() != kTabletNodeOk) {
       SetStatusCode(response.status(), ret_status);
-      LOG(ERROR) << "fail to load meta table: " << StatusCodeToString(response.status());
-      tablet_manager_->ClearTableList();
+      LOG(ERROR) << "fail to scan meta table: " << StatusCodeToString(response.status());
       return false;
     }
     if (response.results().key_values_size() <= 0) {
-      LOG(INFO) << "load meta table success";
       return true;
     }
     uint32_t record_size = response.results().key_values_size();
-    LOG(INFO) << "load meta table: " << record_size << " records";
+    LOG(INFO) << "scan meta table: " << record_size << " records";
 
     std::string last_record_key;
     for (uint32_t i = 0; i < record_size; i++) {
       const KeyValuePair &record = response.results().key_values(i);
       last_record_key = record.key();
-      char first_key_char = record.key()[0];
-      if (first_key_char == '~') {
-        user_manager_->LoadUserMeta(record.key(), record.value());
-      } else if (first_key_char == '|') {
-        if (record.key().length() < 2) {
-          LOG(ERROR) << "multi tenancy meta key format wrong [key : " << record.key()
-                     << ", value : " << record.value() << "]";
-          continue;
-        }
-        char second_key_char = record.key()[1];
-        if (second_key_char == '0') {
-          /* The auth data stores in meta_table
-           * |00User => Passwd, [role1, role2, ...]
-           * |01role1 => [Permission1, Permission2, ...]
-           */
-          access_entry_->GetAccessUpdater().AddRecord(record.key(), record.value());
-        } else if (second_key_char == '1') {
-          // The quota data stores in meta_table
-          // |10TableName => TableQuota (pb format)
-          quota_entry_->AddRecord(record.key(), record.value());
-        } else {
-          LOG(ERROR) << "multi tenancy meta key format wrong [key : " << record.key()
-                     << ", value : " << record.value() << "]";
-          continue;
-        }
-      } else if (first_key_char == '@') {
-        tablet_manager_->LoadTableMeta(record.key(), record.value());
-      } else if (first_key_char > '@') {
-        tablet_manager_->LoadTabletMeta(record.key(), record.value());
-      } else {
-        continue;
-      }
+      callback(record.key(), record.value());
     }
     std::string next_record_key = NextKey(last_record_key);
     request.set_start(next_record_key);
-    request.set_end("");
+    request.set_end(end);
     request.set_sequence_id(this_sequence_id_.Inc());
     response.Clear();
   }
   SetStatusCode(kRPCError, ret_status);
-  LOG(ERROR) << "fail to load meta table: " << StatusCodeToString(kRPCError);
-  tablet_manager_->ClearTableList();
+  LOG(ERROR) << "fail to scan meta table: " << StatusCodeToString(kRPCError);
   return false;
 }
 
+bool MasterImpl::WriteMetaTableSync(const std::string &meta_tablet_addr,
+                                    const std::vector<MetaWriteRecord> &records,
+                                    StatusCode *ret_status) {
+  WriteTabletRequest request;
+  WriteTabletResponse response;
+  request.set_sequence_id(this_sequence_id_.Inc());
+  request.set_tablet_name(FLAGS_tera_master_meta_table_name);
+  request.set_is_sync(true);
+  request.set_is_instant(true);
+  access_builder_->BuildInternalGroupRequest(&request);
+  for (size_t i = 0; i < records.size(); ++i) {
+    RowMutationSequence *mu_seq = request.add_row_list();
+    mu_seq->set_row_key(records[i].key);
+    Mutation *mutation = mu_seq->add_mutation_sequence();
+    if (!records[i].is_delete) {
+      mutation->set_type(kPut);
+      mutation->set_value(records[i].value);
+    } else {
+      mutation->set_type(kDeleteRow);
+    }
+  }
+  tabletnode::TabletNodeClient meta_node_client(thread_pool_.get(), meta_tablet_addr);
+  if (!meta_node_client.WriteTablet(&request, &response)) {
+    SetStatusCode(kRPCError, ret_status);
+    LOG(WARNING) << "fail to write meta table: " << StatusCodeToString(kRPCError);
+    return false;
+  }
+  StatusCode status = response.status();
+  for (int i = 0; status == kTabletNodeOk && i < response.row_status_list_size(); ++i) {
+    status = response.row_status_list(i);
+  }
+  if (status != kTabletNodeOk) {
+    SetStatusCode(status, ret_status);
+    LOG(WARNING) << "fail to write meta table: " << StatusCodeToString(status);
+    return false;
+  }
+  return true;
+}
+
+void MasterImpl::LoadMetaRecord(const std::string &key, const std::string &value) {
+  char first_key_char = key[0];
+  if (first_key_char == '~') {
+    user_manager_->LoadUserMeta(key, value);
+  } else if (first_key_char == '|') {
+    if (key.length() < 2) {
+      LOG(ERROR) << "multi tenancy meta key format wrong [key : " << key << ", value : " << value
+                 << "]";
+      return;
+    }
+    char second_key_char = key[1];
+    if (second_key_char == '0') {
+      /* The auth data stores in meta_table
+       * |00User => Passwd, [role1, role2, ...]
+       * |01role1 => [Permission1, Permission2, ...]
+       */
+      access_entry_->GetAccessUpdater().AddRecord(key, value);
+    } else if (second_key_char == '1') {
+      // The quota data stores in meta_table
+      // |10TableName => TableQuota (pb format)
+      quota_entry_->AddRecord(key, value);
+    } else {
+      LOG(ERROR) << "multi tenancy meta key format wrong [key : " << key << ", value : " << value
+                 << "]";
+    }
+  } else if (first_key_char == '@') {
+    tablet_manager_->LoadTableMeta(key, value);
+  } else if (first_key_char > '@') {
+    tablet_manager_->LoadTabletMeta(key, value);
+  }
+}
+
+void MasterImpl::LoadMetaRecords(const std::vector<std::pair<std::string, std::string>> &records) {
+  // tables are loaded before tablets, tablets are parsed and added to their
+  // tables in parallel
+  std::vector<const std::pair<std::string, std::string> *> tablet_records;
+  for (size_t i = 0; i < records.size(); ++i) {
+    char first_key_char = records[i].first[0];
+    if (first_key_char > '@' && first_key_char != '|' && first_key_char != '~') {
+      tablet_records.push_back(&records[i]);
+    } else {
+      LoadMetaRecord(records[i].first, records[i].second);
+    }
+  }
+
+  size_t thread_num = std::max(FLAGS_tera_master_meta_load_thread_num, 1);
+  size_t batch_size = (tablet_records.size() + thread_num - 1) / thread_num;
+  ThreadPool load_thread_pool(thread_num);
+  for (size_t begin = 0; begin < tablet_records.size(); begin += batch_size) {
+    size_t end = std::min(begin + batch_size, tablet_records.size());
+    load_thread_pool.AddTask([this, &tablet_records, begin, end](int64_t) {
+      for (size_t i = begin; i < end; ++i) {
+        tablet_manager_->LoadTabletMeta(tablet_records[i]->first, tablet_records[i]->second);
+      }
+    });
+  }
+  load_thread_pool.Stop(true);
+}
+
+bool MasterImpl::LoadMetaTableFromSnapshot(const std::string &meta_tablet_addr) {
+  int64_t start_ms = get_millis();
+  const std::string filename = MetaSnapshotPath();
+  uint64_t snapshot_seq = 0, snapshot_id = 0;
+  std::vector<MetaRecord> records;
+  if (!ReadMetaSnapshot(io::LeveldbBaseEnv(), filename, &snapshot_seq, &snapshot_id, &records)) {
+    LOG(WARNING) << "[meta] no valid snapshot in " << filename << ", load whole meta table";
+    return false;
+  }
+
+  bool has_floor = false;
+  uint64_t floor_seq = 0, floor_id = 0;
+  uint64_t last_journal_seq = snapshot_seq;
+  bool journal_corrupted = false;
+  std::vector<MetaWriteRecord> journal_records;
+  auto load_journal = [&](const std::string &key, const std::string &value) {
+    uint64_t seq = 0;
+    if (key == MetaJournal::kFloorKey) {
+      has_floor = MetaJournal::DecodeFloor(value, &floor_seq, &floor_id);
+    } else if (MetaJournal::ParseKey(key, &seq) && seq > snapshot_seq) {
+      // journals are scanned in seq order
+      if (!MetaJournal::Decode(value, &journal_records)) {
+        journal_corrupted = true;
+      }
+      last_journal_seq = seq;
+    }
+  };
+  if (!ScanMetaTable(meta_tablet_addr, MetaJournal::RangeStart(), MetaJournal::RangeEnd(),
+                     load_journal, NULL)) {
+    return false;
+  }
+  if (!has_floor || floor_seq != snapshot_seq || floor_id != snapshot_id) {
+    LOG(WARNING) << "[meta] snapshot " << snapshot_id << " seq " << snapshot_seq
+                 << " mismatch meta journal floor, load whole meta table";
+    return false;
+  }
+  if (journal_corrupted) {
+    LOG(WARNING) << "[meta] corrupted meta journal, load whole meta table";
+    return false;
+  }
+
+  size_t snapshot_records = records.size();
+  MetaJournal::Replay(journal_records, &records);
+  LoadMetaRecords(records);
+  TeraMasterEnv::ResetMetaJournalSeq(last_journal_seq);
+  last_meta_snapshot_seq_ = snapshot_seq;
+  LOG(INFO) << "[meta] load meta table from snapshot seq " << snapshot_seq << ", "
+            << snapshot_records << " records, replay " << journal_records.size()
+            << " journal records up to seq " << last_journal_seq << ", cost "
+            << get_millis() - start_ms << " ms";
+  return true;
+}
+
+std::string MasterImpl::MetaSnapshotPath() {
+  return FLAGS_tera_tabletnode_path_prefix + "/" + FLAGS_tera_master_meta_snapshot_file;
+}
+
+void MasterImpl::DoMetaSnapshot() {
+  {
+    MutexLock lock(&mutex_);
+    if (!meta_snapshot_enabled_) {
+      meta_snapshot_timer_id_ = kInvalidTimerId;
+      return;
+    }
+  }
+
+  std::string meta_tablet_addr;
+  int64_t snapshot_seq = TeraMasterEnv::CommittedMetaJournalSeq();
+  if (snapshot_seq != last_meta_snapshot_seq_ &&
+      tablet_manager_->GetMetaTabletAddr(&meta_tablet_addr)) {
+    // records committed after |snapshot_seq| may be scanned too, replaying
+    // their journals again on the snapshot leads to the same meta
+    int64_t start_ms = get_millis();
+    std::vector<MetaRecord> records;
+    std::vector<MetaWriteRecord> trim_records;
+    auto collect = [&](const std::string &key, const std::string &value) {
+      uint64_t seq = 0;
+      if (MetaJournal::ParseKey(key, &seq)) {
+        if (seq <= static_cast<uint64_t>(snapshot_seq)) {
+          trim_records.emplace_back(key, "", true);
+        }
+      } else if (key[0] != '!') {
+        records.emplace_back(key, value);
+      }
+    };
+    uint64_t snapshot_id = (static_cast<uint64_t>(get_micros()) << 16) ^ rand();
+    if (ScanMetaTable(meta_tablet_addr, "", "", collect, NULL) &&
+        WriteMetaSnapshot(io::LeveldbBaseEnv(), MetaSnapshotPath(), snapshot_seq, snapshot_id,
+                          records)) {
+      trim_records.emplace_back(MetaJournal::kFloorKey,
+                                MetaJournal::EncodeFloor(snapshot_seq, snapshot_id), false);
+      if (WriteMetaTableSync(meta_tablet_addr, trim_records, NULL)) {
+        last_meta_snapshot_seq_ = snapshot_seq;
+        LOG(INFO) << "[meta] snapshot " << snapshot_id << " seq " << snapshot_seq << ", "
+                  << records.size() << " records, trim " << trim_records.size() - 1
+                  << " journals, cost " << get_millis() - start_ms << " ms";
+      }
+    } else {
+      LOG(WARNING) << "[meta] fail to snapshot meta table at seq " << snapshot_seq;
+    }
+  }
+
+  MutexLock lock(&mutex_);
+  ScheduleMetaSnapshot();
+}
+
+void MasterImpl::ScheduleMetaSnapshot() {
+  mutex_.AssertHeld();
+  ThreadPool::Task task = std::bind(&MasterImpl::DoMetaSnapshot, this);
+  meta_snapshot_timer_id_ =
+      thread_pool_->DelayTask(FLAGS_tera_master_meta_snapshot_period_s * 1000, task);
+}
+
+void MasterImpl::EnableMetaSnapshotTimer() {
+  if (!TeraMasterEnv::MetaJournalEnabled()) {
+    return;
+  }
+
+  MutexLock lock(&mutex_);
+  if (meta_snapshot_timer_id_ == kInvalidTimerId) {
+    ScheduleMetaSnapshot();
+  }
+  meta_snapshot_enabled_ = true;
+}
+
+void MasterImpl::DisableMetaSnapshotTimer() {
+  if (!TeraMasterEnv::MetaJournalEnabled()) {
+    return;
+  }
+
+  MutexLock lock(&mutex_);
+  if (meta_snapshot_timer_id_ != kInvalidTimerId) {
+    bool non_block = true;
+    if (thread_pool_->CancelTask(meta_snapshot_timer_id_, non_block)) {
+      meta_snapshot_timer_id_ = kInvalidTimerId;
+    }
+  }
+  meta_snapshot_enabled_ = false;
+}
+
 bool MasterImpl::LoadMetaTableFromFile(const std::string &filename, StatusCode *ret_status) {
   tablet_manager_->ClearTableList();
   std::ifstream ifs(filename.c_str(), std::ofstream::binary);
@@ -1511,6 +1773,10 @@ void MasterImpl::ProcedureLimitCmdCtrl(const CmdCtrlRequest *request, CmdCtrlRes
       ProcedureLimiter::Instance().SetLockLimit(ProcedureLimiter::LockType::kLoad, limit);
     } else if (type == "kUnload") {
       ProcedureLimiter::Instance().SetLockLimit(ProcedureLimiter::LockType::kUnload, limit);
+    } else if (type == "kNode") {
+      ProcedureLimiter::Instance().SetNodeLockLimit(limit);
+    } else if (type == "kTable") {
+      ProcedureLimiter::Instance().SetTableLockLimit(limit);
     } else {
       response->set_status(kInvalidArgument);
       return;
@@ -1603,8 +1869,13 @@ void MasterImpl::QueryTabletNode() {
     update_quota_pending_count_.Inc();
     QueryClosure done =
         std::bind(&MasterImpl::QueryTabletNodeCallback, this, tabletnode->addr_, _1, _2, _3, _4);
+    int64_t acked_meta_version = -1;
+    if (FLAGS_tera_master_query_delta_enabled) {
+      acked_meta_version =
+          tabletnode->GetAckedMetaVersion(FLAGS_tera_master_query_full_sync_period);
+    }
     QueryTabletNodeAsync(tabletnode->addr_, FLAGS_tera_master_query_tabletnode_period,
-                         gc_query_enable, done);
+                         gc_query_enable, done, acked_meta_version);
   }
 
   if (0 == query_pending_count_.Dec()) {
@@ -1836,6 +2107,8 @@ bool MasterImpl::TabletNodeLoadBalance(TabletNodePtr tabletnode, Scheduler *sche
       continue;
     }
     double write_workload = tablet->GetCounter().write_workload();
+    std::string hot_split_key;
+    bool is_hotspot = IsHotspotTablet(tablet, &hot_split_key);
     int64_t split_size = FLAGS_tera_master_split_tablet_size;
     if (tablet->GetSchema().has_split_size() && tablet->GetSchema().split_size() > 0) {
       split_size = tablet->GetSchema().split_size();
@@ -1896,8 +2169,17 @@ bool MasterImpl::TabletNodeLoadBalance(TabletNodePtr tabletnode, Scheduler *sche
       TrySplitTablet(tablet);
       any_tablet_split = true;
       continue;
+    } else if (is_hotspot && tablet->GetDataSize() > (FLAGS_tera_master_min_split_size << 20) &&
+               tablet->TestAndSetSplitTimeStamp(get_micros())) {
+      LOG(INFO) << "[split] hotspot tablet: " << tablet->GetPath()
+                << ", access qps: " << tablet->GetAverageCounter().access_qps()
+                << ", split at load median key: " << DebugString(hot_split_key);
+      TrySplitTablet(tablet, hot_split_key);
+      any_tablet_split = true;
+      continue;
     } else if (tablet->GetDataSize() < (merge_size << 20)) {
-      if (!tablet->IsBusy() && write_workload < FLAGS_tera_master_workload_merge_threshold) {
+      if (!is_hotspot && !tablet->IsBusy() &&
+          write_workload < FLAGS_tera_master_workload_merge_threshold) {
         TryMergeTablet(tablet);
       } else {
         VLOG(6) << "[merge] skip high workload tablet: " << tablet->GetPath() << ", write_workload "
@@ -2227,6 +2509,7 @@ bool MasterImpl::EnterSafeMode(const MasterEvent event, StatusCode *status) {
   DisableTabletNodeGcTimer();
   DisableLoadBalance();
   DisableGcTrashCleanTimer();
+  DisableMetaSnapshotTimer();
   return true;
 }
 
@@ -2262,6 +2545,7 @@ bool MasterImpl::LeaveSafeMode(const MasterEvent event, StatusCode *status) {
   EnableTabletNodeGcTimer();
   EnableLoadBalance();
   EnableGcTrashCleanTimer();
+  EnableMetaSnapshotTimer();
 
   return true;
 }
@@ -2424,7 +2708,7 @@ bool MasterImpl::UnloadTabletSync(const std::string &table_name, const std::stri
 }
 
 void MasterImpl::QueryTabletNodeAsync(std::string addr, int32_t timeout, bool is_gc,
-                                      QueryClosure done) {
+                                      QueryClosure done, int64_t acked_meta_version) {
   tabletnode::TabletNodeClient node_client(thread_pool_.get(), addr, timeout);
 
   QueryRequest *request = new QueryRequest;
@@ -2434,6 +2718,9 @@ void MasterImpl::QueryTabletNodeAsync(std::string addr, int32_t timeout, bool is
   if (is_gc) {
     request->set_is_gc_query(true);
   }
+  if (acked_meta_version >= 0) {
+    request->set_acked_meta_version(acked_meta_version);
+  }
 
   // Set update info in access_checker
   access_entry_->GetAccessUpdater().BuildReq(request);
@@ -2450,7 +2737,6 @@ void MasterImpl::QueryTabletNodeCallback(std::string addr, QueryRequest *req, Qu
   std::unique_ptr<QueryResponse> response{res};
   bool in_safemode = IsInSafeMode();
   int64_t query_callback_start = get_micros();
-  const int64_t fuzzy_time = FLAGS_tera_master_query_tabletnode_period * 1000;
   TabletNodePtr node;
   if (!tabletnode_manager_->FindTabletNode(addr, &node)) {
     LOG(WARNING) << "fail to query: server down, id: " << request->sequence_id()
@@ -2465,13 +2751,23 @@ void MasterImpl::QueryTabletNodeCallback(std::string addr, QueryRequest *req, Qu
       LOG(ERROR) << kSms << "fail to query " << addr << " for " << fail_count << " times";
       TryKickTabletNode(addr);
     }
+  } else if (request->has_acked_meta_version() &&
+             !node->AckQueryMeta(request->acked_meta_version(), response->tablet_meta_version(),
+                                 response->is_delta_meta())) {
+    // next query will get a full list
+    LOG(WARNING) << "[query] ignore out of sync delta query, id: " << request->sequence_id()
+                 << ", server: " << addr;
   } else {
+    // a delta only has tablets changed since last query, the others keep what
+    // master already knows, and missed tablets are checked by full queries
+    bool delta_meta = request->has_acked_meta_version() && response->is_delta_meta();
     // update tablet meta
-    uint32_t meta_num = response->tabletmeta_list().meta_size();
+    const TabletMetaList &meta_list = response->tabletmeta_list();
+    uint32_t meta_num = meta_list.meta_size();
     std::map<tabletnode::TabletRange, int> tablet_map;
     for (uint32_t i = 0; i < meta_num; i++) {
-      const TabletMeta &meta = response->tabletmeta_list().meta(i);
-      const TabletCounter &counter = response->tabletmeta_list().counter(i);
+      const TabletMeta &meta = meta_list.meta(i);
+      const TabletCounter &counter = meta_list.counter(i);
       const std::string &table_name = meta.table_name();
       const std::string &key_start = meta.key_range().key_start();
       const std::string &key_end = meta.key_range().key_end();
@@ -2553,10 +2849,21 @@ void MasterImpl::QueryTabletNodeCallback(std::string addr, QueryRequest *req, Qu
         LOG(INFO) << "table disabled: " << tablet->GetPath();
       } else {
         VLOG(20) << "[query] OK tablet: " << meta.path() << "] @ " << meta.server_addr();
+        int64_t old_size = tablet->GetDataSize();
+        int64_t old_qps = tablet->GetQps();
         tablet->SetUpdateTime(query_callback_start);
         tablet->UpdateSize(meta);
         tablet->SetCounter(counter);
         tablet->SetCompactStatus(meta.compact_status());
+        if (delta_meta) {
+          node->UpdateSize(table_name, tablet->GetDataSize() - old_size,
+                           tablet->GetQps() - old_qps);
+        }
+      }
+    }
+    if (delta_meta) {
+      for (int32_t i = 0; i < response->removed_tablets_size(); ++i) {
+        CheckRemovedTablet(addr, response->removed_tablets(i), in_safemode);
       }
     }
 
@@ -2575,22 +2882,17 @@ void MasterImpl::QueryTabletNodeCallback(std::string addr, QueryRequest *req, Qu
     state.update_time_ = update_time.tv_sec * 1000 + update_time.tv_usec / 1000;
     // calculate data_size of tabletnode
     // count both Ready/OnLoad and OffLine tablet
+    // a delta query has adjusted the size of changed tablets already
     std::vector<TabletPtr> tablet_list;
-    tablet_manager_->FindTablet(addr, &tablet_list, false);  // don't need disabled tables/tablets
+    if (!delta_meta) {
+      // don't need disabled tables/tablets
+      tablet_manager_->FindTablet(addr, &tablet_list, false);
+    }
     std::vector<TabletPtr>::iterator it;
     for (it = tablet_list.begin(); it != tablet_list.end(); ++it) {
       TabletPtr tablet = *it;
       if (tablet->UpdateTime() != query_callback_start) {
-        if (tablet->GetStatus() == TabletMeta::kTabletUnloadFail && !in_safemode) {
-          LOG(WARNING) << "[query] missed previous unload fail tablet, try move it: " << tablet;
-          LOG(ERROR) << "[query] missed tablet, try move it: " << tablet;
-          TryMoveTablet(tablet, tablet->GetTabletNode());
-        }
-        if (tablet->GetStatus() == TabletMeta::kTabletReady &&
-            tablet->ReadyTime() + fuzzy_time < start_query_time_) {
-          LOG(ERROR) << "[query] missed tablet, try move it: " << tablet;
-          TryMoveTablet(tablet, tablet->GetTabletNode());
-        }
+        TryMoveMissedTablet(tablet, in_safemode);
       }
 
       TabletMeta::TabletStatus tablet_status = tablet->GetStatus();
@@ -2608,7 +2910,7 @@ void MasterImpl::QueryTabletNodeCallback(std::string addr, QueryRequest *req, Qu
         }
       }
     }
-    tabletnode_manager_->UpdateTabletNode(addr, state);
+    tabletnode_manager_->UpdateTabletNode(addr, state, !delta_meta);
     node->ResetQueryFailCount();
 
     for (int32_t i = 0; i < response->tablet_background_errors_size(); i++) {
@@ -2685,6 +2987,38 @@ void MasterImpl::QueryTabletNodeCallback(std::string addr, QueryRequest *req, Qu
            << ", callback cost " << (get_micros() - query_callback_start) / 1000 << "ms.";
 }
 
+void MasterImpl::TryMoveMissedTablet(TabletPtr tablet, bool in_safemode) {
+  const int64_t fuzzy_time = FLAGS_tera_master_query_tabletnode_period * 1000;
+  if (tablet->GetStatus() == TabletMeta::kTabletUnloadFail && !in_safemode) {
+    LOG(WARNING) << "[query] missed previous unload fail tablet, try move it: " << tablet;
+    LOG(ERROR) << "[query] missed tablet, try move it: " << tablet;
+    TryMoveTablet(tablet, tablet->GetTabletNode());
+  }
+  if (tablet->GetStatus() == TabletMeta::kTabletReady &&
+      tablet->ReadyTime() + fuzzy_time < start_query_time_) {
+    LOG(ERROR) << "[query] missed tablet, try move it: " << tablet;
+    TryMoveTablet(tablet, tablet->GetTabletNode());
+  }
+}
+
+void MasterImpl::CheckRemovedTablet(const std::string &addr, const std::string &path,
+                                    bool in_safemode) {
+  // tablet path is "table_name/tabletXXXXXXXX"
+  std::string table_name = path.substr(0, path.rfind('/'));
+  TablePtr table;
+  if (!tablet_manager_->FindTable(table_name, &table) || table->GetStatus() == kTableDisable) {
+    return;
+  }
+  std::vector<TabletPtr> tablets;
+  table->GetTablet(&tablets);
+  for (size_t i = 0; i < tablets.size(); ++i) {
+    if (tablets[i]->GetPath() == path && tablets[i]->GetServerAddr() == addr) {
+      TryMoveMissedTablet(tablets[i], in_safemode);
+      return;
+    }
+  }
+}
+
 void MasterImpl::CollectTabletInfoCallback(std::string addr, std::vector<TabletMeta> *tablet_list,
                                            sem_t *finish_counter, Mutex *mutex,
                                            QueryRequest *request, QueryResponse *response,
@@ -3011,6 +3345,27 @@ bool MasterImpl::TryMergeTablet(TabletPtr tablet) {
   return true;
 }
 
+bool MasterImpl::IsHotspotTablet(TabletPtr tablet, std::string* split_key) {
+  if (FLAGS_tera_master_hotspot_split_qps <= 0) {
+    return false;
+  }
+  // copy out, average counter may be refreshed by query concurrently
+  TabletCounter counter = tablet->GetAverageCounter();
+  if (counter.access_qps() <= static_cast<uint64_t>(FLAGS_tera_master_hotspot_split_qps) ||
+      !counter.has_load_median_key()) {
+    return false;
+  }
+  // split key should be strictly inside the tablet, or the split will be
+  // rejected by tabletnode
+  const std::string& median_key = counter.load_median_key();
+  const std::string& key_end = tablet->GetKeyEnd();
+  if (median_key <= tablet->GetKeyStart() || (!key_end.empty() && median_key >= key_end)) {
+    return false;
+  }
+  *split_key = median_key;
+  return true;
+}
+
 bool MasterImpl::TrySplitTablet(TabletPtr tablet, std::string split_key) {
   if (!tablet->LockTransition()) {
     LOG(WARNING) << "tablet: " << tablet->GetPath() << "is in transition, giveup this split try";
@@ -7,7 +7,9 @@
 
 #include <stdint.h>
 #include <semaphore.h>
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "common/event.h"
@@ -64,6 +66,7 @@ class Scheduler;
 class TabletManager;
 class TabletNodeManager;
 class TeraMasterEnv;
+struct MetaWriteRecord;
 
 class MasterImpl {
   friend class TeraMasterEnv;
@@ -192,10 +195,17 @@ class MasterImpl {
 
   void ScheduleQueryTabletNode();
   void QueryTabletNode();
-  void QueryTabletNodeAsync(std::string addr, int32_t timeout, bool is_gc, QueryClosure done);
+  // |acked_meta_version| < 0 means master does not cache tablet meta list of
+  // the node, tabletnode will always reply a full list.
+  void QueryTabletNodeAsync(std::string addr, int32_t timeout, bool is_gc, QueryClosure done,
+                            int64_t acked_meta_version = -1);
 
   void QueryTabletNodeCallback(std::string addr, QueryRequest* req, QueryResponse* res, bool failed,
                                int error_code);
+  // tablet thought to be on the node is not reported by query
+  void TryMoveMissedTablet(TabletPtr tablet, bool in_safemode);
+  // tablet at |path| is reported unloaded by a delta query of |addr|
+  void CheckRemovedTablet(const std::string& addr, const std::string& path, bool in_safemode);
   void CollectTabletInfoCallback(std::string addr, std::vector<TabletMeta>* tablet_list,
                                  sem_t* finish_counter, Mutex* mutex, QueryRequest* request,
                                  QueryResponse* response, bool failed, int error_code);
@@ -225,6 +235,22 @@ class MasterImpl {
   bool LoadMetaTable(const std::string& meta_tablet_addr, StatusCode* ret_status);
   bool LoadMetaTableFromFile(const std::string& filename, StatusCode* ret_status = NULL);
   bool ReadFromStream(std::ifstream& ifs, std::string* key, std::string* value);
+  bool ScanMetaTable(const std::string& meta_tablet_addr, const std::string& start,
+                     const std::string& end,
+                     const std::function<void(const std::string&, const std::string&)>& callback,
+                     StatusCode* ret_status);
+  bool WriteMetaTableSync(const std::string& meta_tablet_addr,
+                          const std::vector<MetaWriteRecord>& records, StatusCode* ret_status);
+  void LoadMetaRecord(const std::string& key, const std::string& value);
+  void LoadMetaRecords(const std::vector<std::pair<std::string, std::string>>& records);
+
+  // meta table snapshot, see meta_snapshot.h
+  bool LoadMetaTableFromSnapshot(const std::string& meta_tablet_addr);
+  void EnableMetaSnapshotTimer();
+  void DisableMetaSnapshotTimer();
+  void ScheduleMetaSnapshot();
+  void DoMetaSnapshot();
+  std::string MetaSnapshotPath();
 
   // load metatable on a tabletserver
   bool LoadMetaTablet(std::string* server_addr);
@@ -289,6 +315,9 @@ class MasterImpl {
   bool TryMergeTablet(TabletPtr tablet);
 
   bool TrySplitTablet(TabletPtr tablet, std::string split_key = "");
+  // A tablet whose sampled access qps is too high, |split_key| is set to the
+  // median of its sampled row key accesses.
+  bool IsHotspotTablet(TabletPtr tablet, std::string* split_key);
 
  private:
   mutable Mutex status_mutex_;
@@ -342,6 +371,11 @@ class MasterImpl {
   int64_t gc_timer_id_;
   bool gc_query_enable_;
 
+  // meta table snapshot
+  bool meta_snapshot_enabled_;
+  int64_t meta_snapshot_timer_id_;
+  int64_t last_meta_snapshot_seq_;
+
   std::shared_ptr<ProcedureExecutor> executor_;
   std::shared_ptr<TabletAvailability> tablet_availability_;
 
@@ -0,0 +1,266 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "master/meta_snapshot.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <map>
+#include <memory>
+
+#include <glog/logging.h>
+
+#include "leveldb/env.h"
+#include "leveldb/util/crc32c.h"
+
+namespace tera {
+namespace master {
+
+static const char* const kJournalPrefix = "!j";
+static const uint32_t kSnapshotMagic = 0x5445524d;  // "TERM"
+
+const char* const MetaJournal::kFloorKey = "!f";
+
+static void AppendFixed32(std::string* dst, uint32_t v) { dst->append((char*)&v, sizeof(v)); }
+
+static void AppendFixed64(std::string* dst, uint64_t v) { dst->append((char*)&v, sizeof(v)); }
+
+static bool ConsumeFixed32(const std::string& src, size_t* pos, uint32_t* v) {
+  if (*pos + sizeof(*v) > src.size()) {
+    return false;
+  }
+  memcpy(v, src.data() + *pos, sizeof(*v));
+  *pos += sizeof(*v);
+  return true;
+}
+
+static bool ConsumeString(const std::string& src, size_t* pos, std::string* str) {
+  uint32_t size = 0;
+  if (!ConsumeFixed32(src, pos, &size) || *pos + size > src.size()) {
+    return false;
+  }
+  str->assign(src.data() + *pos, size);
+  *pos += size;
+  return true;
+}
+
+std::string MetaJournal::Key(uint64_t seq) {
+  // fixed width hex keeps journals sorted by seq in meta table
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%s%016lx", kJournalPrefix, seq);
+  return buf;
+}
+
+bool MetaJournal::ParseKey(const std::string& key, uint64_t* seq) {
+  const size_t prefix_len = strlen(kJournalPrefix);
+  if (key.size() != prefix_len + 16 || key.compare(0, prefix_len, kJournalPrefix) != 0) {
+    return false;
+  }
+  char* end = NULL;
+  *seq = strtoull(key.c_str() + prefix_len, &end, 16);
+  return *end == '\0';
+}
+
+std::string MetaJournal::RangeStart() { return "!"; }
+
+std::string MetaJournal::RangeEnd() { return "\""; }
+
+std::string MetaJournal::EncodeFloor(uint64_t seq, uint64_t snapshot_id) {
+  std::string value;
+  AppendFixed64(&value, seq);
+  AppendFixed64(&value, snapshot_id);
+  return value;
+}
+
+bool MetaJournal::DecodeFloor(const std::string& value, uint64_t* seq, uint64_t* snapshot_id) {
+  if (value.size() != sizeof(*seq) + sizeof(*snapshot_id)) {
+    return false;
+  }
+  memcpy(seq, value.data(), sizeof(*seq));
+  memcpy(snapshot_id, value.data() + sizeof(*seq), sizeof(*snapshot_id));
+  return true;
+}
+
+void MetaJournal::Encode(const std::vector<MetaWriteRecord>& records, std::string* value) {
+  value->clear();
+  AppendFixed32(value, records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    value->push_back(records[i].is_delete ? 1 : 0);
+    AppendFixed32(value, records[i].key.size());
+    value->append(records[i].key);
+    AppendFixed32(value, records[i].value.size());
+    value->append(records[i].value);
+  }
+}
+
+bool MetaJournal::Decode(const std::string& value, std::vector<MetaWriteRecord>* records) {
+  size_t pos = 0;
+  uint32_t num = 0;
+  if (!ConsumeFixed32(value, &pos, &num)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < num; ++i) {
+    if (pos >= value.size()) {
+      return false;
+    }
+    MetaWriteRecord record;
+    record.is_delete = (value[pos++] != 0);
+    if (!ConsumeString(value, &pos, &record.key) || !ConsumeString(value, &pos, &record.value)) {
+      return false;
+    }
+    records->push_back(record);
+  }
+  return pos == value.size();
+}
+
+void MetaJournal::Replay(const std::vector<MetaWriteRecord>& journal_records,
+                         std::vector<MetaRecord>* snapshot_records) {
+  if (journal_records.empty()) {
+    return;
+  }
+  // the last write of a key wins, <false, ""> means the key is deleted
+  std::map<std::string, std::pair<bool, std::string>> changes;
+  for (size_t i = 0; i < journal_records.size(); ++i) {
+    const MetaWriteRecord& record = journal_records[i];
+    changes[record.key] = std::make_pair(!record.is_delete, record.value);
+  }
+  std::vector<MetaRecord> merged;
+  merged.reserve(snapshot_records->size() + changes.size());
+  auto change_it = changes.begin();
+  for (auto it = snapshot_records->begin(); it != snapshot_records->end(); ++it) {
+    for (; change_it != changes.end() && change_it->first < it->first; ++change_it) {
+      if (change_it->second.first) {
+        merged.emplace_back(change_it->first, change_it->second.second);
+      }
+    }
+    if (change_it != changes.end() && change_it->first == it->first) {
+      if (change_it->second.first) {
+        merged.emplace_back(change_it->first, change_it->second.second);
+      }
+      ++change_it;
+    } else {
+      merged.emplace_back(std::move(*it));
+    }
+  }
+  for (; change_it != changes.end(); ++change_it) {
+    if (change_it->second.first) {
+      merged.emplace_back(change_it->first, change_it->second.second);
+    }
+  }
+  snapshot_records->swap(merged);
+}
+
+bool WriteMetaSnapshot(leveldb::Env* env, const std::string& filename, uint64_t seq,
+                       uint64_t snapshot_id, const std::vector<MetaRecord>& records) {
+  std::string tmp_filename = filename + ".tmp";
+  leveldb::WritableFile* file = NULL;
+  leveldb::Status s = env->NewWritableFile(tmp_filename, &file, leveldb::EnvOptions());
+  if (!s.ok()) {
+    LOG(WARNING) << "[meta] fail to open file " << tmp_filename << " for write: " << s.ToString();
+    return false;
+  }
+  std::unique_ptr<leveldb::WritableFile> file_holder(file);
+  // checksum covers the header too, so a flipped seq or record number is
+  // never taken as a valid snapshot
+  std::string buf;
+  AppendFixed32(&buf, kSnapshotMagic);
+  AppendFixed64(&buf, seq);
+  AppendFixed64(&buf, snapshot_id);
+  AppendFixed64(&buf, records.size());
+  uint32_t crc = leveldb::crc32c::Value(buf.data(), buf.size());
+  s = file->Append(buf);
+  for (size_t i = 0; s.ok() && i < records.size(); ++i) {
+    buf.clear();
+    AppendFixed32(&buf, records[i].first.size());
+    buf.append(records[i].first);
+    AppendFixed32(&buf, records[i].second.size());
+    buf.append(records[i].second);
+    crc = leveldb::crc32c::Extend(crc, buf.data(), buf.size());
+    s = file->Append(buf);
+  }
+  if (s.ok()) {
+    buf.clear();
+    AppendFixed32(&buf, crc);
+    s = file->Append(buf);
+  }
+  if (s.ok()) {
+    s = file->Sync();
+  }
+  if (s.ok()) {
+    s = file->Close();
+  }
+  if (!s.ok()) {
+    LOG(WARNING) << "[meta] fail to write snapshot file " << tmp_filename << ": " << s.ToString();
+    env->DeleteFile(tmp_filename);
+    return false;
+  }
+  s = env->RenameFile(tmp_filename, filename);
+  if (!s.ok()) {
+    LOG(WARNING) << "[meta] fail to rename " << tmp_filename << " to " << filename << ": "
+                 << s.ToString();
+    return false;
+  }
+  return true;
+}
+
+bool ReadMetaSnapshot(leveldb::Env* env, const std::string& filename, uint64_t* seq,
+                      uint64_t* snapshot_id, std::vector<MetaRecord>* records) {
+  std::string data;
+  leveldb::Status s = leveldb::ReadFileToString(env, filename, &data);
+  if (!s.ok()) {
+    LOG(WARNING) << "[meta] fail to read snapshot file " << filename << ": " << s.ToString();
+    return false;
+  }
+  const size_t header_size = sizeof(uint32_t) + 3 * sizeof(uint64_t);
+  if (data.size() < header_size + sizeof(uint32_t)) {
+    LOG(WARNING) << "[meta] snapshot file " << filename << " is truncated";
+    return false;
+  }
+  uint32_t expected_crc = 0;
+  size_t body_end = data.size() - sizeof(expected_crc);
+  memcpy(&expected_crc, data.data() + body_end, sizeof(expected_crc));
+  if (leveldb::crc32c::Value(data.data(), body_end) != expected_crc) {
+    LOG(WARNING) << "[meta] checksum mismatch of snapshot file " << filename;
+    return false;
+  }
+  data.resize(body_end);
+
+  uint32_t magic = 0;
+  uint64_t num = 0;
+  const char* p = data.data();
+  memcpy(&magic, p, sizeof(magic));
+  p += sizeof(magic);
+  memcpy(seq, p, sizeof(*seq));
+  p += sizeof(*seq);
+  memcpy(snapshot_id, p, sizeof(*snapshot_id));
+  p += sizeof(*snapshot_id);
+  memcpy(&num, p, sizeof(num));
+  if (magic != kSnapshotMagic) {
+    LOG(WARNING) << "[meta] bad magic of snapshot file " << filename;
+    return false;
+  }
+  // each record takes two sizes at least
+  if (num > (data.size() - header_size) / (2 * sizeof(uint32_t))) {
+    LOG(WARNING) << "[meta] bad record number " << num << " of snapshot file " << filename;
+    return false;
+  }
+
+  records->clear();
+  records->reserve(num);
+  size_t pos = header_size;
+  for (uint64_t i = 0; i < num; ++i) {
+    MetaRecord record;
+    if (!ConsumeString(data, &pos, &record.first) || !ConsumeString(data, &pos, &record.second)) {
+      LOG(WARNING) << "[meta] corrupted snapshot file " << filename;
+      records->clear();
+      return false;
+    }
+    records->emplace_back(std::move(record));
+  }
+  return pos == data.size();
+}
+
+}  // namespace master
+}  // namespace tera
@@ -0,0 +1,63 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "leveldb/env.h"
+#include "master/master_env.h"
+
+namespace tera {
+namespace master {
+
+// Snapshot of meta table and journal of meta table writes, a new master loads
+// the snapshot and replays journals after it instead of scanning the whole
+// meta table.
+//
+// Every meta write batch also puts a journal row "!j<seq>" holding the
+// records of the batch. After a snapshot covering journals up to <seq> is
+// persisted, the floor row "!f" is set to <seq> and the unique id of the
+// snapshot, then journals up to <seq> are deleted. Only the snapshot the
+// floor points to can be replayed, a stale snapshot file or one left by
+// another master is ignored. Keys starting with '!' are ignored by meta table
+// loaders.
+
+typedef std::pair<std::string, std::string> MetaRecord;
+
+class MetaJournal {
+ public:
+  static const char* const kFloorKey;
+
+  static std::string Key(uint64_t seq);
+  static bool ParseKey(const std::string& key, uint64_t* seq);
+  // start and end of the key range of all journal rows and floor row
+  static std::string RangeStart();
+  static std::string RangeEnd();
+
+  static std::string EncodeFloor(uint64_t seq, uint64_t snapshot_id);
+  static bool DecodeFloor(const std::string& value, uint64_t* seq, uint64_t* snapshot_id);
+
+  static void Encode(const std::vector<MetaWriteRecord>& records, std::string* value);
+  static bool Decode(const std::string& value, std::vector<MetaWriteRecord>* records);
+
+  // applies journal records in order on a sorted snapshot
+  static void Replay(const std::vector<MetaWriteRecord>& journal_records,
+                     std::vector<MetaRecord>* snapshot_records);
+};
+
+// The snapshot file lives on dfs beside tables, so that any master taking
+// over can load it. |records| should be sorted by key, the file is replaced
+// by rename.
+bool WriteMetaSnapshot(leveldb::Env* env, const std::string& filename, uint64_t seq,
+                       uint64_t snapshot_id, const std::vector<MetaRecord>& records);
+bool ReadMetaSnapshot(leveldb::Env* env, const std::string& filename, uint64_t* seq,
+                      uint64_t* snapshot_id, std::vector<MetaRecord>* records);
+
+}  // namespace master
+}  // namespace tera
@@ -0,0 +1,92 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "master/meta_write_coalescer.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include "common/timer.h"
+
+namespace tera {
+namespace master {
+
+MetaWriteCoalescer::MetaWriteCoalescer(CommitFunc commit, size_t max_batch_records)
+    : commit_(commit),
+      max_batch_records_(std::max(max_batch_records, static_cast<size_t>(1))),
+      committing_(false),
+      batch_count_("tera_master_meta_write_batch", {SubscriberType::QPS}),
+      record_count_("tera_master_meta_write_record", {SubscriberType::QPS}),
+      commit_fail_count_("tera_master_meta_write_fail", {SubscriberType::QPS}),
+      batch_size_("tera_master_meta_write_batch_size", "percentile:99", 99),
+      commit_latency_("tera_master_meta_write_latency_us", "stage:commit,percentile:99", 99),
+      write_latency_("tera_master_meta_write_latency_us", "stage:total,percentile:99", 99) {}
+
+MetaWriteCoalescer::~MetaWriteCoalescer() {}
+
+void MetaWriteCoalescer::Write(const std::vector<MetaWriteRecord>& records,
+                               UpdateMetaClosure done) {
+  MutexLock lock(&mutex_);
+  pending_writes_.emplace_back();
+  PendingWrite& write = pending_writes_.back();
+  write.records = records;
+  write.done = done;
+  write.start_us = get_micros();
+  if (!committing_) {
+    CommitPendingWrites();
+  }
+}
+
+void MetaWriteCoalescer::CommitPendingWrites() {
+  mutex_.AssertHeld();
+  if (pending_writes_.empty()) {
+    return;
+  }
+  // a write is never split, so a large one may exceed max_batch_records_
+  std::vector<PendingWrite>* batch = new std::vector<PendingWrite>;
+  std::vector<MetaWriteRecord> records;
+  while (!pending_writes_.empty()) {
+    PendingWrite& write = pending_writes_.front();
+    if (!records.empty() && records.size() + write.records.size() > max_batch_records_) {
+      break;
+    }
+    records.insert(records.end(), write.records.begin(), write.records.end());
+    batch->emplace_back(std::move(write));
+    pending_writes_.pop_front();
+  }
+  committing_ = true;
+  batch_count_.Inc();
+  record_count_.Add(records.size());
+  batch_size_.Append(records.size());
+  VLOG(10) << "[meta] commit " << batch->size() << " writes with " << records.size()
+           << " records, " << pending_writes_.size() << " writes pending";
+
+  CommitDone done = std::bind(&MetaWriteCoalescer::CommitCallback, this, batch, get_micros(),
+                              std::placeholders::_1);
+  mutex_.Unlock();
+  commit_(records, done);
+  mutex_.Lock();
+}
+
+void MetaWriteCoalescer::CommitCallback(std::vector<PendingWrite>* batch,
+                                        int64_t commit_start_us, bool succ) {
+  int64_t now_us = get_micros();
+  commit_latency_.Append(now_us - commit_start_us);
+  if (!succ) {
+    commit_fail_count_.Inc();
+  }
+  for (auto it = batch->begin(); it != batch->end(); ++it) {
+    write_latency_.Append(now_us - it->start_us);
+    it->done(succ);
+  }
+  delete batch;
+
+  MutexLock lock(&mutex_);
+  committing_ = false;
+  CommitPendingWrites();
+}
+
+}  // namespace master
+}  // namespace tera
@@ -0,0 +1,67 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "common/metric/metric_counter.h"
+#include "common/metric/percentile_counter.h"
+#include "common/mutex.h"
+#include "master/master_env.h"
+
+namespace tera {
+namespace master {
+
+// Coalesces concurrent meta table writes of procedures into one
+// WriteTabletRequest.
+//
+// At most one batch is committing at any time, writes arrive during the
+// commit are queued and go out together in the next batch. Records are packed
+// in arrival order, so updates of one tablet are applied in the order they
+// are written.
+class MetaWriteCoalescer {
+ public:
+  typedef std::function<void(bool)> CommitDone;
+  // writes all |records| to meta table, calls |done| with whether succeed
+  typedef std::function<void(const std::vector<MetaWriteRecord>& records, CommitDone done)>
+      CommitFunc;
+
+  MetaWriteCoalescer(CommitFunc commit, size_t max_batch_records);
+  ~MetaWriteCoalescer();
+
+  // |done| is called once the batch containing |records| is committed
+  void Write(const std::vector<MetaWriteRecord>& records, UpdateMetaClosure done);
+
+ private:
+  struct PendingWrite {
+    std::vector<MetaWriteRecord> records;
+    UpdateMetaClosure done;
+    int64_t start_us;
+  };
+
+  // REQUIRES: mutex_ held and committing_ is false
+  void CommitPendingWrites();
+  void CommitCallback(std::vector<PendingWrite>* batch, int64_t commit_start_us, bool succ);
+
+ private:
+  CommitFunc commit_;
+  const size_t max_batch_records_;
+
+  Mutex mutex_;
+  std::deque<PendingWrite> pending_writes_;
+  bool committing_;
+
+  MetricCounter batch_count_;
+  MetricCounter record_count_;
+  MetricCounter commit_fail_count_;
+  PercentileCounter batch_size_;
+  PercentileCounter commit_latency_;
+  PercentileCounter write_latency_;
+};
+
+}  // namespace master
+}  // namespace tera
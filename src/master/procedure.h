@@ -30,6 +30,14 @@ class Procedure {
 
   virtual ProcedureLimiter::LockType GetLockType() { return type_; }
 
+  // the tabletnode and the table this Procedure works on, ProcedureLimiter
+  // also limits Procedures per node and per table by them, empty means no limit.
+  // Only leaf Procedures (load/unload) should return them: a parent waits for
+  // its sub Procedures on the same node and table while holding its own lock,
+  // which would never be released under a limit of 1.
+  virtual std::string GetLockNode() { return ""; }
+  virtual std::string GetLockTable() { return ""; }
+
   Procedure() : type_(ProcedureLimiter::LockType::kNoLimit) {}
   Procedure(const ProcedureLimiter::LockType& type) : type_(type) {}
 
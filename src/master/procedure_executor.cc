@@ -2,6 +2,9 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <functional>
+
 #include <glog/logging.h>
 #include "common/timer.h"
 #include "master/master_env.h"
@@ -9,6 +12,8 @@
 #include "proto/tabletnode_client.h"
 
 DEFINE_int32(procedure_executor_thread_num, 10, "procedure executor thread pool number");
+DEFINE_int32(procedure_executor_shard_num, 4,
+             "procedure executor shard number, each shard has a schedule thread");
 
 namespace tera {
 namespace master {
@@ -17,7 +22,7 @@ void ProcedureWrapper::RunNextStage(std::shared_ptr<ProcedureExecutor> proc_exec
   proc_->RunNextStage();
   scheduling_.store(false);
   if (Done()) {
-    ProcedureLimiter::Instance().ReleaseLock(proc_->GetLockType());
+    ReleaseLock();
     VLOG(23) << "procedure executor remove procedure: " << ProcId();
     proc_executor->RemoveProcedure(ProcId());
   }
@@ -26,7 +31,12 @@ void ProcedureWrapper::RunNextStage(std::shared_ptr<ProcedureExecutor> proc_exec
 ProcedureExecutor::ProcedureExecutor()
     : running_(false),
       proc_index_(0),
-      thread_pool_(new ThreadPool(FLAGS_procedure_executor_thread_num)) {}
+      thread_pool_(new ThreadPool(FLAGS_procedure_executor_thread_num)) {
+  int32_t shard_num = std::max(FLAGS_procedure_executor_shard_num, 1);
+  for (int32_t i = 0; i < shard_num; ++i) {
+    shards_.emplace_back(new Shard);
+  }
+}
 
 bool ProcedureExecutor::Start() {
   std::unique_lock<std::mutex> lock(mutex_);
@@ -34,68 +44,100 @@ bool ProcedureExecutor::Start() {
     return false;
   }
   running_ = true;
-  schedule_thread_ = std::move(std::thread(&ProcedureExecutor::ScheduleProcedures, this));
+  for (auto& shard : shards_) {
+    shard->schedule_thread =
+        std::thread(&ProcedureExecutor::ScheduleProcedures, this, shard.get());
+  }
   return true;
 }
 
 void ProcedureExecutor::Stop() {
-  mutex_.lock();
+  std::unique_lock<std::mutex> lock(mutex_);
   if (!running_) {
-    mutex_.unlock();
     return;
   }
   running_ = false;
-  cv_.notify_all();
-  // it may takes a long time to join threads, so unlock mutex_ manually to
-  // minimize race condition
-  mutex_.unlock();
-
-  schedule_thread_.join();
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> shard_lock(shard->mutex);
+    shard->cv.notify_all();
+  }
+  for (auto& shard : shards_) {
+    shard->schedule_thread.join();
+  }
 
   thread_pool_->Stop(true);
 }
 
+ProcedureExecutor::Shard* ProcedureExecutor::GetShard(const std::string& proc_id) {
+  return shards_[std::hash<std::string>()(proc_id) % shards_.size()].get();
+}
+
 uint64_t ProcedureExecutor::AddProcedure(std::shared_ptr<Procedure> proc) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::string proc_id = proc->ProcId();
+  Shard* shard = GetShard(proc_id);
+  std::lock_guard<std::mutex> lock(shard->mutex);
   if (!running_) {
     return 0;
   }
-  std::string proc_id = proc->ProcId();
-  if (procedure_indexs_.find(proc_id) != procedure_indexs_.end()) {
+  if (shard->procedure_indexs.find(proc_id) != shard->procedure_indexs.end()) {
     VLOG(23) << "Error in AddProcedure : " << proc_id << " has existed!";
     return 0;
   }
-  procedure_indexs_.emplace(proc_id, ++proc_index_);
-  procedures_.emplace(proc_index_, std::shared_ptr<ProcedureWrapper>(new ProcedureWrapper(proc)));
-  cv_.notify_all();
-  return proc_index_;
+  uint64_t index = ++proc_index_;
+  shard->procedure_indexs.emplace(proc_id, index);
+  shard->procedures.emplace(index, std::shared_ptr<ProcedureWrapper>(new ProcedureWrapper(proc)));
+  shard->cv.notify_all();
+  return index;
 }
 
 bool ProcedureExecutor::RemoveProcedure(const std::string& proc_id) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  auto it = procedure_indexs_.find(proc_id);
-  if (it == procedure_indexs_.end()) {
+  Shard* shard = GetShard(proc_id);
+  std::unique_lock<std::mutex> lock(shard->mutex);
+  auto it = shard->procedure_indexs.find(proc_id);
+  if (it == shard->procedure_indexs.end()) {
     return false;
   }
-  procedures_.erase(it->second);
-  procedure_indexs_.erase(it);
+  shard->procedures.erase(it->second);
+  shard->procedure_indexs.erase(it);
   return true;
 }
 
-void ProcedureExecutor::ScheduleProcedures() {
+size_t ProcedureExecutor::ProcedureNum() {
+  size_t num = 0;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    num += shard->procedures.size();
+  }
+  return num;
+}
+
+std::shared_ptr<Procedure> ProcedureExecutor::GetProcedure(uint64_t index) {
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    auto it = shard->procedures.find(index);
+    if (it != shard->procedures.end()) {
+      return it->second->proc_;
+    }
+  }
+  return std::shared_ptr<Procedure>();
+}
+
+void ProcedureExecutor::ScheduleProcedures(Shard* shard) {
+  std::vector<std::shared_ptr<ProcedureWrapper>> procedures;
   while (running_) {
-    std::map<uint64_t, std::shared_ptr<ProcedureWrapper>> procedures;
+    procedures.clear();
     {
-      std::unique_lock<std::mutex> lock(mutex_);
-      while (procedures_.empty() && running_) {
-        cv_.wait(lock);
+      std::unique_lock<std::mutex> lock(shard->mutex);
+      while (shard->procedures.empty() && running_) {
+        shard->cv.wait(lock);
+      }
+      procedures.reserve(shard->procedures.size());
+      for (auto it = shard->procedures.begin(); it != shard->procedures.end(); ++it) {
+        procedures.emplace_back(it->second);
       }
-      procedures = procedures_;
     }
 
-    for (auto it = procedures.begin(); it != procedures.end(); ++it) {
-      auto proc = it->second;
-      const std::string proc_id = proc->ProcId();
+    for (auto& proc : procedures) {
       if (proc->TrySchedule()) {
         ThreadPool::Task task =
             std::bind(&ProcedureWrapper::RunNextStage, proc, shared_from_this());
@@ -48,18 +48,31 @@ class ProcedureWrapper {
     if (got_lock_) {
       return true;
     }
-    if (!ProcedureLimiter::Instance().GetLock(proc_->GetLockType())) {
+    // remember node and table of the lock, they may change before release
+    lock_node_ = proc_->GetLockNode();
+    lock_table_ = proc_->GetLockTable();
+    if (!ProcedureLimiter::Instance().GetLock(proc_->GetLockType(), lock_node_, lock_table_)) {
       return false;
     }
     got_lock_ = true;
     return true;
   }
 
+  void ReleaseLock() {
+    ProcedureLimiter::Instance().ReleaseLock(proc_->GetLockType(), lock_node_, lock_table_);
+  }
+
   std::atomic<bool> scheduling_;
   std::shared_ptr<Procedure> proc_;
   bool got_lock_;
+  std::string lock_node_;
+  std::string lock_table_;
 };
 
+// Procedures are sharded by the hash of ProcId, which contains the tablet
+// path for tablet procedures, and each shard is polled by its own schedule
+// thread, so one scheduling round never walks all Procedures of the master.
+// Stages of all shards run in one shared thread pool.
 class ProcedureExecutor : public std::enable_shared_from_this<ProcedureExecutor> {
  public:
   ProcedureExecutor();
@@ -71,30 +84,39 @@ class ProcedureExecutor : public std::enable_shared_from_this<ProcedureExecutor>
 
   uint64_t AddProcedure(std::shared_ptr<Procedure> proc);
 
-  void ScheduleProcedures();
+  size_t ProcedureNum();
 
  private:
+  // Procedure added with |index|, or nullptr if not found
+  std::shared_ptr<Procedure> GetProcedure(uint64_t index);
+
+  struct Shard {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::map<std::string, uint64_t> procedure_indexs;
+    // use integer as map key thus we can schedule Procedures
+    // according to the order as they are added to the map
+    std::map<uint64_t, std::shared_ptr<ProcedureWrapper>> procedures;
+    // polling Procedures of this shard and add Procedure can be scheduled to
+    // thread_pool_, a procedure may be scheduled several times until it is Done
+    std::thread schedule_thread;
+  };
+
+  void ScheduleProcedures(Shard* shard);
+  Shard* GetShard(const std::string& proc_id);
   bool RemoveProcedure(const std::string& proc_id);
   friend class ProcedureWrapper;
 
  private:
+  // guards Start() and Stop()
   std::mutex mutex_;
-  std::condition_variable cv_;
   std::atomic<bool> running_;
 
-  uint64_t proc_index_;
-  std::map<std::string, uint64_t> procedure_indexs_;
-  // use integer as map key thus we can schedule Procedures
-  // according to the order as they are added to the map
-  std::map<uint64_t, std::shared_ptr<ProcedureWrapper>> procedures_;
+  std::atomic<uint64_t> proc_index_;
+  std::vector<std::unique_ptr<Shard>> shards_;
 
-  // ThreadPool used to run
+  // ThreadPool used to run the Procedures background
   std::shared_ptr<ThreadPool> thread_pool_;
-  // polling all Procedures and add Procedure can be scheduled to thread_pool,
-  // running the
-  // Procedure background in thread_pool_
-  // A procedure may be scheduled several times until the Procedure is Done
-  std::thread schedule_thread_;
 };
 }
 }
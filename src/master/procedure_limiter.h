@@ -6,11 +6,15 @@
 
 #include <assert.h>
 
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <mutex>
+#include <string>
 #include <sstream>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -20,10 +24,16 @@ DECLARE_int32(master_split_procedure_limit);
 DECLARE_int32(master_move_procedure_limit);
 DECLARE_int32(master_load_procedure_limit);
 DECLARE_int32(master_unload_procedure_limit);
+DECLARE_int32(master_node_procedure_limit);
+DECLARE_int32(master_table_procedure_limit);
 
 namespace tera {
 namespace master {
 
+// Limits the concurrency of procedures by their LockType, and optionally by
+// the tabletnode and the table they work on. The global counters are atomic,
+// and the per node/table counters are partitioned by hash with a mutex each,
+// so that sharded procedure schedulers seldom contend on one lock.
 class ProcedureLimiter final {
  public:
   enum class LockType { kNoLimit = 0, kMerge, kSplit, kMove, kLoad, kUnload };
@@ -43,58 +53,98 @@ class ProcedureLimiter final {
     return instance;
   }
 
-  bool GetLock(const LockType& type) {
+  // |node| and |table| are optional, an empty one is not limited. Locks of
+  // type kNoLimit are never limited, neither by node nor by table.
+  bool GetLock(const LockType& type, const std::string& node = "",
+               const std::string& table = "") {
     if (type == LockType::kNoLimit) {
       VLOG(20) << "[ProcedureLimiter] get lock for type:" << type << " success";
       return true;
     }
-    assert(limit_.find(type) != limit_.end());
-    assert(in_use_.find(type) != in_use_.end());
-
-    std::lock_guard<std::mutex> guard(mutex_);
-    if (in_use_[type] >= limit_[type]) {
-      VLOG(20) << "[ProcedureLimiter] get lock for type:" << type
-               << " fail, reason: lock exhaust, lock limit:" << limit_[type]
-               << ", in use:" << in_use_[type];
+    size_t index = Index(type);
+    uint32_t in_use = in_use_[index].load();
+    do {
+      if (in_use >= limit_[index].load()) {
+        VLOG(20) << "[ProcedureLimiter] get lock for type:" << type
+                 << " fail, reason: lock exhaust, lock limit:" << limit_[index].load()
+                 << ", in use:" << in_use;
+        return false;
+      }
+    } while (!in_use_[index].compare_exchange_weak(in_use, in_use + 1));
+
+    if (!node.empty() && !node_partitions_[Partition(node)].Acquire(node, node_limit_.load())) {
+      VLOG(20) << "[ProcedureLimiter] get lock for type:" << type << " on node:" << node
+               << " fail, reason: node lock exhaust, node lock limit:" << node_limit_.load();
+      --in_use_[index];
       return false;
     }
-    ++in_use_[type];
-    VLOG(20) << "[ProcedureLimiter] get lock for type:" << type
-             << " success, lock limit:" << limit_[type] << ", in use:" << in_use_[type];
+    if (!table.empty() &&
+        !table_partitions_[Partition(table)].Acquire(table, table_limit_.load())) {
+      VLOG(20) << "[ProcedureLimiter] get lock for type:" << type << " on table:" << table
+               << " fail, reason: table lock exhaust, table lock limit:" << table_limit_.load();
+      if (!node.empty()) {
+        node_partitions_[Partition(node)].Release(node);
+      }
+      --in_use_[index];
+      return false;
+    }
+    VLOG(20) << "[ProcedureLimiter] get lock for type:" << type << " node:" << node
+             << " table:" << table << " success, lock limit:" << limit_[index].load()
+             << ", in use:" << in_use + 1;
     return true;
   }
 
-  void ReleaseLock(const LockType& type) {
+  // should be called with the same arguments as the successful GetLock()
+  void ReleaseLock(const LockType& type, const std::string& node = "",
+                   const std::string& table = "") {
     if (type == LockType::kNoLimit) {
       VLOG(20) << "[ProcedureLimiter] release lock for type:" << type << " success";
       return;
     }
-    assert(limit_.find(type) != limit_.end());
-    assert(in_use_.find(type) != in_use_.end());
-
-    std::lock_guard<std::mutex> guard(mutex_);
-    assert(in_use_[type] > 0);
-    --in_use_[type];
-    VLOG(20) << "[ProcedureLimiter] release lock for type:" << type
-             << " success, lock limit:" << limit_[type] << ", in use:" << in_use_[type];
+    if (!table.empty()) {
+      table_partitions_[Partition(table)].Release(table);
+    }
+    if (!node.empty()) {
+      node_partitions_[Partition(node)].Release(node);
+    }
+    size_t index = Index(type);
+    assert(in_use_[index].load() > 0);
+    uint32_t in_use = --in_use_[index];
+    VLOG(20) << "[ProcedureLimiter] release lock for type:" << type << " node:" << node
+             << " table:" << table << " success, lock limit:" << limit_[index].load()
+             << ", in use:" << in_use;
   }
 
   void SetLockLimit(const LockType& type, uint32_t num) {
-    std::lock_guard<std::mutex> guard(mutex_);
-    limit_[type] = num;
+    limit_[Index(type)].store(num);
     VLOG(20) << "[ProcedureLimiter] set lock type:" << type << " with lock limit:" << num;
   }
 
-  uint32_t GetLockLimit(const LockType& type) const {
-    assert(limit_.find(type) != limit_.end());
-    std::lock_guard<std::mutex> guard(mutex_);
-    return limit_[type];
+  uint32_t GetLockLimit(const LockType& type) const { return limit_[Index(type)].load(); }
+
+  uint32_t GetLockInUse(const LockType& type) const { return in_use_[Index(type)].load(); }
+
+  // max procedures on one tabletnode or one table, 0 means no limit
+  void SetNodeLockLimit(uint32_t num) {
+    node_limit_.store(num);
+    VLOG(20) << "[ProcedureLimiter] set node lock limit:" << num;
   }
 
-  uint32_t GetLockInUse(const LockType& type) const {
-    assert(in_use_.find(type) != in_use_.end());
-    std::lock_guard<std::mutex> guard(mutex_);
-    return in_use_[type];
+  void SetTableLockLimit(uint32_t num) {
+    table_limit_.store(num);
+    VLOG(20) << "[ProcedureLimiter] set table lock limit:" << num;
+  }
+
+  uint32_t GetNodeLockLimit() const { return node_limit_.load(); }
+
+  uint32_t GetTableLockLimit() const { return table_limit_.load(); }
+
+  uint32_t GetNodeLockInUse(const std::string& node) const {
+    return node_partitions_[Partition(node)].InUse(node);
+  }
+
+  uint32_t GetTableLockInUse(const std::string& table) const {
+    return table_partitions_[Partition(table)].InUse(table);
   }
 
   std::string GetSummary() const {
@@ -108,36 +158,78 @@ class ProcedureLimiter final {
            << "]\n[kLoad, limit:" << GetLockLimit(LockType::kLoad)
            << ", in_use:" << GetLockInUse(LockType::kLoad)
            << "]\n[kUnload, limit:" << GetLockLimit(LockType::kUnload)
-           << ", in_use:" << GetLockInUse(LockType::kUnload) << "]";
+           << ", in_use:" << GetLockInUse(LockType::kUnload)
+           << "]\n[kNode, limit:" << GetNodeLockLimit()
+           << "]\n[kTable, limit:" << GetTableLockLimit() << "]";
     return res_ss.str();
   }
 
  private:
-  struct LockTypeHash {
-    template <typename T>
-    std::size_t operator()(const T& t) const {
-      return static_cast<std::size_t>(t);
+  static const size_t kLockTypeNum = 6;
+  static const size_t kPartitionNum = 16;
+
+  class LockPartition final {
+   public:
+    bool Acquire(const std::string& key, uint32_t limit) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      uint32_t& in_use = in_use_[key];
+      if (limit > 0 && in_use >= limit) {
+        return false;
+      }
+      ++in_use;
+      return true;
     }
+
+    void Release(const std::string& key) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      auto it = in_use_.find(key);
+      assert(it != in_use_.end() && it->second > 0);
+      if (it != in_use_.end() && --it->second == 0) {
+        in_use_.erase(it);
+      }
+    }
+
+    uint32_t InUse(const std::string& key) const {
+      std::lock_guard<std::mutex> guard(mutex_);
+      auto it = in_use_.find(key);
+      return it == in_use_.end() ? 0 : it->second;
+    }
+
+   private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, uint32_t> in_use_;
   };
-  mutable std::unordered_map<LockType, uint32_t, LockTypeHash> limit_;
-  mutable std::unordered_map<LockType, uint32_t, LockTypeHash> in_use_;
-  mutable std::mutex mutex_;
+
+  static size_t Index(const LockType& type) {
+    size_t index = static_cast<std::underlying_type<LockType>::type>(type);
+    assert(index < kLockTypeNum);
+    return index;
+  }
+
+  static size_t Partition(const std::string& key) {
+    return std::hash<std::string>()(key) % kPartitionNum;
+  }
+
+  std::atomic<uint32_t> limit_[kLockTypeNum];
+  std::atomic<uint32_t> in_use_[kLockTypeNum];
+  std::atomic<uint32_t> node_limit_;
+  std::atomic<uint32_t> table_limit_;
+  LockPartition node_partitions_[kPartitionNum];
+  LockPartition table_partitions_[kPartitionNum];
 
  private:
-  ProcedureLimiter() {
+  ProcedureLimiter() : node_limit_(0), table_limit_(0) {
+    for (size_t i = 0; i < kLockTypeNum; ++i) {
+      limit_[i].store(0);
+      in_use_[i].store(0);
+    }
     SetLockLimit(LockType::kMerge, static_cast<uint32_t>(FLAGS_master_merge_procedure_limit));
     SetLockLimit(LockType::kSplit, static_cast<uint32_t>(FLAGS_master_split_procedure_limit));
     SetLockLimit(LockType::kMove, static_cast<uint32_t>(FLAGS_master_move_procedure_limit));
     SetLockLimit(LockType::kLoad, static_cast<uint32_t>(FLAGS_master_load_procedure_limit));
     SetLockLimit(LockType::kUnload, static_cast<uint32_t>(FLAGS_master_unload_procedure_limit));
-    {
-      std::lock_guard<std::mutex> guard(mutex_);
-      in_use_[LockType::kMerge] = 0;
-      in_use_[LockType::kSplit] = 0;
-      in_use_[LockType::kMove] = 0;
-      in_use_[LockType::kLoad] = 0;
-      in_use_[LockType::kUnload] = 0;
-    }
+    SetNodeLockLimit(static_cast<uint32_t>(FLAGS_master_node_procedure_limit));
+    SetTableLockLimit(static_cast<uint32_t>(FLAGS_master_table_procedure_limit));
   }
 
   ~ProcedureLimiter() = default;
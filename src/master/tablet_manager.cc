@@ -326,6 +326,13 @@ void Tablet::SetCounter(const TabletCounter& counter) {
   average_counter_.set_write_workload(counter.write_workload());
   average_counter_.set_is_on_busy(counter.is_on_busy());
   average_counter_.set_db_status(counter.db_status());
+  average_counter_.set_access_qps(
+      CounterWeightedSum(counter.access_qps(), average_counter_.access_qps()));
+  if (counter.has_load_median_key()) {
+    average_counter_.set_load_median_key(counter.load_median_key());
+  } else {
+    average_counter_.clear_load_median_key();
+  }
 }
 
 void Tablet::UpdateSize(const TabletMeta& meta) {
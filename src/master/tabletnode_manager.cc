@@ -4,9 +4,12 @@
 
 #include "master/tabletnode_manager.h"
 
+#include <algorithm>
+
 #include "master/master_impl.h"
 #include "master/workload_scheduler.h"
 #include "common/timer.h"
+#include "io/utils_leveldb.h"
 
 DECLARE_string(tera_master_meta_table_name);
 DECLARE_int32(tera_master_max_load_concurrency);
@@ -16,6 +19,8 @@ DECLARE_bool(tera_master_meta_isolate_enabled);
 DECLARE_int32(tera_master_tabletnode_timeout);
 DECLARE_int32(tera_master_max_unload_concurrency);
 DECLARE_bool(tera_master_support_isomerism);
+DECLARE_bool(tera_master_cache_aware_placement_enabled);
+DECLARE_double(tera_master_cache_aware_placement_ratio);
 
 namespace tera {
 namespace master {
@@ -48,7 +53,9 @@ TabletNode::TabletNode()
       onload_count_(0),
       unloading_count_(0),
       onsplit_count_(0),
-      plan_move_in_count_(0) {
+      plan_move_in_count_(0),
+      acked_meta_version_(0),
+      delta_query_count_(0) {
   info_.set_addr("");
   info_.set_status_m(NodeStateToString(state_));
   info_.set_timestamp(get_micros());
@@ -70,7 +77,9 @@ TabletNode::TabletNode(const std::string& addr, const std::string& uuid)
       onload_count_(0),
       unloading_count_(0),
       onsplit_count_(0),
-      plan_move_in_count_(0) {
+      plan_move_in_count_(0),
+      acked_meta_version_(0),
+      delta_query_count_(0) {
   info_.set_addr(addr);
   info_.set_status_m(NodeStateToString(state_));
   info_.set_timestamp(get_micros());
@@ -102,6 +111,8 @@ TabletNode::TabletNode(const TabletNode& t) {
   onsplit_count_ = t.onsplit_count_;
   plan_move_in_count_ = t.plan_move_in_count_;
   recent_load_time_list_ = t.recent_load_time_list_;
+  acked_meta_version_ = 0;
+  delta_query_count_ = 0;
 }
 
 TabletNode::~TabletNode() {}
@@ -166,6 +177,11 @@ uint64_t TabletNode::GetPersistentCacheSize() {
   return persistent_cache_size_;
 }
 
+bool TabletNode::MayCacheTablet(const std::string& tablet_path) {
+  MutexLock lock(&mutex_);
+  return io::PersistentCacheSketchMayContain(info_.persistent_cache_sketch(), tablet_path);
+}
+
 uint32_t TabletNode::GetPlanToMoveInCount() {
   MutexLock lock(&mutex_);
   VLOG(16) << "GetPlanToMoveInCount: " << addr_ << " " << plan_move_in_count_;
@@ -220,6 +236,19 @@ void TabletNode::UpdateSize(TabletPtr tablet) {
   }
 }
 
+void TabletNode::UpdateSize(const std::string& table_name, int64_t size_delta,
+                            int64_t qps_delta) {
+  MutexLock lock(&mutex_);
+  // a full query will correct the sum if it ever drifts below zero
+  auto add = [](uint64_t* value, int64_t delta) {
+    *value = (delta < 0 && *value < static_cast<uint64_t>(-delta)) ? 0 : *value + delta;
+  };
+  add(&data_size_, size_delta);
+  add(&table_size_[table_name], size_delta);
+  add(&qps_, qps_delta);
+  add(&table_qps_[table_name], qps_delta);
+}
+
 bool TabletNode::TryLoad(TabletPtr tablet) {
   MutexLock lock(&mutex_);
   if (onload_count_ < static_cast<uint32_t>(FLAGS_tera_master_max_load_concurrency)) {
@@ -320,6 +349,27 @@ void TabletNode::ResetQueryFailCount() {
   query_fail_count_ = 0;
 }
 
+uint64_t TabletNode::GetAckedMetaVersion(int32_t full_sync_period) {
+  MutexLock lock(&mutex_);
+  if (++delta_query_count_ >= static_cast<uint32_t>(std::max(full_sync_period, 1))) {
+    delta_query_count_ = 0;
+    return 0;
+  }
+  return acked_meta_version_;
+}
+
+bool TabletNode::AckQueryMeta(uint64_t base_version, uint64_t new_version, bool is_delta) {
+  MutexLock lock(&mutex_);
+  if (is_delta && (base_version == 0 || base_version != acked_meta_version_)) {
+    LOG(WARNING) << "[query] delta meta base on version " << base_version << ", but acked "
+                 << acked_meta_version_ << ", ask full list of " << addr_;
+    acked_meta_version_ = 0;
+    return false;
+  }
+  acked_meta_version_ = new_version;
+  return true;
+}
+
 TabletNodeManager::TabletNodeManager(MasterImpl* master_impl)
     : tabletnode_added_(&mutex_), master_impl_(master_impl) {}
 
@@ -368,7 +418,8 @@ TabletNodePtr TabletNodeManager::DelTabletNode(const std::string& addr) {
   return state;
 }
 
-void TabletNodeManager::UpdateTabletNode(const std::string& addr, const TabletNode& state) {
+void TabletNodeManager::UpdateTabletNode(const std::string& addr, const TabletNode& state,
+                                         bool update_size) {
   MutexLock lock(&mutex_);
   TabletNodeList::iterator it = tabletnode_list_.find(addr);
   if (it == tabletnode_list_.end()) {
@@ -378,15 +429,17 @@ void TabletNodeManager::UpdateTabletNode(const std::string& addr, const TabletNo
   TabletNode* node = it->second.get();
   MutexLock node_lock(&node->mutex_);
   node->report_status_ = state.report_status_;
-  node->data_size_ = state.data_size_;
-  node->qps_ = state.qps_;
+  if (update_size) {
+    node->data_size_ = state.data_size_;
+    node->qps_ = state.qps_;
+    node->table_size_ = state.table_size_;
+    node->table_qps_ = state.table_qps_;
+  }
   node->info_ = state.info_;
   node->info_.set_addr(addr);
   node->load_ = state.load_;
   node->persistent_cache_size_ = state.persistent_cache_size_;
   node->update_time_ = state.update_time_;
-  node->table_size_ = state.table_size_;
-  node->table_qps_ = state.table_qps_;
 
   node->info_.set_status_m(NodeStateToString(node->state_));
   node->info_.set_tablet_onload(node->onload_count_);
@@ -558,11 +611,54 @@ bool TabletNodeManager::ScheduleTabletNode(Scheduler* scheduler, const std::stri
   }
 
   size_t best_index = 0;
-  if (scheduler->FindBestNode(candidates, table_name, &best_index)) {
-    *node = candidates[best_index];
-    return true;
+  if (!scheduler->FindBestNode(candidates, table_name, &best_index)) {
+    return false;
   }
-  return false;
+  *node = candidates[best_index];
+  if (tablet && FLAGS_tera_master_cache_aware_placement_enabled) {
+    FindCacheWarmNode(scheduler, table_name, tablet, candidates, node);
+  }
+  return true;
+}
+
+void TabletNodeManager::FindCacheWarmNode(Scheduler* scheduler, const std::string& table_name,
+                                          const TabletPtr& tablet,
+                                          const std::vector<TabletNodePtr>& candidates,
+                                          TabletNodePtr* node) {
+  // a tablet loaded on a node without its files in persistent cache reads
+  // from dfs until the cache is filled again
+  std::vector<TabletNodePtr> warm_candidates;
+  for (const auto& candidate : candidates) {
+    if (candidate->MayCacheTablet(tablet->GetPath())) {
+      warm_candidates.push_back(candidate);
+    }
+  }
+  if (warm_candidates.empty()) {
+    return;
+  }
+  for (const auto& candidate : warm_candidates) {
+    if (candidate == *node) {
+      return;
+    }
+  }
+  size_t warm_index = 0;
+  if (!scheduler->FindBestNode(warm_candidates, table_name, &warm_index)) {
+    return;
+  }
+  TabletNodePtr warm_node = warm_candidates[warm_index];
+  const double ratio = FLAGS_tera_master_cache_aware_placement_ratio;
+  TabletNodePtr best_node = *node;
+  uint64_t best_pending = best_node->GetReadPending() + best_node->GetWritePending();
+  uint64_t warm_pending = warm_node->GetReadPending() + warm_node->GetWritePending();
+  if (warm_node->GetSize(table_name) > best_node->GetSize(table_name) * ratio ||
+      warm_pending > best_pending * ratio) {
+    VLOG(6) << "[cache-aware] skip cache warm node " << warm_node->GetAddr() << " for "
+            << tablet->GetPath() << ", best node: " << best_node->GetAddr();
+    return;
+  }
+  VLOG(6) << "[cache-aware] place " << tablet->GetPath() << " on cache warm node "
+          << warm_node->GetAddr() << " instead of " << best_node->GetAddr();
+  *node = warm_node;
 }
 
 bool TabletNodeManager::ShouldMoveData(Scheduler* scheduler, const std::string& table_name,
@@ -89,6 +89,10 @@ struct TabletNode {
   // Keep FLAGS_tera_master_max_load_concurrency items at maximum.
   std::list<int64_t> recent_load_time_list_;
 
+  // Tablet meta version acked by delta query, not copied with the node.
+  uint64_t acked_meta_version_;
+  uint32_t delta_query_count_;
+
   TabletNode();
   TabletNode(const std::string& addr, const std::string& uuid);
   TabletNode(const TabletNode& t);
@@ -106,6 +110,9 @@ struct TabletNode {
   uint64_t GetScanPending();
   uint64_t GetRowReadDelay();
   uint64_t GetPersistentCacheSize();
+  // whether sst files of the tablet may be in persistent cache of this node,
+  // by the sketch reported in query
+  bool MayCacheTablet(const std::string& tablet_path);
 
   uint32_t GetPlanToMoveInCount();
   void PlanToMoveIn();
@@ -115,6 +122,8 @@ struct TabletNode {
   bool MayLoadNow();
 
   void UpdateSize(TabletPtr tablet);
+  // apply size and qps changes of a tablet reported by delta query
+  void UpdateSize(const std::string& table_name, int64_t size_delta, int64_t qps_delta);
 
   bool TryLoad(TabletPtr tablet);
   void BeginLoad();
@@ -144,6 +153,13 @@ struct TabletNode {
   uint32_t IncQueryFailCount();
   void ResetQueryFailCount();
 
+  // Return the meta version to ack in next query, 0 asks for a full list.
+  // A full list is asked every |full_sync_period| rounds for safety.
+  uint64_t GetAckedMetaVersion(int32_t full_sync_period);
+  // Ack a query result based on |base_version|. Return false and ask for a
+  // full list next time if a delta does not base on the acked version.
+  bool AckQueryMeta(uint64_t base_version, uint64_t new_version, bool is_delta);
+
   typedef StateTransitionRules<NodeState, NodeEvent> TSStateTransitionRulesType;
 
  private:
@@ -168,7 +184,8 @@ class TabletNodeManager {
 
   // return the deleted tabletnode, if not exists return TabletNodePtr(nullptr)
   TabletNodePtr DelTabletNode(const std::string& addr);
-  void UpdateTabletNode(const std::string& addr, const TabletNode& info);
+  // size and qps of |info| are ignored if not |update_size|
+  void UpdateTabletNode(const std::string& addr, const TabletNode& info, bool update_size = true);
   TabletNodePtr FindTabletNode(const std::string& addr, TabletNodePtr* info);
   void GetAllTabletNodeAddr(std::vector<std::string>* addr_array);
   void GetAllTabletNodeId(std::map<std::string, std::string>* id_map);
@@ -194,6 +211,11 @@ class TabletNodeManager {
 
   bool ScheduleTabletNode(Scheduler* scheduler, const std::string& table_name,
                           const TabletPtr& tablet, bool is_move, bool wait, TabletNodePtr* node);
+  // replaces |node| picked by scheduler with a candidate which may hold the
+  // tablet in persistent cache, if the candidate is not much busier
+  void FindCacheWarmNode(Scheduler* scheduler, const std::string& table_name,
+                         const TabletPtr& tablet, const std::vector<TabletNodePtr>& candidates,
+                         TabletNodePtr* node);
 
   mutable Mutex mutex_;
   CondVar tabletnode_added_;
@@ -296,26 +296,26 @@ TEST_F(LoadTabletProcedureTest, EOFPhaseHandler) {
   tablet_->LockTransition();
   load_proc_->EOFHandler(TabletEvent::kEofEvent);
   EXPECT_FALSE(tablet_->InTransition());
-  EXPECT_EQ(proc_executor->procedures_.size(), 0);
+  EXPECT_EQ(proc_executor->ProcedureNum(), 0);
 
   tablet_->load_fail_cnt_ = FLAGS_tablet_load_max_tried_ts + 1;
   tablet_->LockTransition();
   load_proc_->EOFHandler(TabletEvent::kEofEvent);
   EXPECT_FALSE(tablet_->InTransition());
-  EXPECT_EQ(proc_executor->procedures_.size(), 0);
+  EXPECT_EQ(proc_executor->ProcedureNum(), 0);
 
   tablet_->load_fail_cnt_ = FLAGS_tablet_load_max_tried_ts - 1;
   tablet_->LockTransition();
   tablet_->SetStatus(TabletMeta::kTabletReady);
   load_proc_->EOFHandler(TabletEvent::kEofEvent);
-  EXPECT_EQ(proc_executor->procedures_.size(), 0);
+  EXPECT_EQ(proc_executor->ProcedureNum(), 0);
   EXPECT_FALSE(tablet_->InTransition());
 
   proc_executor->Start();
   tablet_->SetStatus(TabletMeta::kTabletLoadFail);
   tablet_->LockTransition();
   load_proc_->EOFHandler(TabletEvent::kEofEvent);
-  EXPECT_EQ(proc_executor->procedures_.size(), 1);
+  EXPECT_EQ(proc_executor->ProcedureNum(), 1);
   EXPECT_TRUE(tablet_->InTransition());
   proc_executor->Stop();
 }
@@ -162,9 +162,9 @@ TEST_F(MergeTabletProcedureTest, UnloadTabletsPhase) {
   EXPECT_TRUE(merge_proc_->unload_procs_[1]);
   EXPECT_FALSE(merge_proc_->unload_procs_[0]->Done());
   EXPECT_FALSE(merge_proc_->unload_procs_[1]->Done());
-  EXPECT_EQ(proc_executor_->procedures_.size(), 2);
-  EXPECT_EQ(proc_executor_->procedures_[1]->proc_, merge_proc_->unload_procs_[0]);
-  EXPECT_EQ(proc_executor_->procedures_[2]->proc_, merge_proc_->unload_procs_[1]);
+  EXPECT_EQ(proc_executor_->ProcedureNum(), 2);
+  EXPECT_EQ(proc_executor_->GetProcedure(1), merge_proc_->unload_procs_[0]);
+  EXPECT_EQ(proc_executor_->GetProcedure(2), merge_proc_->unload_procs_[1]);
   std::shared_ptr<UnloadTabletProcedure> unload_proc_0 =
       std::dynamic_pointer_cast<UnloadTabletProcedure>(merge_proc_->unload_procs_[0]);
   std::shared_ptr<UnloadTabletProcedure> unload_proc_1 =
@@ -196,12 +196,12 @@ TEST_F(MergeTabletProcedureTest, LoadMergedTabletPhase) {
 
   merge_proc_->LoadMergedTabletPhaseHandler(MergeTabletPhase::kLoadMergedTablet);
   EXPECT_TRUE(merge_proc_->load_proc_);
-  EXPECT_EQ(merge_proc_->load_proc_, proc_executor_->procedures_[1]->proc_);
+  EXPECT_EQ(merge_proc_->load_proc_, proc_executor_->GetProcedure(1));
   std::shared_ptr<LoadTabletProcedure> load_proc =
       std::dynamic_pointer_cast<LoadTabletProcedure>(merge_proc_->load_proc_);
   EXPECT_FALSE(merge_proc_->load_proc_->Done());
-  EXPECT_EQ(merge_proc_->load_proc_, proc_executor_->procedures_[1]->proc_);
-  EXPECT_EQ(proc_executor_->procedures_.size(), 1);
+  EXPECT_EQ(merge_proc_->load_proc_, proc_executor_->GetProcedure(1));
+  EXPECT_EQ(proc_executor_->ProcedureNum(), 1);
   load_proc->done_ = true;
   merge_proc_->LoadMergedTabletPhaseHandler(MergeTabletPhase::kLoadMergedTablet);
   EXPECT_EQ(merge_proc_->phases_.back(), MergeTabletPhase::kEofPhase);
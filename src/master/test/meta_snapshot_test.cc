@@ -0,0 +1,126 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "master/meta_snapshot.h"
+
+#include <stdio.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+
+namespace tera {
+namespace master {
+namespace test {
+
+TEST(MetaSnapshotTest, JournalKey) {
+  uint64_t seq = 0;
+  ASSERT_TRUE(MetaJournal::ParseKey(MetaJournal::Key(0x1234), &seq));
+  ASSERT_EQ(seq, 0x1234U);
+  ASSERT_LT(MetaJournal::Key(9), MetaJournal::Key(10));
+  ASSERT_LT(MetaJournal::Key(0xff), MetaJournal::Key(0x100));
+  ASSERT_FALSE(MetaJournal::ParseKey(MetaJournal::kFloorKey, &seq));
+  ASSERT_FALSE(MetaJournal::ParseKey("@table", &seq));
+
+  // journal rows sort before all other meta rows
+  ASSERT_LE(MetaJournal::RangeStart(), MetaJournal::Key(1));
+  ASSERT_LT(MetaJournal::Key(~0ULL), MetaJournal::RangeEnd());
+  ASSERT_LT(std::string(MetaJournal::kFloorKey), MetaJournal::RangeEnd());
+  ASSERT_LT(MetaJournal::RangeEnd(), "@table");
+
+  uint64_t snapshot_id = 0;
+  ASSERT_TRUE(MetaJournal::DecodeFloor(MetaJournal::EncodeFloor(7, 99), &seq, &snapshot_id));
+  ASSERT_EQ(seq, 7U);
+  ASSERT_EQ(snapshot_id, 99U);
+}
+
+TEST(MetaSnapshotTest, EncodeDecodeJournal) {
+  std::vector<MetaWriteRecord> records;
+  records.emplace_back("@table", std::string("v\0v", 3), false);
+  records.emplace_back("table#a", "", true);
+  std::string value;
+  MetaJournal::Encode(records, &value);
+
+  std::vector<MetaWriteRecord> decoded;
+  ASSERT_TRUE(MetaJournal::Decode(value, &decoded));
+  ASSERT_EQ(decoded.size(), 2U);
+  ASSERT_EQ(decoded[0].key, "@table");
+  ASSERT_EQ(decoded[0].value, std::string("v\0v", 3));
+  ASSERT_FALSE(decoded[0].is_delete);
+  ASSERT_EQ(decoded[1].key, "table#a");
+  ASSERT_TRUE(decoded[1].is_delete);
+
+  decoded.clear();
+  ASSERT_FALSE(MetaJournal::Decode(value.substr(0, value.size() - 1), &decoded));
+}
+
+TEST(MetaSnapshotTest, Replay) {
+  std::vector<MetaRecord> snapshot;
+  snapshot.emplace_back("a", "1");
+  snapshot.emplace_back("c", "3");
+  snapshot.emplace_back("e", "5");
+
+  std::vector<MetaWriteRecord> journal;
+  journal.emplace_back("c", "", true);
+  journal.emplace_back("b", "2", false);
+  journal.emplace_back("e", "55", false);
+  journal.emplace_back("f", "6", false);
+  journal.emplace_back("f", "", true);
+  journal.emplace_back("c", "33", false);
+  MetaJournal::Replay(journal, &snapshot);
+
+  std::vector<MetaRecord> expected;
+  expected.emplace_back("a", "1");
+  expected.emplace_back("b", "2");
+  expected.emplace_back("c", "33");
+  expected.emplace_back("e", "55");
+  ASSERT_EQ(snapshot, expected);
+
+  // replaying the same journals again changes nothing
+  MetaJournal::Replay(journal, &snapshot);
+  ASSERT_EQ(snapshot, expected);
+}
+
+TEST(MetaSnapshotTest, WriteReadSnapshot) {
+  const std::string filename = "./meta_snapshot_test.snapshot";
+  std::vector<MetaRecord> records;
+  for (int i = 0; i < 1000; ++i) {
+    records.emplace_back("table#" + std::to_string(i), std::string(i % 7, 'v'));
+  }
+  leveldb::Env* env = leveldb::Env::Default();
+  ASSERT_TRUE(WriteMetaSnapshot(env, filename, 42, 4242, records));
+
+  uint64_t seq = 0, snapshot_id = 0;
+  std::vector<MetaRecord> read_records;
+  ASSERT_TRUE(ReadMetaSnapshot(env, filename, &seq, &snapshot_id, &read_records));
+  ASSERT_EQ(seq, 42U);
+  ASSERT_EQ(snapshot_id, 4242U);
+  ASSERT_EQ(read_records, records);
+
+  // flip one byte of the records
+  {
+    std::fstream fs(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    fs.seekp(100);
+    fs.put('x');
+  }
+  ASSERT_FALSE(ReadMetaSnapshot(env, filename, &seq, &snapshot_id, &read_records));
+
+  // flip one byte of the seq in header
+  ASSERT_TRUE(WriteMetaSnapshot(env, filename, 42, 4242, records));
+  {
+    std::fstream fs(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    fs.seekp(6);
+    fs.put('x');
+  }
+  ASSERT_FALSE(ReadMetaSnapshot(env, filename, &seq, &snapshot_id, &read_records));
+  remove(filename.c_str());
+  ASSERT_FALSE(ReadMetaSnapshot(env, filename, &seq, &snapshot_id, &read_records));
+}
+
+}  // namespace test
+}  // namespace master
+}  // namespace tera
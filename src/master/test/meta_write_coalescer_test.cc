@@ -0,0 +1,128 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "master/meta_write_coalescer.h"
+
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+
+namespace tera {
+namespace master {
+namespace test {
+
+class MetaWriteCoalescerTest : public ::testing::Test {
+ public:
+  MetaWriteCoalescerTest()
+      : coalescer_(std::bind(&MetaWriteCoalescerTest::Commit, this, std::placeholders::_1,
+                             std::placeholders::_2),
+                   4) {}
+  virtual ~MetaWriteCoalescerTest() {}
+
+  // commits are finished by FinishCommit() to simulate rpc latency
+  void Commit(const std::vector<MetaWriteRecord>& records, MetaWriteCoalescer::CommitDone done) {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < records.size(); ++i) {
+      keys.push_back(records[i].key);
+    }
+    batches_.push_back(keys);
+    commit_done_.push_back(done);
+  }
+
+  void FinishCommit(bool succ) {
+    ASSERT_FALSE(commit_done_.empty());
+    MetaWriteCoalescer::CommitDone done = commit_done_.front();
+    commit_done_.erase(commit_done_.begin());
+    done(succ);
+  }
+
+  void Write(const std::string& key, const std::string& value, int* done_count, bool* succ) {
+    std::vector<MetaWriteRecord> records;
+    records.emplace_back(key, value, false);
+    coalescer_.Write(records, [done_count, succ](bool ok) {
+      ++*done_count;
+      *succ = ok;
+    });
+  }
+
+ protected:
+  MetaWriteCoalescer coalescer_;
+  std::vector<std::vector<std::string>> batches_;
+  std::vector<MetaWriteCoalescer::CommitDone> commit_done_;
+};
+
+TEST_F(MetaWriteCoalescerTest, CoalesceWritesDuringCommit) {
+  int done_count = 0;
+  bool succ = false;
+  // the first write is committed at once
+  Write("t1", "v1", &done_count, &succ);
+  ASSERT_EQ(batches_.size(), 1);
+  // writes during commit are queued, including a second update of t1
+  Write("t2", "v1", &done_count, &succ);
+  Write("t1", "v2", &done_count, &succ);
+  Write("t3", "v1", &done_count, &succ);
+  ASSERT_EQ(batches_.size(), 1);
+  ASSERT_EQ(done_count, 0);
+
+  FinishCommit(true);
+  ASSERT_EQ(done_count, 1);
+  ASSERT_TRUE(succ);
+  // queued writes go out in one batch in arrival order
+  ASSERT_EQ(batches_.size(), 2);
+  ASSERT_EQ(batches_[1], std::vector<std::string>({"t2", "t1", "t3"}));
+
+  FinishCommit(true);
+  ASSERT_EQ(done_count, 4);
+  ASSERT_TRUE(succ);
+  ASSERT_TRUE(commit_done_.empty());
+}
+
+TEST_F(MetaWriteCoalescerTest, MaxBatchRecords) {
+  int done_count = 0;
+  bool succ = false;
+  Write("t0", "v", &done_count, &succ);
+  for (int i = 1; i <= 6; ++i) {
+    Write("t" + std::to_string(i), "v", &done_count, &succ);
+  }
+  FinishCommit(true);
+  ASSERT_EQ(batches_.size(), 2);
+  ASSERT_EQ(batches_[1].size(), 4);
+  FinishCommit(true);
+  ASSERT_EQ(batches_.size(), 3);
+  ASSERT_EQ(batches_[2], std::vector<std::string>({"t5", "t6"}));
+  FinishCommit(true);
+  ASSERT_EQ(done_count, 7);
+
+  // a write larger than the batch limit is never split
+  std::vector<MetaWriteRecord> records;
+  for (int i = 0; i < 6; ++i) {
+    records.emplace_back("big" + std::to_string(i), "v", false);
+  }
+  coalescer_.Write(records, [&done_count](bool) { ++done_count; });
+  ASSERT_EQ(batches_.size(), 4);
+  ASSERT_EQ(batches_[3].size(), 6);
+  FinishCommit(true);
+  ASSERT_EQ(done_count, 8);
+}
+
+TEST_F(MetaWriteCoalescerTest, CommitFail) {
+  int done_count = 0;
+  bool succ = true;
+  Write("t1", "v", &done_count, &succ);
+  Write("t2", "v", &done_count, &succ);
+  FinishCommit(false);
+  ASSERT_EQ(done_count, 1);
+  ASSERT_FALSE(succ);
+  // the next batch still goes out
+  ASSERT_EQ(batches_.size(), 2);
+  FinishCommit(true);
+  ASSERT_EQ(done_count, 2);
+  ASSERT_TRUE(succ);
+}
+
+}  // namespace test
+}  // namespace master
+}  // namespace tera
@@ -10,6 +10,8 @@
 #include "master/master_env.h"
 #include "master/master_zk_adapter.h"
 
+DECLARE_int32(tera_master_tabletnode_timeout);
+
 namespace tera {
 namespace master {
 namespace test {
@@ -111,14 +113,14 @@ TEST_F(MoveTabletProcedureTest, UnLoadTabletPhaseHandler) {
   std::shared_ptr<UnloadTabletProcedure> unload_proc =
       std::dynamic_pointer_cast<UnloadTabletProcedure>(move_proc_->unload_proc_);
   EXPECT_FALSE(move_proc_->unload_proc_->Done());
-  EXPECT_EQ(proc_executor_->procedures_.size(), 1);
-  EXPECT_EQ(proc_executor_->procedures_[1]->proc_, move_proc_->unload_proc_);
+  EXPECT_EQ(proc_executor_->ProcedureNum(), 1);
+  EXPECT_EQ(proc_executor_->GetProcedure(1), move_proc_->unload_proc_);
 
   move_proc_->UnloadTabletPhaseHandler(MoveTabletPhase::kUnLoadTablet);
   EXPECT_FALSE(move_proc_->unload_proc_->Done());
   EXPECT_EQ(move_proc_->phases_.back(), MoveTabletPhase::kUnLoadTablet);
-  EXPECT_EQ(proc_executor_->procedures_.size(), 1);
-  EXPECT_EQ(proc_executor_->procedures_[1]->proc_, move_proc_->unload_proc_);
+  EXPECT_EQ(proc_executor_->ProcedureNum(), 1);
+  EXPECT_EQ(proc_executor_->GetProcedure(1), move_proc_->unload_proc_);
 
   unload_proc->done_ = true;
   move_proc_->UnloadTabletPhaseHandler(MoveTabletPhase::kUnLoadTablet);
@@ -142,13 +144,13 @@ TEST_F(MoveTabletProcedureTest, LoadTabletPhaseHandler) {
   std::shared_ptr<LoadTabletProcedure> load_proc =
       std::dynamic_pointer_cast<LoadTabletProcedure>(move_proc_->load_proc_);
   EXPECT_FALSE(move_proc_->load_proc_->Done());
-  EXPECT_EQ(proc_executor_->procedures_.size(), 1);
-  EXPECT_EQ(proc_executor_->procedures_[1]->proc_, move_proc_->load_proc_);
+  EXPECT_EQ(proc_executor_->ProcedureNum(), 1);
+  EXPECT_EQ(proc_executor_->GetProcedure(1), move_proc_->load_proc_);
 
   move_proc_->LoadTabletPhaseHandler(MoveTabletPhase::kLoadTablet);
   EXPECT_FALSE(move_proc_->load_proc_->Done());
-  EXPECT_EQ(proc_executor_->procedures_.size(), 1);
-  EXPECT_EQ(proc_executor_->procedures_[1]->proc_, move_proc_->load_proc_);
+  EXPECT_EQ(proc_executor_->ProcedureNum(), 1);
+  EXPECT_EQ(proc_executor_->GetProcedure(1), move_proc_->load_proc_);
 
   load_proc->done_ = true;
   move_proc_->LoadTabletPhaseHandler(MoveTabletPhase::kLoadTablet);
@@ -164,6 +166,59 @@ TEST_F(MoveTabletProcedureTest, EofPhaseHandler) {
   move_proc_->EOFPhaseHandler(MoveTabletPhase::kEofPhase);
   EXPECT_EQ(dest_node_->plan_move_in_count_, 0);
 }
+
+TEST_F(MoveTabletProcedureTest, RunWithNodeLockLimit) {
+  ProcedureLimiter& limiter = ProcedureLimiter::Instance();
+  uint32_t load_limit = limiter.GetLockLimit(ProcedureLimiter::LockType::kLoad);
+  int32_t tabletnode_timeout = FLAGS_tera_master_tabletnode_timeout;
+  limiter.SetNodeLockLimit(1);
+  limiter.SetLockLimit(ProcedureLimiter::LockType::kLoad, 1);
+
+  // unload on an offline node succeeds at once, and the load waits for the
+  // pending offline node to come back instead of scheduling another one
+  FLAGS_tera_master_tabletnode_timeout = 60000;
+  tablet_->SetStatus(TabletMeta::kTabletReady);
+  tablet_->AssignTabletNode(src_node_);
+  EXPECT_EQ(ts_manager_->DelTabletNode(src_node_->GetAddr()), src_node_);
+  EXPECT_TRUE(src_node_->NodeDown());
+  // move back to the same node, so both sub procedures work on the node
+  move_proc_ = std::shared_ptr<MoveTabletProcedure>(
+      new MoveTabletProcedure(tablet_, src_node_, MasterEnv().GetThreadPool().get()));
+  proc_executor_->running_ = false;
+  EXPECT_TRUE(proc_executor_->Start());
+  EXPECT_GT(proc_executor_->AddProcedure(move_proc_), 0);
+  for (int i = 0;
+       i < 500 && (!move_proc_->Done() || tablet_->GetStatus() != TabletMeta::kTabletDelayOffline);
+       ++i) {
+    usleep(10 * 1000);
+  }
+  // the nested load holds the only node slot
+  EXPECT_EQ(tablet_->GetStatus(), TabletMeta::kTabletDelayOffline);
+  EXPECT_TRUE(move_proc_->Done());
+  ASSERT_TRUE(move_proc_->load_proc_);
+  EXPECT_FALSE(move_proc_->load_proc_->Done());
+  EXPECT_EQ(limiter.GetLockInUse(ProcedureLimiter::LockType::kLoad), 1);
+  EXPECT_EQ(limiter.GetNodeLockInUse(src_node_->GetAddr()), 1);
+  EXPECT_EQ(limiter.GetTableLockInUse("test"), 1);
+
+  // pretend the tabletnode comes back and loads the tablet
+  tablet_->SetStatus(TabletMeta::kTabletReady);
+  for (int i = 0; i < 500 && !move_proc_->load_proc_->Done(); ++i) {
+    usleep(10 * 1000);
+  }
+  EXPECT_TRUE(move_proc_->load_proc_->Done());
+  for (int i = 0; i < 500 && limiter.GetNodeLockInUse(src_node_->GetAddr()) > 0; ++i) {
+    usleep(10 * 1000);
+  }
+  proc_executor_->Stop();
+  EXPECT_EQ(limiter.GetLockInUse(ProcedureLimiter::LockType::kLoad), 0);
+  EXPECT_EQ(limiter.GetNodeLockInUse(src_node_->GetAddr()), 0);
+  EXPECT_EQ(limiter.GetTableLockInUse("test"), 0);
+
+  FLAGS_tera_master_tabletnode_timeout = tabletnode_timeout;
+  limiter.SetNodeLockLimit(0);
+  limiter.SetLockLimit(ProcedureLimiter::LockType::kLoad, load_limit);
+}
 }
 }
 }
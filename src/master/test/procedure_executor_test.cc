@@ -1,7 +1,13 @@
+#include <set>
+
 #include "gflags/gflags.h"
+#include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "common/thread_pool.h"
 #include "master/procedure_executor.h"
 
+DECLARE_int32(procedure_executor_shard_num);
+
 namespace tera {
 namespace master {
 namespace test {
@@ -55,14 +61,14 @@ TEST_F(ProcedureExecutorTest, AddRemoveProcedures) {
   // true
   executor_->running_ = true;
   EXPECT_GE(executor_->AddProcedure(proc), 0);
-  EXPECT_EQ(executor_->procedures_.size(), 1);
+  EXPECT_EQ(executor_->ProcedureNum(), 1);
   // add again, wil return 0
   EXPECT_EQ(executor_->AddProcedure(proc), 0);
-  EXPECT_EQ(executor_->procedures_.size(), 1);
+  EXPECT_EQ(executor_->ProcedureNum(), 1);
   EXPECT_TRUE(executor_->RemoveProcedure(proc->ProcId()));
-  EXPECT_EQ(executor_->procedures_.size(), 0);
+  EXPECT_EQ(executor_->ProcedureNum(), 0);
   EXPECT_FALSE(executor_->RemoveProcedure(proc->ProcId()));
-  EXPECT_EQ(executor_->procedures_.size(), 0);
+  EXPECT_EQ(executor_->ProcedureNum(), 0);
   executor_->running_ = false;
 }
 
@@ -72,10 +78,107 @@ TEST_F(ProcedureExecutorTest, ScheduleProcedures) {
   EXPECT_TRUE(executor_->running_);
   EXPECT_FALSE(proc1->Done());
   executor_->AddProcedure(proc1);
-  EXPECT_EQ(executor_->procedures_.size(), 1);
+  EXPECT_EQ(executor_->ProcedureNum(), 1);
   usleep(50 * 1000);
   EXPECT_TRUE(proc1->Done());
-  EXPECT_TRUE(executor_->procedures_.empty());
+  EXPECT_EQ(executor_->ProcedureNum(), 0);
+}
+
+TEST_F(ProcedureExecutorTest, ShardedProcedures) {
+  std::set<ProcedureExecutor::Shard*> shards;
+  executor_->running_ = true;
+  for (int i = 0; i < 100; ++i) {
+    std::shared_ptr<Procedure> proc(new TestProcedure("TestProcedure" + std::to_string(i)));
+    EXPECT_EQ(executor_->AddProcedure(proc), i + 1);
+    shards.insert(executor_->GetShard(proc->ProcId()));
+    EXPECT_EQ(executor_->GetProcedure(i + 1), proc);
+  }
+  EXPECT_EQ(executor_->ProcedureNum(), 100);
+  EXPECT_EQ(shards.size(), executor_->shards_.size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(executor_->RemoveProcedure("TestProcedure" + std::to_string(i)));
+  }
+  EXPECT_EQ(executor_->ProcedureNum(), 0);
+  executor_->running_ = false;
+}
+
+// answers load requests after |delay_ms|, like a busy tabletnode
+class MockTabletNode {
+ public:
+  MockTabletNode(const std::string& addr, int64_t delay_ms)
+      : addr_(addr), delay_ms_(delay_ms), thread_pool_(2) {}
+
+  void LoadTablet(ThreadPool::Task done) { thread_pool_.DelayTask(delay_ms_, done); }
+
+  const std::string& GetAddr() { return addr_; }
+
+ private:
+  std::string addr_;
+  int64_t delay_ms_;
+  ThreadPool thread_pool_;
+};
+
+// stages like LoadTabletProcedure: dispatch load rpc, then wait response
+class MockLoadTabletProcedure : public Procedure {
+ public:
+  MockLoadTabletProcedure(const std::string& path, MockTabletNode* node)
+      : Procedure(ProcedureLimiter::LockType::kLoad),
+        id_("LoadTablet:" + path),
+        node_(node),
+        dispatched_(false),
+        loaded_(false),
+        done_(false) {}
+  virtual ~MockLoadTabletProcedure() {}
+  std::string ProcId() const { return id_; }
+  void RunNextStage() {
+    if (!dispatched_) {
+      dispatched_ = true;
+      node_->LoadTablet([this](int64_t) { loaded_ = true; });
+    } else if (loaded_) {
+      done_ = true;
+    }
+  }
+  bool Done() { return done_; }
+  std::string GetLockNode() override { return node_->GetAddr(); }
+  std::string GetLockTable() override { return "test"; }
+
+ private:
+  std::string id_;
+  MockTabletNode* node_;
+  bool dispatched_;
+  std::atomic<bool> loaded_;
+  bool done_;
+};
+
+TEST_F(ProcedureExecutorTest, LoadTabletBenchmark) {
+  const int kNodeNum = 50;
+  const int kTabletNum = 5000;
+  std::vector<std::unique_ptr<MockTabletNode>> nodes;
+  for (int i = 0; i < kNodeNum; ++i) {
+    nodes.emplace_back(new MockTabletNode("127.0.0.1:" + std::to_string(2000 + i), 5));
+  }
+  int32_t default_shard_num = FLAGS_procedure_executor_shard_num;
+  for (int32_t shard_num : {1, 4, 8}) {
+    FLAGS_procedure_executor_shard_num = shard_num;
+    std::shared_ptr<ProcedureExecutor> executor(new ProcedureExecutor);
+    executor->Start();
+    int64_t start_us = get_micros();
+    for (int i = 0; i < kTabletNum; ++i) {
+      std::shared_ptr<Procedure> proc(new MockLoadTabletProcedure(
+          "test/tablet" + std::to_string(i), nodes[i % kNodeNum].get()));
+      EXPECT_GT(executor->AddProcedure(proc), 0);
+    }
+    while (executor->ProcedureNum() > 0) {
+      usleep(1000);
+    }
+    int64_t cost_us = get_micros() - start_us;
+    executor->Stop();
+    LOG(INFO) << "[procedure] benchmark " << kTabletNum << " load procedures on " << kNodeNum
+              << " nodes with " << shard_num << " shards cost " << cost_us << "us";
+    EXPECT_EQ(ProcedureLimiter::Instance().GetLockInUse(ProcedureLimiter::LockType::kLoad), 0);
+    EXPECT_EQ(ProcedureLimiter::Instance().GetTableLockInUse("test"), 0);
+  }
+  FLAGS_procedure_executor_shard_num = default_shard_num;
 }
 }
 }
@@ -207,6 +207,40 @@ TEST_F(ProcedureLimiterTest, DecLimitTest) {
   ASSERT_EQ(0, ProcedureLimiter::Instance().GetLockInUse(type));
 }
 
+TEST_F(ProcedureLimiterTest, NodeTableLimitTest) {
+  const ProcedureLimiter::LockType type = ProcedureLimiter::LockType::kLoad;
+  ProcedureLimiter& limiter = ProcedureLimiter::Instance();
+  limiter.SetLockLimit(type, 100);
+  limiter.SetNodeLockLimit(2);
+  limiter.SetTableLockLimit(3);
+
+  ASSERT_TRUE(limiter.GetLock(type, "node1", "table1"));
+  ASSERT_TRUE(limiter.GetLock(type, "node1", "table1"));
+  // node1 is exhausted
+  ASSERT_FALSE(limiter.GetLock(type, "node1", "table2"));
+  ASSERT_EQ(2, limiter.GetNodeLockInUse("node1"));
+  ASSERT_EQ(0, limiter.GetTableLockInUse("table2"));
+  ASSERT_TRUE(limiter.GetLock(type, "node2", "table1"));
+  // table1 is exhausted, node lock got should be rolled back
+  ASSERT_FALSE(limiter.GetLock(type, "node3", "table1"));
+  ASSERT_EQ(0, limiter.GetNodeLockInUse("node3"));
+  ASSERT_EQ(3, limiter.GetLockInUse(type));
+  // kNoLimit is never limited
+  ASSERT_TRUE(limiter.GetLock(ProcedureLimiter::LockType::kNoLimit, "node1", "table1"));
+
+  limiter.ReleaseLock(type, "node1", "table1");
+  ASSERT_TRUE(limiter.GetLock(type, "node3", "table1"));
+  limiter.ReleaseLock(type, "node1", "table1");
+  limiter.ReleaseLock(type, "node2", "table1");
+  limiter.ReleaseLock(type, "node3", "table1");
+  ASSERT_EQ(0, limiter.GetLockInUse(type));
+  ASSERT_EQ(0, limiter.GetNodeLockInUse("node1"));
+  ASSERT_EQ(0, limiter.GetTableLockInUse("table1"));
+
+  limiter.SetNodeLockLimit(0);
+  limiter.SetTableLockLimit(0);
+}
+
 }  // namespace test
 }  // namespace master
 }  // namespace tera
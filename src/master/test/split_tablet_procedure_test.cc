@@ -100,8 +100,8 @@ TEST_F(SplitTabletProcedureTest, UnloadTabletPhaseHandler) {
   std::shared_ptr<UnloadTabletProcedure> unload_proc =
       std::dynamic_pointer_cast<UnloadTabletProcedure>(split_proc_->unload_proc_);
   EXPECT_TRUE(unload_proc->is_sub_proc_);
-  EXPECT_EQ(proc_executor_->procedures_.size(), 1);
-  EXPECT_EQ(proc_executor_->procedures_[1]->proc_, split_proc_->unload_proc_);
+  EXPECT_EQ(proc_executor_->ProcedureNum(), 1);
+  EXPECT_EQ(proc_executor_->GetProcedure(1), split_proc_->unload_proc_);
 
   split_proc_->UnloadTabletPhaseHandler(SplitTabletPhase::kUnLoadTablet);
   EXPECT_FALSE(split_proc_->unload_proc_->Done());
@@ -163,9 +163,9 @@ TEST_F(SplitTabletProcedureTest, LoadTabletsPhaseHandler) {
       std::dynamic_pointer_cast<LoadTabletProcedure>(split_proc_->load_procs_[1]);
   EXPECT_FALSE(split_proc_->load_procs_[0]->Done());
   EXPECT_FALSE(split_proc_->load_procs_[1]->Done());
-  EXPECT_EQ(proc_executor_->procedures_.size(), 2);
-  EXPECT_EQ(proc_executor_->procedures_[1]->proc_, split_proc_->load_procs_[0]);
-  EXPECT_EQ(proc_executor_->procedures_[2]->proc_, split_proc_->load_procs_[1]);
+  EXPECT_EQ(proc_executor_->ProcedureNum(), 2);
+  EXPECT_EQ(proc_executor_->GetProcedure(1), split_proc_->load_procs_[0]);
+  EXPECT_EQ(proc_executor_->GetProcedure(2), split_proc_->load_procs_[1]);
   load_proc1->done_ = true;
   split_proc_->LoadTabletsPhaseHandler(SplitTabletPhase::kLoadTablets);
   load_proc2->done_ = true;
@@ -182,7 +182,7 @@ TEST_F(SplitTabletProcedureTest, FaultRecoverPhaseHandler) {
   EXPECT_FALSE(split_proc_->recover_proc_);
   split_proc_->FaultRecoverPhaseHandler(SplitTabletPhase::kFaultRecover);
   EXPECT_TRUE(split_proc_->recover_proc_);
-  EXPECT_EQ(proc_executor_->procedures_.size(), 1);
+  EXPECT_EQ(proc_executor_->ProcedureNum(), 1);
   EXPECT_FALSE(split_proc_->recover_proc_->Done());
   std::shared_ptr<LoadTabletProcedure> recover_proc =
       std::dynamic_pointer_cast<LoadTabletProcedure>(split_proc_->recover_proc_);
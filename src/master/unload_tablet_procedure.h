@@ -36,6 +36,10 @@ class UnloadTabletProcedure : public Procedure,
     }
   }
 
+  virtual std::string GetLockNode() override { return tablet_->GetServerAddr(); }
+
+  virtual std::string GetLockTable() override { return tablet_->GetTableName(); }
+
  private:
   typedef std::function<void(UnloadTabletProcedure*, const TabletEvent&)> UnloadTabletEventHandler;
 
@@ -8,7 +8,9 @@
 
 #include "common/timer.h"
 #include "common/base/string_number.h"
+#include "observer/executor/scanner_impl.h"
 #include "sdk/global_txn_internal.h"
+#include "sdk/mutate_impl.h"
 #include "types.h"
 
 namespace tera {
@@ -83,6 +85,8 @@ void NotificationImpl::Notify(Table* t, const std::string& row_key,
                               const std::string& column_family, const std::string& qualifier) {
   if (notify_cell_->notify_transaction != NULL) {
     notify_cell_->notify_transaction->Notify(t, row_key, column_family, qualifier);
+    // range is marked dirty in Done(), once the transaction is committed
+    notify_rows_.push_back(std::make_pair(t->GetName(), row_key));
     return;
   }
 
@@ -102,17 +106,33 @@ void NotificationImpl::Notify(Table* t, const std::string& row_key,
     mutation->SetCallBack([](RowMutation* mu) {
       NotificationImpl* notification_impl = (NotificationImpl*)mu->GetContext();
       ErrorCode err = mu->GetError();
+      if (err.GetType() == ErrorCode::kOK) {
+        Table* table = static_cast<RowMutationImpl*>(mu)->GetTable();
+        ScannerImpl::GetInstance()->MarkNotifyDirty(table->GetName(), mu->RowKey());
+      }
       notification_impl->notify_callback_(notification_impl, err);
       delete mu;
     });
   }
   t->ApplyMutation(mutation);
   if (notify_callback_ == nullptr) {
+    if (mutation->GetError().GetType() == ErrorCode::kOK) {
+      ScannerImpl::GetInstance()->MarkNotifyDirty(t->GetName(), row_key);
+    }
     delete mutation;
   }
 }
 
-void NotificationImpl::Done() { delete this; }
+void NotificationImpl::Done() {
+  Transaction* txn = notify_cell_->notify_transaction.get();
+  // commit timestamp is set only when the transaction is committed
+  if (txn != NULL && txn->GetCommitTimestamp() > 0 && txn->GetError().GetType() == ErrorCode::kOK) {
+    for (size_t i = 0; i < notify_rows_.size(); ++i) {
+      ScannerImpl::GetInstance()->MarkNotifyDirty(notify_rows_[i].first, notify_rows_[i].second);
+    }
+  }
+  delete this;
+}
 
 }  // namespace observer
 }  // namespace tera
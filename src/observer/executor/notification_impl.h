@@ -7,6 +7,8 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include "observer/executor/notify_cell.h"
 
 #include "observer/notification.h"
@@ -46,6 +48,8 @@ class NotificationImpl : public Notification {
   Notification::Callback notify_callback_;
   void* ack_context_;
   void* notify_context_;
+  // <table_name, row_key> notified in the transaction, marked dirty after commit
+  std::vector<std::pair<std::string, std::string>> notify_rows_;
 };
 
 }  // namespace observer
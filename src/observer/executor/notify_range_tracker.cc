@@ -0,0 +1,90 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "observer/executor/notify_range_tracker.h"
+
+namespace tera {
+namespace observer {
+
+NotifyRangeTracker::NotifyRangeTracker(int64_t min_backoff_ms, int64_t max_backoff_ms)
+    : min_backoff_ms_(min_backoff_ms > 0 ? min_backoff_ms : 1),
+      max_backoff_ms_(max_backoff_ms),
+      last_sweep_ms_(0) {}
+
+NotifyRangeTracker::~NotifyRangeTracker() {}
+
+int64_t NotifyRangeTracker::ScanDelay(const std::string& table_name, const std::string& start_key,
+                                      const std::string& end_key, int64_t now_ms) {
+  if (max_backoff_ms_ <= 0) {
+    return 0;
+  }
+  MutexLock lock(&mutex_);
+  auto it = ranges_.find(std::make_tuple(table_name, start_key, end_key));
+  if (it == ranges_.end() || it->second.next_scan_ms <= now_ms) {
+    return 0;
+  }
+  return it->second.next_scan_ms - now_ms;
+}
+
+void NotifyRangeTracker::OnScanned(const std::string& table_name, const std::string& start_key,
+                                   const std::string& end_key, int64_t notify_rows,
+                                   int64_t now_ms) {
+  if (max_backoff_ms_ <= 0) {
+    return;
+  }
+  MutexLock lock(&mutex_);
+  RangeKey key = std::make_tuple(table_name, start_key, end_key);
+  if (notify_rows > 0) {
+    ranges_.erase(key);
+  } else {
+    auto it = ranges_.find(key);
+    int64_t backoff_ms = min_backoff_ms_;
+    if (it != ranges_.end()) {
+      backoff_ms = it->second.backoff_ms * 2;
+    }
+    if (backoff_ms > max_backoff_ms_) {
+      backoff_ms = max_backoff_ms_;
+    }
+    RangeState& state = ranges_[key];
+    state.backoff_ms = backoff_ms;
+    state.next_scan_ms = now_ms + backoff_ms;
+  }
+  SweepExpired(now_ms);
+}
+
+void NotifyRangeTracker::MarkDirty(const std::string& table_name, const std::string& row_key) {
+  if (max_backoff_ms_ <= 0) {
+    return;
+  }
+  MutexLock lock(&mutex_);
+  auto it = ranges_.lower_bound(std::make_tuple(table_name, std::string(), std::string()));
+  while (it != ranges_.end() && std::get<0>(it->first) == table_name) {
+    const std::string& start_key = std::get<1>(it->first);
+    const std::string& end_key = std::get<2>(it->first);
+    if (start_key <= row_key && (end_key.empty() || row_key < end_key)) {
+      it = ranges_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void NotifyRangeTracker::SweepExpired(int64_t now_ms) {
+  mutex_.AssertHeld();
+  if (now_ms - last_sweep_ms_ < max_backoff_ms_) {
+    return;
+  }
+  last_sweep_ms_ = now_ms;
+  // ranges left behind by tablet split or merge are never scanned again
+  for (auto it = ranges_.begin(); it != ranges_.end();) {
+    if (it->second.next_scan_ms + max_backoff_ms_ < now_ms) {
+      it = ranges_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace observer
+}  // namespace tera
@@ -0,0 +1,64 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TERA_OBSERVER_EXECUTOR_NOTIFY_RANGE_TRACKER_H_
+#define TERA_OBSERVER_EXECUTOR_NOTIFY_RANGE_TRACKER_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <tuple>
+
+#include "common/mutex.h"
+
+namespace tera {
+namespace observer {
+
+// Tracks which scan ranges of observed tables may hold notify cells.
+//
+// Notify cells live in a dedicated locality group, so a scan of a clean range
+// reads only tombstones and returns nothing. A range whose scan found no
+// notify row is backed off, the delay doubles from |min_backoff_ms| up to
+// |max_backoff_ms| while it keeps coming back empty. Notify writes seen by
+// this process mark the covering ranges dirty, so they are scanned at once;
+// writes from other clients are picked up within |max_backoff_ms|.
+class NotifyRangeTracker {
+ public:
+  NotifyRangeTracker(int64_t min_backoff_ms, int64_t max_backoff_ms);
+  ~NotifyRangeTracker();
+
+  // Milliseconds to wait before range [start_key, end_key) of |table_name|
+  // is worth scanning again, 0 means scan now.
+  int64_t ScanDelay(const std::string& table_name, const std::string& start_key,
+                    const std::string& end_key, int64_t now_ms);
+
+  void OnScanned(const std::string& table_name, const std::string& start_key,
+                 const std::string& end_key, int64_t notify_rows, int64_t now_ms);
+
+  void MarkDirty(const std::string& table_name, const std::string& row_key);
+
+ private:
+  typedef std::tuple<std::string, std::string, std::string> RangeKey;
+  struct RangeState {
+    int64_t backoff_ms;
+    int64_t next_scan_ms;
+  };
+
+  // REQUIRES: mutex_ held
+  void SweepExpired(int64_t now_ms);
+
+ private:
+  const int64_t min_backoff_ms_;
+  const int64_t max_backoff_ms_;
+
+  Mutex mutex_;
+  std::map<RangeKey, RangeState> ranges_;
+  int64_t last_sweep_ms_;
+};
+
+}  // namespace observer
+}  // namespace tera
+
+#endif  // TERA_OBSERVER_EXECUTOR_NOTIFY_RANGE_TRACKER_H_
@@ -33,12 +33,18 @@ DECLARE_string(rowlock_server_port);
 DECLARE_int32(observer_rowlock_client_thread_num);
 DECLARE_int32(observer_random_access_thread_num);
 DECLARE_bool(mock_rowlock_enable);
+DECLARE_int64(observer_empty_scan_min_backoff_ms);
+DECLARE_int64(observer_empty_scan_max_backoff_ms);
 
 using namespace std::placeholders;
 
 namespace tera {
 namespace observer {
 
+// a backed off scanner thread wakes up at least this often to notice dirty
+// ranges and quit
+static const int64_t kMaxIdleSleepMs = 100;
+
 Scanner* Scanner::GetScanner() { return ScannerImpl::GetInstance(); }
 
 ScannerImpl* ScannerImpl::GetInstance() {
@@ -52,6 +58,8 @@ ScannerImpl::ScannerImpl()
       observer_threads_(new common::ThreadPool(FLAGS_observer_proc_thread_num)),
       transaction_callback_threads_(
           new common::ThreadPool(FLAGS_observer_random_access_thread_num)),
+      range_tracker_(new NotifyRangeTracker(FLAGS_observer_empty_scan_min_backoff_ms,
+                                            FLAGS_observer_empty_scan_max_backoff_ms)),
       quit_(false),
       semaphore_(FLAGS_observer_max_pending_limit) {
   VLOG(13) << "FLAGS_observer_proc_thread_num = " << FLAGS_observer_proc_thread_num;
@@ -186,6 +194,10 @@ void ScannerImpl::Exit() { quit_ = true; }
 
 tera::Client* ScannerImpl::GetTeraClient() const { return tera_client_.get(); }
 
+void ScannerImpl::MarkNotifyDirty(const std::string& table_name, const std::string& row_key) {
+  range_tracker_->MarkDirty(table_name, row_key);
+}
+
 void ScannerImpl::ScanTable() {
   std::string start_key;
   std::string end_key;
@@ -201,6 +213,18 @@ void ScannerImpl::ScanTable() {
     // again and again
 
     if (key_selector_->SelectRange(&table_name, &start_key, &end_key)) {
+      // random strategy covers the whole table from a random start key, so
+      // back-off is tracked per table rather than per selected range
+      const bool whole_table = (options_.strategy == ScanStrategy::kRandom);
+      const std::string& track_start = whole_table ? std::string() : start_key;
+      const std::string& track_end = whole_table ? std::string() : end_key;
+      int64_t delay_ms = range_tracker_->ScanDelay(table_name, track_start, track_end, get_millis());
+      if (delay_ms > 0) {
+        VLOG(12) << "skip clean range, table_name=" << table_name << " start_key=[" << start_key
+                 << "] end_key=[" << end_key << "] delay_ms=" << delay_ms;
+        ThisThread::Sleep(delay_ms < kMaxIdleSleepMs ? delay_ms : kMaxIdleSleepMs);
+        continue;
+      }
       LOG(INFO) << "table_name=" << table_name << " start_key=[" << start_key << "] end_key=["
                 << end_key << "]";
       GetObserveColumns(table_name, &observe_columns);
@@ -208,22 +232,27 @@ void ScannerImpl::ScanTable() {
         filter_columns.insert({col.family, col.qualifier});
       }
       table = GetTable(table_name);
+      int64_t notify_rows = 0;
       BeforeScanTable(table_name, filter_columns);
-      bool scan_ret = DoScanTable(table, observe_columns, start_key, end_key);
+      bool scan_ret = DoScanTable(table, observe_columns, start_key, end_key, &notify_rows);
       AfterScanTable(table_name, filter_columns, scan_ret);
       if (scan_ret) {
         if (options_.strategy == ScanStrategy::kRandom) {
           BeforeScanTable(table_name, filter_columns);
-          scan_ret = DoScanTable(table, observe_columns, end_key, start_key);
+          scan_ret = DoScanTable(table, observe_columns, end_key, start_key, &notify_rows);
           AfterScanTable(table_name, filter_columns, scan_ret);
         } else if (options_.strategy == ScanStrategy::kTabletBucket) {
           BeforeScanTable(table_name, filter_columns);
-          scan_ret = DoScanTable(table, observe_columns, start_key, end_key);
+          scan_ret = DoScanTable(table, observe_columns, start_key, end_key, &notify_rows);
           AfterScanTable(table_name, filter_columns, scan_ret);
         } else {
           abort();
         }
       }
+      // a failed scan tells nothing about the range unless it saw a notify
+      if (scan_ret || notify_rows > 0) {
+        range_tracker_->OnScanned(table_name, track_start, track_end, notify_rows, get_millis());
+      }
     }
   }
 }
@@ -242,7 +271,8 @@ void ScannerImpl::AfterScanTable(const std::string& table_name, const ScanHook::
 }
 
 bool ScannerImpl::DoScanTable(tera::Table* table, const std::set<Column>& observe_columns,
-                              const std::string& start_key, const std::string& end_key) {
+                              const std::string& start_key, const std::string& end_key,
+                              int64_t* notify_rows) {
   if (table == nullptr) {
     LOG(ERROR) << "table not opened or closed";
     return false;
@@ -266,30 +296,51 @@ bool ScannerImpl::DoScanTable(tera::Table* table, const std::set<Column>& observ
     return !quit_;
   }
 
+  const size_t batch_size = options_.batch_size > 1 ? options_.batch_size : 1;
   bool finished = false;
-  while (true) {
-    std::string rowkey;
-    std::vector<Column> notify_columns;
-    if (!NextRow(result_stream.get(), table->GetName(), &finished, &rowkey, &notify_columns)) {
-      return finished;
+  bool stream_end = false;
+  while (!stream_end) {
+    std::vector<std::string> rows;
+    std::vector<std::vector<Column>> rows_notify_columns;
+    while (rows.size() < batch_size) {
+      std::string rowkey;
+      std::vector<Column> notify_columns;
+      if (!NextRow(result_stream.get(), table->GetName(), &finished, &rowkey, &notify_columns)) {
+        stream_end = true;
+        break;
+      }
+      rows.push_back(rowkey);
+      rows_notify_columns.push_back(notify_columns);
     }
-
-    if (!TryLockRow(table->GetName(), rowkey)) {
-      // collision
-      LOG(INFO) << "[rowlock failed] table=" << table->GetName() << " row=" << rowkey;
-      return false;
+    if (rows.empty()) {
+      break;
     }
-    VLOG(12) << "[time] read value start. [row] " << rowkey;
+    *notify_rows += rows.size();
+    scan_row_counter_.Add(rows.size());
+    batch_counter_.Inc();
 
-    std::shared_ptr<AutoRowUnlocker> unlocker(new AutoRowUnlocker(table->GetName(), rowkey));
+    std::vector<bool> locked;
+    bool all_locked = TryLockRows(table->GetName(), rows, &locked);
     std::vector<std::shared_ptr<NotifyCell>> notify_cells;
-    PrepareNotifyCell(table, rowkey, observe_columns, notify_columns, unlocker, &notify_cells);
+    for (size_t i = 0; i < rows.size(); ++i) {
+      if (!locked[i]) {
+        LOG(INFO) << "[rowlock failed] table=" << table->GetName() << " row=" << rows[i];
+        lock_fail_counter_.Inc();
+        continue;
+      }
+      VLOG(12) << "[time] read value start. [row] " << rows[i];
+      std::shared_ptr<AutoRowUnlocker> unlocker(new AutoRowUnlocker(table->GetName(), rows[i]));
+      PrepareNotifyCell(table, rows[i], observe_columns, rows_notify_columns[i], unlocker,
+                        &notify_cells);
+    }
+    AsyncReadCells(notify_cells);
 
-    for (uint32_t i = 0; i < notify_cells.size(); ++i) {
-      AsyncReadCell(notify_cells[i]);
+    if (!all_locked) {
+      // collision, other scanners are working on this range
+      return false;
     }
   }
-  return true;
+  return finished;
 }
 void ScannerImpl::PrepareNotifyCell(tera::Table* table, const std::string& rowkey,
                                     const std::set<Column>& observe_columns,
@@ -429,6 +480,30 @@ bool ScannerImpl::ParseNotifyQualifier(const std::string& notify_qualifier,
 }
 
 void ScannerImpl::AsyncReadCell(std::shared_ptr<NotifyCell> notify_cell) {
+  tera::RowReader* value_reader = NewCellReader(notify_cell);
+  if (notify_cell->notify_transaction.get()) {
+    notify_cell->notify_transaction->Get(value_reader);
+  } else {
+    notify_cell->table->Get(value_reader);
+  }
+}
+
+void ScannerImpl::AsyncReadCells(const std::vector<std::shared_ptr<NotifyCell>>& notify_cells) {
+  std::map<tera::Table*, std::vector<RowReader*>> batch_readers;
+  for (size_t i = 0; i < notify_cells.size(); ++i) {
+    if (notify_cells.size() == 1 || notify_cells[i]->notify_transaction.get()) {
+      // transaction reads stay with their own transaction
+      AsyncReadCell(notify_cells[i]);
+    } else {
+      batch_readers[notify_cells[i]->table].push_back(NewCellReader(notify_cells[i]));
+    }
+  }
+  for (auto it = batch_readers.begin(); it != batch_readers.end(); ++it) {
+    it->first->Get(it->second);
+  }
+}
+
+RowReader* ScannerImpl::NewCellReader(std::shared_ptr<NotifyCell> notify_cell) {
   VLOG(12) << "[time] do read value start. [row] " << notify_cell->row << " cf:qu "
            << notify_cell->observed_column.family << ":" << notify_cell->observed_column.qualifier;
   tera::RowReader* value_reader = notify_cell->table->NewRowReader(notify_cell->row);
@@ -453,11 +528,7 @@ void ScannerImpl::AsyncReadCell(std::shared_ptr<NotifyCell> notify_cell) {
       delete value_reader;
     }
   });
-  if (notify_cell->notify_transaction.get()) {
-    notify_cell->notify_transaction->Get(value_reader);
-  } else {
-    notify_cell->table->Get(value_reader);
-  }
+  return value_reader;
 }
 
 void ScannerImpl::GetObserveColumns(const std::string& table_name,
@@ -487,12 +558,20 @@ tera::Table* ScannerImpl::GetTable(const std::string table_name) {
 
 void ScannerImpl::Profiling() {
   while (!quit_) {
+    int64_t scan_rows = scan_row_counter_.Get();
+    int64_t batches = batch_counter_.Get();
     LOG(INFO) << "[Observer Profiling Info]  total: " << total_counter_.Get()
               << " failed: " << fail_counter_.Get()
-              << "  transaction pending: " << observer_threads_->PendingNum();
+              << "  transaction pending: " << observer_threads_->PendingNum()
+              << "  scan rows: " << scan_rows << " lock failed: " << lock_fail_counter_.Get()
+              << " batches: " << batches
+              << " avg batch size: " << (batches > 0 ? scan_rows / batches : 0);
     ThisThread::Sleep(1000);
     total_counter_.Clear();
     fail_counter_.Clear();
+    scan_row_counter_.Clear();
+    lock_fail_counter_.Clear();
+    batch_counter_.Clear();
   }
 }
 
@@ -579,6 +658,51 @@ bool ScannerImpl::TryLockRow(const std::string& table_name, const std::string& r
   return true;
 }
 
+bool ScannerImpl::TryLockRows(const std::string& table_name, const std::vector<std::string>& rows,
+                              std::vector<bool>* locked) const {
+  locked->assign(rows.size(), false);
+  if (rows.empty()) {
+    return true;
+  }
+  if (rows.size() == 1) {
+    (*locked)[0] = TryLockRow(table_name, rows[0]);
+    return (*locked)[0];
+  }
+
+  BatchRowlockRequest request;
+  BatchRowlockResponse response;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    RowlockRequest* row_request = request.add_rows();
+    row_request->set_table_name(table_name);
+    row_request->set_row(rows[i]);
+  }
+
+  std::shared_ptr<RowlockClient> rowlock_client;
+  if (FLAGS_mock_rowlock_enable == true) {
+    rowlock_client.reset(new FakeRowlockClient());
+  } else {
+    rowlock_client.reset(new RowlockClient());
+  }
+
+  VLOG(12) << "[time] batch trylock " << table_name << " " << rows.size() << " rows";
+  if (!rowlock_client->BatchTryLock(&request, &response)) {
+    LOG(ERROR) << "BatchTryLock rpc fail, table: " << table_name << " rows: " << rows.size();
+    return false;
+  }
+  if (response.lock_status_size() != request.rows_size()) {
+    LOG(ERROR) << "BatchTryLock response mismatch, request rows: " << request.rows_size()
+               << " response rows: " << response.lock_status_size();
+    return false;
+  }
+
+  bool all_locked = true;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    (*locked)[i] = (response.lock_status(i) == kLockSucc);
+    all_locked = all_locked && (*locked)[i];
+  }
+  return all_locked;
+}
+
 bool ScannerImpl::CheckTransactionTypeLegalForTable(TransactionType transaction_type,
                                                     TransactionType table_type) {
   if (transaction_type == table_type) {
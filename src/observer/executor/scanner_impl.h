@@ -13,6 +13,7 @@
 #include "common/this_thread.h"
 #include "common/timer.h"
 #include "observer/executor/notify_cell.h"
+#include "observer/executor/notify_range_tracker.h"
 #include "observer/observer.h"
 #include "observer/scanner.h"
 #include "tera.h"
@@ -67,13 +68,17 @@ class ScannerImpl : public Scanner {
   void ValidateAckConfict(RowReader* ack_reader);
   void SetAckVersionCallBack(Transaction* ack_transaction);
 
+  // a notify cell of |row_key| is written, scan its range without back-off
+  void MarkNotifyDirty(const std::string& table_name, const std::string& row_key);
+
  private:
   ScannerImpl();
 
   void ScanTable();
 
   bool DoScanTable(tera::Table* table, const std::set<Column>& column_set,
-                   const std::string& start_key, const std::string& end_key);
+                   const std::string& start_key, const std::string& end_key,
+                   int64_t* notify_rows);
 
   void BeforeScanTable(const std::string& table_name, const ScanHook::Columns& columns);
 
@@ -82,6 +87,11 @@ class ScannerImpl : public Scanner {
 
   void AsyncReadCell(std::shared_ptr<NotifyCell> notify_cell);
 
+  // cells read without transaction go to tabletnodes in one batch
+  void AsyncReadCells(const std::vector<std::shared_ptr<NotifyCell>>& notify_cells);
+
+  RowReader* NewCellReader(std::shared_ptr<NotifyCell> notify_cell);
+
   void ValidateCellValue(RowReader* value_reader);
 
   bool ParseNotifyQualifier(const std::string& notify_qualifier, std::string* data_family,
@@ -100,6 +110,9 @@ class ScannerImpl : public Scanner {
   std::string GetAckQualifierPrefix(const std::string& family, const std::string& qualifier) const;
   std::string GetAckQualifier(const std::string& prefix, const std::string& observer_name) const;
   bool TryLockRow(const std::string& table_name, const std::string& row) const;
+  // return false if any row is not locked, |locked| tells which ones are
+  bool TryLockRows(const std::string& table_name, const std::vector<std::string>& rows,
+                   std::vector<bool>* locked) const;
 
   bool CheckTransactionTypeLegalForTable(TransactionType transaction_type,
                                          TransactionType table_type);
@@ -119,6 +132,7 @@ class ScannerImpl : public Scanner {
   mutable Mutex table_mutex_;
   std::unique_ptr<tera::Client> tera_client_;
   std::unique_ptr<KeySelector> key_selector_;
+  std::unique_ptr<NotifyRangeTracker> range_tracker_;
 
   // map<table name, table observe info:table ptr, map<column, observer>>
   std::shared_ptr<std::map<std::string, TableObserveInfo>> table_observe_info_;
@@ -136,6 +150,9 @@ class ScannerImpl : public Scanner {
   std::thread profiling_thread_;
   Counter total_counter_;
   Counter fail_counter_;
+  Counter scan_row_counter_;
+  Counter lock_fail_counter_;
+  Counter batch_counter_;
   common::Semaphore semaphore_;
   ScannerOptions options_;
   std::shared_ptr<ScanHook> scan_hook_;
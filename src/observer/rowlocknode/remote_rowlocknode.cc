@@ -28,5 +28,12 @@ void RemoteRowlockNode::UnLock(google::protobuf::RpcController* controller,
   rowlocknode_impl_->UnLock(request, response, done);
 }
 
+void RemoteRowlockNode::BatchLock(google::protobuf::RpcController* controller,
+                                  const BatchRowlockRequest* request,
+                                  BatchRowlockResponse* response,
+                                  google::protobuf::Closure* done) {
+  rowlocknode_impl_->BatchTryLock(request, response, done);
+}
+
 }  // namespace observer
 }  // namespace tera
@@ -23,6 +23,9 @@ class RemoteRowlockNode : public RowlockService {
   void UnLock(google::protobuf::RpcController* controller, const RowlockRequest* request,
               RowlockResponse* response, google::protobuf::Closure* done);
 
+  void BatchLock(google::protobuf::RpcController* controller, const BatchRowlockRequest* request,
+                 BatchRowlockResponse* response, google::protobuf::Closure* done);
+
  private:
   RowlockNodeImpl* rowlocknode_impl_;
 };
@@ -5,97 +5,193 @@
 #ifndef TERA_OBSERVER_ROWLOCKNODE_ROWLOCK_DB_H_
 #define TERA_OBSERVER_ROWLOCKNODE_ROWLOCK_DB_H_
 
-#include <map>
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
-#include <unordered_map>
+#include <thread>
 #include <vector>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "common/base/scoped_ptr.h"
-#include "common/mutex.h"
 #include "common/thread_pool.h"
 #include "common/timer.h"
 
 DECLARE_int32(rowlock_db_sharding_number);
 DECLARE_int32(rowlock_db_ttl);
 DECLARE_int32(rowlock_timing_wheel_patch_num);
+DECLARE_int32(rowlock_db_slot_number);
 
 namespace tera {
 namespace observer {
 
+// A fixed size open addressing table of lock words, no mutex and no
+// allocation on TryLock/UnLock.
+//
+// A lock word is |row tag:46|used:1|claiming:1|epoch:16|, 0 is an empty slot.
+// A row is locked in one of kProbeNum slots after its home slot. TryLock
+// claims an empty or expired slot by CAS, then looks through the probe window
+// for the same row: a lock, or a claim at lower slot makes it give up, so at
+// most one claim of a row becomes a lock.
+//
+// A lock taken at epoch e expires once rowlock_timing_wheel_patch_num epochs
+// passed, ClearTimeout() moves the epoch forward and sweeps expired words.
+//
+// Rows are 64 bits hashes of table name and row key, only the low 46 bits are
+// kept as tag, so rows with the same tag share one lock.
 class RowlockDB {
  public:
   RowlockDB()
-      : timing_wheel_pos_(0), timing_wheel_patch_num_(FLAGS_rowlock_timing_wheel_patch_num) {
-    timing_wheel_.resize(timing_wheel_patch_num_);
+      : slot_num_(FLAGS_rowlock_db_slot_number > static_cast<int32_t>(kProbeNum)
+                      ? FLAGS_rowlock_db_slot_number
+                      : kProbeNum),
+        slots_(new std::atomic<uint64_t>[slot_num_]),
+        ttl_epoch_num_(FLAGS_rowlock_timing_wheel_patch_num < static_cast<int32_t>(kMaxTtlEpochNum)
+                           ? std::max(FLAGS_rowlock_timing_wheel_patch_num, 1)
+                           : kMaxTtlEpochNum),
+        epoch_(0) {
+    for (size_t i = 0; i < slot_num_; ++i) {
+      slots_[i].store(0);
+    }
   }
 
   ~RowlockDB() {}
 
   bool TryLock(uint64_t row) {
-    MutexLock locker(&mutex_);
-    if (locks_.find(row) == locks_.end()) {
-      locks_[row].reset(new uint64_t(row));
-      std::weak_ptr<uint64_t> ptr = locks_[row];
-      timing_wheel_[timing_wheel_pos_].push_back(ptr);
-      return true;
-    } else {
+    const uint64_t tag = RowTag(row);
+    const size_t home = HomeSlot(row);
+    const uint32_t epoch = epoch_.load();
+
+    // 1. claim an empty or expired slot
+    const uint64_t claim_word = tag | kUsedBit | kClaimingBit | (epoch & kEpochMask);
+    size_t claimed = kProbeNum;
+    for (size_t i = 0; i < kProbeNum && claimed == kProbeNum; ++i) {
+      std::atomic<uint64_t>& slot = Slot(home, i);
+      uint64_t word = slot.load();
+      while (!IsLive(word)) {
+        if (slot.compare_exchange_weak(word, claim_word)) {
+          claimed = i;
+          break;
+        }
+      }
+      if (claimed == kProbeNum && !IsClaiming(word) && Tag(word) == tag) {
+        return false;
+      }
+    }
+    if (claimed == kProbeNum) {
+      LOG(WARNING) << "rowlock probe window is full, row: " << row;
       return false;
     }
+
+    // 2. look for the lock or other claims of the same row
+    for (size_t i = 0; i < kProbeNum; ++i) {
+      if (i == claimed) {
+        continue;
+      }
+      std::atomic<uint64_t>& slot = Slot(home, i);
+      uint64_t word = slot.load();
+      while (IsLive(word) && Tag(word) == tag) {
+        if (!IsClaiming(word) || i < claimed) {
+          Slot(home, claimed).store(0);
+          return false;
+        }
+        // the claim at higher slot will give up after it sees this one
+        std::this_thread::yield();
+        word = slot.load();
+      }
+    }
+
+    // 3. the claim becomes a lock
+    Slot(home, claimed).store(tag | kUsedBit | (epoch & kEpochMask));
+    return true;
   }
 
   void UnLock(uint64_t row) {
-    MutexLock locker(&mutex_);
-    locks_.erase(row);
+    const uint64_t tag = RowTag(row);
+    const size_t home = HomeSlot(row);
+    for (size_t i = 0; i < kProbeNum; ++i) {
+      std::atomic<uint64_t>& slot = Slot(home, i);
+      uint64_t word = slot.load();
+      if (word != 0 && !IsClaiming(word) && Tag(word) == tag) {
+        slot.compare_exchange_strong(word, 0);
+      }
+    }
   }
 
   // call this function ever timeout period
-  // 1. pointer of timing wheel move forward by one step
-  // 2. clear all the rowlock keys and remove them from locks_
-  // 3. the next 60 seconds all new rowlock keys will be put into this wheel
-  // patch
+  // 1. epoch moves forward by one step, locks taken
+  //    rowlock_timing_wheel_patch_num epochs ago expire
+  // 2. expired lock words are cleared, so that their epochs never wrap
   void ClearTimeout() {
-    // pointer forward
-    mutex_.Lock();
-    timing_wheel_pos_ = (timing_wheel_pos_ + 1) % timing_wheel_patch_num_;
-    std::vector<std::weak_ptr<uint64_t>> buffer;
-
-    // release memory
-    buffer.swap(timing_wheel_[timing_wheel_pos_]);
-    mutex_.Unlock();
-
-    // remove key from locks_
-    for (uint32_t i = 0; i < buffer.size(); ++i) {
-      if (!buffer[i].expired()) {
-        mutex_.Lock();
-        auto it = buffer[i].lock();
-        locks_.erase(*it);
-        mutex_.Unlock();
+    epoch_.fetch_add(1);
+    for (size_t i = 0; i < slot_num_; ++i) {
+      uint64_t word = slots_[i].load();
+      if (word != 0 && !IsLive(word)) {
+        slots_[i].compare_exchange_strong(word, 0);
       }
     }
   }
 
   size_t Size() const {
-    MutexLock locker(&mutex_);
-    return locks_.size();
+    size_t size = 0;
+    for (size_t i = 0; i < slot_num_; ++i) {
+      uint64_t word = slots_[i].load();
+      if (IsLive(word) && !IsClaiming(word)) {
+        ++size;
+      }
+    }
+    return size;
   }
 
  private:
-  mutable Mutex mutex_;
+  static const size_t kProbeNum = 16;
+  static const uint64_t kEpochMask = (1ULL << 16) - 1;
+  // ages above kEpochMask / 2 are taken as locks from the future, so the ttl
+  // must stay below it for locks to ever expire
+  static const uint32_t kMaxTtlEpochNum = kEpochMask / 2 - 1;
+  static const uint64_t kClaimingBit = 1ULL << 16;
+  static const uint64_t kUsedBit = 1ULL << 17;
+  static const int kTagShift = 18;
+
+  static uint64_t RowTag(uint64_t row) { return row << kTagShift; }
+  static uint64_t Tag(uint64_t word) { return word >> kTagShift << kTagShift; }
+  static bool IsClaiming(uint64_t word) { return (word & kClaimingBit) != 0; }
+
+  size_t HomeSlot(uint64_t row) const {
+    // rows of a shard have the same remainder, mix bits before modulo
+    row ^= row >> 33;
+    row *= 0xff51afd7ed558ccdULL;
+    row ^= row >> 33;
+    return row % slot_num_;
+  }
 
-  std::unordered_map<uint64_t, std::shared_ptr<uint64_t>> locks_;
+  std::atomic<uint64_t>& Slot(size_t home, size_t i) const {
+    return slots_[(home + i) % slot_num_];
+  }
+
+  // a claim is always live, a lock is live until it expires. an epoch newer
+  // than epoch_ is from a lock taken after epoch_ was read.
+  bool IsLive(uint64_t word) const {
+    if (word == 0) {
+      return false;
+    }
+    if (IsClaiming(word)) {
+      return true;
+    }
+    uint32_t age = (epoch_.load() - word) & kEpochMask;
+    return age < ttl_epoch_num_ || age > kEpochMask / 2;
+  }
 
-  // timing wheel
-  uint32_t timing_wheel_pos_;
-  uint32_t timing_wheel_patch_num_;
-  std::vector<std::vector<std::weak_ptr<uint64_t>>> timing_wheel_;
+  const size_t slot_num_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  const uint32_t ttl_epoch_num_;
+  std::atomic<uint32_t> epoch_;
 };
 
 class ShardedRowlockDB {
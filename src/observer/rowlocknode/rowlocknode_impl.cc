@@ -61,6 +61,24 @@ void RowlockNodeImpl::UnLock(const RowlockRequest* request, RowlockResponse* res
   done->Run();
 }
 
+void RowlockNodeImpl::BatchTryLock(const BatchRowlockRequest* request,
+                                   BatchRowlockResponse* response,
+                                   google::protobuf::Closure* done) {
+  for (int i = 0; i < request->rows_size(); ++i) {
+    const RowlockRequest& row_request = request->rows(i);
+    uint64_t rowlock_key = GetRowlockKey(row_request.table_name(), row_request.row());
+    if (rowlock_db_.TryLock(rowlock_key)) {
+      response->add_lock_status(kLockSucc);
+      VLOG(12) << "Lock success: " << row_request.row();
+    } else {
+      response->add_lock_status(kLockFail);
+      LOG(WARNING) << " table name: " << row_request.table_name()
+                   << " row :" << row_request.row();
+    }
+  }
+  done->Run();
+}
+
 void RowlockNodeImpl::PrintQPS() { return; }
 
 uint64_t RowlockNodeImpl::GetRowlockKey(const std::string& table_name,
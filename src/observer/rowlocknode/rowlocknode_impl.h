@@ -36,6 +36,9 @@ class RowlockNodeImpl {
   void UnLock(const RowlockRequest* request, RowlockResponse* response,
               google::protobuf::Closure* done);
 
+  void BatchTryLock(const BatchRowlockRequest* request, BatchRowlockResponse* response,
+                    google::protobuf::Closure* done);
+
   void PrintQPS();
 
  private:
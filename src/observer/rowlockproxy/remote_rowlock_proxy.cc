@@ -28,5 +28,12 @@ void RemoteRowlockProxy::UnLock(google::protobuf::RpcController* controller,
   rowlock_proxy_impl_->UnLock(request, response, done);
 }
 
+void RemoteRowlockProxy::BatchLock(google::protobuf::RpcController* controller,
+                                   const BatchRowlockRequest* request,
+                                   BatchRowlockResponse* response,
+                                   google::protobuf::Closure* done) {
+  rowlock_proxy_impl_->BatchTryLock(request, response, done);
+}
+
 }  // namespace observer
 }  // namespace tera
@@ -25,6 +25,9 @@ class RemoteRowlockProxy : public RowlockService {
   void UnLock(google::protobuf::RpcController* controller, const RowlockRequest* request,
               RowlockResponse* response, google::protobuf::Closure* done);
 
+  void BatchLock(google::protobuf::RpcController* controller, const BatchRowlockRequest* request,
+                 BatchRowlockResponse* response, google::protobuf::Closure* done);
+
  private:
   RowlockProxyImpl* rowlock_proxy_impl_;
 };
@@ -5,6 +5,8 @@
 #include "observer/rowlockproxy/rowlock_proxy_impl.h"
 
 #include <functional>
+#include <map>
+#include <vector>
 
 #include "common/timer.h"
 #include "utils/utils_cmd.h"
@@ -62,6 +64,39 @@ void RowlockProxyImpl::UnLock(const RowlockRequest* request, RowlockResponse* re
   done->Run();
 }
 
+void RowlockProxyImpl::BatchTryLock(const BatchRowlockRequest* request,
+                                    BatchRowlockResponse* response,
+                                    google::protobuf::Closure* done) {
+  // server addr -> index of rows in request
+  std::map<std::string, std::vector<int>> server_rows;
+  for (int i = 0; i < request->rows_size(); ++i) {
+    uint64_t rowlock_key = GetRowKey(request->rows(i).table_name(), request->rows(i).row());
+    server_rows[ScheduleRowKey(rowlock_key)].push_back(i);
+    response->add_lock_status(kLockFail);
+  }
+
+  for (auto it = server_rows.begin(); it != server_rows.end(); ++it) {
+    const std::vector<int>& rows = it->second;
+    BatchRowlockRequest server_request;
+    BatchRowlockResponse server_response;
+    for (size_t i = 0; i < rows.size(); ++i) {
+      server_request.add_rows()->CopyFrom(request->rows(rows[i]));
+    }
+    RowlockStub client(it->first);
+    if (!client.BatchTryLock(&server_request, &server_response) ||
+        server_response.lock_status_size() != static_cast<int>(rows.size())) {
+      LOG(WARNING) << "batch lock " << rows.size() << " rows fail on " << it->first;
+      continue;
+    }
+    for (size_t i = 0; i < rows.size(); ++i) {
+      response->set_lock_status(rows[i], server_response.lock_status(i));
+    }
+  }
+  VLOG(12) << "batch lock " << request->rows_size() << " rows on " << server_rows.size()
+           << " nodes";
+  done->Run();
+}
+
 uint64_t RowlockProxyImpl::GetRowKey(const std::string& table_name, const std::string& row) const {
   std::string rowkey_str = table_name + row;
   return std::hash<std::string>()(rowkey_str);
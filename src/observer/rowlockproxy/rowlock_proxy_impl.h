@@ -35,6 +35,10 @@ class RowlockProxyImpl {
   void UnLock(const RowlockRequest* request, RowlockResponse* response,
               google::protobuf::Closure* done);
 
+  // rows are grouped by rowlock node, one BatchLock rpc for each node
+  void BatchTryLock(const BatchRowlockRequest* request, BatchRowlockResponse* response,
+                    google::protobuf::Closure* done);
+
   // for zk
   void SetServerNumber(uint32_t number);
   uint32_t GetServerNumber();
@@ -0,0 +1,66 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "observer/executor/notify_range_tracker.h"
+
+#include <gtest/gtest.h>
+
+namespace tera {
+namespace observer {
+
+TEST(NotifyRangeTrackerTest, EmptyScanBackoff) {
+  NotifyRangeTracker tracker(100, 1000);
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 0), 0);
+
+  // backoff doubles while the range keeps coming back empty
+  tracker.OnScanned("t", "a", "m", 0, 0);
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 0), 100);
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 40), 60);
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 100), 0);
+  tracker.OnScanned("t", "a", "m", 0, 100);
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 100), 200);
+  for (int i = 0; i < 10; ++i) {
+    tracker.OnScanned("t", "a", "m", 0, 300);
+  }
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 300), 1000);
+
+  // other ranges are not affected
+  ASSERT_EQ(tracker.ScanDelay("t", "m", "", 300), 0);
+  ASSERT_EQ(tracker.ScanDelay("t2", "a", "m", 300), 0);
+
+  // a scan that sees notifies resets the backoff
+  tracker.OnScanned("t", "a", "m", 3, 300);
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 300), 0);
+  tracker.OnScanned("t", "a", "m", 0, 300);
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 300), 100);
+}
+
+TEST(NotifyRangeTrackerTest, MarkDirty) {
+  NotifyRangeTracker tracker(100, 1000);
+  tracker.OnScanned("t", "a", "m", 0, 0);
+  tracker.OnScanned("t", "m", "", 0, 0);
+  tracker.OnScanned("t", "", "", 0, 0);
+  tracker.OnScanned("t2", "", "", 0, 0);
+
+  tracker.MarkDirty("t", "z");
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 0), 100);
+  ASSERT_EQ(tracker.ScanDelay("t", "m", "", 0), 0);
+  ASSERT_EQ(tracker.ScanDelay("t", "", "", 0), 0);
+  ASSERT_EQ(tracker.ScanDelay("t2", "", "", 0), 100);
+
+  // end key is exclusive
+  tracker.MarkDirty("t", "m");
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 0), 100);
+  tracker.MarkDirty("t", "a");
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 0), 0);
+}
+
+TEST(NotifyRangeTrackerTest, Disabled) {
+  NotifyRangeTracker tracker(100, 0);
+  tracker.OnScanned("t", "a", "m", 0, 0);
+  ASSERT_EQ(tracker.ScanDelay("t", "a", "m", 0), 0);
+}
+
+}  // namespace observer
+}  // namespace tera
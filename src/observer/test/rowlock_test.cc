@@ -2,8 +2,10 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <atomic>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "gflags/gflags.h"
@@ -14,6 +16,7 @@
 #include "common/counter.h"
 
 DECLARE_int32(rowlock_timing_wheel_patch_num);
+DECLARE_int32(rowlock_db_slot_number);
 
 namespace tera {
 namespace observer {
@@ -159,6 +162,54 @@ TEST(RowlockDB, LockTest) {
   EXPECT_EQ(FLAGS_rowlock_timing_wheel_patch_num - 2, db.Size());
 }
 
+TEST(RowlockDB, LargePatchNumTest) {
+  int32_t patch_num = FLAGS_rowlock_timing_wheel_patch_num;
+  int32_t slot_number = FLAGS_rowlock_db_slot_number;
+  FLAGS_rowlock_timing_wheel_patch_num = 1 << 20;
+  FLAGS_rowlock_db_slot_number = 64;
+  RowlockDB db;
+  EXPECT_TRUE(db.TryLock(1));
+  // ttl is clamped into the epoch window, the lock expires in the end
+  for (int32_t i = 0; i < (1 << 16) && db.Size() > 0; ++i) {
+    db.ClearTimeout();
+  }
+  EXPECT_EQ(0, db.Size());
+  EXPECT_TRUE(db.TryLock(1));
+  FLAGS_rowlock_timing_wheel_patch_num = patch_num;
+  FLAGS_rowlock_db_slot_number = slot_number;
+}
+
+TEST(RowlockDB, ConcurrentLockTest) {
+  RowlockDB db;
+  std::atomic<int32_t> holders[4];
+  std::atomic<bool> double_locked(false);
+  for (uint32_t i = 0; i < 4; ++i) {
+    holders[i] = 0;
+  }
+
+  // 8 threads lock and unlock 4 keys, a key is never held by two threads
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < 8; ++t) {
+    threads.emplace_back([&db, &holders, &double_locked, t]() {
+      for (uint32_t i = 0; i < 10000; ++i) {
+        uint64_t key = (i + t) % 4;
+        if (db.TryLock(key)) {
+          if (holders[key].fetch_add(1) != 0) {
+            double_locked = true;
+          }
+          holders[key].fetch_sub(1);
+          db.UnLock(key);
+        }
+      }
+    });
+  }
+  for (uint32_t t = 0; t < threads.size(); ++t) {
+    threads[t].join();
+  }
+  EXPECT_FALSE(double_locked);
+  EXPECT_EQ(0, db.Size());
+}
+
 TEST(ShardedRowlockDB, ParaTest) {
   Counter counter;
   ShardedRowlockDB db;
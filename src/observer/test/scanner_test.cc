@@ -381,6 +381,25 @@ TEST(ScannerImpl, PrepareNotifyCell) {
   EXPECT_EQ(notify_cells[0]->observer, observer);
 }
 
+TEST(ScannerImpl, TryLockRows) {
+  FLAGS_mock_rowlock_enable = true;
+  ScannerImpl scanner;
+  std::vector<bool> locked;
+
+  std::vector<std::string> rows;
+  EXPECT_TRUE(scanner.TryLockRows("test_table", rows, &locked));
+  EXPECT_EQ(locked.size(), 0);
+
+  rows.push_back("row1");
+  EXPECT_TRUE(scanner.TryLockRows("test_table", rows, &locked));
+  EXPECT_EQ(locked, std::vector<bool>(1, true));
+
+  rows.push_back("row2");
+  rows.push_back("row3");
+  EXPECT_TRUE(scanner.TryLockRows("test_table", rows, &locked));
+  EXPECT_EQ(locked, std::vector<bool>(3, true));
+}
+
 TEST(ScannerImpl, GetAckQualifierPrefix) {
   ScannerImpl scanner;
 
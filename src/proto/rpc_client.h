@@ -29,15 +29,18 @@ struct RpcCallbackParam {
   Callback closure;
   std::string tips;
   ThreadPool* thread_pool;
+  bool inline_callback;  // run closure in rpc thread, skip the thread pool
 
   RpcCallbackParam(sofa::pbrpc::RpcController* ctrler, const Request* req, Response* resp,
-                   Callback cb, const std::string& str, ThreadPool* tpool)
+                   Callback cb, const std::string& str, ThreadPool* tpool,
+                   bool inline_cb = false)
       : rpc_controller(ctrler),
         request(req),
         response(resp),
         closure(cb),
         tips(str),
-        thread_pool(tpool) {}
+        thread_pool(tpool),
+        inline_callback(inline_cb) {}
 };
 
 class RpcClientBase {
@@ -103,11 +106,17 @@ class RpcClientBase {
 template <class ServerType>
 class RpcClient : public RpcClientBase {
  public:
-  RpcClient(const std::string& addr) : sync_call_failed(false) { ResetClient(addr); }
+  RpcClient(const std::string& addr) : inline_callback_(false), sync_call_failed(false) {
+    ResetClient(addr);
+  }
   virtual ~RpcClient() {}
 
   std::string GetConnectAddr() const { return server_addr_; }
 
+  // Run async callbacks in rpc work thread directly instead of the thread pool.
+  // Only for cheap callbacks which never block, e.g. waking up a waiting thread.
+  void SetInlineCallback(bool inline_callback) { inline_callback_ = inline_callback; }
+
  protected:
   virtual void ResetClient(const std::string& server_addr) {
     if (server_addr_ == server_addr) {
@@ -155,7 +164,8 @@ class RpcClient : public RpcClientBase {
     rpc_controller->SetTimeout(rpc_timeout);
     RpcCallbackParam<Request, Response, Callback>* param =
         new RpcCallbackParam<Request, Response, Callback>(rpc_controller, request, response,
-                                                          closure, tips, thread_pool);
+                                                          closure, tips, thread_pool,
+                                                          inline_callback_);
     google::protobuf::Closure* done = google::protobuf::NewCallback(
         &RpcClient::template RpcCallback<Request, Response, Callback>, this, param);
     (server_client_.get()->*func)(rpc_controller, request, response, done);
@@ -178,6 +188,7 @@ class RpcClient : public RpcClientBase {
     Response* response = param->response;
     Callback closure = param->closure;
     ThreadPool* thread_pool = param->thread_pool;
+    bool inline_callback = param->inline_callback;
 
     bool failed = rpc_controller->Failed();
     int error = rpc_controller->ErrorCode();
@@ -196,6 +207,10 @@ class RpcClient : public RpcClientBase {
     }
 
     // async call
+    if (inline_callback) {
+      UserCallback(request, response, closure, failed, error);
+      return;
+    }
     ThreadPool::Task done =
         std::bind(&RpcClient::template UserCallback<Request, Response, Callback>, request, response,
                   closure, failed, error);
@@ -215,6 +230,7 @@ class RpcClient : public RpcClientBase {
  private:
   scoped_ptr<ServerType> server_client_;
   std::string server_addr_;
+  bool inline_callback_;
 
   bool sync_call_failed;
   AutoResetEvent sync_call_event;
@@ -6,11 +6,13 @@
 
 #include <glog/logging.h>
 #include "quota/limiter/general_quota_limiter.h"
+#include "quota/limiter/token_bucket_quota_limiter.h"
 
 namespace tera {
 namespace quota {
 
 static const std::string general_quota_limiter_type = "general_quota_limiter";
+static const std::string token_bucket_quota_limiter_type = "token_bucket_quota_limiter";
 
 class LimiterFactory {
  public:
@@ -20,6 +22,8 @@ class LimiterFactory {
                                           const std::string& table_name) {
     if (general_quota_limiter_type == limiter_type) {
       return new GeneralQuotaLimiter(table_name);
+    } else if (token_bucket_quota_limiter_type == limiter_type) {
+      return new TokenBucketQuotaLimiter(table_name);
     } else {
       LOG(ERROR) << "Not surport limit_type = " << limiter_type;
       return nullptr;
@@ -0,0 +1,58 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quota/limiter/token_bucket_quota_limiter.h"
+
+namespace tera {
+namespace quota {
+
+namespace {
+static const int64_t unlimited_quota = -1;
+static const int64_t period_one_sec = 1;
+}
+
+TokenBucketQuotaLimiter::TokenBucketQuotaLimiter(const std::string& table_name)
+    : table_name_(table_name) {
+  for (int type = kQuotaWriteReqs; type <= kQuotaScanBytes; ++type) {
+    op_rate_limiters_[type].reset(
+        new TokenBucketRateLimiter(table_name_, static_cast<QuotaOperationType>(type)));
+  }
+}
+
+void TokenBucketQuotaLimiter::Reset(const TableQuota& table_quota) {
+  int64_t limits[kQuotaScanBytes + 1];
+  int64_t periods[kQuotaScanBytes + 1];
+  for (int type = kQuotaWriteReqs; type <= kQuotaScanBytes; ++type) {
+    limits[type] = unlimited_quota;
+    periods[type] = period_one_sec;
+  }
+  for (int i = 0; i < table_quota.quota_infos_size(); ++i) {
+    QuotaOperationType type = table_quota.quota_infos(i).type();
+    limits[type] = table_quota.quota_infos(i).limit();
+    periods[type] = table_quota.quota_infos(i).period();
+  }
+  for (int type = kQuotaWriteReqs; type <= kQuotaScanBytes; ++type) {
+    op_rate_limiters_[type]->Reset(limits[type], periods[type]);
+  }
+}
+
+bool TokenBucketQuotaLimiter::CheckAndConsume(const Throttle& throttle) {
+  const std::pair<QuotaOperationType, int64_t> amounts[] = {
+      {kQuotaWriteReqs, throttle.write_reqs}, {kQuotaWriteBytes, throttle.write_bytes},
+      {kQuotaReadReqs, throttle.read_reqs},   {kQuotaReadBytes, throttle.read_bytes},
+      {kQuotaScanReqs, throttle.scan_reqs},   {kQuotaScanBytes, throttle.scan_bytes}};
+  const int amount_num = sizeof(amounts) / sizeof(amounts[0]);
+  for (int i = 0; i < amount_num; ++i) {
+    if (!op_rate_limiters_[amounts[i].first]->TryConsume(amounts[i].second)) {
+      // all or nothing, give back what is taken
+      for (int j = 0; j < i; ++j) {
+        op_rate_limiters_[amounts[j].first]->Return(amounts[j].second);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+}
+}
@@ -0,0 +1,35 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "quota/limiter/quota_limiter.h"
+#include "quota/limiter/token_bucket_rate_limiter.h"
+
+namespace tera {
+namespace quota {
+
+// Table level quota made of one token bucket per operation type, with the
+// tabletnode level QuotaCreditPool of each type above them. Buckets are
+// never replaced after construction and Reset only swaps atomic settings,
+// so CheckAndConsume on rpc path takes no lock.
+class TokenBucketQuotaLimiter : public QuotaLimiter {
+ public:
+  explicit TokenBucketQuotaLimiter(const std::string& table_name);
+  virtual ~TokenBucketQuotaLimiter() {}
+
+  void Reset(const TableQuota& table_quota) override;
+
+  // if quota limited, return false and consume nothing
+  // otherwise, consume the quota and return true
+  bool CheckAndConsume(const Throttle& throttle) override;
+
+ private:
+  std::string table_name_;
+  std::unique_ptr<TokenBucketRateLimiter> op_rate_limiters_[kQuotaScanBytes + 1];
+};
+}
+}
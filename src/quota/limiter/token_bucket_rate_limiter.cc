@@ -0,0 +1,248 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quota/limiter/token_bucket_rate_limiter.h"
+#include "quota/helpers/quota_utils.h"
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <thread>
+#include "common/event.h"
+#include "common/timer.h"
+
+DECLARE_double(tera_quota_burst_ratio);
+DECLARE_int64(tera_quota_credit_pool_sec);
+
+namespace tera {
+namespace quota {
+
+// interval to refill all buckets, the quota of an idle table reaches the pool
+// at most this late
+static const int64_t kCollectIntervalMs = 100;
+
+namespace {
+
+class CreditPools {
+ public:
+  CreditPools() : thread_(&CreditPools::CollectLoop, this) {}
+
+  ~CreditPools() {
+    stop_event_.Set();
+    thread_.join();
+  }
+
+  QuotaCreditPool* Get(QuotaOperationType type) { return &pools_[type]; }
+
+ private:
+  void CollectLoop() {
+    while (!stop_event_.TimeWait(kCollectIntervalMs)) {
+      for (QuotaCreditPool& pool : pools_) {
+        pool.CollectIdleCredit();
+      }
+    }
+  }
+
+ private:
+  // pools_ are built before thread_ starts
+  QuotaCreditPool pools_[kQuotaScanBytes + 1];
+  common::AutoResetEvent stop_event_;
+  std::thread thread_;
+};
+
+}  // namespace
+
+QuotaCreditPool* QuotaCreditPool::Instance(QuotaOperationType type) {
+  static CreditPools pools;
+  return pools.Get(type);
+}
+
+void QuotaCreditPool::Deposit(int64_t amount) {
+  if (amount <= 0) {
+    return;
+  }
+  // the pool keeps unused credit of at most a few seconds
+  int64_t cap = total_rate_.load() * FLAGS_tera_quota_credit_pool_sec;
+  int64_t cur = credit_.load();
+  while (cur < cap) {
+    int64_t next = cur + amount < cap ? cur + amount : cap;
+    if (credit_.compare_exchange_weak(cur, next)) {
+      return;
+    }
+  }
+}
+
+void QuotaCreditPool::AddBucket(TokenBucketRateLimiter* bucket) {
+  MutexLock lock(&mutex_);
+  buckets_.insert(bucket);
+}
+
+void QuotaCreditPool::RemoveBucket(TokenBucketRateLimiter* bucket) {
+  MutexLock lock(&mutex_);
+  buckets_.erase(bucket);
+}
+
+void QuotaCreditPool::CollectIdleCredit() {
+  int64_t now_us = get_micros();
+  MutexLock lock(&mutex_);
+  for (auto it = buckets_.begin(); it != buckets_.end(); ++it) {
+    (*it)->Refill(now_us);
+  }
+}
+
+bool QuotaCreditPool::Borrow(int64_t amount, int64_t rate) {
+  int64_t total_rate = total_rate_.load();
+  if (amount <= 0 || rate <= 0 || total_rate <= 0) {
+    return false;
+  }
+  int64_t cur = credit_.load();
+  while (true) {
+    double share = static_cast<double>(cur) * rate / total_rate;
+    if (share < amount) {
+      return false;
+    }
+    if (credit_.compare_exchange_weak(cur, cur - amount)) {
+      return true;
+    }
+  }
+}
+
+TokenBucketRateLimiter::TokenBucketRateLimiter(const std::string& table_name,
+                                               QuotaOperationType type)
+    : quota_type_(QuotaUtils::GetQuotaOperation(type)),
+      table_name_(table_name),
+      pool_(QuotaCreditPool::Instance(type)),
+      limit_per_sec_(quota_type_, LabelStringBuilder().Append("table", table_name).ToString(),
+                     {SubscriberType::LATEST}, false),
+      limit_(-1),
+      period_us_(1000000),
+      rate_per_sec_(0),
+      capacity_(0),
+      tokens_(0),
+      last_refill_us_(0) {
+  pool_->AddBucket(this);
+}
+
+TokenBucketRateLimiter::~TokenBucketRateLimiter() {
+  pool_->RemoveBucket(this);
+  pool_->AddRate(-rate_per_sec_.load());
+}
+
+void TokenBucketRateLimiter::Reset(int64_t limit, int64_t period_sec) {
+  if (period_sec <= 0) {
+    period_sec = 1;
+  }
+  int64_t rate_per_sec = limit > 0 ? limit / period_sec : 0;
+  int64_t capacity = limit > 0 ? static_cast<int64_t>(limit * FLAGS_tera_quota_burst_ratio) : 0;
+  if (capacity < limit) {
+    capacity = limit;
+  }
+  pool_->AddRate(rate_per_sec - rate_per_sec_.exchange(rate_per_sec));
+  period_us_.store(period_sec * 1000000);
+  capacity_.store(capacity);
+  tokens_.store(limit > 0 ? limit : 0);
+  last_refill_us_.store(get_micros());
+  limit_.store(limit);
+  limit_per_sec_.Set(rate_per_sec);
+
+  VLOG(7) << "reset token bucket quota " << table_name_ << " " << quota_type_ << " " << limit
+          << "/" << period_sec << " capacity " << capacity;
+}
+
+void TokenBucketRateLimiter::Refill(int64_t now_us) {
+  int64_t limit = limit_.load();
+  int64_t period_us = period_us_.load();
+  int64_t capacity = capacity_.load();
+  int64_t last_us = last_refill_us_.load();
+  if (limit <= 0 || now_us <= last_us) {
+    return;
+  }
+  double refill = static_cast<double>(now_us - last_us) * limit / period_us;
+  if (refill < 1) {
+    // sub-token refill, keep accruing from last_us
+    return;
+  }
+  int64_t tokens;
+  int64_t next_last_us;
+  if (refill >= capacity) {
+    tokens = capacity;
+    next_last_us = now_us;
+  } else {
+    tokens = static_cast<int64_t>(refill);
+    // only the time turned into whole tokens is used up
+    next_last_us = last_us + static_cast<int64_t>(static_cast<double>(tokens) * period_us / limit);
+  }
+  if (!last_refill_us_.compare_exchange_strong(last_us, next_last_us)) {
+    // refilled by another thread
+    return;
+  }
+  int64_t cur = tokens_.fetch_add(tokens) + tokens;
+  while (cur > capacity) {
+    if (tokens_.compare_exchange_weak(cur, capacity)) {
+      pool_->Deposit(cur - capacity);
+      break;
+    }
+  }
+}
+
+bool TokenBucketRateLimiter::RefillAndCheck(int64_t amount) {
+  if (limit_.load() < 0 || amount <= 0) {
+    return true;
+  }
+  Refill(get_micros());
+  return tokens_.load() >= amount;
+}
+
+void TokenBucketRateLimiter::Consume(int64_t amount) {
+  if (limit_.load() < 0 || amount <= 0) {
+    return;
+  }
+  int64_t cur = tokens_.load();
+  while (true) {
+    int64_t next = cur > amount ? cur - amount : 0;
+    if (tokens_.compare_exchange_weak(cur, next)) {
+      return;
+    }
+  }
+}
+
+bool TokenBucketRateLimiter::TryConsume(int64_t amount) {
+  if (limit_.load() < 0) {
+    return true;
+  }
+  Refill(get_micros());
+  if (amount <= 0) {
+    return true;
+  }
+  int64_t cur = tokens_.load();
+  while (cur >= amount) {
+    if (tokens_.compare_exchange_weak(cur, cur - amount)) {
+      return true;
+    }
+  }
+  int64_t lack = amount - (cur > 0 ? cur : 0);
+  if (!pool_->Borrow(lack, rate_per_sec_.load())) {
+    VLOG(25) << "[" << table_name_ << " " << quota_type_ << "] quota reach limit";
+    return false;
+  }
+  // the borrowed credit is spent directly, only the rest is taken from bucket
+  int64_t own = amount - lack;
+  cur = tokens_.load();
+  while (cur >= own) {
+    if (tokens_.compare_exchange_weak(cur, cur - own)) {
+      VLOG(25) << "[" << table_name_ << " " << quota_type_ << "] borrow " << lack;
+      return true;
+    }
+  }
+  // others took the tokens first, give the credit back
+  pool_->Refund(lack);
+  return false;
+}
+
+void TokenBucketRateLimiter::Return(int64_t amount) {
+  if (limit_.load() < 0 || amount <= 0) {
+    return;
+  }
+  tokens_.fetch_add(amount);
+}
+}
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <set>
+#include <string>
+#include "common/mutex.h"
+#include "quota/limiter/rate_limiter.h"
+#include "common/metric/metric_counter.h"
+#include "proto/quota.pb.h"
+
+namespace tera {
+namespace quota {
+
+class TokenBucketRateLimiter;
+
+// Unused quota of all tables on this tabletnode for one operation type.
+// A table bucket spills the tokens it can't hold into the pool, and a table
+// short of tokens borrows from it, no more than its share of the pool
+// weighted by its refill rate. Buckets are refilled lazily on request, so a
+// background thread refills all buckets periodically to collect the quota
+// of tables which send no request.
+class QuotaCreditPool {
+ public:
+  static QuotaCreditPool* Instance(QuotaOperationType type);
+
+  QuotaCreditPool() : credit_(0), total_rate_(0) {}
+
+  void AddRate(int64_t delta) { total_rate_.fetch_add(delta); }
+
+  void AddBucket(TokenBucketRateLimiter* bucket);
+  void RemoveBucket(TokenBucketRateLimiter* bucket);
+
+  // refill all buckets, spilling the quota of idle tables into the pool,
+  // called by the background thread only
+  void CollectIdleCredit();
+
+  void Deposit(int64_t amount);
+
+  // take |amount| credit for a table refilling |rate| tokens per second,
+  // return false and take nothing if it is more than the table's share
+  bool Borrow(int64_t amount, int64_t rate);
+
+  // give back credit taken by Borrow but not spent
+  void Refund(int64_t amount) { credit_.fetch_add(amount); }
+
+  int64_t Credit() const { return credit_.load(); }
+
+ private:
+  std::atomic<int64_t> credit_;
+  std::atomic<int64_t> total_rate_;
+
+  // guards buckets_, taken when a bucket is created or destroyed and by the
+  // background refill, never on the request path
+  Mutex mutex_;
+  std::set<TokenBucketRateLimiter*> buckets_;
+};
+
+// Lock free token bucket, refilled continuously at limit/period and holding
+// up to limit * FLAGS_tera_quota_burst_ratio tokens, so an idle table
+// accrues credit for a burst and the refill isn't bound to period edges.
+class TokenBucketRateLimiter : public RateLimiter {
+ public:
+  TokenBucketRateLimiter(const std::string& table_name, QuotaOperationType type);
+  virtual ~TokenBucketRateLimiter();
+
+  void Reset(int64_t limit, int64_t period_sec) override;
+
+  bool RefillAndCheck(int64_t amount) override;
+
+  void Consume(int64_t amount) override;
+
+  // take |amount| tokens at once, borrow the missing part from pool if any.
+  // If return false, tokens of the bucket and the pool stay untouched.
+  bool TryConsume(int64_t amount);
+
+  // give back tokens taken by TryConsume for a request rejected afterwards
+  void Return(int64_t amount);
+
+ private:
+  friend class QuotaCreditPool;
+  void Refill(int64_t now_us);
+
+ private:
+  std::string quota_type_;
+  std::string table_name_;
+  QuotaCreditPool* pool_;
+  tera::MetricCounter limit_per_sec_;
+
+  // negative limit means unlimited
+  std::atomic<int64_t> limit_;
+  std::atomic<int64_t> period_us_;
+  std::atomic<int64_t> rate_per_sec_;
+  std::atomic<int64_t> capacity_;
+  std::atomic<int64_t> tokens_;
+  std::atomic<int64_t> last_refill_us_;
+};
+}
+}
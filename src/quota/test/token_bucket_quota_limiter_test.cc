@@ -0,0 +1,102 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <gflags/gflags.h>
+#include <thread>
+#include "quota/limiter/token_bucket_quota_limiter.h"
+
+DECLARE_double(tera_quota_burst_ratio);
+DECLARE_int64(tera_quota_credit_pool_sec);
+
+namespace tera {
+namespace quota {
+namespace test {
+
+static TableQuota BuildWriteReqsQuota(const std::string& table_name, int64_t limit,
+                                      int64_t period) {
+  TableQuota table_quota;
+  table_quota.set_table_name(table_name);
+  QuotaInfo* quota_info = table_quota.add_quota_infos();
+  quota_info->set_type(kQuotaWriteReqs);
+  quota_info->set_limit(limit);
+  quota_info->set_period(period);
+  quota_info = table_quota.add_quota_infos();
+  quota_info->set_type(kQuotaWriteBytes);
+  quota_info->set_limit(limit * 10);
+  quota_info->set_period(period);
+  return table_quota;
+}
+
+static Throttle WriteThrottle(int64_t reqs, int64_t bytes) {
+  Throttle throttle;
+  throttle.write_reqs = reqs;
+  throttle.write_bytes = bytes;
+  return throttle;
+}
+
+TEST(TokenBucketQuotaLimiterTest, Unlimited) {
+  TokenBucketQuotaLimiter limiter("unlimited");
+  limiter.Reset(TableQuota());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(limiter.CheckAndConsume(WriteThrottle(1000000, 1000000)));
+  }
+}
+
+TEST(TokenBucketQuotaLimiterTest, AllOrNothing) {
+  FLAGS_tera_quota_credit_pool_sec = 0;
+  TokenBucketQuotaLimiter limiter("all_or_nothing");
+  limiter.Reset(BuildWriteReqsQuota("all_or_nothing", 100, 3600));
+  // bytes run out first, reqs taken before must be given back
+  EXPECT_FALSE(limiter.CheckAndConsume(WriteThrottle(10, 2000)));
+  EXPECT_TRUE(limiter.CheckAndConsume(WriteThrottle(100, 1000)));
+  EXPECT_FALSE(limiter.CheckAndConsume(WriteThrottle(1, 0)));
+}
+
+TEST(TokenBucketQuotaLimiterTest, SubSecondRefill) {
+  FLAGS_tera_quota_credit_pool_sec = 0;
+  TokenBucketQuotaLimiter limiter("sub_second");
+  limiter.Reset(BuildWriteReqsQuota("sub_second", 1000, 1));
+  EXPECT_TRUE(limiter.CheckAndConsume(WriteThrottle(1000, 0)));
+  EXPECT_FALSE(limiter.CheckAndConsume(WriteThrottle(100, 0)));
+  // a tenth of the period refills a tenth of the limit
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  EXPECT_TRUE(limiter.CheckAndConsume(WriteThrottle(100, 0)));
+}
+
+TEST(TokenBucketQuotaLimiterTest, BurstCredit) {
+  FLAGS_tera_quota_credit_pool_sec = 0;
+  FLAGS_tera_quota_burst_ratio = 3;
+  TokenBucketQuotaLimiter limiter("burst");
+  limiter.Reset(BuildWriteReqsQuota("burst", 100, 1));
+  FLAGS_tera_quota_burst_ratio = 1;
+  EXPECT_TRUE(limiter.CheckAndConsume(WriteThrottle(100, 0)));
+  // idle for a while accrues credit for more than one period
+  std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+  EXPECT_TRUE(limiter.CheckAndConsume(WriteThrottle(200, 0)));
+  EXPECT_FALSE(limiter.CheckAndConsume(WriteThrottle(100, 0)));
+}
+
+TEST(TokenBucketQuotaLimiterTest, BorrowUnusedQuota) {
+  FLAGS_tera_quota_credit_pool_sec = 10;
+  TokenBucketQuotaLimiter idle("borrow_idle");
+  TokenBucketQuotaLimiter busy("borrow_busy");
+  idle.Reset(BuildWriteReqsQuota("borrow_idle", 3000, 1));
+  busy.Reset(BuildWriteReqsQuota("borrow_busy", 1000, 1));
+  EXPECT_TRUE(busy.CheckAndConsume(WriteThrottle(1000, 0)));
+  EXPECT_FALSE(busy.CheckAndConsume(WriteThrottle(500, 0)));
+
+  // the idle table never consumes, its unused quota is still collected into
+  // the pool, and the busy one borrows no more than its weighted share
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  EXPECT_TRUE(busy.CheckAndConsume(WriteThrottle(1000, 0)));
+  EXPECT_TRUE(busy.CheckAndConsume(WriteThrottle(500, 0)));
+  EXPECT_FALSE(busy.CheckAndConsume(WriteThrottle(100000, 0)));
+  FLAGS_tera_quota_credit_pool_sec = 1;
+}
+
+}  // namespace test
+}  // namespace quota
+}  // namespace tera
@@ -54,6 +54,9 @@ DECLARE_bool(tera_sdk_perf_collect_enabled);
 DECLARE_int32(tera_gtxn_thread_max_num);
 DECLARE_bool(tera_sdk_client_for_gtxn);
 DECLARE_bool(tera_sdk_tso_client_enabled);
+DECLARE_bool(tera_sdk_tso_batch_enabled);
+DECLARE_int32(tera_sdk_tso_batch_max_size);
+DECLARE_int64(tera_sdk_tso_batch_window_us);
 DECLARE_bool(tera_sdk_mock_enable);
 
 DECLARE_string(tera_auth_policy);
@@ -106,6 +109,11 @@ ClientImpl::ClientImpl(const ClientOptions& client_options, ThreadPool* client_t
     cluster_ = sdk::NewClusterFinder(client_zk_adapter_);
     if (FLAGS_tera_sdk_tso_client_enabled) {
       tso_cluster_ = sdk::NewTimeoracleClusterFinder();
+      if (FLAGS_tera_sdk_tso_batch_enabled) {
+        tso_batcher_.reset(new timeoracle::TimestampBatcher(
+            gtxn_thread_pool_, tso_cluster_, FLAGS_tera_sdk_tso_batch_max_size,
+            FLAGS_tera_sdk_tso_batch_window_us));
+      }
     }
     RegisterSelf();
   } else {
@@ -138,6 +146,7 @@ ClientImpl::~ClientImpl() {
   }
   if (FLAGS_tera_sdk_client_for_gtxn) {
     if (FLAGS_tera_sdk_tso_client_enabled) {
+      tso_batcher_.reset();
       delete tso_cluster_;
     }
     delete client_zk_adapter_;
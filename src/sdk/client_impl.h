@@ -136,6 +136,9 @@ class ClientImpl : public Client, public std::enable_shared_from_this<ClientImpl
 
   sdk::ClusterFinder* GetClusterFinder();
 
+  // NULL if global txns do not batch timestamp requests
+  timeoracle::TimestampBatcher* GetTimestampBatcher() { return tso_batcher_.get(); }
+
   std::shared_ptr<auth::AccessBuilder> GetAccessBuilder();
 
   bool Login(ErrorCode* err);
@@ -201,6 +204,7 @@ class ClientImpl : public Client, public std::enable_shared_from_this<ClientImpl
   sdk::ClientZkAdapterBase* client_zk_adapter_;
   sdk::ClusterFinder* cluster_;
   sdk::ClusterFinder* tso_cluster_;
+  std::unique_ptr<timeoracle::TimestampBatcher> tso_batcher_;
   sdk::PerfCollecter* collecter_;
   std::string session_str_;
 
@@ -0,0 +1,107 @@
+// Copyright (c) 2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sdk/completion_queue_impl.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <glog/logging.h>
+
+#include "sdk/mutate_impl.h"
+#include "sdk/read_impl.h"
+#include "tera/table.h"
+#include "common/timer.h"
+
+namespace tera {
+
+CompletionQueue* CompletionQueue::NewCompletionQueue() { return new CompletionQueueImpl; }
+
+CompletionQueueImpl::CompletionQueueImpl()
+    : cond_(&mutex_), notify_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+  PCHECK(notify_fd_ >= 0) << "fail to create eventfd for completion queue";
+}
+
+CompletionQueueImpl::~CompletionQueueImpl() {
+  if (pending_cnt_.Get() > 0) {
+    LOG(ERROR) << "completion queue deleted with " << pending_cnt_.Get() << " pending operations";
+  }
+  close(notify_fd_);
+}
+
+void CompletionQueueImpl::Get(Table* table, RowReader* reader, void* tag) {
+  RowReaderImpl* reader_impl = static_cast<RowReaderImpl*>(reader);
+  CHECK(reader_impl->GetCallBack() == NULL) << "reader of completion queue has callback";
+  reader_impl->SetCompletionQueue(this, tag);
+  pending_cnt_.Inc();
+  table->Get(reader);
+}
+
+void CompletionQueueImpl::ApplyMutation(Table* table, RowMutation* mutation, void* tag) {
+  RowMutationImpl* mutation_impl = static_cast<RowMutationImpl*>(mutation);
+  CHECK(mutation_impl->GetCallBack() == NULL) << "mutation of completion queue has callback";
+  mutation_impl->SetCompletionQueue(this, tag);
+  pending_cnt_.Inc();
+  table->ApplyMutation(mutation);
+}
+
+void CompletionQueueImpl::Push(SdkTask* task) {
+  Completion completion;
+  completion.tag = task->GetCompletionTag();
+  completion.reader = NULL;
+  completion.mutation = NULL;
+  if (task->Type() == SdkTask::READ) {
+    completion.type = Completion::kRead;
+    completion.reader = static_cast<RowReaderImpl*>(task);
+  } else {
+    CHECK_EQ(task->Type(), SdkTask::MUTATION);
+    completion.type = Completion::kMutation;
+    completion.mutation = static_cast<RowMutationImpl*>(task);
+  }
+
+  MutexLock lock(&mutex_);
+  done_list_.push_back(completion);
+  if (done_list_.size() == 1) {
+    uint64_t one = 1;
+    ssize_t ret = write(notify_fd_, &one, sizeof(one));
+    (void)ret;
+  }
+  cond_.Signal();
+}
+
+int32_t CompletionQueueImpl::Next(Completion* completions, int32_t max_num, int64_t timeout_ms) {
+  int64_t deadline_ms = get_millis() + timeout_ms;
+  MutexLock lock(&mutex_);
+  while (done_list_.empty() && timeout_ms != 0) {
+    if (timeout_ms < 0) {
+      cond_.Wait();
+      continue;
+    }
+    int64_t wait_ms = deadline_ms - get_millis();
+    if (wait_ms <= 0) {
+      break;
+    }
+    cond_.TimeWait(wait_ms, "CompletionQueueNext");
+  }
+
+  int32_t num = 0;
+  while (num < max_num && !done_list_.empty()) {
+    completions[num++] = done_list_.front();
+    done_list_.pop_front();
+  }
+  if (done_list_.empty()) {
+    ClearNotify();
+  }
+  pending_cnt_.Sub(num);
+  return num;
+}
+
+void CompletionQueueImpl::ClearNotify() {
+  mutex_.AssertHeld();
+  uint64_t value = 0;
+  ssize_t ret = read(notify_fd_, &value, sizeof(value));
+  (void)ret;
+}
+
+}  // namespace tera
@@ -0,0 +1,44 @@
+// Copyright (c) 2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TERA_SDK_COMPLETION_QUEUE_IMPL_H_
+#define TERA_SDK_COMPLETION_QUEUE_IMPL_H_
+
+#include <deque>
+
+#include "common/mutex.h"
+#include "common/counter.h"
+#include "sdk/sdk_task.h"
+#include "tera/completion_queue.h"
+
+namespace tera {
+
+class CompletionQueueImpl : public CompletionQueue {
+ public:
+  CompletionQueueImpl();
+  virtual ~CompletionQueueImpl();
+
+  virtual void Get(Table* table, RowReader* reader, void* tag);
+  virtual void ApplyMutation(Table* table, RowMutation* mutation, void* tag);
+  virtual int32_t Next(Completion* completions, int32_t max_num, int64_t timeout_ms);
+  virtual int NotifyFd() { return notify_fd_; }
+  virtual int64_t PendingNum() { return pending_cnt_.Get(); }
+
+  // Called by sdk instead of user callback once |task| is finished.
+  void Push(SdkTask* task);
+
+ private:
+  void ClearNotify();
+
+ private:
+  Mutex mutex_;
+  CondVar cond_;
+  std::deque<Completion> done_list_;
+  int notify_fd_;  // eventfd, readable iff done_list_ is not empty
+  Counter pending_cnt_;
+};
+
+}  // namespace tera
+
+#endif  // TERA_SDK_COMPLETION_QUEUE_IMPL_H_
@@ -4,6 +4,7 @@
 //
 // Author: baorenyi@baidu.com
 
+#include <algorithm>
 #include <functional>
 #include <thread>
 
@@ -22,6 +23,8 @@ DECLARE_int32(tera_gtxn_get_waited_times_limit);
 DECLARE_int32(tera_gtxn_commit_timeout_ms);
 DECLARE_int32(tera_gtxn_timeout_ms);
 DECLARE_bool(tera_sdk_tso_client_enabled);
+DECLARE_int32(tera_gtxn_prewrite_max_inflight_rows);
+DECLARE_bool(tera_gtxn_async_commit_secondaries);
 
 namespace tera {
 
@@ -49,6 +52,7 @@ Transaction* GlobalTxn::NewGlobalTxn(std::shared_ptr<tera::ClientImpl> client_im
   if (client_impl && thread_pool != NULL) {
     std::shared_ptr<GlobalTxn> global_txn_shared_ptr(
         new GlobalTxn(client_impl, thread_pool, tso_cluster));
+    global_txn_shared_ptr->self_ = global_txn_shared_ptr;
     return new tera::TransactionWrapper<GlobalTxn>(global_txn_shared_ptr);
   }
   LOG(ERROR) << "client_impl or tso_cluster is NULL";
@@ -60,6 +64,9 @@ GlobalTxn::GlobalTxn(std::shared_ptr<tera::ClientImpl> client_impl, common::Thre
     : gtxn_internal_(new GlobalTxnInternal(client_impl)),
       status_returned_(false),
       primary_write_(NULL),
+      prewrite_iterator_(writes_.end()),
+      prewrite_inflight_(0),
+      prewrite_failed_(false),
       writes_size_(0),
       commit_ts_(0),
       isolation_level_(IsolationLevel::kSnapshot),
@@ -73,15 +80,15 @@ GlobalTxn::GlobalTxn(std::shared_ptr<tera::ClientImpl> client_impl, common::Thre
       tso_cluster_(tso_cluster),
       commit_timeout_ms_(FLAGS_tera_gtxn_commit_timeout_ms),
       ttl_timestamp_ms_(FLAGS_tera_gtxn_timeout_ms + get_millis()),
-      all_task_pushed_(false) {
+      all_task_pushed_(false),
+      async_secondaries_(false) {
   if (FLAGS_tera_gtxn_test_opened) {
     VLOG(12) << "conf_file = " << FLAGS_tera_gtxn_test_flagfile;
     start_ts_ = gtxn_internal_->TEST_Init(FLAGS_tera_gtxn_test_flagfile);
   } else if (!FLAGS_tera_sdk_tso_client_enabled) {
     start_ts_ = get_micros();
   } else {
-    timeoracle::TimeoracleClientImpl tsoc(thread_pool_, tso_cluster_);
-    start_ts_ = tsoc.GetTimestamp(1);
+    start_ts_ = gtxn_internal_->GetTimestamp(thread_pool_, tso_cluster_);
     if (start_ts_ == 0) {
       status_.SetFailed(ErrorCode::kGTxnTimestampLost);
       status_returned_ = true;
@@ -208,8 +215,8 @@ void GlobalTxn::DoGetCellReaderCallback(RowReader* reader) {
     MergeCellToRow(reader, status);
     return;
   }
-  // local check lock
-  if (gtxn_internal_->IsLockedByOthers(row, *cell)) {
+  // local check lock, lock of a committed txn is resolved without reread
+  if (gtxn_internal_->IsLockedByOthers(row, *cell) && !ResolveCommittedLock(&row, *cell)) {
     // sync operate
     status.SetFailed(ErrorCode::kOK);
     InternalReaderContext* internal_reader_ctx = ctx->internal_reader_ctx;
@@ -334,6 +341,46 @@ bool GlobalTxn::FindValueFromResultRow(RowReader::TRow& result_row, Cell* target
   return false;
 }
 
+bool GlobalTxn::ResolveCommittedLock(RowReader::TRow* row, const Cell& cell) {
+  RowReader::TColumn& lock_col = (*row)[cell.ColFamily()][cell.LockName()];
+  auto lock_it = lock_col.lower_bound(start_ts_);
+  if (lock_it == lock_col.begin()) {
+    return false;
+  }
+  --lock_it;
+  int lock_type = -1;
+  tera::PrimaryInfo primary_info;
+  // primary's lock is removed when it is committed
+  if (!DecodeLockValue(lock_it->second, &lock_type, &primary_info) ||
+      gtxn_internal_->IsPrimary(cell, primary_info)) {
+    return false;
+  }
+  ErrorCode status;
+  int64_t commit_ts = gtxn_internal_->PrimaryCommitTimestamp(primary_info, &status);
+  if (commit_ts < 0) {
+    return false;
+  }
+  VLOG(12) << gtxn_internal_->DebugString(
+      cell, "[gtxn][get][" + std::to_string(start_ts_) + "] resolve lock, primary committed @" +
+                std::to_string(commit_ts));
+  gtxn_read_rollforward_cnt.Inc();
+  const std::string& write_value = EncodeWriteValue(lock_type, primary_info.gtxn_start_ts());
+  RowMutation* mu = cell.Table()->NewRowMutation(cell.RowKey());
+  mu->Put(cell.ColFamily(), cell.WriteName(), write_value, commit_ts);
+  mu->DeleteColumns(cell.ColFamily(), cell.LockName(), commit_ts);
+  mu->SetCallBack([](RowMutation* row_mu) {
+    if (row_mu->GetError().GetType() != tera::ErrorCode::kOK) {
+      LOG(WARNING) << "[gtxn][get] roll forward failed, " << row_mu->GetError().ToString();
+    }
+    delete row_mu;
+  });
+  cell.Table()->ApplyMutation(mu);
+
+  (*row)[cell.ColFamily()][cell.WriteName()][commit_ts] = write_value;
+  lock_col.erase(lock_it);
+  return !gtxn_internal_->IsLockedByOthers(*row, cell);
+}
+
 void GlobalTxn::BackoffAndMaybeCleanupLock(RowReader::TRow& row, const Cell& cell,
                                            const bool try_clean, ErrorCode* status) {
   VLOG(12) << gtxn_internal_->DebugString(
@@ -592,8 +639,7 @@ void GlobalTxn::InternalCommit() {
     } else if (!FLAGS_tera_sdk_tso_client_enabled) {
       start_ts_ = get_micros();
     } else {
-      timeoracle::TimeoracleClientImpl tsoc(thread_pool_, tso_cluster_);
-      prewrite_start_ts_ = tsoc.GetTimestamp(1);
+      prewrite_start_ts_ = gtxn_internal_->GetTimestamp(thread_pool_, tso_cluster_);
     }
     if (prewrite_start_ts_ < start_ts_) {
       ErrorCode status;
@@ -613,7 +659,32 @@ void GlobalTxn::InternalCommit() {
   primary_write_ = &(prewrite_iterator_->second[0]);
   primary_write_->Serialize(prewrite_start_ts_, gtxn_internal_->GetClientSession(),
                             &serialized_primary_);
-  AsyncPrewrite(&prewrite_iterator_->second);
+  {
+    MutexLock lock(&mu_);
+    ++prewrite_inflight_;
+    ++prewrite_iterator_;
+  }
+  AsyncPrewrite(&(writes_.begin()->second));
+}
+
+void GlobalTxn::LaunchPrewrites() {
+  // at least one row in flight, or the txn never finishes
+  const int32_t max_inflight_rows = std::max(FLAGS_tera_gtxn_prewrite_max_inflight_rows, 1);
+  std::vector<std::vector<Write>*> rows;
+  {
+    MutexLock lock(&mu_);
+    while (!prewrite_failed_ && prewrite_iterator_ != writes_.end() &&
+           prewrite_inflight_ < max_inflight_rows) {
+      rows.push_back(&(prewrite_iterator_->second));
+      ++prewrite_iterator_;
+      ++prewrite_inflight_;
+    }
+  }
+  // rows are in <tablename, row_key> order, the ones of a tablet are sent
+  // back to back and packed by sdk
+  for (size_t i = 0; i < rows.size(); ++i) {
+    AsyncPrewrite(rows[i]);
+  }
 }
 
 // [prewrite] Step(1):
@@ -722,27 +793,44 @@ void GlobalTxn::DoPrewriteCallback(Transaction* single_row_txn) {
     }
     VLOG(12) << "[gtxn][prewrite][stxn_commit] failed : " << ctx->DebugString();
     RunAfterPrewriteFailed(ctx);
-  } else if (++prewrite_iterator_ != writes_.end()) {
-    thread_pool_->AddTask(
-        std::bind(&GlobalTxn::AsyncPrewrite, this, &(prewrite_iterator_->second)));
-    delete ctx;
   } else {
-    gtxn_internal_->PerfPrewriteDelay(0, get_micros());  // finish_time
-    VLOG(12) << "prewrite done, next step";
-    InternalCommitPhase2();
     delete ctx;
+    FinishPrewrite(false);
   }
 }
 
 void GlobalTxn::RunAfterPrewriteFailed(PrewriteContext* ctx) {
-  gtxn_internal_->PerfPrewriteDelay(0, get_micros());  // finish_time
-  gtxn_prewrite_fail_cnt.Inc();
   if (gtxn_internal_->IsTimeOut() || ctx->status.GetType() == ErrorCode::kTimeout) {
     ctx->status.SetFailed(ErrorCode::kGTxnPrewriteTimeout, ctx->status.ToString());
   }
   SetLastStatus(&ctx->status);
   delete ctx;
-  RunUserCallback();
+  FinishPrewrite(true);
+}
+
+void GlobalTxn::FinishPrewrite(bool failed) {
+  bool all_done = false;
+  {
+    MutexLock lock(&mu_);
+    --prewrite_inflight_;
+    prewrite_failed_ = prewrite_failed_ || failed;
+    failed = prewrite_failed_;
+    all_done = prewrite_inflight_ <= 0 && (failed || prewrite_iterator_ == writes_.end());
+  }
+  if (!all_done) {
+    if (!failed) {
+      LaunchPrewrites();
+    }
+    return;
+  }
+  gtxn_internal_->PerfPrewriteDelay(0, get_micros());  // finish_time
+  if (failed) {
+    gtxn_prewrite_fail_cnt.Inc();
+    RunUserCallback();
+  } else {
+    VLOG(12) << "prewrite done, next step";
+    InternalCommitPhase2();
+  }
 }
 
 // commit phase2 Step(1):
@@ -765,8 +853,7 @@ void GlobalTxn::InternalCommitPhase2() {
   } else if (!FLAGS_tera_sdk_tso_client_enabled) {
     commit_ts_ = get_micros();
   } else {
-    timeoracle::TimeoracleClientImpl tsoc(thread_pool_, tso_cluster_);
-    commit_ts_ = tsoc.GetTimestamp(1);
+    commit_ts_ = gtxn_internal_->GetTimestamp(thread_pool_, tso_cluster_);
   }
   if (commit_ts_ < prewrite_start_ts_) {
     LOG(ERROR) << "[gtxn][commit] get commit ts failed";
@@ -881,10 +968,25 @@ void GlobalTxn::CheckPrimaryStatusAndCommmitSecondaries(Transaction* pri_txn) {
   }
 
   all_task_pushed_ = false;
-  /// begin commit secondaries
-  for (auto& same_row_writes : writes_) {
-    thread_pool_->AddTask(
-        std::bind(&GlobalTxn::AsyncCommitSecondaries, this, &(same_row_writes.second)));
+  if (FLAGS_tera_gtxn_async_commit_secondaries && writes_cnt_.Get() > 0) {
+    // user callback will not wait for secondaries,
+    // keep this gtxn alive until they are committed
+    MutexLock lock(&mu_);
+    background_ref_ = self_.lock();
+    async_secondaries_ = (background_ref_ != NULL);
+  }
+  /// begin commit secondaries, one task for rows of each table
+  std::vector<std::vector<Write>*> same_table_rows;
+  for (auto it = writes_.begin(); it != writes_.end(); ++it) {
+    if (!same_table_rows.empty() && same_table_rows[0]->begin()->TableName() != it->first.first) {
+      thread_pool_->AddTask(
+          std::bind(&GlobalTxn::AsyncCommitSecondaries, this, same_table_rows));
+      same_table_rows.clear();
+    }
+    same_table_rows.push_back(&(it->second));
+  }
+  if (!same_table_rows.empty()) {
+    thread_pool_->AddTask(std::bind(&GlobalTxn::AsyncCommitSecondaries, this, same_table_rows));
   }
 
   /// begin ack
@@ -896,18 +998,29 @@ void GlobalTxn::CheckPrimaryStatusAndCommmitSecondaries(Transaction* pri_txn) {
     thread_pool_->AddTask(std::bind(&GlobalTxn::AsyncNotify, this, &(same_row_notifies.second)));
   }
   bool should_callback = false;
+  std::shared_ptr<GlobalTxn> self;
   {
     MutexLock lock(&mu_);
     all_task_pushed_ = true;
-    should_callback = commit_secondaries_done_cnt_.Get() == writes_cnt_.Get() &&
-                      acks_cnt_.Get() == ack_done_cnt_.Get() &&
-                      notifies_cnt_.Get() == notify_done_cnt_.Get() && all_task_pushed_ == true;
+    if (commit_secondaries_done_cnt_.Get() == writes_cnt_.Get()) {
+      self.swap(background_ref_);
+    }
+    should_callback = SecondariesWaitedDone() && acks_cnt_.Get() == ack_done_cnt_.Get() &&
+                      notifies_cnt_.Get() == notify_done_cnt_.Get();
   }
   if (should_callback) {
     RunUserCallback();
   }
 }
 
+bool GlobalTxn::SecondariesWaitedDone() const {
+  mu_.AssertHeld();
+  if (async_secondaries_) {
+    return all_task_pushed_;
+  }
+  return commit_secondaries_done_cnt_.Get() == writes_cnt_.Get();
+}
+
 void GlobalTxn::AsyncAck(std::vector<Write>* ws) {
   gtxn_internal_->PerfAckDelay(get_micros(), 0);
   gtxn_acks_cnt.Inc();
@@ -937,7 +1050,7 @@ void GlobalTxn::DoAckCallback(RowMutation* mutation) {
     MutexLock lock(&mu_);
     ack_done_cnt_.Inc();
     gtxn_internal_->PerfAckDelay(0, get_micros());
-    should_callback = commit_secondaries_done_cnt_.Get() == writes_cnt_.Get() &&
+    should_callback = SecondariesWaitedDone() &&
                       acks_cnt_.Get() == ack_done_cnt_.Get() &&
                       notifies_cnt_.Get() == notify_done_cnt_.Get();
   }
@@ -977,7 +1090,7 @@ void GlobalTxn::DoNotifyCallback(RowMutation* mutation) {
     MutexLock lock(&mu_);
     notify_done_cnt_.Inc();
     gtxn_internal_->PerfNotifyDelay(0, get_micros());
-    should_callback = commit_secondaries_done_cnt_.Get() == writes_cnt_.Get() &&
+    should_callback = SecondariesWaitedDone() &&
                       acks_cnt_.Get() == ack_done_cnt_.Get() &&
                       notifies_cnt_.Get() == notify_done_cnt_.Get() && all_task_pushed_ == true;
   }
@@ -987,20 +1100,25 @@ void GlobalTxn::DoNotifyCallback(RowMutation* mutation) {
   }
 }
 
-void GlobalTxn::AsyncCommitSecondaries(std::vector<Write>* ws) {
-  gtxn_internal_->PerfSecondariesCommitDelay(get_micros(), 0);  // begin time
-  gtxn_secondaries_cnt.Inc();
-  assert(ws->size() > 0);
-  Write w = *(ws->begin());
-  Table* table = w.Table();
-  RowMutation* mu = table->NewRowMutation(w.RowKey());
-  gtxn_internal_->SetInternalSdkTaskTimeout(mu);
-  gtxn_internal_->BuildRowMutationForCommit(ws, mu, commit_ts_);
-  mu->SetCallBack([](RowMutation* row_mu) {
-    ((GlobalTxn*)row_mu->GetContext())->DoCommitSecondariesCallback(row_mu);
-  });
-  mu->SetContext(this);
-  table->ApplyMutation(mu);
+void GlobalTxn::AsyncCommitSecondaries(std::vector<std::vector<Write>*> same_table_rows) {
+  assert(same_table_rows.size() > 0);
+  Table* table = same_table_rows[0]->begin()->Table();
+  std::vector<RowMutation*> mutations;
+  for (size_t i = 0; i < same_table_rows.size(); ++i) {
+    std::vector<Write>* ws = same_table_rows[i];
+    assert(ws->size() > 0);
+    gtxn_internal_->PerfSecondariesCommitDelay(get_micros(), 0);  // begin time
+    gtxn_secondaries_cnt.Inc();
+    RowMutation* mu = table->NewRowMutation(ws->begin()->RowKey());
+    gtxn_internal_->SetInternalSdkTaskTimeout(mu);
+    gtxn_internal_->BuildRowMutationForCommit(ws, mu, commit_ts_);
+    mu->SetCallBack([](RowMutation* row_mu) {
+      ((GlobalTxn*)row_mu->GetContext())->DoCommitSecondariesCallback(row_mu);
+    });
+    mu->SetContext(this);
+    mutations.push_back(mu);
+  }
+  table->ApplyMutation(mutations);
 }
 
 void GlobalTxn::DoCommitSecondariesCallback(RowMutation* mutation) {
@@ -1011,13 +1129,20 @@ void GlobalTxn::DoCommitSecondariesCallback(RowMutation* mutation) {
   delete mutation;
 
   bool should_callback = false;
+  // may be the last reference of this gtxn, release it after all
+  std::shared_ptr<GlobalTxn> self;
   {
     MutexLock lock(&mu_);
     commit_secondaries_done_cnt_.Inc();
     gtxn_internal_->PerfSecondariesCommitDelay(0, get_micros());  // finish time
-    should_callback = commit_secondaries_done_cnt_.Get() == writes_cnt_.Get() &&
+    bool secondaries_done =
+        commit_secondaries_done_cnt_.Get() == writes_cnt_.Get() && all_task_pushed_ == true;
+    if (secondaries_done) {
+      self.swap(background_ref_);
+    }
+    should_callback = !async_secondaries_ && secondaries_done &&
                       acks_cnt_.Get() == ack_done_cnt_.Get() &&
-                      notifies_cnt_.Get() == notify_done_cnt_.Get() && all_task_pushed_ == true;
+                      notifies_cnt_.Get() == notify_done_cnt_.Get();
   }
 
   if (should_callback) {
@@ -8,6 +8,7 @@
 #define TERA_SDK_GLOBAL_TXN_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <set>
 #include <utility>
@@ -91,6 +92,13 @@ class GlobalTxn : public Transaction {
   // maybe call CleanLock, RollForward or wait some times
   //
   // if try_clean == true will be CleanLock not wait
+  // the newest lock of "cell" before start_ts_ is left by a txn which
+  // primary is committed: roll forward "cell" in background and patch "row"
+  // as if it was committed, so no backoff and reread is needed.
+  //
+  // return true if "row" is not locked by others any more
+  bool ResolveCommittedLock(RowReader::TRow* row, const Cell& cell);
+
   void BackoffAndMaybeCleanupLock(RowReader::TRow& row, const Cell& cell, const bool try_clean,
                                   ErrorCode* status);
   void CleanLock(const Cell& cell, const tera::PrimaryInfo& primary, ErrorCode* status,
@@ -118,6 +126,11 @@ class GlobalTxn : public Transaction {
   // do [commit phase1], [commit phase2] will begin at callback
   void InternalCommit();
 
+  // start prewrites of next rows, keep at most
+  // FLAGS_tera_gtxn_prewrite_max_inflight_rows rows in flight.
+  // the primary row is prewritten alone before any secondary
+  void LaunchPrewrites();
+
   // [prewrite] Step(1):
   //      read "data", "lock", "write" column from tera
   //
@@ -139,6 +152,8 @@ class GlobalTxn : public Transaction {
   // call by [prewrite] step(2), through single_row_txn commit callback
   void DoPrewriteCallback(Transaction* single_row_txn);
   void RunAfterPrewriteFailed(PrewriteContext* ctx);
+  // the last finished prewrite goes on to [commit] or fails the gtxn
+  void FinishPrewrite(bool failed);
 
   // --------------------- begin commit phase2 ---------------------- //
 
@@ -160,13 +175,22 @@ class GlobalTxn : public Transaction {
   void CheckPrimaryStatusAndCommmitSecondaries(Transaction* primary_single_txn);
 
   // commit phase2 Step(2):
-  //      async commit secondaries writes through RowMutaion
+  //      async commit secondaries writes through RowMutaion,
+  //      rows of one table are applied together, so that sdk packs rows
+  //      of the same tablet into one rpc
   //
   // call by [commit phase2] step(1)
-  void AsyncCommitSecondaries(std::vector<Write>* same_row_writes);
+  void AsyncCommitSecondaries(std::vector<std::vector<Write>*> same_table_rows);
 
+  // after all secondaries are committed in background,
+  // release the reference which holds this gtxn alive
   void DoCommitSecondariesCallback(RowMutation* mutation);
 
+  // REQUIRES: mu_ held
+  // user callback waits for all secondaries committed,
+  // or only all of them launched if they are committed in background
+  bool SecondariesWaitedDone() const;
+
   // commit phase2 Step(3):
   //      async do ack through RowMutaion
   //
@@ -210,7 +234,9 @@ class GlobalTxn : public Transaction {
 
   Write* primary_write_;
   WriterMap writes_;
-  WriterMap::iterator prewrite_iterator_;
+  WriterMap::iterator prewrite_iterator_;  // next row to prewrite
+  int64_t prewrite_inflight_;               // guarded by mu_
+  bool prewrite_failed_;                    // guarded by mu_
   int64_t writes_size_;
 
   int64_t start_ts_;
@@ -247,6 +273,11 @@ class GlobalTxn : public Transaction {
   Counter acks_cnt_;
   Counter notifies_cnt_;
   std::atomic<bool> all_task_pushed_;
+
+  // see FLAGS_tera_gtxn_async_commit_secondaries
+  std::weak_ptr<GlobalTxn> self_;
+  bool async_secondaries_;                     // guarded by mu_
+  std::shared_ptr<GlobalTxn> background_ref_;  // guarded by mu_
 };
 
 }  // namespace tera
@@ -273,6 +273,41 @@ bool GlobalTxnInternal::PrimaryIsLocked(const tera::PrimaryInfo& primary, const
   return false;
 }
 
+int64_t GlobalTxnInternal::PrimaryCommitTimestamp(const tera::PrimaryInfo& primary,
+                                                  ErrorCode* status) {
+  Table* table = FindTable(primary.table_name());
+  if (table == NULL) {
+    status->SetFailed(ErrorCode::kGTxnPrimaryLost, "not found primary table and open failed");
+    return -1;
+  }
+  const Cell& cell = Cell(table, primary.row_key(), primary.column_family(), primary.qualifier());
+
+  std::unique_ptr<RowReader> reader(table->NewRowReader(cell.RowKey()));
+  reader->AddColumn(cell.ColFamily(), cell.WriteName());
+  // primary is committed after its prewrite
+  reader->SetTimeRange(primary.gtxn_start_ts(), kMaxTimeStamp);
+  reader->SetMaxVersions(UINT32_MAX);
+  table->Get(reader.get());
+
+  if (reader->GetError().GetType() != tera::ErrorCode::kOK &&
+      reader->GetError().GetType() != tera::ErrorCode::kNotFound) {
+    *status = reader->GetError();
+    return -1;
+  }
+  while (!reader->Done()) {
+    int write_type;
+    int64_t data_ts;
+    if (DecodeWriteValue(reader->Value(), &write_type, &data_ts) &&
+        data_ts == primary.gtxn_start_ts()) {
+      VLOG(12) << DebugString(cell, "other transaction committed @" +
+                                        std::to_string(reader->Timestamp()));
+      return reader->Timestamp();
+    }
+    reader->Next();
+  }
+  return -1;
+}
+
 void GlobalTxnInternal::BuildRowReaderForPrewrite(const std::vector<Write>& ws, RowReader* reader) {
   for (auto& w : ws) {
     reader->AddColumn(w.ColFamily(), w.DataName());
@@ -444,6 +479,16 @@ bool GlobalTxnInternal::IsGTxnColumnFamily(const std::string& tablename,
 
 std::string GlobalTxnInternal::GetClientSession() { return client_impl_->ClientSession(); }
 
+int64_t GlobalTxnInternal::GetTimestamp(common::ThreadPool* thread_pool,
+                                        sdk::ClusterFinder* tso_cluster) {
+  timeoracle::TimestampBatcher* batcher = client_impl_ ? client_impl_->GetTimestampBatcher() : NULL;
+  if (batcher != NULL) {
+    return batcher->GetTimestamp();
+  }
+  timeoracle::TimeoracleClientImpl tsoc(thread_pool, tso_cluster);
+  return tsoc.GetTimestamp(1);
+}
+
 std::string GlobalTxnInternal::DebugString(const Cell& cell, const std::string& msg) const {
   std::stringstream ss;
   ss << msg << " @ [" << cell.Table()->GetName() << ":" << cell.RowKey() << ":" << cell.ColFamily()
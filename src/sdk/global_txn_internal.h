@@ -258,6 +258,10 @@ class GlobalTxnInternal {
   bool PrimaryIsLocked(const tera::PrimaryInfo& primary_info, const int64_t lock_ts,
                        ErrorCode* status);
 
+  // commit ts of the txn which primary is "primary_info",
+  // return -1 if the primary is not committed or read failed
+  int64_t PrimaryCommitTimestamp(const tera::PrimaryInfo& primary_info, ErrorCode* status);
+
   bool IsLockedByOthers(RowReader::TRow& row, const tera::Cell& cell);
 
   bool SuspectLive(const tera::PrimaryInfo& primary_info);
@@ -295,6 +299,10 @@ class GlobalTxnInternal {
   // for other transaction alive
   std::string GetClientSession();
 
+  // one timestamp from timeoracle, batched with other txns of the client
+  // if enabled, return 0 if failed
+  int64_t GetTimestamp(common::ThreadPool* thread_pool, sdk::ClusterFinder* tso_cluster);
+
  private:
   // for pref
   void UpdateTimerCounter(Counter* c) { c->Set(get_micros() - c->Get()); }
@@ -4,6 +4,7 @@
 
 #include "common/base/string_format.h"
 #include "io/coding.h"
+#include "sdk/completion_queue_impl.h"
 #include "sdk/mutate_impl.h"
 #include "sdk/sdk_utils.h"
 #include "common/timer.h"
@@ -251,7 +252,7 @@ void* RowMutationImpl::GetContext() { return user_context_; }
 const ErrorCode& RowMutationImpl::GetError() { return error_code_; }
 
 /// 是否异步操作
-bool RowMutationImpl::IsAsync() { return (callback_ != NULL); }
+bool RowMutationImpl::IsAsync() { return (callback_ != NULL || GetCompletionQueue() != NULL); }
 
 /// 异步操作是否完成
 bool RowMutationImpl::IsFinished() const {
@@ -306,6 +307,8 @@ void RowMutationImpl::RunCallback() {
   }
   if (callback_) {
     callback_(this);
+  } else if (GetCompletionQueue() != NULL) {
+    GetCompletionQueue()->Push(this);
   } else {
     MutexLock lock(&finish_mutex_);
     finish_ = true;
@@ -4,6 +4,7 @@
 
 #include "sdk/read_impl.h"
 #include "sdk/table_impl.h"
+#include "sdk/completion_queue_impl.h"
 
 namespace tera {
 
@@ -226,7 +227,7 @@ void RowReaderImpl::SetError(ErrorCode::ErrorCodeType err, const std::string& re
   error_code_.SetFailed(err, reason);
 }
 
-bool RowReaderImpl::IsAsync() { return (callback_ != NULL); }
+bool RowReaderImpl::IsAsync() { return (callback_ != NULL || GetCompletionQueue() != NULL); }
 
 int64_t RowReaderImpl::TimeOut() { return timeout_ms_; }
 
@@ -236,6 +237,8 @@ void RowReaderImpl::RunCallback() {
   }
   if (callback_) {
     callback_(this);
+  } else if (GetCompletionQueue() != NULL) {
+    GetCompletionQueue()->Push(this);
   } else {
     MutexLock lock(&finish_mutex_);
     finish_ = true;
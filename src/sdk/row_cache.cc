@@ -0,0 +1,165 @@
+// Copyright (c) 2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sdk/row_cache.h"
+
+#include <functional>
+
+#include "common/timer.h"
+
+namespace tera {
+
+RowCache::RowCache(int64_t capacity, int32_t shard_num, int64_t ttl_ms)
+    : shard_capacity_(capacity / (shard_num > 0 ? shard_num : 1)), ttl_ms_(ttl_ms) {
+  if (shard_num <= 0) {
+    shard_num = 1;
+  }
+  for (int32_t i = 0; i < shard_num; ++i) {
+    shards_.emplace_back(new Shard);
+  }
+}
+
+RowCache::~RowCache() {}
+
+RowCache::Shard* RowCache::GetShard(const std::string& key) {
+  size_t hash = std::hash<std::string>()(key);
+  return shards_[hash % shards_.size()].get();
+}
+
+void RowCache::EraseEntry(Shard* shard, EntryList::iterator it) {
+  shard->mutex.AssertHeld();
+  shard->usage -= it->charge;
+  shard->index.erase(it->key);
+  shard->lru.erase(it);
+}
+
+bool RowCache::Lookup(const std::string& key, const std::string& tablet, RowResult* result,
+                      bool* found) {
+  TabletState state;
+  GetTabletState(tablet, &state);
+  Shard* shard = GetShard(key);
+  MutexLock lock(&shard->mutex);
+  auto index_it = shard->index.find(key);
+  if (index_it == shard->index.end()) {
+    miss_cnt_.Inc();
+    return false;
+  }
+  EntryList::iterator it = index_it->second;
+  if (it->tablet != tablet || it->server_addr != state.server_addr ||
+      it->write_ts < state.write_ts || it->expire_time_ms < get_millis()) {
+    EraseEntry(shard, it);
+    stale_cnt_.Inc();
+    miss_cnt_.Inc();
+    return false;
+  }
+  shard->lru.splice(shard->lru.begin(), shard->lru, it);
+  *found = it->found;
+  if (it->found) {
+    result->CopyFrom(it->result);
+  }
+  hit_cnt_.Inc();
+  return true;
+}
+
+void RowCache::Insert(const std::string& key, const std::string& tablet,
+                      const std::string& server_addr, int64_t write_ts, const RowResult* result) {
+  UpdateTabletWriteTs(tablet, server_addr, write_ts);
+  TabletState state;
+  GetTabletState(tablet, &state);
+  if (state.server_addr != server_addr || write_ts < state.write_ts) {
+    // a newer write or a move of the tablet has been observed, the result is
+    // stale already
+    return;
+  }
+  int64_t charge = key.size() + tablet.size() + sizeof(Entry);
+  if (result != NULL) {
+    charge += result->SpaceUsed();
+  }
+  if (charge > shard_capacity_) {
+    return;
+  }
+
+  Shard* shard = GetShard(key);
+  MutexLock lock(&shard->mutex);
+  auto index_it = shard->index.find(key);
+  if (index_it != shard->index.end()) {
+    EraseEntry(shard, index_it->second);
+  }
+  shard->lru.push_front(Entry());
+  Entry& entry = shard->lru.front();
+  entry.key = key;
+  entry.tablet = tablet;
+  entry.server_addr = server_addr;
+  entry.write_ts = write_ts;
+  entry.expire_time_ms = get_millis() + ttl_ms_;
+  entry.found = (result != NULL);
+  if (result != NULL) {
+    entry.result.CopyFrom(*result);
+  }
+  entry.charge = charge;
+  shard->index[key] = shard->lru.begin();
+  shard->usage += charge;
+
+  while (shard->usage > shard_capacity_ && !shard->lru.empty()) {
+    EraseEntry(shard, --shard->lru.end());
+  }
+}
+
+void RowCache::Erase(const std::string& key) {
+  Shard* shard = GetShard(key);
+  MutexLock lock(&shard->mutex);
+  auto index_it = shard->index.find(key);
+  if (index_it != shard->index.end()) {
+    EraseEntry(shard, index_it->second);
+  }
+}
+
+void RowCache::UpdateTabletWriteTs(const std::string& tablet, const std::string& server_addr,
+                                   int64_t write_ts) {
+  {
+    ReadLock lock(&tablet_mutex_);
+    auto it = tablet_state_.find(tablet);
+    if (it != tablet_state_.end() && it->second.server_addr == server_addr &&
+        it->second.write_ts >= write_ts) {
+      return;
+    }
+  }
+  WriteLock lock(&tablet_mutex_);
+  TabletState& state = tablet_state_[tablet];
+  if (state.server_addr != server_addr) {
+    // clocks of tabletnodes are not comparable, start over on the new server
+    // and leave entries filled on the old one to be dropped on lookup
+    state.server_addr = server_addr;
+    state.write_ts = write_ts;
+  } else if (state.write_ts < write_ts) {
+    state.write_ts = write_ts;
+  }
+}
+
+int64_t RowCache::GetTabletWriteTs(const std::string& tablet) {
+  TabletState state;
+  GetTabletState(tablet, &state);
+  return state.write_ts;
+}
+
+bool RowCache::GetTabletState(const std::string& tablet, TabletState* state) {
+  ReadLock lock(&tablet_mutex_);
+  auto it = tablet_state_.find(tablet);
+  if (it == tablet_state_.end()) {
+    return false;
+  }
+  *state = it->second;
+  return true;
+}
+
+int64_t RowCache::Usage() {
+  int64_t usage = 0;
+  for (auto& shard : shards_) {
+    MutexLock lock(&shard->mutex);
+    usage += shard->usage;
+  }
+  return usage;
+}
+
+}  // namespace tera
@@ -0,0 +1,111 @@
+// Copyright (c) 2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TERA_SDK_ROW_CACHE_H_
+#define TERA_SDK_ROW_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/counter.h"
+#include "common/mutex.h"
+#include "common/rwmutex.h"
+#include "proto/tabletnode_rpc.pb.h"
+
+namespace tera {
+
+// Client side cache of RowReader results for hot rows.
+//
+// An entry is keyed by row + column selection (see TableImpl::RowCacheKey) and
+// remembers which tablet served it, on which tabletnode, and the tablet's last
+// write timestamp at read time. Tabletnodes piggyback this timestamp on every
+// read/write response, once a newer timestamp of the tablet is seen, all
+// entries filled before it are treated as stale. The timestamp is the clock of
+// the serving tabletnode, so it's only compared within one server: once the
+// tablet is seen on another server, all its entries are dropped. Writes from
+// other clients which never pass through this sdk are only bounded by ttl.
+class RowCache {
+ public:
+  // |capacity| is the total byte limit of all shards.
+  RowCache(int64_t capacity, int32_t shard_num, int64_t ttl_ms);
+  ~RowCache();
+
+  // Returns true if |key| is cached and still valid. |found| is set to false if
+  // the row is cached as not exist, in which case |result| is untouched.
+  bool Lookup(const std::string& key, const std::string& tablet, RowResult* result, bool* found);
+
+  // |result| == NULL means the row does not exist.
+  void Insert(const std::string& key, const std::string& tablet, const std::string& server_addr,
+              int64_t write_ts, const RowResult* result);
+
+  void Erase(const std::string& key);
+
+  // Record a write timestamp of |tablet| reported by tabletnode |server_addr|.
+  void UpdateTabletWriteTs(const std::string& tablet, const std::string& server_addr,
+                           int64_t write_ts);
+
+  int64_t GetTabletWriteTs(const std::string& tablet);
+
+  int64_t Usage();
+
+  int64_t HitCount() { return hit_cnt_.Get(); }
+  int64_t MissCount() { return miss_cnt_.Get(); }
+  int64_t StaleCount() { return stale_cnt_.Get(); }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string tablet;
+    std::string server_addr;
+    int64_t write_ts;
+    int64_t expire_time_ms;
+    bool found;
+    RowResult result;
+    int64_t charge;
+  };
+  typedef std::list<Entry> EntryList;
+
+  struct TabletState {
+    std::string server_addr;
+    int64_t write_ts;
+
+    TabletState() : write_ts(0) {}
+  };
+
+  struct Shard {
+    Mutex mutex;
+    EntryList lru;  // front is the most recently used
+    std::unordered_map<std::string, EntryList::iterator> index;
+    int64_t usage;
+
+    Shard() : usage(0) {}
+  };
+
+  Shard* GetShard(const std::string& key);
+  bool GetTabletState(const std::string& tablet, TabletState* state);
+  // REQUIRES: shard->mutex held
+  void EraseEntry(Shard* shard, EntryList::iterator it);
+
+ private:
+  RowCache(const RowCache&);
+  void operator=(const RowCache&);
+
+  const int64_t shard_capacity_;
+  const int64_t ttl_ms_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  RWMutex tablet_mutex_;
+  std::unordered_map<std::string, TabletState> tablet_state_;
+
+  Counter hit_cnt_;
+  Counter miss_cnt_;
+  Counter stale_cnt_;
+};
+
+}  // namespace tera
+
+#endif  // TERA_SDK_ROW_CACHE_H_
@@ -46,6 +46,13 @@ bool RowlockStub::UnLock(const RowlockRequest* request, RowlockResponse* respons
                               rpc_timeout_, thread_pool_);
 }
 
+bool RowlockStub::BatchTryLock(
+    const BatchRowlockRequest* request, BatchRowlockResponse* response,
+    std::function<void(BatchRowlockRequest*, BatchRowlockResponse*, bool, int)> done) {
+  return SendMessageWithRetry(&RowlockService::Stub::BatchLock, request, response, done,
+                              "BatchTryLock", rpc_timeout_, thread_pool_);
+}
+
 bool RowlockClient::init_ = false;
 std::string RowlockClient::server_addr_ = "";
 
@@ -121,6 +128,27 @@ bool RowlockClient::UnLock(const RowlockRequest* request, RowlockResponse* respo
   return false;
 }
 
+bool RowlockClient::BatchTryLock(
+    const BatchRowlockRequest* request, BatchRowlockResponse* response,
+    std::function<void(BatchRowlockRequest*, BatchRowlockResponse*, bool, int)> done) {
+  std::shared_ptr<RowlockStub> client;
+  {
+    MutexLock locker(&client_mutex_);
+    // COW ref +1
+    client = client_;
+  }
+  for (int32_t i = 0; i < FLAGS_rowlock_client_max_fail_times; ++i) {
+    bool ret = client->BatchTryLock(request, response, done);
+    if (ret) {
+      return true;
+    }
+    LOG(WARNING) << "batch try lock fail, rows: " << request->rows_size();
+  }
+  // rpc fail
+  SetZkAdapter();
+  return false;
+}
+
 void RowlockClient::SetZkAdapter() {
   // mock rowlock, do not need a real zk adapter
   if (FLAGS_mock_rowlock_enable == true) {
@@ -36,6 +36,10 @@ class RowlockStub : public tera::RpcClient<RowlockService::Stub> {
       const RowlockRequest* request, RowlockResponse* response,
       std::function<void(RowlockRequest*, RowlockResponse*, bool, int)> done = NULL);
 
+  virtual bool BatchTryLock(
+      const BatchRowlockRequest* request, BatchRowlockResponse* response,
+      std::function<void(BatchRowlockRequest*, BatchRowlockResponse*, bool, int)> done = NULL);
+
  private:
   int32_t rpc_timeout_;
   static ThreadPool* thread_pool_;
@@ -56,6 +60,11 @@ class RowlockClient {
       const RowlockRequest* request, RowlockResponse* response,
       std::function<void(RowlockRequest*, RowlockResponse*, bool, int)> done = NULL);
 
+  // lock status of each row is in response, in the same order of request
+  virtual bool BatchTryLock(
+      const BatchRowlockRequest* request, BatchRowlockResponse* response,
+      std::function<void(BatchRowlockRequest*, BatchRowlockResponse*, bool, int)> done = NULL);
+
   void Update(const std::vector<std::string>& addrs);
 
  private:
@@ -94,6 +103,15 @@ class FakeRowlockClient : public RowlockClient {
 
     return true;
   }
+
+  virtual bool BatchTryLock(
+      const BatchRowlockRequest* request, BatchRowlockResponse* response,
+      std::function<void(BatchRowlockRequest*, BatchRowlockResponse*, bool, int)> done = NULL) {
+    for (int i = 0; i < request->rows_size(); ++i) {
+      response->add_lock_status(kLockSucc);
+    }
+    return true;
+  }
 };
 
 }  // namespace observer
@@ -41,6 +41,10 @@ void ScanDescriptor::SetNumberLimit(int64_t number_limit) { impl_->SetNumberLimi
 
 int64_t ScanDescriptor::GetNumberLimit() { return impl_->GetNumberLimit(); }
 
+void ScanDescriptor::SetParallelism(int32_t parallelism, bool ordered) {
+  impl_->SetParallelism(parallelism, ordered);
+}
+
 ScanDescImpl* ScanDescriptor::GetImpl() const { return impl_; }
 
 }  // namespace tera
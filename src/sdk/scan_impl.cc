@@ -16,6 +16,7 @@
 #include "sdk/filter_utils.h"
 #include "sdk/sdk_utils.h"
 #include "sdk/table_impl.h"
+#include "utils/string_util.h"
 #include "common/atomic.h"
 #include "common/timer.h"
 
@@ -30,7 +31,8 @@ DECLARE_bool(debug_tera_sdk_scan);
 
 namespace tera {
 
-ResultStreamImpl::ResultStreamImpl(TableImpl* table, ScanDescImpl* scan_desc_impl)
+ResultStreamImpl::ResultStreamImpl(TableImpl* table, ScanDescImpl* scan_desc_impl,
+                                   std::function<void()> ready_callback)
     : cv_(&mu_),
       scan_desc_impl_(new ScanDescImpl(*scan_desc_impl)),
       table_ptr_(table),
@@ -39,7 +41,8 @@ ResultStreamImpl::ResultStreamImpl(TableImpl* table, ScanDescImpl* scan_desc_imp
       data_size_(0),
       row_count_(0),
       last_key_(""),
-      canceled_(false) {
+      canceled_(false),
+      ready_callback_(ready_callback) {
   // do something startup
   sliding_window_.resize(FLAGS_tera_sdk_max_batch_scan_req);
   session_end_key_ = scan_desc_impl_->GetStartRowKey();
@@ -121,7 +124,7 @@ void ResultStreamImpl::ReleaseRpcHandle(ScanTabletRequest* request, ScanTabletRe
 //          2.1. stop scan, and report error to user
 //      3. scan success, notify user to consume result
 void ResultStreamImpl::OnFinish(ScanTabletRequest* request, ScanTabletResponse* response) {
-  MutexLock mutex(&mu_);
+  mu_.Lock();
   // check session id
   if (request->session_id() != (int64_t)session_id_) {
     SCAN_LOG << "[OnFinish]session_id not match, request session id" << request->session_id();
@@ -174,7 +177,30 @@ void ResultStreamImpl::OnFinish(ScanTabletRequest* request, ScanTabletResponse*
       session_done_ = true;
     }
   }
-  return;
+  mu_.Unlock();
+  // notify without lock, the callback may check this stream again
+  if (ready_callback_) {
+    ready_callback_();
+  }
+}
+
+bool ResultStreamImpl::HasReadyResult() {
+  MutexLock mutex(&mu_);
+  if (canceled_ || session_error_ != kTabletNodeOk || ref_count_ == 1) {
+    return true;
+  }
+  const ScanSlot& slot = sliding_window_[sliding_window_idx_];
+  if (slot.state_ == SCANSLOT_INVALID) {
+    return false;
+  }
+  if (next_idx_ < slot.cell_.key_values_size()) {
+    return true;
+  }
+  if (session_done_ && session_data_idx_ == session_last_idx_) {
+    return true;
+  }
+  int32_t next_slot_idx = (sliding_window_idx_ + 1) % FLAGS_tera_sdk_max_batch_scan_req;
+  return sliding_window_[next_slot_idx].state_ == SCANSLOT_VALID;
 }
 
 void ResultStreamImpl::ComputeStartKey(const KeyValuePair& kv, KeyValuePair* start_key) {
@@ -406,6 +432,176 @@ void ResultStreamImpl::UpdateRowCount(uint32_t row_count) { row_count_ += row_co
 void ResultStreamImpl::UpdateDataSize(uint32_t data_size) { data_size_ += data_size; }
 void ResultStreamImpl::UpdateLastKey(const KeyValuePair& kv) { last_key_ = kv.key(); }
 
+///////////////////////// ParallelResultStreamImpl ///////////////////////
+ParallelResultStreamImpl::ParallelResultStreamImpl(TableImpl* table, ScanDescImpl* scan_desc_impl,
+                                                   const std::vector<std::string>& split_keys)
+    : cv_(&mu_),
+      table_ptr_(table),
+      scan_desc_impl_(new ScanDescImpl(*scan_desc_impl)),
+      parallelism_(std::max(scan_desc_impl->GetParallelism(), 1)),
+      ordered_(scan_desc_impl->IsOrdered()),
+      cur_stream_(NULL),
+      data_size_(0),
+      row_count_(0),
+      canceled_(false) {
+  std::string range_start = scan_desc_impl_->GetStartRowKey();
+  for (size_t i = 0; i < split_keys.size(); ++i) {
+    pending_ranges_.push_back(std::make_pair(range_start, split_keys[i]));
+    range_start = split_keys[i];
+  }
+  pending_ranges_.push_back(std::make_pair(range_start, scan_desc_impl_->GetEndRowKey()));
+  StartStreams();
+}
+
+ParallelResultStreamImpl::~ParallelResultStreamImpl() {
+  std::list<ResultStreamImpl*> streams;
+  {
+    MutexLock mutex(&mu_);
+    streams.swap(active_streams_);
+  }
+  // wait for the inflight rpcs of each stream
+  for (auto it = streams.begin(); it != streams.end(); ++it) {
+    delete *it;
+  }
+  delete scan_desc_impl_;
+}
+
+void ParallelResultStreamImpl::StartStreams() {
+  MutexLock mutex(&mu_);
+  while (active_streams_.size() < static_cast<size_t>(parallelism_) && !pending_ranges_.empty()) {
+    ScanDescImpl desc(*scan_desc_impl_);
+    const std::pair<std::string, std::string>& range = pending_ranges_.front();
+    // keep the start cell of user for the first range
+    if (range.first != scan_desc_impl_->GetStartRowKey()) {
+      desc.SetStart(range.first);
+    }
+    desc.SetEnd(range.second);
+    pending_ranges_.pop_front();
+    VLOG(6) << "start parallel scan [" << DebugString(desc.GetStartRowKey()) << ", "
+            << DebugString(desc.GetEndRowKey()) << ")";
+    active_streams_.push_back(new ResultStreamImpl(
+        table_ptr_, &desc, std::bind(&ParallelResultStreamImpl::OnStreamReady, this)));
+  }
+}
+
+void ParallelResultStreamImpl::FinishStream(ResultStreamImpl* stream) {
+  {
+    MutexLock mutex(&mu_);
+    active_streams_.remove(stream);
+    data_size_ += stream->GetDataSize();
+    row_count_ += stream->GetRowCount();
+    if (!stream->GetLastKey().empty()) {
+      last_key_ = stream->GetLastKey();
+    }
+  }
+  delete stream;
+  StartStreams();
+}
+
+void ParallelResultStreamImpl::OnStreamReady() {
+  MutexLock mutex(&mu_);
+  cv_.Signal();
+}
+
+ResultStreamImpl* ParallelResultStreamImpl::PickReadyStream() {
+  MutexLock mutex(&mu_);
+  while (!active_streams_.empty() && !canceled_) {
+    for (auto it = active_streams_.begin(); it != active_streams_.end(); ++it) {
+      if ((*it)->HasReadyResult()) {
+        return *it;
+      }
+    }
+    // a stream may also become ready by retry in itself, do not wait forever
+    cv_.TimeWaitInUs(10000, "ParallelScanWait");
+  }
+  return active_streams_.empty() ? NULL : active_streams_.front();
+}
+
+bool ParallelResultStreamImpl::Done(ErrorCode* error) {
+  if (error) {
+    error->SetFailed(ErrorCode::kOK);
+  }
+  while (true) {
+    if (canceled_) {
+      LOG(INFO) << "This scan is cancelled.\n";
+      return true;
+    }
+    // unordered, leave the stream which is waiting for rpc
+    if (!ordered_ && cur_stream_ != NULL && !cur_stream_->HasReadyResult()) {
+      cur_stream_ = NULL;
+    }
+    if (cur_stream_ == NULL) {
+      if (ordered_) {
+        MutexLock mutex(&mu_);
+        cur_stream_ = active_streams_.empty() ? NULL : active_streams_.front();
+      } else {
+        cur_stream_ = PickReadyStream();
+      }
+      if (cur_stream_ == NULL) {
+        return true;
+      }
+    }
+    ErrorCode stream_error;
+    if (!cur_stream_->Done(&stream_error)) {
+      return false;
+    }
+    if (stream_error.GetType() != ErrorCode::kOK) {
+      if (error) {
+        *error = stream_error;
+      }
+      return true;
+    }
+    FinishStream(cur_stream_);
+    cur_stream_ = NULL;
+  }
+  return true;
+}
+
+void ParallelResultStreamImpl::Next() { cur_stream_->Next(); }
+bool ParallelResultStreamImpl::LookUp(const std::string& row_key) { return true; }
+std::string ParallelResultStreamImpl::RowName() const { return cur_stream_->RowName(); }
+std::string ParallelResultStreamImpl::Family() const { return cur_stream_->Family(); }
+std::string ParallelResultStreamImpl::Qualifier() const { return cur_stream_->Qualifier(); }
+std::string ParallelResultStreamImpl::ColumnName() const { return cur_stream_->ColumnName(); }
+int64_t ParallelResultStreamImpl::Timestamp() const { return cur_stream_->Timestamp(); }
+std::string ParallelResultStreamImpl::Value() const { return cur_stream_->Value(); }
+int64_t ParallelResultStreamImpl::ValueInt64() const { return cur_stream_->ValueInt64(); }
+
+uint64_t ParallelResultStreamImpl::GetDataSize() const {
+  MutexLock mutex(&mu_);
+  uint64_t data_size = data_size_;
+  for (auto it = active_streams_.begin(); it != active_streams_.end(); ++it) {
+    data_size += (*it)->GetDataSize();
+  }
+  return data_size;
+}
+
+uint64_t ParallelResultStreamImpl::GetRowCount() const {
+  MutexLock mutex(&mu_);
+  uint64_t row_count = row_count_;
+  for (auto it = active_streams_.begin(); it != active_streams_.end(); ++it) {
+    row_count += (*it)->GetRowCount();
+  }
+  return row_count;
+}
+
+std::string ParallelResultStreamImpl::GetLastKey() const {
+  if (cur_stream_ != NULL && !cur_stream_->GetLastKey().empty()) {
+    return cur_stream_->GetLastKey();
+  }
+  MutexLock mutex(&mu_);
+  return last_key_;
+}
+
+void ParallelResultStreamImpl::Cancel() {
+  MutexLock mutex(&mu_);
+  canceled_ = true;
+  for (auto it = active_streams_.begin(); it != active_streams_.end(); ++it) {
+    (*it)->Cancel();
+  }
+  cv_.Signal();
+}
+
 ///////////////////////// ScanDescImpl ///////////////////////
 ScanDescImpl::ScanDescImpl(const string& rowkey)
     : start_timestamp_(0),
@@ -416,6 +612,8 @@ ScanDescImpl::ScanDescImpl(const string& rowkey)
       max_qualifiers_(std::numeric_limits<uint64_t>::max()),
       scan_slot_timeout_(FLAGS_tera_sdk_scan_timeout),
       snapshot_(0),
+      parallelism_(1),
+      ordered_(true),
       filter_desc_(NULL) {
   SetStart(rowkey);
 }
@@ -432,6 +630,8 @@ ScanDescImpl::ScanDescImpl(const ScanDescImpl& impl)
       max_qualifiers_(impl.max_qualifiers_),
       scan_slot_timeout_(impl.scan_slot_timeout_),
       snapshot_(impl.snapshot_),
+      parallelism_(impl.parallelism_),
+      ordered_(impl.ordered_),
       table_schema_(impl.table_schema_) {
   if (impl.GetFilterDesc()) {
     filter_desc_ = new filter::FilterDesc();
@@ -546,6 +746,15 @@ int64_t ScanDescImpl::GetBufferSize() const { return buf_size_; }
 
 int64_t ScanDescImpl::GetNumberLimit() { return number_limit_; }
 
+void ScanDescImpl::SetParallelism(int32_t parallelism, bool ordered) {
+  parallelism_ = parallelism;
+  ordered_ = ordered;
+}
+
+int32_t ScanDescImpl::GetParallelism() const { return parallelism_; }
+
+bool ScanDescImpl::IsOrdered() const { return ordered_; }
+
 void ScanDescImpl::SetTableSchema(const TableSchema& schema) { table_schema_ = schema; }
 
 bool ScanDescImpl::IsKvOnlyTable() { return IsKvTable(table_schema_); }
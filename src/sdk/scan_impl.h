@@ -5,6 +5,9 @@
 #ifndef TERA_SDK_SCAN_IMPL_H_
 #define TERA_SDK_SCAN_IMPL_H_
 
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <list>
 #include <queue>
 #include <string>
@@ -24,7 +27,8 @@ class TableImpl;
 
 class ResultStreamImpl : public ResultStream {
  public:
-  ResultStreamImpl(TableImpl* table, ScanDescImpl* scan_desc_impl);
+  ResultStreamImpl(TableImpl* table, ScanDescImpl* scan_desc_impl,
+                   std::function<void()> ready_callback = NULL);
   virtual ~ResultStreamImpl();
 
   bool LookUp(const std::string& row_key);  // TODO: result maybe search like a map
@@ -51,6 +55,7 @@ class ResultStreamImpl : public ResultStream {
                         ScanTabletResponse* response);  // free resource for scan session
   void OnFinish(ScanTabletRequest* request, ScanTabletResponse* response);  // scan callback
   std::string GetNextStartPoint(const std::string& str);                    // for session reset
+  bool HasReadyResult();  // Done() would not wait for rpc
 
  private:
   void ClearAndScanNextSlot(bool scan_next);
@@ -95,12 +100,68 @@ class ResultStreamImpl : public ResultStream {
   uint64_t row_count_;
   std::string last_key_;
   bool canceled_;
+  std::function<void()> ready_callback_;  // called after a scan result arrived
 
  private:
   ResultStreamImpl(const ResultStreamImpl&);
   void operator=(const ResultStreamImpl&);
 };
 
+// Scan tablets of [start, end) concurrently, each tablet range is served by a
+// ResultStreamImpl, at most |parallelism| of them are active at the same time.
+class ParallelResultStreamImpl : public ResultStream {
+ public:
+  // |split_keys| are the tablet boundaries inside the scan range
+  ParallelResultStreamImpl(TableImpl* table, ScanDescImpl* scan_desc_impl,
+                           const std::vector<std::string>& split_keys);
+  virtual ~ParallelResultStreamImpl();
+
+  bool LookUp(const std::string& row_key);
+  bool Done(ErrorCode* err);
+  void Next();
+
+  std::string RowName() const;
+  std::string Family() const;
+  std::string Qualifier() const;
+  std::string ColumnName() const;
+  int64_t Timestamp() const;
+  std::string Value() const;
+  int64_t ValueInt64() const;
+  uint64_t GetDataSize() const;
+  uint64_t GetRowCount() const;
+  std::string GetLastKey() const;
+  void Cancel();
+
+ private:
+  void StartStreams();
+  void FinishStream(ResultStreamImpl* stream);
+  // unordered only, wait until any active stream is ready
+  ResultStreamImpl* PickReadyStream();
+  void OnStreamReady();
+
+ private:
+  mutable Mutex mu_;
+  CondVar cv_;
+  TableImpl* table_ptr_;
+  ScanDescImpl* scan_desc_impl_;
+  int32_t parallelism_;
+  bool ordered_;
+
+  std::deque<std::pair<std::string, std::string>> pending_ranges_;
+  std::list<ResultStreamImpl*> active_streams_;  // in key order
+  ResultStreamImpl* cur_stream_;
+
+  uint64_t data_size_;  // of finished streams
+  uint64_t row_count_;
+  std::string last_key_;
+  // set under mu_, read without it by Done()
+  std::atomic<bool> canceled_;
+
+ private:
+  ParallelResultStreamImpl(const ParallelResultStreamImpl&);
+  void operator=(const ParallelResultStreamImpl&);
+};
+
 class ScanDescImpl {
  public:
   ScanDescImpl(const std::string& rowkey);
@@ -131,6 +192,8 @@ class ScanDescImpl {
 
   void SetNumberLimit(int64_t number_limit);
 
+  void SetParallelism(int32_t parallelism, bool ordered);
+
   void SetStart(const std::string& row_key, const std::string& column_family = "",
                 const std::string& qualifier = "", int64_t time_stamp = kLatestTs);
 
@@ -164,6 +227,10 @@ class ScanDescImpl {
 
   int64_t GetNumberLimit();
 
+  int32_t GetParallelism() const;
+
+  bool IsOrdered() const;
+
   void SetTableSchema(const TableSchema& schema);
 
   bool IsKvOnlyTable();
@@ -182,6 +249,8 @@ class ScanDescImpl {
   int64_t max_qualifiers_;
   int64_t scan_slot_timeout_;
   uint64_t snapshot_;
+  int32_t parallelism_;
+  bool ordered_;
   TableSchema table_schema_;
   filter::FilterDesc* filter_desc_;
 };
@@ -119,6 +119,9 @@ void TableDescriptor::SetBloomFilterBitsPerKey(uint32_t val) {
   return impl_->SetBloomFilterBitsPerKey(val);
 }
 
+uint32_t TableDescriptor::ScheduleWeight() const { return impl_->ScheduleWeight(); }
+void TableDescriptor::SetScheduleWeight(uint32_t val) { impl_->SetScheduleWeight(val); }
+
 }  // namespace tera
 
 /* vim: set expandtab ts=4 sw=4 sts=4 tw=100: */
@@ -150,7 +150,8 @@ TableDescImpl::TableDescImpl(const std::string& tb_name)
       disable_wal_(false),
       enable_txn_(false),
       enable_hash_(false),
-      bloom_filter_bits_per_key_(10) {}
+      bloom_filter_bits_per_key_(10),
+      schedule_weight_(100) {}
 
 /*
 TableDescImpl::TableDescImpl(TableDescImpl& desc) {
@@ -350,4 +351,8 @@ bool TableDescImpl::IsHashEnabled() const { return enable_hash_; }
 uint32_t TableDescImpl::BloomFilterBitsPerKey() const { return bloom_filter_bits_per_key_; }
 
 void TableDescImpl::SetBloomFilterBitsPerKey(uint32_t val) { bloom_filter_bits_per_key_ = val; }
+
+uint32_t TableDescImpl::ScheduleWeight() const { return schedule_weight_; }
+
+void TableDescImpl::SetScheduleWeight(uint32_t val) { schedule_weight_ = val; }
 }  // namespace tera
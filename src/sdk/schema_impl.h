@@ -207,6 +207,9 @@ class TableDescImpl {
   uint32_t BloomFilterBitsPerKey() const;
   void SetBloomFilterBitsPerKey(uint32_t);
 
+  uint32_t ScheduleWeight() const;
+  void SetScheduleWeight(uint32_t);
+
   static const std::string DEFAULT_LG_NAME;
   static const std::string NOTIFY_LG_NAME;
   static const std::string DEFAULT_CF_NAME;
@@ -231,6 +234,7 @@ class TableDescImpl {
   std::string admin_group_;
   std::string admin_;
   uint32_t bloom_filter_bits_per_key_;
+  uint32_t schedule_weight_;
 };
 
 }  // namespace tera
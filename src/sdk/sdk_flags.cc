@@ -9,6 +9,12 @@
 DEFINE_bool(tera_sdk_client_for_gtxn, false, "build thread_pool for global transaction");
 DEFINE_bool(tera_sdk_tso_client_enabled, false,
             "get timestamp from timeoracle, default from local timestamp");
+DEFINE_bool(tera_sdk_tso_batch_enabled, true,
+            "coalesce concurrent timestamp requests of global txns into one rpc");
+DEFINE_int32(tera_sdk_tso_batch_max_size, 1024, "max timestamps got by one timeoracle rpc");
+DEFINE_int64(tera_sdk_tso_batch_window_us, 0,
+             "(us) time to wait for more timestamp requests before a batched rpc, "
+             "requests arriving during an inflight rpc are batched anyway");
 DEFINE_int32(tera_gtxn_thread_max_num, 20,
              "the max thread number for global transaction operations");
 DEFINE_int32(tera_gtxn_commit_timeout_ms, 600000,
@@ -17,6 +23,14 @@ DEFINE_int32(tera_gtxn_get_waited_times_limit, 10, "global txn wait other locked
 DEFINE_int32(tera_gtxn_all_puts_size_limit, 10000, "(B) global txn all puts data size limit");
 DEFINE_int32(tera_gtxn_timeout_ms, 86400000,
              "global transaction timeout limit (ms) default 24 hours");
+DEFINE_int32(tera_gtxn_prewrite_max_inflight_rows, 256,
+             "the max number of rows prewriting at the same time by a global txn, "
+             "rows of the same tablet are packed into one rpc");
+DEFINE_bool(tera_gtxn_async_commit_secondaries, false,
+            "run the callback of a global txn once its primary is committed, "
+            "secondaries are committed in background and resolved by readers if lost. "
+            "tables written by global txns must be kept open as long as the client, "
+            "see Transaction::Commit()");
 
 ///////// SDK  /////////
 DEFINE_string(tera_sdk_impl_type, "tera", "the activated type of SDK impl");
@@ -67,6 +81,21 @@ DEFINE_int64(tera_sdk_max_reader_pending_num, INT64_MAX,
              "default number of pending readers in async get op");
 DEFINE_bool(tera_sdk_async_blocking_enabled, true,
             "enable blocking when async writing and reading");
+DEFINE_bool(tera_sdk_row_cache_enabled, false,
+            "enable client side row cache for hot rows, each table has its own cache");
+DEFINE_int64(tera_sdk_row_cache_size, 64, "(MB) the size limit of row cache of each table");
+DEFINE_int32(tera_sdk_row_cache_shard_num, 16, "the shard number of row cache");
+DEFINE_int64(tera_sdk_row_cache_ttl_ms, 1000,
+             "(ms) the max time a row cache entry lives without being invalidated by tabletnode");
+DEFINE_bool(tera_sdk_reader_coalesce_enabled, false,
+            "merge identical outstanding row readers of a table into one rpc row, a reader "
+            "may get the result of an identical one sent before its own earlier write, "
+            "i.e. no read-your-writes");
+DEFINE_int32(tera_sdk_rpc_pipeline_depth, 0,
+             "max inflight read/write rpcs of a table to one tabletnode, requests wait in batch "
+             "until an rpc returns, 0 means unlimited");
+DEFINE_bool(tera_sdk_rpc_inline_callback_enabled, true,
+            "run rpc callbacks of sync requests in rpc thread without a thread pool hop");
 DEFINE_int32(tera_sdk_update_meta_concurrency, 3, "the concurrency for updating meta");
 DEFINE_int32(tera_sdk_update_meta_buffer_limit, 102400,
              "(B) the pack size limit for updating meta");
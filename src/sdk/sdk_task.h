@@ -18,6 +18,8 @@
 
 namespace tera {
 
+class CompletionQueueImpl;
+
 class SdkTask {
  public:
   typedef std::function<void(SdkTask*)> TimeoutFunc;
@@ -53,6 +55,14 @@ class SdkTask {
   void SetServerAddr(const std::string& server_addr) { server_addr_ = server_addr; }
   std::string GetServerAddr() { return server_addr_; }
 
+  // if set, the finished task is delivered to |cq| instead of user callback
+  void SetCompletionQueue(CompletionQueueImpl* cq, void* tag) {
+    completion_queue_ = cq;
+    completion_tag_ = tag;
+  }
+  CompletionQueueImpl* GetCompletionQueue() { return completion_queue_; }
+  void* GetCompletionTag() { return completion_tag_; }
+
   int64_t GetRef();
   void IncRef();
   void DecRef();
@@ -82,7 +92,9 @@ class SdkTask {
         retry_times_(0),
         cond_(&mutex_),
         ref_(1),
-        server_addr_("") {}
+        server_addr_(""),
+        completion_queue_(NULL),
+        completion_tag_(NULL) {}
   virtual ~SdkTask() {}
 
  private:
@@ -98,6 +110,8 @@ class SdkTask {
   CondVar cond_;
   int64_t ref_;
   std::string server_addr_;
+  CompletionQueueImpl* completion_queue_;
+  void* completion_tag_;
 };
 
 typedef void (*StatCallback)(Table* table, SdkTask* task);
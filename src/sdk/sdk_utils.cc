@@ -121,6 +121,9 @@ void ShowTableSchema(const TableSchema& s, bool is_x) {
     if (is_x || schema.bloom_filter_bits_per_key() != 10) {
       ss << "bloom_filter_bits_per_key=" << schema.bloom_filter_bits_per_key() << ",";
     }
+    if (is_x || schema.schedule_weight() != 100) {
+      ss << "schedule_weight=" << schema.schedule_weight() << ",";
+    }
     ss << "\b>\n"
        << "  (kv mode)\n";
     str = ss.str();
@@ -153,6 +156,9 @@ void ShowTableSchema(const TableSchema& s, bool is_x) {
   if (is_x || schema.bloom_filter_bits_per_key() != 10) {
     ss << "bloom_filter_bits_per_key=" << schema.bloom_filter_bits_per_key() << ",";
   }
+  if (is_x || schema.schedule_weight() != 100) {
+    ss << "schedule_weight=" << schema.schedule_weight() << ",";
+  }
   ss << "\b> {" << std::endl;
 
   size_t lg_num = schema.locality_groups_size();
@@ -256,6 +262,7 @@ void TableDescToSchema(const TableDescriptor& desc, TableSchema* schema) {
   schema->set_enable_txn(desc.IsTxnEnabled());
   schema->set_enable_hash(desc.IsHashEnabled());
   schema->set_bloom_filter_bits_per_key(desc.BloomFilterBitsPerKey());
+  schema->set_schedule_weight(desc.ScheduleWeight());
   // add lg
   int num = desc.LocalityGroupNum();
   for (int i = 0; i < num; ++i) {
@@ -347,6 +354,9 @@ void TableSchemaToDesc(const TableSchema& schema, TableDescriptor* desc) {
   if (schema.has_bloom_filter_bits_per_key()) {
     desc->SetBloomFilterBitsPerKey(schema.bloom_filter_bits_per_key());
   }
+  if (schema.has_schedule_weight()) {
+    desc->SetScheduleWeight(schema.schedule_weight());
+  }
   int32_t lg_num = schema.locality_groups_size();
   for (int32_t i = 0; i < lg_num; i++) {
     const LocalityGroupSchema& lg = schema.locality_groups(i);
@@ -582,6 +592,12 @@ bool SetTableProperties(const string& name, const string& value, TableDescriptor
       return false;
     }
     desc->SetBloomFilterBitsPerKey(bloom_filter_bits_per_key);
+  } else if (name == "schedule_weight") {
+    uint32_t schedule_weight;
+    if (!StringToNumber(value, &schedule_weight) || schedule_weight == 0) {
+      return false;
+    }
+    desc->SetScheduleWeight(schedule_weight);
   } else {
     return false;
   }
@@ -32,6 +32,7 @@
 #include "sdk/single_row_txn.h"
 #include "sdk/scan_impl.h"
 #include "sdk/schema_impl.h"
+#include "sdk/sdk_utils.h"
 #include "sdk/sdk_zk.h"
 #include "tera.h"
 #include "utils/crypt.h"
@@ -67,6 +68,13 @@ DECLARE_int32(tera_rpc_timeout_period);
 DECLARE_string(tera_auth_policy);
 DECLARE_int32(tera_sdk_get_tablet_retry_times);
 DECLARE_int32(tera_sdk_update_meta_rpc_timeout_max_ms);
+DECLARE_bool(tera_sdk_row_cache_enabled);
+DECLARE_int64(tera_sdk_row_cache_size);
+DECLARE_int32(tera_sdk_row_cache_shard_num);
+DECLARE_int64(tera_sdk_row_cache_ttl_ms);
+DECLARE_bool(tera_sdk_reader_coalesce_enabled);
+DECLARE_int32(tera_sdk_rpc_pipeline_depth);
+DECLARE_bool(tera_sdk_rpc_inline_callback_enabled);
 
 using namespace std::placeholders;
 
@@ -323,19 +331,28 @@ void TableImpl::SetWriteTimeout(int64_t timeout_ms) {}
 void TableImpl::Get(RowReader* row_reader) {
   perf_counter_.user_read_cnt.Add(1);
   ((RowReaderImpl*)row_reader)->Prepare(OpStatCallback);
+  if (ReadFromRowCache(static_cast<RowReaderImpl*>(row_reader))) {
+    return;
+  }
   std::vector<RowReaderImpl*> row_reader_list;
   row_reader_list.push_back(static_cast<RowReaderImpl*>(row_reader));
   DistributeReaders(row_reader_list, true);
 }
 
 void TableImpl::Get(const std::vector<RowReader*>& row_readers) {
-  std::vector<RowReaderImpl*> row_reader_list(row_readers.size());
+  std::vector<RowReaderImpl*> row_reader_list;
+  row_reader_list.reserve(row_readers.size());
   for (uint32_t i = 0; i < row_readers.size(); ++i) {
     perf_counter_.user_read_cnt.Add(1);
-    ((RowReaderImpl*)row_readers[i])->Prepare(OpStatCallback);
-    row_reader_list[i] = static_cast<RowReaderImpl*>(row_readers[i]);
+    RowReaderImpl* row_reader = static_cast<RowReaderImpl*>(row_readers[i]);
+    row_reader->Prepare(OpStatCallback);
+    if (!ReadFromRowCache(row_reader)) {
+      row_reader_list.push_back(row_reader);
+    }
+  }
+  if (row_reader_list.size() > 0) {
+    DistributeReaders(row_reader_list, true);
   }
-  DistributeReaders(row_reader_list, true);
 }
 
 bool TableImpl::Get(const std::string& row_key, const std::string& family,
@@ -406,11 +423,36 @@ ResultStream* TableImpl::Scan(const ScanDescriptor& desc, ErrorCode* err) {
   }
   impl.SetTableSchema(table_schema_);
   ResultStream* results = NULL;
+  if (impl.GetParallelism() > 1) {
+    std::vector<std::string> split_keys;
+    GetTabletSplitKeys(impl.GetStartRowKey(), impl.GetEndRowKey(), &split_keys);
+    if (!split_keys.empty()) {
+      VLOG(6) << "activate parallel-scan, " << split_keys.size() + 1 << " tablets, parallelism "
+              << impl.GetParallelism();
+      results = new ParallelResultStreamImpl(this, &impl, split_keys);
+      return results;
+    }
+  }
   VLOG(6) << "activate async-scan";
   results = new ResultStreamImpl(this, &impl);
   return results;
 }
 
+void TableImpl::GetTabletSplitKeys(const std::string& start_key, const std::string& end_key,
+                                   std::vector<std::string>* split_keys) {
+  // make sure meta of the whole range is cached
+  ScanMetaTable(start_key, end_key);
+  MutexLock lock(&meta_mutex_);
+  auto it = tablet_meta_list_.upper_bound(start_key);
+  for (; it != tablet_meta_list_.end(); ++it) {
+    const std::string& key_start = it->second.meta.key_range().key_start();
+    if (end_key != "" && key_start >= end_key) {
+      break;
+    }
+    split_keys->push_back(key_start);
+  }
+}
+
 void TableImpl::ScanTabletAsync(ResultStreamImpl* stream) {
   ScanTask* scan_task = new ScanTask;
   scan_task->stream = stream;
@@ -567,6 +609,18 @@ bool TableImpl::OpenInternal(std::function<std::string(const std::string&)> hash
     hash_method_ = hash_method;
   }
 
+  if (FLAGS_tera_sdk_row_cache_enabled) {
+    std::set<std::string> gtxn_cfs;
+    FindGlobalTransactionCfs(table_schema_, &gtxn_cfs);
+    if (gtxn_cfs.empty()) {
+      row_cache_.reset(new RowCache(FLAGS_tera_sdk_row_cache_size << 20,
+                                    FLAGS_tera_sdk_row_cache_shard_num,
+                                    FLAGS_tera_sdk_row_cache_ttl_ms));
+    } else {
+      LOG(INFO) << "row cache is disabled for global transaction table " << name_;
+    }
+  }
+
   if (FLAGS_tera_sdk_cookie_enabled) {
     if (!RestoreCookie()) {
       LOG(ERROR) << "fail to restore cookie.";
@@ -664,6 +718,12 @@ void TableImpl::DistributeTasks(const std::vector<SdkTask*>& task_list, bool cal
       }
     }
 
+    // identical reader is in flight, wait for its result
+    if (called_by_user && task_type == SdkTask::READ && CoalesceReader((RowReaderImpl*)task)) {
+      task->DecRef();
+      continue;
+    }
+
     std::string server_addr;
     if (!GetTabletAddrOrScheduleUpdateMeta(task->InternalRowKey(), task, &server_addr)) {
       perf_counter_.meta_sched_cnt.Inc();
@@ -705,6 +765,29 @@ void TableImpl::DistributeDelayTasks(
   }
 }
 
+void TableImpl::DistributeFailedTasks(
+    std::vector<SdkTask*>& not_in_range_list,
+    const std::map<uint32_t, std::vector<int64_t>*>& retry_times_list, SdkTask::TYPE task_type,
+    bool in_rpc_thread) {
+  if (not_in_range_list.size() > 0) {
+    if (!in_rpc_thread) {
+      DistributeTasks(not_in_range_list, false, task_type);
+    } else {
+      // updating meta and committing again may block, leave the rpc thread
+      std::vector<int64_t>* task_id_list = new std::vector<int64_t>;
+      for (size_t i = 0; i < not_in_range_list.size(); ++i) {
+        task_id_list->push_back(not_in_range_list[i]->GetId());
+        not_in_range_list[i]->DecRef();
+      }
+      ThreadPool::Task task =
+          std::bind(&TableImpl::DistributeTasksByIdWrapper,
+                    std::weak_ptr<TableImpl>(shared_from_this()), task_id_list, task_type);
+      thread_pool_->AddTask(task);
+    }
+  }
+  DistributeDelayTasks(retry_times_list, task_type);
+}
+
 void TableImpl::CollectFailedTasks(int64_t task_id, SdkTask::TYPE type, StatusCode err,
                                    std::vector<SdkTask*>* not_in_range_list,
                                    std::map<uint32_t, std::vector<int64_t>*>* retry_times_list) {
@@ -784,11 +867,13 @@ void TableImpl::CommitBatchMutations(const std::string& server_addr,
   request->set_timestamp(get_micros());
   std::function<void(WriteTabletRequest*, WriteTabletResponse*, bool, int)> done =
       std::bind(&TableImpl::BatchMutateCallBackWrapper,
-                std::weak_ptr<TableImpl>(shared_from_this()), mu_id_list, _1, _2, _3, _4);
+                std::weak_ptr<TableImpl>(shared_from_this()), server_addr, mu_id_list, _1, _2, _3,
+                _4);
   tabletnode_client_async.WriteTablet(request, response, done);
 }
 
 void TableImpl::BatchMutateCallBackWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
+                                           std::string server_addr,
                                            std::vector<int64_t>* mu_id_list,
                                            WriteTabletRequest* request,
                                            WriteTabletResponse* response, bool failed,
@@ -797,10 +882,11 @@ void TableImpl::BatchMutateCallBackWrapper(std::weak_ptr<TableImpl> weak_ptr_tab
   if (!table) {
     return;
   }
-  table->BatchMutateCallBack(mu_id_list, request, response, failed, error_code);
+  table->BatchMutateCallBack(server_addr, mu_id_list, request, response, failed, error_code);
 }
 
-void TableImpl::BatchMutateCallBack(std::vector<int64_t>* mu_id_list, WriteTabletRequest* request,
+void TableImpl::BatchMutateCallBack(const std::string& server_addr,
+                                    std::vector<int64_t>* mu_id_list, WriteTabletRequest* request,
                                     WriteTabletResponse* response, bool failed, int error_code) {
   perf_counter_.rpc_w.Add(get_micros() - request->timestamp());
   perf_counter_.rpc_w_cnt.Inc();
@@ -822,6 +908,14 @@ void TableImpl::BatchMutateCallBack(std::vector<int64_t>* mu_id_list, WriteTable
     }
   }
 
+  if (row_cache_) {
+    int32_t row_num = std::min(request->row_list_size(), response->last_write_ts_list_size());
+    for (int32_t i = 0; i < row_num; ++i) {
+      UpdateRowCacheWriteTs(request->row_list(i).row_key(), server_addr,
+                            response->last_write_ts_list(i));
+    }
+  }
+
   bool rpc_timeout_timer_reset = (kRPCTimeout != response->status());
   std::map<uint32_t, std::vector<int64_t>*> retry_times_list;
   std::vector<SdkTask*> not_in_range_list;
@@ -899,6 +993,7 @@ void TableImpl::CommitMutations(const std::string& server_addr,
   access_builder_->BuildRequest(request);
 
   bool is_instant = false;
+  bool is_async = false;
   std::vector<int64_t>* mu_id_list = new std::vector<int64_t>;
   for (uint32_t i = 0; i < mu_list.size(); ++i) {
     RowMutationImpl* row_mutation = mu_list[i];
@@ -920,6 +1015,7 @@ void TableImpl::CommitMutations(const std::string& server_addr,
     }
     mu_id_list->push_back(row_mutation->GetId());
     is_instant |= !row_mutation->IsAsync();
+    is_async |= row_mutation->IsAsync();
     row_mutation->AddCommitTimes();
     row_mutation->DecRef();
   }
@@ -928,24 +1024,31 @@ void TableImpl::CommitMutations(const std::string& server_addr,
   VLOG(20) << "commit " << mu_list.size() << " mutations to " << server_addr
            << "timeout:" << request->client_timeout_ms();
   request->set_timestamp(get_micros());
+  // only wake up sync callers, no user callback
+  bool in_rpc_thread = FLAGS_tera_sdk_rpc_inline_callback_enabled && !is_async;
   std::function<void(WriteTabletRequest*, WriteTabletResponse*, bool, int)> done =
       std::bind(&TableImpl::MutateCallBackWrapper, std::weak_ptr<TableImpl>(shared_from_this()),
-                mu_id_list, _1, _2, _3, _4);
+                server_addr, mu_id_list, in_rpc_thread, _1, _2, _3, _4);
+  tabletnode_client_async.SetInlineCallback(in_rpc_thread);
   tabletnode_client_async.WriteTablet(request, response, done);
 }
 
 void TableImpl::MutateCallBackWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
-                                      std::vector<int64_t>* mu_id_list, WriteTabletRequest* request,
+                                      std::string server_addr, std::vector<int64_t>* mu_id_list,
+                                      bool in_rpc_thread, WriteTabletRequest* request,
                                       WriteTabletResponse* response, bool failed, int error_code) {
   auto table = weak_ptr_table.lock();
   if (!table) {
     return;
   }
-  table->MutateCallBack(mu_id_list, request, response, failed, error_code);
+  table->FinishPipelinedRpc(server_addr, SdkTask::MUTATION, in_rpc_thread);
+  table->MutateCallBack(server_addr, mu_id_list, request, response, failed, error_code,
+                        in_rpc_thread);
 }
 
-void TableImpl::MutateCallBack(std::vector<int64_t>* mu_id_list, WriteTabletRequest* request,
-                               WriteTabletResponse* response, bool failed, int error_code) {
+void TableImpl::MutateCallBack(const std::string& server_addr, std::vector<int64_t>* mu_id_list,
+                               WriteTabletRequest* request, WriteTabletResponse* response,
+                               bool failed, int error_code, bool in_rpc_thread) {
   perf_counter_.rpc_w.Add(get_micros() - request->timestamp());
   perf_counter_.rpc_w_cnt.Inc();
   if (failed) {
@@ -966,6 +1069,14 @@ void TableImpl::MutateCallBack(std::vector<int64_t>* mu_id_list, WriteTabletRequ
     }
   }
 
+  if (row_cache_) {
+    int32_t row_num = std::min(request->row_list_size(), response->last_write_ts_list_size());
+    for (int32_t i = 0; i < row_num; ++i) {
+      UpdateRowCacheWriteTs(request->row_list(i).row_key(), server_addr,
+                            response->last_write_ts_list(i));
+    }
+  }
+
   bool rpc_timeout_timer_reset = (kRPCTimeout != response->status());
   std::map<uint32_t, std::vector<int64_t>*> retry_times_list;
   std::vector<SdkTask*> not_in_range_list;
@@ -1023,10 +1134,7 @@ void TableImpl::MutateCallBack(std::vector<int64_t>* mu_id_list, WriteTabletRequ
     CollectFailedTasks(mu_id, SdkTask::MUTATION, err, &not_in_range_list, &retry_times_list);
   }
 
-  if (not_in_range_list.size() > 0) {
-    DistributeTasks(not_in_range_list, false, SdkTask::MUTATION);
-  }
-  DistributeDelayTasks(retry_times_list, SdkTask::MUTATION);
+  DistributeFailedTasks(not_in_range_list, retry_times_list, SdkTask::MUTATION, in_rpc_thread);
 
   delete request;
   delete response;
@@ -1048,6 +1156,17 @@ void TableImpl::DistributeTasksById(std::vector<int64_t>* task_id_list, SdkTask:
   delete task_id_list;
 }
 
+void TableImpl::DistributeTasksByIdWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
+                                           std::vector<int64_t>* task_id_list,
+                                           SdkTask::TYPE task_type) {
+  auto table = weak_ptr_table.lock();
+  if (!table) {
+    delete task_id_list;
+    return;
+  }
+  table->DistributeTasksById(task_id_list, task_type);
+}
+
 void TableImpl::TaskTimeout(SdkTask* task) {
   perf_counter_.GetTimeoutCnt(task).Inc();
   CHECK_NOTNULL(task);
@@ -1090,6 +1209,7 @@ void TableImpl::TaskTimeout(SdkTask* task) {
     case SdkTask::READ: {
       RowReaderImpl* row_reader = (RowReaderImpl*)task;
       row_reader->SetError(ErrorCode::kTimeout, err_reason);
+      ReleaseCoalescedReaders(row_reader->GetId());
       cur_reader_pending_counter_.Dec();
     } break;
     case SdkTask::BATCH_MUTATION: {
@@ -1124,6 +1244,7 @@ void TableImpl::CommitReaders(const std::string& server_addr,
                               std::vector<RowReaderImpl*>& reader_list) {
   std::vector<int64_t>* reader_id_list = new std::vector<int64_t>;
   tabletnode::TabletNodeClient tabletnode_client_async(thread_pool_, server_addr);
+  bool is_async = false;
   ReadTabletRequest* request = new ReadTabletRequest;
   ReadTabletResponse* response = new ReadTabletResponse;
   request->set_sequence_id(last_sequence_id_++);
@@ -1143,29 +1264,40 @@ void TableImpl::CommitReaders(const std::string& server_addr,
     row_reader->ToProtoBuf(row_reader_info);
     // row_reader_info->CopyFrom(row_reader->GetRowReaderInfo());
     reader_id_list->push_back(row_reader->GetId());
+    is_async |= row_reader->IsAsync();
     row_reader->AddCommitTimes();
     row_reader->DecRef();
   }
   VLOG(20) << "commit " << reader_list.size() << " reads to " << server_addr
            << "timeout:" << request->client_timeout_ms();
   request->set_timestamp(get_micros());
+  // only wake up sync callers, no user callback. coalesced followers may be
+  // async, they are handed to thread pool by FinishCoalescedReaders
+  bool in_rpc_thread = FLAGS_tera_sdk_rpc_inline_callback_enabled && !is_async;
   std::function<void(ReadTabletRequest*, ReadTabletResponse*, bool, int)> done =
       std::bind(&TableImpl::ReaderCallBackWrapper, std::weak_ptr<TableImpl>(shared_from_this()),
-                reader_id_list, _1, _2, _3, _4);
+                server_addr, reader_id_list, in_rpc_thread, _1, _2, _3, _4);
+  tabletnode_client_async.SetInlineCallback(in_rpc_thread);
   tabletnode_client_async.ReadTablet(request, response, done);
 }
 void TableImpl::ReaderCallBackWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
-                                      std::vector<int64_t>* reader_id_list,
+                                      std::string server_addr,
+                                      std::vector<int64_t>* reader_id_list, bool in_rpc_thread,
                                       ReadTabletRequest* request, ReadTabletResponse* response,
                                       bool failed, int error_code) {
   auto table = weak_ptr_table.lock();
   if (!table) {
     return;
   }
-  table->ReaderCallBack(reader_id_list, request, response, failed, error_code);
+  table->FinishPipelinedRpc(server_addr, SdkTask::READ, in_rpc_thread);
+  table->ReaderCallBack(server_addr, reader_id_list, request, response, failed, error_code,
+                        in_rpc_thread);
 }
-void TableImpl::ReaderCallBack(std::vector<int64_t>* reader_id_list, ReadTabletRequest* request,
-                               ReadTabletResponse* response, bool failed, int error_code) {
+
+void TableImpl::ReaderCallBack(const std::string& server_addr,
+                               std::vector<int64_t>* reader_id_list, ReadTabletRequest* request,
+                               ReadTabletResponse* response, bool failed, int error_code,
+                               bool in_rpc_thread) {
   perf_counter_.rpc_r.Add(get_micros() - request->timestamp());
   perf_counter_.rpc_r_cnt.Inc();
   if (failed) {
@@ -1226,16 +1358,25 @@ void TableImpl::ReaderCallBack(std::vector<int64_t>* reader_id_list, ReadTabletR
       CHECK_EQ(task->GetRef(), 1);
 
       RowReaderImpl* row_reader = (RowReaderImpl*)task;
+      int64_t write_ts = -1;
+      if (static_cast<int32_t>(i) < response->last_write_ts_list_size()) {
+        write_ts = response->last_write_ts_list(i);
+      }
+      const RowResult* row_result = NULL;
       if (err == kTabletNodeOk) {
-        row_reader->SetResult(response->detail().row_result(row_result_index++));
+        row_result = &response->detail().row_result(row_result_index++);
+        row_reader->SetResult(*row_result);
         row_reader->SetError(ErrorCode::kOK);
+        FillRowCache(row_reader, server_addr, write_ts, row_result);
       } else if (err == kKeyNotExist) {
         row_reader->SetError(ErrorCode::kNotFound, "not found");
+        FillRowCache(row_reader, server_addr, write_ts, NULL);
       } else if (err == kNotPermission) {
         row_reader->SetError(ErrorCode::kNoAuth, "not permissions");
       } else {  // err == kSnapshotNotExist
         row_reader->SetError(ErrorCode::kNotFound, "snapshot not found");
       }
+      FinishCoalescedReaders(reader_id, row_reader->GetError(), row_result, in_rpc_thread);
       int64_t perf_time = get_micros();
       row_reader->RunCallback();
       perf_counter_.user_callback.Add(get_micros() - perf_time);
@@ -1247,16 +1388,192 @@ void TableImpl::ReaderCallBack(std::vector<int64_t>* reader_id_list, ReadTabletR
     CollectFailedTasks(reader_id, SdkTask::READ, err, &not_in_range_list, &retry_times_list);
   }
 
-  if (not_in_range_list.size() > 0) {
-    DistributeTasks(not_in_range_list, false, SdkTask::READ);
-  }
-  DistributeDelayTasks(retry_times_list, SdkTask::READ);
+  DistributeFailedTasks(not_in_range_list, retry_times_list, SdkTask::READ, in_rpc_thread);
 
   delete request;
   delete response;
   delete reader_id_list;
 }
 
+bool TableImpl::ReadFromRowCache(RowReaderImpl* row_reader) {
+  if (!row_cache_ || row_reader->GetTransaction() != NULL) {
+    return false;
+  }
+  std::string tablet;
+  if (!GetTabletKeyStart(row_reader->InternalRowKey(), &tablet)) {
+    return false;
+  }
+  RowResult result;
+  bool found = false;
+  if (!row_cache_->Lookup(ReaderKey(row_reader), tablet, &result, &found)) {
+    return false;
+  }
+  perf_counter_.reader_cache_hit_cnt.Inc();
+  if (found) {
+    row_reader->SetResult(result);
+    row_reader->SetError(ErrorCode::kOK);
+  } else {
+    row_reader->SetError(ErrorCode::kNotFound, "not found");
+  }
+  if (row_reader->IsAsync()) {
+    // keep the same behavior as rpc: never run user callback in caller thread
+    ThreadPool::Task task = std::bind(&RowReaderImpl::RunCallback, row_reader);
+    thread_pool_->AddTask(task);
+  } else {
+    row_reader->RunCallback();
+  }
+  return true;
+}
+
+void TableImpl::FillRowCache(RowReaderImpl* row_reader, const std::string& server_addr,
+                             int64_t write_ts, const RowResult* result) {
+  if (!row_cache_ || write_ts < 0 || row_reader->GetTransaction() != NULL) {
+    return;
+  }
+  std::string tablet;
+  if (!GetTabletKeyStart(row_reader->InternalRowKey(), &tablet)) {
+    return;
+  }
+  row_cache_->Insert(ReaderKey(row_reader), tablet, server_addr, write_ts, result);
+}
+
+void TableImpl::UpdateRowCacheWriteTs(const std::string& row, const std::string& server_addr,
+                                      int64_t write_ts) {
+  std::string tablet;
+  if (!GetTabletKeyStart(row, &tablet)) {
+    return;
+  }
+  row_cache_->UpdateTabletWriteTs(tablet, server_addr, write_ts);
+}
+
+std::string TableImpl::ReaderKey(RowReaderImpl* row_reader) {
+  RowReaderInfo info;
+  row_reader->ToProtoBuf(&info);
+  std::string key = std::to_string(row_reader->GetSnapshot()) + ":";
+  info.AppendToString(&key);
+  return key;
+}
+
+bool TableImpl::CoalesceReader(RowReaderImpl* row_reader) {
+  if (!FLAGS_tera_sdk_reader_coalesce_enabled || row_reader->GetTransaction() != NULL) {
+    return false;
+  }
+  std::string key = ReaderKey(row_reader);
+  MutexLock lock(&coalesce_mutex_);
+  auto it = coalesced_readers_.find(key);
+  if (it == coalesced_readers_.end()) {
+    CoalescedReaders& readers = coalesced_readers_[key];
+    readers.leader_id = row_reader->GetId();
+    coalesce_leader_keys_[row_reader->GetId()] = key;
+    return false;
+  }
+  it->second.follower_ids.push_back(row_reader->GetId());
+  perf_counter_.reader_coalesced_cnt.Inc();
+  VLOG(20) << "reader " << row_reader->GetId() << " coalesced to " << it->second.leader_id;
+  return true;
+}
+
+void TableImpl::FinishCoalescedReaders(int64_t leader_id, const ErrorCode& error,
+                                       const RowResult* result, bool in_rpc_thread) {
+  std::vector<int64_t> follower_ids;
+  {
+    MutexLock lock(&coalesce_mutex_);
+    auto key_it = coalesce_leader_keys_.find(leader_id);
+    if (key_it == coalesce_leader_keys_.end()) {
+      return;
+    }
+    auto it = coalesced_readers_.find(key_it->second);
+    follower_ids.swap(it->second.follower_ids);
+    coalesced_readers_.erase(it);
+    coalesce_leader_keys_.erase(key_it);
+  }
+  if (follower_ids.empty()) {
+    return;
+  }
+  if (!in_rpc_thread) {
+    RunCoalescedReaders(follower_ids, error, result);
+    return;
+  }
+  // |result| belongs to the rpc response, which is gone after the callback
+  std::vector<int64_t>* follower_id_list = new std::vector<int64_t>;
+  follower_id_list->swap(follower_ids);
+  RowResult* result_copy = (result != NULL) ? new RowResult(*result) : NULL;
+  ThreadPool::Task task =
+      std::bind(&TableImpl::RunCoalescedReadersWrapper,
+                std::weak_ptr<TableImpl>(shared_from_this()), follower_id_list, error, result_copy);
+  thread_pool_->AddTask(task);
+}
+
+void TableImpl::RunCoalescedReadersWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
+                                           std::vector<int64_t>* follower_ids, ErrorCode error,
+                                           RowResult* result) {
+  auto table = weak_ptr_table.lock();
+  if (table) {
+    table->RunCoalescedReaders(*follower_ids, error, result);
+  }
+  delete follower_ids;
+  delete result;
+}
+
+void TableImpl::RunCoalescedReaders(const std::vector<int64_t>& follower_ids,
+                                    const ErrorCode& error, const RowResult* result) {
+  for (size_t i = 0; i < follower_ids.size(); ++i) {
+    SdkTask* task = task_pool_.PopTask(follower_ids[i]);
+    if (task == NULL) {
+      VLOG(10) << "coalesced reader " << follower_ids[i] << " success but timeout";
+      continue;
+    }
+    CHECK_EQ(task->Type(), SdkTask::READ);
+    CHECK_EQ(task->GetRef(), 1);
+    if (error.GetType() == ErrorCode::kOK || error.GetType() == ErrorCode::kNotFound) {
+      perf_counter_.reader_ok_cnt.Inc();
+    }
+    RowReaderImpl* row_reader = (RowReaderImpl*)task;
+    if (result != NULL) {
+      row_reader->SetResult(*result);
+    }
+    row_reader->SetError(error.GetType(), error.GetReason());
+    int64_t perf_time = get_micros();
+    row_reader->RunCallback();
+    perf_counter_.user_callback.Add(get_micros() - perf_time);
+    perf_counter_.user_callback_cnt.Inc();
+    cur_reader_pending_counter_.Dec();
+  }
+}
+
+void TableImpl::ReleaseCoalescedReaders(int64_t leader_id) {
+  std::vector<int64_t>* follower_ids = new std::vector<int64_t>;
+  {
+    MutexLock lock(&coalesce_mutex_);
+    auto key_it = coalesce_leader_keys_.find(leader_id);
+    if (key_it != coalesce_leader_keys_.end()) {
+      auto it = coalesced_readers_.find(key_it->second);
+      follower_ids->swap(it->second.follower_ids);
+      coalesced_readers_.erase(it);
+      coalesce_leader_keys_.erase(key_it);
+    }
+  }
+  if (follower_ids->empty()) {
+    delete follower_ids;
+    return;
+  }
+  // followers may have longer timeout than leader, let them go on their own
+  ThreadPool::Task task =
+      std::bind(&TableImpl::DistributeTasksByIdWrapper,
+                std::weak_ptr<TableImpl>(shared_from_this()), follower_ids, SdkTask::READ);
+  thread_pool_->AddTask(task);
+}
+
+bool TableImpl::GetTabletKeyStart(const std::string& row, std::string* key_start) {
+  MutexLock lock(&meta_mutex_);
+  TabletMetaNode* node = GetTabletMetaNodeForKey(row);
+  if (node == NULL || node->status != NORMAL) {
+    return false;
+  }
+  *key_start = node->meta.key_range().key_start();
+  return true;
+}
+
 void TableImpl::PackSdkTasks(const std::string& server_addr, std::vector<SdkTask*>& task_list,
                              SdkTask::TYPE task_type) {
   Mutex* mutex = NULL;
@@ -1280,6 +1597,7 @@ void TableImpl::PackSdkTasks(const std::string& server_addr, std::vector<SdkTask
     assert(0);
   }
 
+  std::map<std::string, int32_t>* inflight_rpc = GetInflightRpcMap(task_type);
   TaskBatch* task_batch = NULL;
   bool is_instant = false;
   MutexLock lock(mutex);
@@ -1319,9 +1637,18 @@ void TableImpl::PackSdkTasks(const std::string& server_addr, std::vector<SdkTask
     // 2) any mutation is sync (flush == true)
     // 3) batch_row_num >= min_batch_row_num
     // 4) commit timeout
-    if (task_batch->byte_size >= kMaxRpcSize ||
-        ((i == task_list.size() - 1) &&
-         (is_instant || (task_batch->row_id_list->size() >= commit_size)))) {
+    // 5) for the *LAST* batch, the rpc pipeline of the server is not full,
+    //    otherwise it is held and committed once an inflight rpc returns
+    bool ready = (i == task_list.size() - 1) &&
+                 (is_instant || (task_batch->row_id_list->size() >= commit_size));
+    if (ready && inflight_rpc != NULL) {
+      auto it = inflight_rpc->find(server_addr);
+      if (it != inflight_rpc->end() && it->second >= FLAGS_tera_sdk_rpc_pipeline_depth) {
+        task_batch->pipeline_held = true;
+        ready = false;
+      }
+    }
+    if (task_batch->byte_size >= kMaxRpcSize || ready) {
       std::vector<int64_t>* task_id_list = task_batch->row_id_list;
       task_batch->row_id_list = NULL;
       task_batch_map->erase(server_addr);
@@ -1336,6 +1663,76 @@ void TableImpl::PackSdkTasks(const std::string& server_addr, std::vector<SdkTask
   }
 }
 
+std::map<std::string, int32_t>* TableImpl::GetInflightRpcMap(SdkTask::TYPE task_type) {
+  if (FLAGS_tera_sdk_rpc_pipeline_depth <= 0) {
+    return NULL;
+  }
+  if (task_type == SdkTask::MUTATION) {
+    return &mutation_inflight_rpc_;
+  } else if (task_type == SdkTask::READ) {
+    return &reader_inflight_rpc_;
+  }
+  return NULL;
+}
+
+void TableImpl::FinishPipelinedRpc(const std::string& server_addr, SdkTask::TYPE task_type,
+                                   bool in_rpc_thread) {
+  Mutex* mutex = NULL;
+  std::map<std::string, TaskBatch*>* task_batch_map = NULL;
+  std::map<std::string, int32_t>* inflight_rpc = NULL;
+  if (task_type == SdkTask::MUTATION) {
+    mutex = &mutation_batch_mutex_;
+    task_batch_map = &mutation_batch_map_;
+    inflight_rpc = &mutation_inflight_rpc_;
+  } else {
+    mutex = &reader_batch_mutex_;
+    task_batch_map = &reader_batch_map_;
+    inflight_rpc = &reader_inflight_rpc_;
+  }
+
+  std::vector<int64_t>* task_id_list = NULL;
+  {
+    MutexLock lock(mutex);
+    auto it = inflight_rpc->find(server_addr);
+    if (it == inflight_rpc->end()) {
+      return;
+    }
+    if (--it->second <= 0) {
+      inflight_rpc->erase(it);
+    }
+    auto batch_it = task_batch_map->find(server_addr);
+    if (batch_it != task_batch_map->end() && batch_it->second->pipeline_held &&
+        batch_it->second->type == task_type) {
+      task_id_list = batch_it->second->row_id_list;
+      batch_it->second->row_id_list = NULL;
+      task_batch_map->erase(batch_it);
+    }
+  }
+  if (task_id_list == NULL) {
+    return;
+  }
+  if (in_rpc_thread) {
+    // building and sending the next rpc is too heavy for the rpc thread
+    ThreadPool::Task task =
+        std::bind(&TableImpl::CommitTasksByIdWrapper, std::weak_ptr<TableImpl>(shared_from_this()),
+                  server_addr, task_id_list, task_type);
+    thread_pool_->AddTask(task);
+    return;
+  }
+  CommitTasksById(server_addr, *task_id_list, task_type);
+  delete task_id_list;
+}
+
+void TableImpl::CommitTasksByIdWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
+                                       std::string server_addr, std::vector<int64_t>* task_id_list,
+                                       SdkTask::TYPE task_type) {
+  auto table = weak_ptr_table.lock();
+  if (table) {
+    table->CommitTasksById(server_addr, *task_id_list, task_type);
+  }
+  delete task_id_list;
+}
+
 void TableImpl::TaskBatchTimeout(SdkTask* task) {
   std::vector<int64_t>* task_id_list = NULL;
   CHECK_NOTNULL(task);
@@ -1387,6 +1784,11 @@ void TableImpl::CommitTasksById(const std::string& server_addr, std::vector<int6
       batch_mutation_list.push_back((BatchMutationImpl*)task);
     }
   }
+  std::map<std::string, int32_t>* inflight_rpc = GetInflightRpcMap(task_type);
+  if (inflight_rpc != NULL) {
+    MutexLock lock(task_type == SdkTask::READ ? &reader_batch_mutex_ : &mutation_batch_mutex_);
+    (*inflight_rpc)[server_addr]++;
+  }
   if (task_type == SdkTask::MUTATION) {
     CommitMutations(server_addr, mutation_list);
   } else if (task_type == SdkTask::READ) {
@@ -2175,6 +2577,11 @@ void TableImpl::DoDumpPerfCounterLog() {
             << " pending_r: " << cur_reader_pending_counter_.Get()
             << " pending_w: " << cur_commit_pending_counter_.Get();
   perf_counter_.DoDumpPerfCounterLog("[table " + name_ + " PerfCounter]");
+  if (row_cache_) {
+    LOG(INFO) << "[table " << name_ << " PerfCounter][row_cache]"
+              << " usage: " << row_cache_->Usage() << " hit: " << row_cache_->HitCount()
+              << " miss: " << row_cache_->MissCount() << " stale: " << row_cache_->StaleCount();
+  }
 }
 
 void TableImpl::PerfCounter::DoDumpPerfCounterLog(const std::string& log_prefix) {
@@ -2198,7 +2605,9 @@ void TableImpl::PerfCounter::DoDumpPerfCounterLog(const std::string& log_prefix)
             << " all: " << reader_cnt.Clear() << " ok: " << reader_ok_cnt.Clear()
             << " fail: " << reader_fail_cnt.Clear() << " range: " << reader_range_cnt.Clear()
             << " timeout: " << reader_timeout_cnt.Clear()
-            << " queue_timeout: " << reader_queue_timeout_cnt.Clear();
+            << " queue_timeout: " << reader_queue_timeout_cnt.Clear()
+            << " cache_hit: " << reader_cache_hit_cnt.Clear()
+            << " coalesced: " << reader_coalesced_cnt.Clear();
 
   LOG(INFO) << log_prefix << "[user_mu]"
             << " cnt: " << user_mu_cnt.Clear() << " suc: " << user_mu_suc.Clear()
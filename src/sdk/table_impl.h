@@ -15,6 +15,7 @@
 #include "proto/table_meta.pb.h"
 #include "proto/tabletnode_rpc.pb.h"
 #include "sdk/client_impl.h"
+#include "sdk/row_cache.h"
 #include "sdk/sdk_task.h"
 #include "sdk/sdk_zk.h"
 #include "tera.h"
@@ -198,6 +199,8 @@ class TableImpl : public Table, public std::enable_shared_from_this<TableImpl> {
     Counter reader_range_cnt;          // reader回调失败-原因为not in range
     Counter reader_timeout_cnt;        // reader在sdk队列中超时
     Counter reader_queue_timeout_cnt;  // raader在sdk队列中超时，且之前从未被重试过
+    Counter reader_cache_hit_cnt;      // reader命中sdk row cache的次数
+    Counter reader_coalesced_cnt;      // reader合并到相同的在途reader上的次数
 
     Counter user_mu_cnt;
     Counter user_mu_suc;
@@ -300,18 +303,24 @@ class TableImpl : public Table, public std::enable_shared_from_this<TableImpl> {
 
   // mutate RPC回调
   static void MutateCallBackWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
-                                    std::vector<int64_t>* mu_id_list, WriteTabletRequest* request,
+                                    std::string server_addr, std::vector<int64_t>* mu_id_list,
+                                    bool in_rpc_thread, WriteTabletRequest* request,
                                     WriteTabletResponse* response, bool failed, int error_code);
-  void MutateCallBack(std::vector<int64_t>* mu_id_list, WriteTabletRequest* request,
-                      WriteTabletResponse* response, bool failed, int error_code);
+  // |in_rpc_thread| is true if called inline by the rpc work thread, which may
+  // only wake up sync callers, all other work is handed to thread pool
+  void MutateCallBack(const std::string& server_addr, std::vector<int64_t>* mu_id_list,
+                      WriteTabletRequest* request, WriteTabletResponse* response, bool failed,
+                      int error_code, bool in_rpc_thread);
 
   static void BatchMutateCallBackWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
+                                         std::string server_addr,
                                          std::vector<int64_t>* mu_id_list,
                                          WriteTabletRequest* request, WriteTabletResponse* response,
                                          bool failed, int error_code);
 
-  void BatchMutateCallBack(std::vector<int64_t>* mu_id_list, WriteTabletRequest* request,
-                           WriteTabletResponse* response, bool failed, int error_code);
+  void BatchMutateCallBack(const std::string& server_addr, std::vector<int64_t>* mu_id_list,
+                           WriteTabletRequest* request, WriteTabletResponse* response,
+                           bool failed, int error_code);
 
   void TaskTimeout(SdkTask* sdk_task);
 
@@ -322,31 +331,84 @@ class TableImpl : public Table, public std::enable_shared_from_this<TableImpl> {
   void CommitReaders(const std::string& server_addr, std::vector<RowReaderImpl*>& reader_list);
 
   void DistributeTasksById(std::vector<int64_t>* task_id_list, SdkTask::TYPE task_type);
+  static void DistributeTasksByIdWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
+                                         std::vector<int64_t>* task_id_list,
+                                         SdkTask::TYPE task_type);
 
   void DistributeDelayTasks(const std::map<uint32_t, std::vector<int64_t>*>& retry_times_list,
                             SdkTask::TYPE task_type);
 
+  // retry tasks collected by CollectFailedTasks
+  void DistributeFailedTasks(std::vector<SdkTask*>& not_in_range_list,
+                             const std::map<uint32_t, std::vector<int64_t>*>& retry_times_list,
+                             SdkTask::TYPE task_type, bool in_rpc_thread);
+
   void CollectFailedTasks(int64_t task_id, SdkTask::TYPE type, StatusCode err,
                           std::vector<SdkTask*>* not_in_range_list,
                           std::map<uint32_t, std::vector<int64_t>*>* retry_times_list);
 
   // reader RPC回调
   static void ReaderCallBackWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
-                                    std::vector<int64_t>* reader_id_list,
-                                    ReadTabletRequest* request, ReadTabletResponse* response,
-                                    bool failed, int error_code);
-
-  void ReaderCallBack(std::vector<int64_t>* reader_id_list, ReadTabletRequest* request,
-                      ReadTabletResponse* response, bool failed, int error_code);
+                                    std::string server_addr, std::vector<int64_t>* reader_id_list,
+                                    bool in_rpc_thread, ReadTabletRequest* request,
+                                    ReadTabletResponse* response, bool failed, int error_code);
+
+  void ReaderCallBack(const std::string& server_addr, std::vector<int64_t>* reader_id_list,
+                      ReadTabletRequest* request, ReadTabletResponse* response, bool failed,
+                      int error_code, bool in_rpc_thread);
+
+  // row cache, only available if FLAGS_tera_sdk_row_cache_enabled
+  bool ReadFromRowCache(RowReaderImpl* row_reader);
+  void FillRowCache(RowReaderImpl* row_reader, const std::string& server_addr, int64_t write_ts,
+                    const RowResult* result);
+  void UpdateRowCacheWriteTs(const std::string& row, const std::string& server_addr,
+                             int64_t write_ts);
+  bool GetTabletKeyStart(const std::string& row, std::string* key_start);
+
+  // identical readers (same row, columns, time range and snapshot) share the key
+  std::string ReaderKey(RowReaderImpl* row_reader);
+
+  // single-flight of identical readers, only available if
+  // FLAGS_tera_sdk_reader_coalesce_enabled.
+  // NOTE: a follower shares the result of a leader sent earlier, which may not
+  // see a write finished between the two, so read-your-writes is not kept.
+  // returns true if |row_reader| is attached to an outstanding identical reader,
+  // otherwise |row_reader| becomes the leader of its key.
+  bool CoalesceReader(RowReaderImpl* row_reader);
+  // leader finished, run followers with the same result, |result| is NULL if
+  // leader failed or the row does not exist.
+  // followers may be async even if the leader is not, so they never run in the
+  // rpc work thread.
+  void FinishCoalescedReaders(int64_t leader_id, const ErrorCode& error, const RowResult* result,
+                              bool in_rpc_thread);
+  void RunCoalescedReaders(const std::vector<int64_t>& follower_ids, const ErrorCode& error,
+                           const RowResult* result);
+  static void RunCoalescedReadersWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
+                                         std::vector<int64_t>* follower_ids, ErrorCode error,
+                                         RowResult* result);
+  // leader timeout, followers have to read by themselves
+  void ReleaseCoalescedReaders(int64_t leader_id);
 
   void PackSdkTasks(const std::string& server_addr, std::vector<SdkTask*>& task_list,
                     SdkTask::TYPE task_type);
   void TaskBatchTimeout(SdkTask* task);
+  // rpc pipeline of each server, only for READ and MUTATION
+  std::map<std::string, int32_t>* GetInflightRpcMap(SdkTask::TYPE task_type);
+  // a held batch is committed by thread pool if |in_rpc_thread|
+  void FinishPipelinedRpc(const std::string& server_addr, SdkTask::TYPE task_type,
+                          bool in_rpc_thread);
+  static void CommitTasksByIdWrapper(std::weak_ptr<TableImpl> weak_ptr_table,
+                                     std::string server_addr, std::vector<int64_t>* task_id_list,
+                                     SdkTask::TYPE task_type);
   void CommitTasksById(const std::string& server_addr, std::vector<int64_t>& task_id_list,
                        SdkTask::TYPE task_type);
 
   void ScanTabletAsync(ScanTask* scan_task, bool called_by_user);
 
+  // tablet key starts inside (start_key, end_key), used by parallel scan
+  void GetTabletSplitKeys(const std::string& start_key, const std::string& end_key,
+                          std::vector<std::string>* split_keys);
+
   void CommitScan(ScanTask* scan_task, const std::string& server_addr);
 
   static void ScanCallBackWrapper(std::weak_ptr<TableImpl> weak_ptr_table, ScanTask* scan_task,
@@ -436,6 +498,7 @@ class TableImpl : public Table, public std::enable_shared_from_this<TableImpl> {
     Mutex* mutex = nullptr;
     std::map<std::string, TaskBatch*>* task_batch_map = nullptr;
     std::vector<int64_t>* row_id_list = nullptr;
+    bool pipeline_held = false;  // ready to commit, but the rpc pipeline is full
 
     TaskBatch() : SdkTask(SdkTask::TASKBATCH) {}
     virtual bool IsAsync() { return false; }
@@ -467,6 +530,9 @@ class TableImpl : public Table, public std::enable_shared_from_this<TableImpl> {
   uint64_t read_commit_timeout_;
   std::map<std::string, TaskBatch*> mutation_batch_map_;
   std::map<std::string, TaskBatch*> reader_batch_map_;
+  // server_addr -> inflight rpc number, protected by batch mutex
+  std::map<std::string, int32_t> mutation_inflight_rpc_;
+  std::map<std::string, int32_t> reader_inflight_rpc_;
   Counter cur_commit_pending_counter_;
   Counter cur_reader_pending_counter_;
   int64_t max_commit_pending_num_;
@@ -508,6 +574,16 @@ class TableImpl : public Table, public std::enable_shared_from_this<TableImpl> {
 
   PerfCounter perf_counter_;  // calc time consumption, for performance analysis
 
+  std::unique_ptr<RowCache> row_cache_;
+
+  struct CoalescedReaders {
+    int64_t leader_id;
+    std::vector<int64_t> follower_ids;
+  };
+  mutable Mutex coalesce_mutex_;
+  std::map<std::string, CoalescedReaders> coalesced_readers_;  // reader key -> readers
+  std::map<int64_t, std::string> coalesce_leader_keys_;        // leader id -> reader key
+
   std::atomic<bool> is_hash_table_{false};
   std::function<std::string(const std::string&)> hash_method_;
 
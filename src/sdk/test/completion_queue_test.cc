@@ -0,0 +1,69 @@
+// Copyright (c) 2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <poll.h>
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "common/thread_pool.h"
+#include "sdk/completion_queue_impl.h"
+#include "sdk/test/mock_table.h"
+
+namespace tera {
+
+static bool IsReadable(int fd) {
+  struct pollfd pfd;
+  pfd.fd = fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+}
+
+TEST(CompletionQueueTest, GetAndApplyMutation) {
+  common::ThreadPool thread_pool(2);
+  std::shared_ptr<MockTable> table(new MockTable("t1", &thread_pool));
+  std::vector<ErrorCode> reader_errs(1);
+  reader_errs[0].SetFailed(ErrorCode::kNotFound, "");
+  table->AddReaderErrors(reader_errs);
+  std::vector<ErrorCode> mu_errs(1);
+  mu_errs[0].SetFailed(ErrorCode::kOK, "");
+  table->AddMutationErrors(mu_errs);
+
+  CompletionQueueImpl cq;
+  Completion completions[4];
+  EXPECT_EQ(cq.Next(completions, 4, 0), 0);
+  EXPECT_EQ(cq.Next(completions, 4, 10), 0);
+  EXPECT_FALSE(IsReadable(cq.NotifyFd()));
+
+  RowReaderImpl* reader = new RowReaderImpl(table.get(), "row");
+  RowMutationImpl* mutation = new RowMutationImpl(table.get(), "row");
+  int tag1 = 1;
+  int tag2 = 2;
+  cq.Get(table.get(), reader, &tag1);
+  EXPECT_TRUE(reader->IsAsync());
+  cq.ApplyMutation(table.get(), mutation, &tag2);
+  EXPECT_EQ(cq.PendingNum(), 2);
+  EXPECT_TRUE(IsReadable(cq.NotifyFd()));
+
+  ASSERT_EQ(cq.Next(completions, 1, -1), 1);
+  EXPECT_EQ(completions[0].type, Completion::kRead);
+  EXPECT_EQ(completions[0].tag, &tag1);
+  EXPECT_EQ(completions[0].reader, reader);
+  EXPECT_EQ(completions[0].reader->GetError().GetType(), ErrorCode::kNotFound);
+  EXPECT_TRUE(IsReadable(cq.NotifyFd()));
+
+  ASSERT_EQ(cq.Next(completions, 4, -1), 1);
+  EXPECT_EQ(completions[0].type, Completion::kMutation);
+  EXPECT_EQ(completions[0].tag, &tag2);
+  EXPECT_EQ(completions[0].mutation, mutation);
+  EXPECT_EQ(cq.PendingNum(), 0);
+  EXPECT_FALSE(IsReadable(cq.NotifyFd()));
+
+  delete reader;
+  delete mutation;
+}
+
+}  // namespace tera
@@ -739,4 +739,50 @@ TEST_F(GlobalTxnInternalTest, PrimaryIsLocked2) {
   EXPECT_FALSE(gtxn_internal_.PrimaryIsLocked(info2, 12, &status));
 }
 
+TEST_F(GlobalTxnInternalTest, PrimaryCommitTimestamp) {
+  ErrorCode status;
+  std::shared_ptr<Table> t1 = OpenTable("t1");
+  TableDescriptor desc("t1");
+  desc.EnableTxn();
+  desc.AddLocalityGroup("lg0");
+  ColumnFamilyDescriptor* cfd1 = desc.AddColumnFamily("cf1");
+  cfd1->EnableGlobalTransaction();
+
+  TableSchema schema;
+  TableDescToSchema(desc, &schema);
+  SetSchema(t1.get(), schema);
+  EXPECT_TRUE(gtxn_internal_.CheckTable(t1.get(), &status));
+
+  tera::PrimaryInfo info;
+  info.set_table_name("t1");
+  info.set_row_key("row1");
+  info.set_column_family("cf1");
+  info.set_qualifier("qu1");
+  info.set_gtxn_start_ts(100);
+
+  // a. committed @120 by this txn, a later txn committed @150
+  // b. only committed by other txn
+  // c. read primary failed
+  std::vector<MockReaderResult> results(3);
+  MakeKvPair("row1", "cf1", PackWriteName("qu1"), 150, EncodeWriteValue(RowMutation::kPut, 130),
+             &results[0].result);
+  KeyValuePair* kv = results[0].result.add_key_values();
+  kv->set_key("row1");
+  kv->set_column_family("cf1");
+  kv->set_qualifier(PackWriteName("qu1"));
+  kv->set_timestamp(120);
+  kv->set_value(EncodeWriteValue(RowMutation::kPut, 100));
+  results[0].status.SetFailed(ErrorCode::kOK);
+  MakeKvPair("row1", "cf1", PackWriteName("qu1"), 150, EncodeWriteValue(RowMutation::kPut, 130),
+             &results[1].result);
+  results[1].status.SetFailed(ErrorCode::kOK);
+  results[2].status.SetFailed(ErrorCode::kSystem);
+  (static_cast<MockTable*>(t1.get()))->AddReaderResult(results);
+
+  EXPECT_EQ(gtxn_internal_.PrimaryCommitTimestamp(info, &status), 120);
+  EXPECT_EQ(gtxn_internal_.PrimaryCommitTimestamp(info, &status), -1);
+  EXPECT_EQ(gtxn_internal_.PrimaryCommitTimestamp(info, &status), -1);
+  EXPECT_TRUE(status.GetType() == ErrorCode::kSystem);
+}
+
 }  // namespace tera
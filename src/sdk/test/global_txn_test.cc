@@ -470,6 +470,74 @@ TEST_F(GlobalTxnTest, DoCommitSecondariesCallback2) {
   EXPECT_TRUE(gtxn_.finish_ == true);
 }
 
+TEST_F(GlobalTxnTest, AsyncCommitSecondaries) {
+  // user callback doesn't wait for secondaries, which hold the gtxn alive
+  std::shared_ptr<GlobalTxn> gtxn(new GlobalTxn(std::shared_ptr<ClientImpl>(), &thread_pool_,
+                                                (new sdk::MockTimeoracleClusterFinder(""))));
+  gtxn->self_ = gtxn;
+  gtxn->status_.SetFailed(ErrorCode::kOK);
+  gtxn->finish_ = false;
+  gtxn->acks_cnt_.Set(0);
+  gtxn->notifies_cnt_.Set(0);
+  gtxn->writes_cnt_.Set(2);
+  gtxn->async_secondaries_ = true;
+  gtxn->background_ref_ = gtxn;
+  gtxn->all_task_pushed_ = true;
+  {
+    MutexLock lock(&gtxn->mu_);
+    EXPECT_TRUE(gtxn->SecondariesWaitedDone());
+  }
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(gtxn.use_count(), 2);
+    RowMutationImpl* mu_impl = new RowMutationImpl(NULL, "rowkey");
+    mu_impl->error_code_.SetFailed(ErrorCode::kOK, "");
+    gtxn->DoCommitSecondariesCallback(static_cast<RowMutation*>(mu_impl));
+    EXPECT_TRUE(gtxn->finish_ == false);
+  }
+  EXPECT_EQ(gtxn.use_count(), 1);
+  EXPECT_TRUE(gtxn->background_ref_ == NULL);
+}
+
+TEST_F(GlobalTxnTest, ResolveCommittedLock) {
+  std::shared_ptr<Table> t = OpenTable("t1");
+  gtxn_.gtxn_internal_->tables_["t1"] =
+      std::pair<Table*, std::set<std::string>>(t.get(), std::set<std::string>());
+  gtxn_.start_ts_ = 200;
+  gtxn_.gtxn_internal_->SetStartTimestamp(200);
+  Cell cell(t.get(), "r1", "cf", "qu");
+
+  tera::PrimaryInfo primary;
+  primary.set_table_name("t1");
+  primary.set_row_key("r0");
+  primary.set_column_family("cf");
+  primary.set_qualifier("qu");
+  primary.set_gtxn_start_ts(100);
+  std::string primary_str;
+  primary.SerializeToString(&primary_str);
+
+  RowReader::TRow row;
+  row["cf"][cell.LockName()][100] = EncodeLockValue(RowMutation::kPut, primary_str);
+  row["cf"][cell.DataName()][100] = "val";
+
+  // primary committed @150, roll forward in background
+  MockReaderResult primary_result;
+  KeyValuePair* kv = primary_result.result.add_key_values();
+  kv->set_key("r0");
+  kv->set_column_family("cf");
+  kv->set_qualifier(PackWriteName("qu"));
+  kv->set_timestamp(150);
+  kv->set_value(EncodeWriteValue(RowMutation::kPut, 100));
+  primary_result.status.SetFailed(ErrorCode::kOK);
+  (static_cast<MockTable*>(t.get()))->AddReaderResult({primary_result});
+  (static_cast<MockTable*>(t.get()))->AddMutationErrors({ErrorCode()});
+
+  EXPECT_TRUE(gtxn_.ResolveCommittedLock(&row, cell));
+  EXPECT_TRUE(row["cf"][cell.LockName()].empty());
+  EXPECT_TRUE(gtxn_.FindValueFromResultRow(row, &cell));
+  EXPECT_EQ(cell.Value(), "val");
+  EXPECT_EQ(cell.Timestamp(), 100);
+}
+
 TEST_F(GlobalTxnTest, DoVerifyPrimaryLockedCallback3) {
   // mutation error is not kOK but status_ is not changed
   size_t secondaries_thread_cnt = 30;
@@ -1245,6 +1313,18 @@ TEST_F(GlobalTxnTest, DoPrewriteCallback2) {
   EXPECT_TRUE(gtxn_.status_.GetType() == ErrorCode::kSystem);
 }
 
+TEST_F(GlobalTxnTest, FinishPrewrite) {
+  // a failed row stops launching more rows, but the txn waits for the
+  // inflight ones before running the user callback
+  gtxn_.prewrite_inflight_ = 2;
+  gtxn_.FinishPrewrite(true);
+  EXPECT_EQ(gtxn_.prewrite_inflight_, 1);
+  EXPECT_TRUE(gtxn_.prewrite_failed_);
+  gtxn_.FinishPrewrite(false);
+  EXPECT_EQ(gtxn_.prewrite_inflight_, 0);
+  EXPECT_TRUE(gtxn_.prewrite_failed_);
+}
+
 TEST_F(GlobalTxnTest, VerifyPrimaryLocked) {
   std::shared_ptr<Table> t = OpenTable("t1");
   Cell cell(t.get(), "r1", "cf", "qu", 1, "val");
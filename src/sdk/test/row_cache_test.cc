@@ -0,0 +1,119 @@
+// Copyright (c) 2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "sdk/row_cache.h"
+
+namespace tera {
+
+static void MakeResult(const std::string& row, const std::string& value, RowResult* result) {
+  KeyValuePair* kv = result->add_key_values();
+  kv->set_key(row);
+  kv->set_column_family("cf");
+  kv->set_qualifier("qu");
+  kv->set_value(value);
+}
+
+TEST(RowCacheTest, InsertLookup) {
+  RowCache cache(1 << 20, 4, 100000);
+  RowResult result;
+  MakeResult("row1", "value1", &result);
+  cache.Insert("row1", "tablet1", "ts1", 100, &result);
+  cache.Insert("row2", "tablet1", "ts1", 100, NULL);
+
+  RowResult cached;
+  bool found = false;
+  ASSERT_TRUE(cache.Lookup("row1", "tablet1", &cached, &found));
+  EXPECT_TRUE(found);
+  ASSERT_EQ(cached.key_values_size(), 1);
+  EXPECT_EQ(cached.key_values(0).value(), "value1");
+
+  ASSERT_TRUE(cache.Lookup("row2", "tablet1", &cached, &found));
+  EXPECT_FALSE(found);
+
+  EXPECT_FALSE(cache.Lookup("row3", "tablet1", &cached, &found));
+  EXPECT_EQ(cache.HitCount(), 2);
+  EXPECT_EQ(cache.MissCount(), 1);
+}
+
+TEST(RowCacheTest, InvalidateByTabletWriteTs) {
+  RowCache cache(1 << 20, 4, 100000);
+  RowResult result;
+  MakeResult("row1", "value1", &result);
+  cache.Insert("row1", "tablet1", "ts1", 100, &result);
+  cache.Insert("row2", "tablet2", "ts1", 100, &result);
+
+  // a write on tablet1 makes every entry of tablet1 stale
+  cache.UpdateTabletWriteTs("tablet1", "ts1", 200);
+  EXPECT_EQ(cache.GetTabletWriteTs("tablet1"), 200);
+  cache.UpdateTabletWriteTs("tablet1", "ts1", 150);
+  EXPECT_EQ(cache.GetTabletWriteTs("tablet1"), 200);
+
+  RowResult cached;
+  bool found = false;
+  EXPECT_FALSE(cache.Lookup("row1", "tablet1", &cached, &found));
+  EXPECT_EQ(cache.StaleCount(), 1);
+  EXPECT_TRUE(cache.Lookup("row2", "tablet2", &cached, &found));
+
+  // result read before the newest write is never cached
+  cache.Insert("row1", "tablet1", "ts1", 180, &result);
+  EXPECT_FALSE(cache.Lookup("row1", "tablet1", &cached, &found));
+
+  // tablet moved or split
+  EXPECT_FALSE(cache.Lookup("row2", "tablet3", &cached, &found));
+}
+
+TEST(RowCacheTest, InvalidateByTabletMove) {
+  RowCache cache(1 << 20, 4, 100000);
+  RowResult result;
+  MakeResult("row1", "value1", &result);
+  cache.Insert("row1", "tablet1", "ts1", 1000, &result);
+
+  // tablet is loaded on a server whose clock runs behind, its writes are
+  // not comparable with timestamps of the old server
+  cache.UpdateTabletWriteTs("tablet1", "ts2", 500);
+  EXPECT_EQ(cache.GetTabletWriteTs("tablet1"), 500);
+  RowResult cached;
+  bool found = false;
+  EXPECT_FALSE(cache.Lookup("row1", "tablet1", &cached, &found));
+
+  // a late response of the old server isn't cached either
+  cache.Insert("row1", "tablet1", "ts1", 1100, &result);
+  cache.UpdateTabletWriteTs("tablet1", "ts2", 600);
+  EXPECT_FALSE(cache.Lookup("row1", "tablet1", &cached, &found));
+
+  cache.Insert("row1", "tablet1", "ts2", 600, &result);
+  EXPECT_TRUE(cache.Lookup("row1", "tablet1", &cached, &found));
+  cache.UpdateTabletWriteTs("tablet1", "ts2", 700);
+  EXPECT_FALSE(cache.Lookup("row1", "tablet1", &cached, &found));
+}
+
+TEST(RowCacheTest, Expire) {
+  RowCache cache(1 << 20, 1, 1);
+  cache.Insert("row1", "tablet1", "ts1", 100, NULL);
+  usleep(5000);
+  RowResult cached;
+  bool found = false;
+  EXPECT_FALSE(cache.Lookup("row1", "tablet1", &cached, &found));
+}
+
+TEST(RowCacheTest, Evict) {
+  RowCache cache(4096, 1, 100000);
+  RowResult result;
+  MakeResult("row", std::string(512, 'v'), &result);
+  for (int i = 0; i < 100; ++i) {
+    cache.Insert("row" + std::to_string(i), "tablet1", "ts1", 100, &result);
+  }
+  EXPECT_LE(cache.Usage(), 4096);
+
+  RowResult cached;
+  bool found = false;
+  EXPECT_FALSE(cache.Lookup("row0", "tablet1", &cached, &found));
+  EXPECT_TRUE(cache.Lookup("row99", "tablet1", &cached, &found));
+}
+
+}  // namespace tera
@@ -2,11 +2,25 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+
 #define private public
 
 #include "scan_impl.h"
 
+#include "common/thread_pool.h"
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
+#include "sdk/table_impl.h"
+
+DECLARE_int32(tera_sdk_max_batch_scan_req);
 
 using std::string;
 
@@ -47,4 +61,173 @@ class ScanDescImplTest : public ::testing::Test, public ScanDescImpl {
  private:
   TableSchema table_schema_;
 };
+
+TEST_F(ScanDescImplTest, SetParallelism) {
+  EXPECT_EQ(GetParallelism(), 1);
+  EXPECT_TRUE(IsOrdered());
+  SetParallelism(8, false);
+  ScanDescImpl desc(*this);
+  EXPECT_EQ(desc.GetParallelism(), 8);
+  EXPECT_FALSE(desc.IsOrdered());
+}
+
+// Serve scan rpcs of ResultStreamImpl from rows in memory, one row per
+// result slot, answered by a thread pool after a random delay.
+class MockScanTable : public TableImpl {
+ public:
+  MockScanTable(common::ThreadPool* thread_pool)
+      : TableImpl("mock_scan_table", thread_pool, std::shared_ptr<ClientImpl>()),
+        rpc_pool_(8),
+        rpc_count_(0) {}
+
+  ~MockScanTable() { rpc_pool_.Stop(true); }
+
+  void AddRow(const std::string& row_key) { rows_.insert(row_key); }
+
+  void ScanTabletAsync(ResultStreamImpl* stream) {
+    ScanTabletRequest* request = NULL;
+    ScanTabletResponse* response = NULL;
+    stream->GetRpcHandle(&request, &response);
+    uint64_t result_id;
+    {
+      MutexLock lock(&mutex_);
+      result_id = next_result_id_[std::make_pair(stream, request->session_id())]++;
+      rpc_count_++;
+    }
+    rpc_pool_.AddTask(std::bind(&MockScanTable::DoScan, this, stream, request, response,
+                                result_id));
+  }
+
+  int64_t RpcCount() {
+    MutexLock lock(&mutex_);
+    return rpc_count_;
+  }
+
+ private:
+  void DoScan(ResultStreamImpl* stream, ScanTabletRequest* request,
+              ScanTabletResponse* response, uint64_t result_id) {
+    usleep(rand() % 1000);
+    ScanDescImpl* desc = stream->GetScanDesc();
+    const std::string& end_key = desc->GetEndRowKey();
+    std::vector<std::string> rows;
+    std::set<std::string>::iterator it = rows_.lower_bound(desc->GetStartRowKey());
+    for (; it != rows_.end() && (end_key == "" || *it < end_key); ++it) {
+      rows.push_back(*it);
+    }
+    response->set_status(kTabletNodeOk);
+    uint64_t last_id = rows.empty() ? 0 : rows.size() - 1;
+    if (result_id > last_id) {
+      // beyond the end of session, ignored by stream
+      response->set_results_id(std::numeric_limits<unsigned long>::max());
+    } else {
+      response->set_results_id(result_id);
+      if (!rows.empty()) {
+        KeyValuePair* kv = response->mutable_results()->add_key_values();
+        kv->set_key(rows[result_id]);
+        kv->set_column_family("cf");
+        kv->set_qualifier("qu");
+        kv->set_timestamp(1);
+        kv->set_value(rows[result_id]);
+        response->set_row_count(1);
+        response->set_data_size(rows[result_id].size());
+      }
+      if (result_id == last_id) {
+        response->set_complete(true);
+        response->set_end(end_key);
+      }
+    }
+    stream->OnFinish(request, response);
+    stream->ReleaseRpcHandle(request, response);
+  }
+
+ private:
+  common::ThreadPool rpc_pool_;
+  std::set<std::string> rows_;
+  Mutex mutex_;
+  std::map<std::pair<ResultStreamImpl*, int64_t>, uint64_t> next_result_id_;
+  int64_t rpc_count_;
+};
+
+class ParallelResultStreamTest : public ::testing::Test {
+ public:
+  ParallelResultStreamTest() : thread_pool_(2), desc_("") {
+    table_.reset(new MockScanTable(&thread_pool_));
+    TableSchema schema;
+    schema.set_name("mock_scan_table");
+    desc_.SetTableSchema(schema);
+    // 4 tablets split at "b", "c", "d", 20 rows each
+    for (char tablet = 'a'; tablet <= 'd'; ++tablet) {
+      for (int i = 0; i < 20; ++i) {
+        char row_key[16];
+        snprintf(row_key, sizeof(row_key), "%c%02d", tablet, i);
+        table_->AddRow(row_key);
+        all_rows_.push_back(row_key);
+      }
+    }
+    split_keys_.push_back("b");
+    split_keys_.push_back("c");
+    split_keys_.push_back("d");
+  }
+
+  std::vector<std::string> ReadAll(ParallelResultStreamImpl* stream) {
+    std::vector<std::string> rows;
+    ErrorCode err;
+    while (!stream->Done(&err)) {
+      rows.push_back(stream->RowName());
+      stream->Next();
+    }
+    EXPECT_EQ(err.GetType(), ErrorCode::kOK);
+    return rows;
+  }
+
+ protected:
+  common::ThreadPool thread_pool_;
+  std::shared_ptr<MockScanTable> table_;
+  ScanDescImpl desc_;
+  std::vector<std::string> split_keys_;
+  std::vector<std::string> all_rows_;
+};
+
+TEST_F(ParallelResultStreamTest, OrderedMerge) {
+  desc_.SetParallelism(3, true);
+  ParallelResultStreamImpl stream(table_.get(), &desc_, split_keys_);
+  std::vector<std::string> rows = ReadAll(&stream);
+  // rows of all tablets, in key order
+  EXPECT_EQ(rows, all_rows_);
+  EXPECT_EQ(stream.GetRowCount(), all_rows_.size());
+}
+
+TEST_F(ParallelResultStreamTest, UnorderedReturnsAllRows) {
+  desc_.SetParallelism(4, false);
+  ParallelResultStreamImpl stream(table_.get(), &desc_, split_keys_);
+  std::vector<std::string> rows = ReadAll(&stream);
+  EXPECT_EQ(rows.size(), all_rows_.size());
+  std::sort(rows.begin(), rows.end());
+  EXPECT_EQ(rows, all_rows_);
+}
+
+TEST_F(ParallelResultStreamTest, BoundedSlots) {
+  int32_t max_batch_scan_req = FLAGS_tera_sdk_max_batch_scan_req;
+  FLAGS_tera_sdk_max_batch_scan_req = 2;
+  desc_.SetParallelism(2, true);
+  {
+    ParallelResultStreamImpl stream(table_.get(), &desc_, split_keys_);
+    // nothing consumed, each active stream fills its slots and stops
+    usleep(100 * 1000);
+    EXPECT_EQ(table_->RpcCount(), 2 * 2);
+
+    // each consumed slot allows one more rpc
+    ErrorCode err;
+    for (int i = 0; i < 5; ++i) {
+      ASSERT_FALSE(stream.Done(&err));
+      stream.Next();
+    }
+    usleep(100 * 1000);
+    EXPECT_LE(table_->RpcCount(), 2 * 2 + 5);
+
+    std::vector<std::string> rows = ReadAll(&stream);
+    EXPECT_EQ(rows.size() + 5, all_rows_.size());
+  }
+  FLAGS_tera_sdk_max_batch_scan_req = max_batch_scan_req;
+}
 }  // namespace tera
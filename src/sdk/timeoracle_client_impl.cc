@@ -3,6 +3,8 @@
 // found in the LICENSE file.
 
 #include "sdk/timeoracle_client_impl.h"
+#include <unistd.h>
+#include <algorithm>
 #include <mutex>
 #include <memory>
 
@@ -101,5 +103,47 @@ void TimeoracleClientImpl::OnRpcFinished(int64_t start_time, std::function<void(
   callback(ts);
 }
 
+TimestampBatcher::TimestampBatcher(ThreadPool* thread_pool, sdk::ClusterFinder* cluster_finder,
+                                   uint32_t max_batch_size, int64_t window_us)
+    : client_(thread_pool, cluster_finder),
+      max_batch_size_(std::max(max_batch_size, 1U)),
+      window_us_(window_us) {}
+
+int64_t TimestampBatcher::GetTimestamp() {
+  Waiter w;
+  std::unique_lock<std::mutex> lock(mutex_);
+  waiters_.push_back(&w);
+  while (!w.done && waiters_.front() != &w) {
+    w.cv.wait(lock);
+  }
+  if (w.done) {
+    return w.timestamp;
+  }
+
+  // the front waiter sends rpc for the batch
+  if (window_us_ > 0 && waiters_.size() < max_batch_size_) {
+    lock.unlock();
+    usleep(window_us_);
+    lock.lock();
+  }
+  uint32_t count = std::min(static_cast<uint32_t>(waiters_.size()), max_batch_size_);
+  lock.unlock();
+  int64_t start_timestamp = client_.GetTimestamp(count);
+  lock.lock();
+
+  VLOG(20) << "get " << count << " timestamps from " << start_timestamp;
+  for (uint32_t i = 0; i < count; ++i) {
+    Waiter* waiter = waiters_.front();
+    waiters_.pop_front();
+    waiter->timestamp = start_timestamp > 0 ? start_timestamp + i : 0;
+    waiter->done = true;
+    waiter->cv.notify_one();
+  }
+  if (!waiters_.empty()) {
+    waiters_.front()->cv.notify_one();
+  }
+  return w.timestamp;
+}
+
 }  // namespace timeoracle
 }  // namespace tera
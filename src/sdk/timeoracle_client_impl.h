@@ -5,6 +5,8 @@
 #ifndef TERA_SDK_TIMEORACLE_CLIENT_IMPL_H_
 #define TERA_SDK_TIMEORACLE_CLIENT_IMPL_H_
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <gflags/gflags.h>
@@ -46,6 +48,38 @@ class TimeoracleClientImpl : public RpcClient<TimeoracleServer::Stub> {
   sdk::ClusterFinder* cluster_finder_;
 };
 
+// Coalesces concurrent single timestamp requests into one GetTimestamp rpc.
+// The first waiter sends the rpc for all waiters queued behind it, the ones
+// arriving meanwhile wait for the next rpc. The range returned is handed out
+// in arrival order, so a waiter never gets a timestamp allocated before it
+// asked for one.
+class TimestampBatcher {
+ public:
+  TimestampBatcher(ThreadPool* thread_pool, sdk::ClusterFinder* cluster_finder,
+                   uint32_t max_batch_size, int64_t window_us);
+
+  ~TimestampBatcher() {}
+
+  // return 0 if failed, the same as TimeoracleClientImpl::GetTimestamp
+  int64_t GetTimestamp();
+
+ private:
+  struct Waiter {
+    int64_t timestamp;
+    bool done;
+    std::condition_variable cv;
+    Waiter() : timestamp(0), done(false) {}
+  };
+
+  TimeoracleClientImpl client_;
+  const uint32_t max_batch_size_;
+  // how long the sending waiter waits for more waiters before the rpc
+  const int64_t window_us_;
+
+  std::mutex mutex_;
+  std::deque<Waiter*> waiters_;
+};
+
 }  // namespace timeoracle
 }  // namespace tera
 
@@ -0,0 +1,68 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tabletnode/queue_delay_controller.h"
+
+#include <limits>
+
+namespace tera {
+namespace tabletnode {
+
+static const int64_t kNoSample = std::numeric_limits<int64_t>::max();
+
+QueueDelayController::QueueDelayController(int64_t target_us, int64_t interval_us)
+    : target_us_(target_us),
+      interval_us_(interval_us > 0 ? interval_us : 1),
+      interval_start_us_(0),
+      interval_min_us_(kNoSample),
+      standing_us_(0),
+      service_us_(0) {}
+
+QueueDelayController::~QueueDelayController() {}
+
+void QueueDelayController::OnDequeue(int64_t queue_us, int64_t now_us) {
+  int64_t start_us = interval_start_us_.load();
+  if (now_us - start_us >= interval_us_ &&
+      interval_start_us_.compare_exchange_strong(start_us, now_us)) {
+    // this sample opens a new interval
+    int64_t last_min_us = interval_min_us_.exchange(queue_us);
+    standing_us_.store(last_min_us == kNoSample ? queue_us : last_min_us);
+    return;
+  }
+  int64_t min_us = interval_min_us_.load();
+  while (queue_us < min_us && !interval_min_us_.compare_exchange_weak(min_us, queue_us)) {
+  }
+}
+
+void QueueDelayController::OnServed(int64_t service_us) {
+  // moving average, racing updates only lose a sample
+  int64_t avg_us = service_us_.load();
+  service_us_.store(avg_us == 0 ? service_us : (avg_us * 7 + service_us) / 8);
+}
+
+bool QueueDelayController::IsOverloaded(int64_t now_us) const {
+  // without dequeue for a while the standing delay is stale, e.g. after all
+  // requests have been rejected, let requests in to measure again
+  if (now_us - interval_start_us_.load() >= 2 * interval_us_) {
+    return false;
+  }
+  return standing_us_.load() > target_us_;
+}
+
+bool QueueDelayController::ShouldReject(int64_t client_timeout_us, int64_t now_us) const {
+  if (client_timeout_us <= 0 || !IsOverloaded(now_us)) {
+    return false;
+  }
+  return standing_us_.load() + service_us_.load() > client_timeout_us;
+}
+
+bool QueueDelayController::ShouldDrop(int64_t queue_us, int64_t client_timeout_us) const {
+  if (client_timeout_us <= 0) {
+    return false;
+  }
+  return queue_us + service_us_.load() > client_timeout_us;
+}
+
+}  // namespace tabletnode
+}  // namespace tera
@@ -0,0 +1,60 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TERA_TABLETNODE_QUEUE_DELAY_CONTROLLER_H_
+#define TERA_TABLETNODE_QUEUE_DELAY_CONTROLLER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+
+namespace tera {
+namespace tabletnode {
+
+// CoDel style admission control of one rpc thread pool.
+//
+// The minimum queueing delay seen in an interval of |interval_us| is the
+// standing delay of the queue: a burst drained within the interval leaves it
+// near zero, while an overloaded pool keeps it above |target_us|. Standing
+// delay plus the average service time, from dequeue to response, is how long
+// a request admitted now waits for its response, so under overload a request
+// whose client timeout can't be met is rejected before it costs anything,
+// and a queued one whose client has given up is dropped before it runs.
+class QueueDelayController {
+ public:
+  QueueDelayController(int64_t target_us, int64_t interval_us);
+  ~QueueDelayController();
+
+  // a request leaves the queue after waiting |queue_us|
+  void OnDequeue(int64_t queue_us, int64_t now_us);
+
+  // a request was answered |service_us| after it left the queue
+  void OnServed(int64_t service_us);
+
+  // return true if a request arriving at |now_us| is not worth queueing for
+  // a client waiting at most |client_timeout_us|, 0 means no timeout
+  bool ShouldReject(int64_t client_timeout_us, int64_t now_us) const;
+
+  // return true if a request waited |queue_us| can't be served in time
+  bool ShouldDrop(int64_t queue_us, int64_t client_timeout_us) const;
+
+  bool IsOverloaded(int64_t now_us) const;
+
+  int64_t StandingDelayUs() const { return standing_us_.load(); }
+  int64_t ServiceUs() const { return service_us_.load(); }
+
+ private:
+  const int64_t target_us_;
+  const int64_t interval_us_;
+
+  std::atomic<int64_t> interval_start_us_;
+  std::atomic<int64_t> interval_min_us_;
+  std::atomic<int64_t> standing_us_;
+  std::atomic<int64_t> service_us_;
+};
+
+}  // namespace tabletnode
+}  // namespace tera
+
+#endif  // TERA_TABLETNODE_QUEUE_DELAY_CONTROLLER_H_
@@ -5,6 +5,7 @@
 #include "tabletnode/remote_tabletnode.h"
 
 #include <functional>
+#include <limits>
 #include <memory>
 
 #include "gflags/gflags.h"
@@ -33,6 +34,10 @@ DECLARE_double(tera_quota_unlimited_pending_ratio);
 DECLARE_int32(tera_quota_scan_max_retry_times);
 DECLARE_int32(tera_quota_scan_retry_delay_interval);
 DECLARE_uint64(tera_quota_max_retry_queue_length);
+DECLARE_string(tera_master_meta_table_name);
+DECLARE_bool(tera_tabletnode_rpc_codel_enabled);
+DECLARE_int64(tera_tabletnode_rpc_queue_target_ms);
+DECLARE_int64(tera_tabletnode_rpc_queue_interval_ms);
 
 namespace tera {
 namespace tabletnode {
@@ -152,6 +157,11 @@ void WriteDoneWrapper::Run() {
   delete this;
 }
 
+void ServedDoneWrapper::Run() {
+  queue_delay_->OnServed(get_micros() - dequeue_micros_);
+  delete this;
+}
+
 void ScanDoneWrapper::Run() {
   if (response_->has_results()) {
     int64_t now_us = get_micros();
@@ -177,7 +187,7 @@ void ScanDoneWrapper::Run() {
   delete this;
 }
 
-enum RpcType { RPC_READ = 1, RPC_SCAN = 2 };
+enum RpcType { RPC_READ = 1, RPC_SCAN = 2, RPC_WRITE = 3 };
 
 struct ReadRpc : public RpcTask {
   google::protobuf::RpcController* controller;
@@ -199,6 +209,26 @@ struct ReadRpc : public RpcTask {
         start_micros(start_micros) {}
 };
 
+struct WriteRpc : public RpcTask {
+  google::protobuf::RpcController* controller;
+  const WriteTabletRequest* request;
+  WriteTabletResponse* response;
+  google::protobuf::Closure* done;
+  WriteRpcTimer* timer;
+  int64_t start_micros;
+
+  WriteRpc(google::protobuf::RpcController* ctrl, const WriteTabletRequest* req,
+           WriteTabletResponse* resp, google::protobuf::Closure* done, WriteRpcTimer* timer,
+           int64_t start_micros)
+      : RpcTask(RPC_WRITE),
+        controller(ctrl),
+        request(req),
+        response(resp),
+        done(done),
+        timer(timer),
+        start_micros(start_micros) {}
+};
+
 struct ScanRpc : public RpcTask {
   google::protobuf::RpcController* controller;
   const ScanTabletRequest* request;
@@ -226,10 +256,16 @@ RemoteTabletNode::RemoteTabletNode(TabletNodeImpl* tabletnode_impl)
       scan_thread_pool_(new ThreadPool(FLAGS_tera_tabletnode_scan_thread_num)),
       compact_thread_pool_(new ThreadPool(FLAGS_tera_tabletnode_manual_compact_thread_num)),
       read_rpc_schedule_(new RpcSchedule(new FairSchedulePolicy)),
+      write_rpc_schedule_(new RpcSchedule(new FairSchedulePolicy)),
       scan_rpc_schedule_(new RpcSchedule(new FairSchedulePolicy)),
       quota_retry_rpc_schedule_(new RpcSchedule(new FairSchedulePolicy)),
+      read_queue_delay_(FLAGS_tera_tabletnode_rpc_queue_target_ms * 1000,
+                        FLAGS_tera_tabletnode_rpc_queue_interval_ms * 1000),
+      write_queue_delay_(FLAGS_tera_tabletnode_rpc_queue_target_ms * 1000,
+                         FLAGS_tera_tabletnode_rpc_queue_interval_ms * 1000),
       access_entry_(new auth::AccessEntry(FLAGS_tera_auth_policy)),
-      quota_entry_(new quota::QuotaEntry) {}
+      quota_entry_(new quota::QuotaEntry),
+      pending_load_seq_(0) {}
 
 RemoteTabletNode::~RemoteTabletNode() {}
 
@@ -257,7 +293,15 @@ void RemoteTabletNode::LoadTablet(google::protobuf::RpcController* controller,
   tablets_ctrl_status_[tablet_path] = TabletCtrlStatus::kCtrlWaitLoad;
   ThreadPool::Task callback =
       std::bind(&RemoteTabletNode::DoLoadTablet, this, controller, request, response, done);
-  ctrl_thread_pool_->AddTask(callback);
+  uint64_t priority = request->tablet_name() == FLAGS_tera_master_meta_table_name
+                          ? std::numeric_limits<uint64_t>::max()
+                          : request->recent_qps();
+  {
+    std::lock_guard<std::mutex> load_lock(pending_loads_mutex_);
+    pending_loads_[LoadOrder(~priority, pending_load_seq_++)] = callback;
+  }
+  // every task runs one pending load, not necessarily the one just queued
+  ctrl_thread_pool_->AddTask(std::bind(&RemoteTabletNode::DoNextLoadTablet, this));
 }
 
 void RemoteTabletNode::UnloadTablet(google::protobuf::RpcController* controller,
@@ -314,6 +358,14 @@ void RemoteTabletNode::ReadTablet(google::protobuf::RpcController* controller,
       last_print = now_time;
     }
     VLOG(8) << "finish RPC (ReadTablet)";
+  } else if (FLAGS_tera_tabletnode_rpc_codel_enabled &&
+             read_queue_delay_.ShouldReject(request->client_timeout_ms() * 1000, start_micros)) {
+    response->set_sequence_id(request->sequence_id());
+    response->set_status(kTabletNodeIsBusy);
+    read_reject_counter.Add(row_num);
+    VLOG(20) << "read queue delay " << read_queue_delay_.StandingDelayUs()
+             << "us exceeds client timeout " << request->client_timeout_ms() << "ms";
+    done->Run();
   } else {
     // check user identification & access
     if (!access_entry_->VerifyAndAuthorize(request, response)) {
@@ -367,6 +419,14 @@ void RemoteTabletNode::WriteTablet(google::protobuf::RpcController* controller,
       last_print = now_time;
     }
     VLOG(8) << "finish RPC (WriteTablet)";
+  } else if (FLAGS_tera_tabletnode_rpc_codel_enabled &&
+             write_queue_delay_.ShouldReject(request->client_timeout_ms() * 1000, start_micros)) {
+    response->set_sequence_id(request->sequence_id());
+    response->set_status(kTabletNodeIsBusy);
+    write_reject_counter.Add(row_num);
+    VLOG(20) << "write queue delay " << write_queue_delay_.StandingDelayUs()
+             << "us exceeds client timeout " << request->client_timeout_ms() << "ms";
+    done->Run();
   } else {
     // check user identification & access
     if (!access_entry_->VerifyAndAuthorize(request, response)) {
@@ -406,9 +466,10 @@ void RemoteTabletNode::WriteTablet(google::protobuf::RpcController* controller,
     write_pending_counter.Add(row_num);
     WriteRpcTimer* timer = new WriteRpcTimer(request, response, done, start_micros);
     RpcTimerList::Instance()->Push(timer);
-    ThreadPool::Task callback = std::bind(&RemoteTabletNode::DoWriteTablet, this, controller,
-                                          request, response, done, timer);
-    write_thread_pool_->AddTask(callback);
+    WriteRpc* rpc = new WriteRpc(controller, request, response, done, timer, start_micros);
+    write_rpc_schedule_->EnqueueRpc(request->tablet_name(), rpc);
+    write_thread_pool_->AddTask(
+        std::bind(&RemoteTabletNode::DoScheduleRpc, this, write_rpc_schedule_.get()));
   }
 }
 
@@ -560,8 +621,11 @@ void RemoteTabletNode::Update(google::protobuf::RpcController* controller,
 
 std::string RemoteTabletNode::ProfilingLog() {
   return "ctrl " + lightweight_ctrl_thread_pool_->ProfilingLog() + " read " +
-         read_thread_pool_->ProfilingLog() + " write " + write_thread_pool_->ProfilingLog() +
-         " scan " + scan_thread_pool_->ProfilingLog() + " compact " +
+         read_thread_pool_->ProfilingLog() + " " +
+         std::to_string(read_queue_delay_.StandingDelayUs() / 1000) + "ms write " +
+         write_thread_pool_->ProfilingLog() + " " +
+         std::to_string(write_queue_delay_.StandingDelayUs() / 1000) + "ms scan " +
+         scan_thread_pool_->ProfilingLog() + " compact " +
          compact_thread_pool_->ProfilingLog();
 }
 
@@ -617,6 +681,9 @@ void RemoteTabletNode::DoLoadTablet(google::protobuf::RpcController* controller,
     std::lock_guard<std::mutex> lock(tablets_ctrl_mutex_);
     tablets_ctrl_status_[request->path()] = TabletCtrlStatus::kCtrlOnLoad;
   }
+  if (request->has_schema()) {
+    UpdateScheduleWeight(request->schema());
+  }
   tabletnode_impl_->LoadTablet(request, response);
   {
     std::lock_guard<std::mutex> lock(tablets_ctrl_mutex_);
@@ -626,6 +693,18 @@ void RemoteTabletNode::DoLoadTablet(google::protobuf::RpcController* controller,
   done->Run();
 }
 
+void RemoteTabletNode::DoNextLoadTablet() {
+  ThreadPool::Task load_task;
+  {
+    std::lock_guard<std::mutex> lock(pending_loads_mutex_);
+    CHECK(!pending_loads_.empty());
+    std::map<LoadOrder, ThreadPool::Task>::iterator it = pending_loads_.begin();
+    load_task = it->second;
+    pending_loads_.erase(it);
+  }
+  load_task(0);
+}
+
 void RemoteTabletNode::DoUnloadTablet(google::protobuf::RpcController* controller,
                                       const UnloadTabletRequest* request,
                                       UnloadTabletResponse* response,
@@ -656,11 +735,16 @@ void RemoteTabletNode::DoReadTablet(google::protobuf::RpcController* controller,
   int32_t row_num = request->row_info_list_size();
   read_pending_counter.Sub(row_num);
 
+  int64_t dequeue_micros = get_micros();
+  int64_t detal = dequeue_micros - start_micros;
+  read_queue_delay_.OnDequeue(detal, dequeue_micros);
+
   bool is_read_timeout = false;
   if (request->has_client_timeout_ms()) {
     int64_t read_timeout = request->client_timeout_ms() * 1000;  // ms -> us
-    int64_t detal = get_micros() - start_micros;
-    if (detal > read_timeout) {
+    // with codel, also drop the ones can't finish before client timeout
+    if (FLAGS_tera_tabletnode_rpc_codel_enabled ? read_queue_delay_.ShouldDrop(detal, read_timeout)
+                                                : detal > read_timeout) {
       LOG(WARNING) << "timeout, drop read request for:" << request->tablet_name()
                    << ", detal(in us):" << detal << ", read_timeout(in us):" << read_timeout;
       is_read_timeout = true;
@@ -668,6 +752,7 @@ void RemoteTabletNode::DoReadTablet(google::protobuf::RpcController* controller,
   }
 
   if (!is_read_timeout) {
+    done = ServedDoneWrapper::NewInstance(&read_queue_delay_, dequeue_micros, done);
     tabletnode_impl_->ReadTablet(start_micros, request, response, done, read_thread_pool_.get());
   } else {
     response->set_sequence_id(request->sequence_id());
@@ -685,12 +770,32 @@ void RemoteTabletNode::DoReadTablet(google::protobuf::RpcController* controller,
 }
 
 void RemoteTabletNode::DoWriteTablet(google::protobuf::RpcController* controller,
-                                     const WriteTabletRequest* request,
+                                     int64_t start_micros, const WriteTabletRequest* request,
                                      WriteTabletResponse* response, google::protobuf::Closure* done,
                                      WriteRpcTimer* timer) {
   VLOG(8) << "run RPC (WriteTablet)";
   int32_t row_num = request->row_list_size();
   write_pending_counter.Sub(row_num);
+
+  int64_t dequeue_micros = get_micros();
+  int64_t detal = dequeue_micros - start_micros;
+  write_queue_delay_.OnDequeue(detal, dequeue_micros);
+  if (FLAGS_tera_tabletnode_rpc_codel_enabled &&
+      write_queue_delay_.ShouldDrop(detal, request->client_timeout_ms() * 1000)) {
+    LOG(WARNING) << "timeout, drop write request for:" << request->tablet_name()
+                 << ", detal(in us):" << detal
+                 << ", write_timeout(in ms):" << request->client_timeout_ms();
+    response->set_sequence_id(request->sequence_id());
+    response->set_status(kTableIsBusy);
+    write_reject_counter.Add(row_num);
+    done->Run();
+    if (NULL != timer) {
+      RpcTimerList::Instance()->Erase(timer);
+      delete timer;
+    }
+    return;
+  }
+  done = ServedDoneWrapper::NewInstance(&write_queue_delay_, dequeue_micros, done);
   tabletnode_impl_->WriteTablet(request, response, done, timer);
   VLOG(8) << "finish RPC (WriteTablet)";
 }
@@ -757,6 +862,9 @@ void RemoteTabletNode::DoUpdate(google::protobuf::RpcController* controller,
                                 google::protobuf::Closure* done) {
   uint64_t id = request->sequence_id();
   LOG(INFO) << "accept RPC (Update) id: " << id;
+  if (request->type() == kUpdateSchema && request->has_schema()) {
+    UpdateScheduleWeight(request->schema());
+  }
   tabletnode_impl_->Update(request, response, done);
   LOG(INFO) << "finish RPC (Update) id: " << id;
 }
@@ -774,6 +882,12 @@ void RemoteTabletNode::DoScheduleRpc(RpcSchedule* rpc_schedule) {
       DoReadTablet(read_rpc->controller, read_rpc->start_micros, read_rpc->request,
                    read_rpc->response, read_rpc->done, read_rpc->timer);
     } break;
+    case RPC_WRITE: {
+      WriteRpc* write_rpc = (WriteRpc*)rpc;
+      table_name = write_rpc->request->tablet_name();
+      DoWriteTablet(write_rpc->controller, write_rpc->start_micros, write_rpc->request,
+                    write_rpc->response, write_rpc->done, write_rpc->timer);
+    } break;
     case RPC_SCAN: {
       ScanRpc* scan_rpc = (ScanRpc*)rpc;
       table_name = scan_rpc->request->table_name();
@@ -789,5 +903,13 @@ void RemoteTabletNode::DoScheduleRpc(RpcSchedule* rpc_schedule) {
   CHECK(status);
 }
 
+void RemoteTabletNode::UpdateScheduleWeight(const TableSchema& schema) {
+  uint32_t weight = schema.schedule_weight();
+  VLOG(10) << "table " << schema.name() << " schedule weight " << weight;
+  read_rpc_schedule_->SetTableWeight(schema.name(), weight);
+  write_rpc_schedule_->SetTableWeight(schema.name(), weight);
+  scan_rpc_schedule_->SetTableWeight(schema.name(), weight);
+}
+
 }  // namespace tabletnode
 }  // namespace tera
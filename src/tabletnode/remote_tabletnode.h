@@ -5,12 +5,15 @@
 #ifndef TERA_TABLETNODE_REMOTE_TABLETNODE_H_
 #define TERA_TABLETNODE_REMOTE_TABLETNODE_H_
 
+#include <map>
 #include <mutex>
+#include <utility>
 #include "common/base/scoped_ptr.h"
 #include "common/thread_pool.h"
 #include "common/request_done_wrapper.h"
 
 #include "proto/tabletnode_rpc.pb.h"
+#include "tabletnode/queue_delay_controller.h"
 #include "tabletnode/rpc_schedule.h"
 #include "utils/rpc_timer_list.h"
 #include "access/access_entry.h"
@@ -110,6 +113,31 @@ class ScanDoneWrapper final : public RequestDoneWrapper {
   std::shared_ptr<quota::QuotaEntry> quota_entry_;
 };
 
+// Reports the time from dequeue to response of a read or write as its service
+// time. Writes are answered by the async tablet writer and batch reads may be
+// split onto the read thread pool, so it's measured when done runs.
+class ServedDoneWrapper final : public RequestDoneWrapper {
+ public:
+  static google::protobuf::Closure* NewInstance(QueueDelayController* queue_delay,
+                                                int64_t dequeue_micros,
+                                                google::protobuf::Closure* done) {
+    return new ServedDoneWrapper(queue_delay, dequeue_micros, done);
+  }
+
+  virtual void Run() override;
+
+  virtual ~ServedDoneWrapper() {}
+
+ protected:
+  // Just Can Create on Heap;
+  ServedDoneWrapper(QueueDelayController* queue_delay, int64_t dequeue_micros,
+                    google::protobuf::Closure* done)
+      : RequestDoneWrapper(done), queue_delay_(queue_delay), dequeue_micros_(dequeue_micros) {}
+
+  QueueDelayController* queue_delay_;
+  int64_t dequeue_micros_;
+};
+
 class RemoteTabletNode : public TabletNodeServer {
  public:
   explicit RemoteTabletNode(TabletNodeImpl* tabletnode_impl);
@@ -151,6 +179,8 @@ class RemoteTabletNode : public TabletNodeServer {
  private:
   void DoLoadTablet(google::protobuf::RpcController* controller, const LoadTabletRequest* request,
                     LoadTabletResponse* response, google::protobuf::Closure* done);
+  // pick the most urgent pending load and run it
+  void DoNextLoadTablet();
 
   void DoUnloadTablet(google::protobuf::RpcController* controller,
                       const UnloadTabletRequest* request, UnloadTabletResponse* response,
@@ -160,9 +190,9 @@ class RemoteTabletNode : public TabletNodeServer {
                     const ReadTabletRequest* request, ReadTabletResponse* response,
                     google::protobuf::Closure* done, ReadRpcTimer* timer = NULL);
 
-  void DoWriteTablet(google::protobuf::RpcController* controller, const WriteTabletRequest* request,
-                     WriteTabletResponse* response, google::protobuf::Closure* done,
-                     WriteRpcTimer* timer = NULL);
+  void DoWriteTablet(google::protobuf::RpcController* controller, int64_t start_micros,
+                     const WriteTabletRequest* request, WriteTabletResponse* response,
+                     google::protobuf::Closure* done, WriteRpcTimer* timer = NULL);
 
   void UpdateAuth(const QueryRequest* request, QueryResponse* response);
 
@@ -196,6 +226,8 @@ class RemoteTabletNode : public TabletNodeServer {
   void DoUpdate(google::protobuf::RpcController* controller, const UpdateRequest* request,
                 UpdateResponse* response, google::protobuf::Closure* done);
   void DoScheduleRpc(RpcSchedule* rpc_schedule);
+  // share rpc threads among tables by their schedule weight in schema
+  void UpdateScheduleWeight(const TableSchema& schema);
 
   bool DoQuotaScanRpcRetry(RpcTask* rpc);
   void DoQuotaRetryScheduleRpc(RpcSchedule* rpc_schedule);
@@ -212,8 +244,13 @@ class RemoteTabletNode : public TabletNodeServer {
   scoped_ptr<ThreadPool> scan_thread_pool_;
   scoped_ptr<ThreadPool> compact_thread_pool_;
   scoped_ptr<RpcSchedule> read_rpc_schedule_;
+  scoped_ptr<RpcSchedule> write_rpc_schedule_;
   scoped_ptr<RpcSchedule> scan_rpc_schedule_;
   scoped_ptr<RpcSchedule> quota_retry_rpc_schedule_;
+  // queueing delay of read/write thread pools, to shed requests that can't
+  // be answered within their client timeout
+  QueueDelayController read_queue_delay_;
+  QueueDelayController write_queue_delay_;
 
   enum TabletCtrlStatus {
     kCtrlWaitLoad = kTabletWaitLoad,
@@ -225,6 +262,13 @@ class RemoteTabletNode : public TabletNodeServer {
   std::mutex tablets_ctrl_mutex_;
   std::map<std::string, TabletCtrlStatus> tablets_ctrl_status_;
 
+  // pending loads ordered by (~priority, arrival seq): meta tablet first, then
+  // the hotter tablets, then the earlier requests
+  typedef std::pair<uint64_t, uint64_t> LoadOrder;
+  std::mutex pending_loads_mutex_;
+  std::map<LoadOrder, ThreadPool::Task> pending_loads_;
+  uint64_t pending_load_seq_;
+
   std::unique_ptr<auth::AccessEntry> access_entry_;
   std::shared_ptr<quota::QuotaEntry> quota_entry_;
 };
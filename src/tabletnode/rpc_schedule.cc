@@ -23,6 +23,10 @@ void RpcSchedule::EnqueueRpc(const std::string& table_name, RpcTask* rpc) {
     entity = it->second;
   } else {
     entity = table_list_[table_name] = policy_->NewScheEntity(new TaskQueue);
+    std::map<TableName, uint32_t>::iterator weight_it = table_weight_.find(table_name);
+    if (weight_it != table_weight_.end()) {
+      policy_->SetWeight(entity, weight_it->second);
+    }
   }
 
   TaskQueue* task_queue = (TaskQueue*)entity->user_ptr;
@@ -88,6 +92,20 @@ bool RpcSchedule::FinishRpc(const std::string& table_name) {
   return true;
 }
 
+void RpcSchedule::SetTableWeight(const std::string& table_name, uint32_t weight) {
+  MutexLock lock(&mutex_);
+  if (weight == 0 || weight == kDefaultScheduleWeight) {
+    table_weight_.erase(table_name);
+    weight = kDefaultScheduleWeight;
+  } else {
+    table_weight_[table_name] = weight;
+  }
+  TableList::iterator it = table_list_.find(table_name);
+  if (it != table_list_.end()) {
+    policy_->SetWeight(it->second, weight);
+  }
+}
+
 }  // namespace tabletnode
 }  // namespace tera
 
@@ -31,6 +31,10 @@ class RpcSchedule {
 
   bool FinishRpc(const std::string& table_name);
 
+  // weight of the table's share of the rpc threads, kept after its queue
+  // goes idle
+  void SetTableWeight(const std::string& table_name, uint32_t weight);
+
   uint64_t GetPendingTaskCount() { return pending_task_count_; }
 
  private:
@@ -48,6 +52,7 @@ class RpcSchedule {
   typedef std::map<TableName, ScheduleEntity*> TableList;
 
   TableList table_list_;
+  std::map<TableName, uint32_t> table_weight_;
   uint64_t pending_task_count_;
   uint64_t running_task_count_;
 };
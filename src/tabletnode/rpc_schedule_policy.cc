@@ -69,9 +69,18 @@ void FairSchedulePolicy::Disable(ScheduleEntity* entity) {
   fair_entity->elapse_time -= min_elapse_time_;
 }
 
+void FairSchedulePolicy::SetWeight(ScheduleEntity* entity, uint32_t weight) {
+  FairScheduleEntity* fair_entity = (FairScheduleEntity*)entity;
+  // account the running time so far with the old weight
+  UpdateEntity(fair_entity);
+  fair_entity->weight = weight > 0 ? weight : kDefaultScheduleWeight;
+}
+
 void FairSchedulePolicy::UpdateEntity(FairScheduleEntity* entity) {
   int64_t now = get_micros();
-  entity->elapse_time += (now - entity->last_update_time) * entity->running_count;
+  // heavier table's running time elapses slower, so it's picked more often
+  entity->elapse_time += (now - entity->last_update_time) * entity->running_count *
+                         kDefaultScheduleWeight / entity->weight;
   entity->last_update_time = now;
 }
 
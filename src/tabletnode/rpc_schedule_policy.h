@@ -15,6 +15,9 @@
 namespace tera {
 namespace tabletnode {
 
+// a table of weight 200 is given twice the running time of a default one
+const uint32_t kDefaultScheduleWeight = 100;
+
 struct ScheduleEntity {
   void* user_ptr;
 
@@ -39,6 +42,8 @@ class SchedulePolicy {
   virtual void Enable(ScheduleEntity* entity) = 0;
 
   virtual void Disable(ScheduleEntity* entity) = 0;
+
+  virtual void SetWeight(ScheduleEntity* entity, uint32_t weight) {}
 };
 
 struct FairScheduleEntity : public ScheduleEntity {
@@ -46,13 +51,15 @@ struct FairScheduleEntity : public ScheduleEntity {
   int64_t last_update_time;
   int64_t elapse_time;
   int64_t running_count;
+  uint32_t weight;
 
   FairScheduleEntity(void* user_ptr)
       : ScheduleEntity(user_ptr),
         pickable(false),
         last_update_time(0),
         elapse_time(0),
-        running_count(0) {}
+        running_count(0),
+        weight(kDefaultScheduleWeight) {}
 };
 
 class FairSchedulePolicy : public SchedulePolicy {
@@ -71,6 +78,8 @@ class FairSchedulePolicy : public SchedulePolicy {
 
   void Disable(ScheduleEntity* entity);
 
+  void SetWeight(ScheduleEntity* entity, uint32_t weight);
+
  private:
   void UpdateEntity(FairScheduleEntity* entity);
 
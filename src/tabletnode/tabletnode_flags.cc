@@ -27,6 +27,13 @@ DEFINE_int32(tera_tabletnode_table_cache_size, 2000, "the table cache size (in M
 
 DEFINE_int32(tera_request_pending_limit, 100000, "the max read/write request pending");
 DEFINE_int32(tera_scan_request_pending_limit, 1000, "the max scan request pending");
+DEFINE_bool(tera_tabletnode_rpc_codel_enabled, false,
+            "shed read/write requests that can't be answered within client timeout "
+            "due to queueing delay");
+DEFINE_int64(tera_tabletnode_rpc_queue_target_ms, 5,
+             "read/write queue is overloaded if its standing delay exceeds this (in ms)");
+DEFINE_int64(tera_tabletnode_rpc_queue_interval_ms, 100,
+             "interval to measure standing delay of read/write queue (in ms)");
 DEFINE_int32(tera_garbage_collect_period, 1800, "garbage collect period in s");
 
 DEFINE_int32(tera_tabletnode_retry_period, 100,
@@ -60,6 +67,9 @@ DEFINE_string(tera_tabletnode_running_info_dump_file, "../monitor/ts.info.data",
               "file path for dump running info");
 DEFINE_int64(tera_refresh_tablets_status_interval_ms, 1800000,
              "background thread refresh tablets status interval in ms, default 0.5h");
+DEFINE_int32(tera_tabletnode_query_removed_tablet_history, 10000,
+             "max number of unloaded tablets remembered for delta query, "
+             "master acked older than the history will get a full tablet list");
 
 DEFINE_bool(tera_tabletnode_dump_level_size_info_enabled, false,
             "enable dump level size or not, it's mainly used for performance-test");
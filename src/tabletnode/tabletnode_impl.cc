@@ -646,13 +646,17 @@ void TabletNodeImpl::WriteTablet(const WriteTabletRequest* request, WriteTabletR
   // reserve response status list space
   response->set_status(kTabletNodeOk);
   response->mutable_row_status_list()->Reserve(row_num);
+  response->mutable_last_write_ts_list()->Reserve(row_num);
   for (int32_t i = 0; i < row_num; i++) {
     response->mutable_row_status_list()->AddAlreadyReserved();
+    response->mutable_last_write_ts_list()->AddAlreadyReserved();
   }
 
   for (it = tablet_task_map.begin(); it != tablet_task_map.end(); ++it) {
     io::TabletIO* tablet_io = it->first;
     WriteTabletTask* tablet_task = it->second;
+    // ref of tablet_io is released in WriteTabletCallback
+    tablet_task->tablet_io = tablet_io;
     if (tablet_io == NULL) {
       WriteTabletFail(tablet_task, kKeyNotInRange);
     } else if (!tablet_io->Write(
@@ -660,10 +664,7 @@ void TabletNodeImpl::WriteTablet(const WriteTabletRequest* request, WriteTabletR
                    request->is_instant(),
                    std::bind(&TabletNodeImpl::WriteTabletCallback, this, tablet_task, _1, _2),
                    &status)) {
-      tablet_io->DecRef();
       WriteTabletFail(tablet_task, status);
-    } else {
-      tablet_io->DecRef();
     }
   }
 }
@@ -682,10 +683,16 @@ void TabletNodeImpl::WriteTabletFail(WriteTabletTask* tablet_task, StatusCode st
 void TabletNodeImpl::WriteTabletCallback(WriteTabletTask* tablet_task,
                                          std::vector<const RowMutationSequence*>* row_mutation_vec,
                                          std::vector<StatusCode>* status_vec) {
+  int64_t last_write_ts = 0;
+  if (tablet_task->tablet_io != NULL) {
+    last_write_ts = tablet_task->tablet_io->LastWriteTime();
+    tablet_task->tablet_io->DecRef();
+  }
   int32_t index_num = tablet_task->row_index_vec.size();
   for (int32_t i = 0; i < index_num; i++) {
     int32_t index = tablet_task->row_index_vec[i];
     tablet_task->response->mutable_row_status_list()->Set(index, (*status_vec)[i]);
+    tablet_task->response->mutable_last_write_ts_list()->Set(index, last_write_ts);
   }
 
   if (tablet_task->row_done_counter->Add(index_num) == tablet_task->request->row_list_size()) {
@@ -738,7 +745,19 @@ void TabletNodeImpl::Query(const QueryRequest* request, QueryResponse* response,
   TabletNodeInfo* ts_info = response->mutable_tabletnode_info();
   sysinfo_.GetTabletNodeInfo(ts_info);
   TabletMetaList* meta_list = response->mutable_tabletmeta_list();
-  sysinfo_.GetTabletMetaList(meta_list);
+  if (request->has_acked_meta_version()) {
+    uint64_t meta_version = 0;
+    bool is_delta = sysinfo_.GetTabletMetaDelta(request->acked_meta_version(), meta_list,
+                                                response->mutable_removed_tablets(), &meta_version);
+    response->set_is_delta_meta(is_delta);
+    response->set_tablet_meta_version(meta_version);
+    VLOG(20) << "[query] acked meta version " << request->acked_meta_version() << ", reply "
+             << (is_delta ? "delta" : "full") << " meta version " << meta_version
+             << ", tablet num " << meta_list->meta_size() << ", removed "
+             << response->removed_tablets_size();
+  } else {
+    sysinfo_.GetTabletMetaList(meta_list);
+  }
 
   if (request->has_is_gc_query() && request->is_gc_query()) {
     std::vector<TabletInheritedFileInfo> inh_infos;
@@ -1288,8 +1307,10 @@ void ReadTabletTask::StartRead() {
   }
 
   response_->mutable_detail()->mutable_status()->Reserve(total_row_num_);
+  response_->mutable_last_write_ts_list()->Reserve(total_row_num_);
   for (int i = 0; i != total_row_num_; ++i) {
     response_->mutable_detail()->mutable_status()->AddAlreadyReserved();
+    response_->mutable_last_write_ts_list()->AddAlreadyReserved();
   }
 
   int64_t max_task_num = FLAGS_tera_tabletnode_parallel_read_task_num;
@@ -1352,6 +1373,8 @@ void ReadTabletTask::DoRead(std::shared_ptr<ShardRequest> shard_req) {
     } else {
       row_results.emplace_back(new RowResult{});
       VLOG(20) << "time_remain_ms: " << time_remain_ms;
+      // fetch write time before reading, so that a result never looks newer than it is
+      response_->mutable_last_write_ts_list()->Set(index, tablet_io->LastWriteTime());
       if (tablet_io->ReadCells(request_->row_info_list(index), row_results.back().get(),
                                snapshot_id_, &row_status, time_remain_ms)) {
         read_success_num_.Inc();
@@ -1450,9 +1473,11 @@ void TabletNodeImpl::PersistentCacheGarbageCollect(const std::set<std::string>&
    * and part 2 of it doesn't match any one in inherited_files, we'll remove it.
    */
   std::unordered_set<std::string> new_delayed_gc_files;
+  std::vector<std::string> cached_keys;
   for (auto& key : all_keys) {
     if (inherited_files.find(key) != inherited_files.end()) {
       // 1. If file name in inherited_files, skip it.
+      cached_keys.push_back(key);
       continue;
     }
     std::vector<std::string> splited_terms;
@@ -1462,6 +1487,7 @@ void TabletNodeImpl::PersistentCacheGarbageCollect(const std::set<std::string>&
     std::string tablet_name = splited_terms[0] + "/" + splited_terms[1];
     if (active_tablets.find(tablet_name) != active_tablets.end()) {
       // 3. Skip active tablets' file.
+      cached_keys.push_back(key);
       continue;
     }
     if (delayed_gc_files_.find(key) != delayed_gc_files_.end()) {
@@ -1472,9 +1498,16 @@ void TabletNodeImpl::PersistentCacheGarbageCollect(const std::set<std::string>&
       LOG(INFO) << "[Persistent Cache GC] Add file: " << key << " to delayed gc files.";
       // 5. Otherwise, it'll be add to delayed_gc_files, waiting for next gc process.
       new_delayed_gc_files.emplace(key);
+      cached_keys.push_back(key);
     }
   }
 
+  // Files of tablets recently moved out are kept for a while, so master may
+  // move such tablets back here with a warm cache.
+  std::string sketch;
+  io::BuildPersistentCacheSketch(cached_keys, &sketch);
+  sysinfo_.SetPersistentCacheSketch(sketch);
+
   std::swap(delayed_gc_files_, new_delayed_gc_files);
   p_cache->GarbageCollect();
   LOG(INFO) << "[Persistent Cache GC] Finished, cost: " << timer.ElapsedMicros() / 1000 << " ms.";
@@ -52,10 +52,17 @@ class TabletNodeImpl {
     WriteTabletResponse* response;
     google::protobuf::Closure* done;
     WriteRpcTimer* timer;
+    // hold one ref until WriteTabletCallback
+    io::TabletIO* tablet_io;
 
     WriteTabletTask(const WriteTabletRequest* req, WriteTabletResponse* resp,
                     google::protobuf::Closure* d, WriteRpcTimer* t, std::shared_ptr<Counter> c)
-        : row_done_counter(c), request(req), response(resp), done(d), timer(t) {}
+        : row_done_counter(c),
+          request(req),
+          response(resp),
+          done(d),
+          timer(t),
+          tablet_io(NULL) {}
   };
 
   TabletNodeImpl();
@@ -4,11 +4,13 @@
 //
 // Author: Xu Peilin (xupeilin@baidu.com)
 
+#include <algorithm>
 #include <cmath>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <unistd.h>
 #include <cstdlib>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -34,6 +36,7 @@ DECLARE_bool(tera_tabletnode_dump_level_size_info_enabled);
 DECLARE_string(tera_tabletnode_running_info_dump_file);
 DECLARE_int64(tera_tabletnode_sysinfo_check_interval);
 DECLARE_bool(tera_enable_persistent_cache);
+DECLARE_int32(tera_tabletnode_query_removed_tablet_history);
 
 namespace leveldb {
 extern tera::Counter rawkey_compare_counter;
@@ -427,7 +430,12 @@ class TabletNodeSysInfoDumper {
 };
 
 TabletNodeSysInfo::TabletNodeSysInfo()
-    : info_{new TabletNodeInfo}, tablet_list_{new TabletMetaList} {
+    : info_{new TabletNodeInfo},
+      tablet_list_{new TabletMetaList},
+      // start from process start time, so a version acked from previous
+      // process will never be taken as a valid delta base
+      meta_version_(get_micros()),
+      min_delta_version_(meta_version_) {
   RegisterDumpInfoFunction(&TabletNodeSysInfo::DumpSysInfo);
   RegisterDumpInfoFunction(&TabletNodeSysInfo::DumpHardWareInfo);
   RegisterDumpInfoFunction(&TabletNodeSysInfo::DumpIoInfo);
@@ -616,6 +624,13 @@ void TabletNodeSysInfo::CollectTabletNodeInfo(TabletManager* tablet_manager,
     tablet_io->Workload(&write_workload);
     counter->set_write_workload(write_workload);
     counter->set_db_status(tablet_status);  // set runtime counter
+    uint64_t access_qps = 0;
+    std::string median_key;
+    tablet_io->GetHotness(&access_qps, &median_key);
+    counter->set_access_qps(access_qps);
+    if (!median_key.empty()) {
+      counter->set_load_median_key(median_key);
+    }
 
     scan_kvs += counter->scan_kvs();
     read_kvs += counter->read_kvs();
@@ -629,6 +644,7 @@ void TabletNodeSysInfo::CollectTabletNodeInfo(TabletManager* tablet_manager,
     }
     tablet_io->DecRef();
   }
+  UpdateTabletMetaVersion();
   not_ready_counter.Set(not_ready);
   ts_tablet_size_counter.Set(total_size);
 
@@ -786,6 +802,74 @@ void TabletNodeSysInfo::GetTabletMetaList(TabletMetaList* meta_list) {
   meta_list->CopyFrom(*tablet_list_);
 }
 
+bool TabletNodeSysInfo::GetTabletMetaDelta(uint64_t acked_version, TabletMetaList* meta_list,
+                                           google::protobuf::RepeatedPtrField<std::string>* removed,
+                                           uint64_t* version) {
+  MutexLock lock(&mutex_);
+  *version = meta_version_;
+  if (acked_version < min_delta_version_ || acked_version > meta_version_) {
+    meta_list->CopyFrom(*tablet_list_);
+    return false;
+  }
+  for (int i = 0; i < tablet_list_->meta_size(); ++i) {
+    const TabletMeta& meta = tablet_list_->meta(i);
+    auto it = tablet_meta_versions_.find(meta.path());
+    if (it != tablet_meta_versions_.end() && it->second.version <= acked_version) {
+      continue;
+    }
+    meta_list->add_meta()->CopyFrom(meta);
+    meta_list->add_counter()->CopyFrom(tablet_list_->counter(i));
+  }
+  for (auto it = removed_tablets_.rbegin(); it != removed_tablets_.rend(); ++it) {
+    if (it->first <= acked_version) {
+      break;
+    }
+    removed->Add()->assign(it->second);
+  }
+  return true;
+}
+
+void TabletNodeSysInfo::UpdateTabletMetaVersion() {
+  mutex_.AssertHeld();
+  uint64_t new_version = meta_version_ + 1;
+  bool changed = false;
+  std::unordered_map<std::string, TabletMetaVersion> versions;
+  versions.reserve(tablet_list_->meta_size());
+  std::string buf;
+  for (int i = 0; i < tablet_list_->meta_size(); ++i) {
+    const TabletMeta& meta = tablet_list_->meta(i);
+    buf.clear();
+    meta.AppendToString(&buf);
+    tablet_list_->counter(i).AppendToString(&buf);
+    size_t digest = std::hash<std::string>()(buf);
+
+    TabletMetaVersion& v = versions[meta.path()];
+    auto it = tablet_meta_versions_.find(meta.path());
+    if (it != tablet_meta_versions_.end() && it->second.digest == digest) {
+      v = it->second;
+      tablet_meta_versions_.erase(it);
+    } else {
+      v.digest = digest;
+      v.version = new_version;
+      changed = true;
+    }
+  }
+  // tablets left are not on this node any more
+  for (auto& removed : tablet_meta_versions_) {
+    removed_tablets_.emplace_back(new_version, removed.first);
+    changed = true;
+  }
+  while (removed_tablets_.size() >
+         static_cast<size_t>(std::max(FLAGS_tera_tabletnode_query_removed_tablet_history, 0))) {
+    min_delta_version_ = removed_tablets_.front().first;
+    removed_tablets_.pop_front();
+  }
+  tablet_meta_versions_.swap(versions);
+  if (changed) {
+    meta_version_ = new_version;
+  }
+}
+
 void TabletNodeSysInfo::SetServerAddr(const std::string& addr) {
   MutexLock lock(&mutex_);
   if (!info_.unique()) {
@@ -804,6 +888,15 @@ void TabletNodeSysInfo::SetPersistentCacheSize(uint64_t size) {
   info_->set_persistent_cache_size(size);
 }
 
+void TabletNodeSysInfo::SetPersistentCacheSketch(const std::string& sketch) {
+  MutexLock lock(&mutex_);
+  if (!info_.unique()) {
+    SwitchInfo();
+  }
+  assert(info_.unique());
+  info_->set_persistent_cache_sketch(sketch);
+}
+
 void TabletNodeSysInfo::SetStatus(StatusCode status) {
   MutexLock lock(&mutex_);
   if (!info_.unique()) {
@@ -7,9 +7,11 @@
 #ifndef TERA_TABLETNODE_TABLETNODE_SYSINFO_H_
 #define TERA_TABLETNODE_TABLETNODE_SYSINFO_H_
 
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "common/mutex.h"
 #include "proto/tabletnode.pb.h"
@@ -38,12 +40,23 @@ class TabletNodeSysInfo {
 
   void SetPersistentCacheSize(uint64_t size);
 
+  void SetPersistentCacheSketch(const std::string& sketch);
+
   void SetStatus(StatusCode status);
 
   void GetTabletNodeInfo(TabletNodeInfo* info);
 
   void GetTabletMetaList(TabletMetaList* meta_list);
 
+  // Fill |meta_list| with tablets whose meta or counter changed after
+  // |acked_version|, and |removed| with paths of tablets unloaded since then.
+  // Return false and fill the full meta list if |acked_version| is too old
+  // (or from another process) to build a delta. |version| is always set to
+  // the current meta version, which master should ack in next query.
+  bool GetTabletMetaDelta(uint64_t acked_version, TabletMetaList* meta_list,
+                          google::protobuf::RepeatedPtrField<std::string>* removed,
+                          uint64_t* version);
+
   void DumpLog();
 
   void SetProcessStartTime(int64_t ts);
@@ -72,6 +85,9 @@ class TabletNodeSysInfo {
   DumpInfoFunction DumpPersistentCacheInfo;
   DumpInfoFunction DumpOtherInfo;
 
+  // REQUIRES: mutex_ held
+  void UpdateTabletMetaVersion();
+
   void RegisterDumpInfoFunction(DumpInfoFunction TabletNodeSysInfo::*f) {
     dump_info_functions_.emplace_back(
         std::bind(f, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
@@ -83,6 +99,17 @@ class TabletNodeSysInfo {
   std::shared_ptr<TabletNodeInfo> info_;
   std::unique_ptr<TabletMetaList> tablet_list_;
 
+  // for delta query, bump meta_version_ once any tablet meta/counter changes
+  struct TabletMetaVersion {
+    size_t digest;
+    uint64_t version;
+  };
+  std::unordered_map<std::string, TabletMetaVersion> tablet_meta_versions_;
+  std::deque<std::pair<uint64_t, std::string>> removed_tablets_;  // <version, path>
+  uint64_t meta_version_;
+  // delta can only be built from versions not less than this
+  uint64_t min_delta_version_;
+
   mutable Mutex mutex_;
 };
 }  // namespace tabletnode
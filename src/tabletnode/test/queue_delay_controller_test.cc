@@ -0,0 +1,54 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tabletnode/queue_delay_controller.h"
+#include "gtest/gtest.h"
+
+namespace tera {
+namespace tabletnode {
+
+// 5ms target, 100ms interval
+static const int64_t kTargetUs = 5000;
+static const int64_t kIntervalUs = 100000;
+
+TEST(QueueDelayControllerTest, BurstIsNotOverload) {
+  QueueDelayController controller(kTargetUs, kIntervalUs);
+  int64_t now_us = 1000000;
+  controller.OnDequeue(0, now_us);
+  // a burst waits long, but the queue drains within the interval
+  for (int i = 0; i < 10; ++i) {
+    controller.OnDequeue(50000, now_us + i * 1000);
+  }
+  controller.OnDequeue(100, now_us + 20000);
+  controller.OnDequeue(60000, now_us + kIntervalUs);
+  EXPECT_EQ(controller.StandingDelayUs(), 0);
+  EXPECT_FALSE(controller.IsOverloaded(now_us + kIntervalUs));
+}
+
+TEST(QueueDelayControllerTest, RejectAndDrop) {
+  QueueDelayController controller(kTargetUs, kIntervalUs);
+  int64_t now_us = 1000000;
+  controller.OnDequeue(40000, now_us);
+  controller.OnDequeue(30000, now_us + 50000);
+  controller.OnDequeue(60000, now_us + kIntervalUs);
+  controller.OnServed(5000);
+  now_us += kIntervalUs;
+  EXPECT_EQ(controller.StandingDelayUs(), 30000);
+  EXPECT_TRUE(controller.IsOverloaded(now_us));
+
+  // 30ms standing delay plus 5ms service can't meet 20ms client timeout
+  EXPECT_TRUE(controller.ShouldReject(20000, now_us));
+  EXPECT_FALSE(controller.ShouldReject(50000, now_us));
+  EXPECT_FALSE(controller.ShouldReject(0, now_us));
+
+  EXPECT_TRUE(controller.ShouldDrop(18000, 20000));
+  EXPECT_FALSE(controller.ShouldDrop(10000, 20000));
+  EXPECT_FALSE(controller.ShouldDrop(1000000, 0));
+
+  // no dequeue for a while, the stale delay doesn't reject any more
+  EXPECT_FALSE(controller.ShouldReject(20000, now_us + 2 * kIntervalUs));
+}
+
+}  // namespace tabletnode
+}  // namespace tera
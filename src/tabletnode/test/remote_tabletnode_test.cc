@@ -3,6 +3,8 @@
 // found in the LICENSE file.
 
 #include <memory>
+#include <string>
+#include <vector>
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "tabletnode/remote_tabletnode.h"
@@ -11,6 +13,7 @@
 DECLARE_int32(tera_tabletnode_ctrl_thread_num);
 DECLARE_string(tera_leveldb_env_type);
 DECLARE_string(tera_tabletnode_path_prefix);
+DECLARE_string(tera_master_meta_table_name);
 
 namespace tera {
 namespace tabletnode {
@@ -111,6 +114,38 @@ TEST_F(RemoteTabletNodeTest, LoadTablet) {
   EXPECT_EQ(remote_ts_->tablets_ctrl_status_.size(), 0);
 }
 
+TEST_F(RemoteTabletNodeTest, LoadTabletPriority) {
+  FLAGS_tera_tabletnode_ctrl_thread_num = 3;
+  std::vector<std::unique_ptr<LoadTabletRequest>> requests;
+  std::vector<std::unique_ptr<LoadTabletResponse>> responses;
+  std::unique_ptr<MockClosure> done(new MockClosure);
+  std::unique_ptr<google::protobuf::RpcController> controller(new sofa::pbrpc::RpcController);
+  // a cold tablet, a hot tablet and the meta tablet, in arrival order
+  const uint64_t qps[] = {10, 1000, 0};
+  for (uint32_t i = 0; i < 3; ++i) {
+    requests.emplace_back(new LoadTabletRequest);
+    responses.emplace_back(new LoadTabletResponse);
+    requests[i]->set_tablet_name(i == 2 ? FLAGS_tera_master_meta_table_name : "test");
+    requests[i]->set_path("test/tablet0000000" + std::to_string(i));
+    requests[i]->set_recent_qps(qps[i]);
+    remote_ts_->LoadTablet(controller.get(), requests[i].get(), responses[i].get(), done.get());
+  }
+  FLAGS_tera_tabletnode_ctrl_thread_num = 1;
+  EXPECT_EQ(remote_ts_->ctrl_thread_pool_->PendingNum(), 3);
+  ASSERT_EQ(remote_ts_->pending_loads_.size(), 3);
+
+  std::vector<uint64_t> seqs;
+  for (auto& load : remote_ts_->pending_loads_) {
+    seqs.push_back(load.first.second);
+  }
+  EXPECT_EQ(seqs, std::vector<uint64_t>({2, 1, 0}));
+
+  remote_ts_->ctrl_thread_pool_->Start();
+  remote_ts_->ctrl_thread_pool_->Stop(true);
+  EXPECT_EQ(remote_ts_->pending_loads_.size(), 0);
+  EXPECT_EQ(remote_ts_->tablets_ctrl_status_.size(), 0);
+}
+
 TEST_F(RemoteTabletNodeTest, UnloadTablet) {
   std::unique_ptr<UnloadTabletRequest> request(new UnloadTabletRequest);
   std::unique_ptr<UnloadTabletResponse> response(new UnloadTabletResponse);
@@ -0,0 +1,78 @@
+// Copyright (c) 2015-2018, Baidu.com, Inc. All Rights Reserved
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "tabletnode/rpc_schedule.h"
+
+#include <chrono>
+#include <map>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace tera {
+namespace tabletnode {
+
+struct TestRpc : public RpcTask {
+  std::string table_name;
+  TestRpc(const std::string& name) : RpcTask(0), table_name(name) {}
+};
+
+// run |task_num| rpcs one by one, each taking about 1ms, and count the
+// rpcs served for every table
+static void RunRpcs(RpcSchedule* schedule, int task_num, std::map<std::string, int>* served) {
+  for (int i = 0; i < task_num; ++i) {
+    RpcTask* rpc = NULL;
+    ASSERT_TRUE(schedule->DequeueRpc(&rpc));
+    std::string table_name = ((TestRpc*)rpc)->table_name;
+    delete rpc;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_TRUE(schedule->FinishRpc(table_name));
+    (*served)[table_name]++;
+  }
+}
+
+TEST(RpcScheduleTest, EqualWeight) {
+  RpcSchedule schedule(new FairSchedulePolicy);
+  for (int i = 0; i < 100; ++i) {
+    schedule.EnqueueRpc("noisy", new TestRpc("noisy"));
+  }
+  for (int i = 0; i < 20; ++i) {
+    schedule.EnqueueRpc("quiet", new TestRpc("quiet"));
+  }
+  // the quiet table isn't starved behind the queue of the noisy one
+  std::map<std::string, int> served;
+  RunRpcs(&schedule, 40, &served);
+  EXPECT_GE(served["quiet"], 15);
+  EXPECT_LE(served["quiet"], 25);
+
+  RunRpcs(&schedule, 80, &served);
+  EXPECT_EQ(served["noisy"], 100);
+  EXPECT_EQ(served["quiet"], 20);
+  EXPECT_EQ(schedule.GetPendingTaskCount(), 0U);
+}
+
+TEST(RpcScheduleTest, WeightedTable) {
+  RpcSchedule schedule(new FairSchedulePolicy);
+  // weight is kept for a table having no rpc queued yet
+  schedule.SetTableWeight("heavy", kDefaultScheduleWeight * 3);
+  for (int i = 0; i < 100; ++i) {
+    schedule.EnqueueRpc("heavy", new TestRpc("heavy"));
+    schedule.EnqueueRpc("light", new TestRpc("light"));
+  }
+  std::map<std::string, int> served;
+  RunRpcs(&schedule, 80, &served);
+  EXPECT_GE(served["heavy"], 50);
+  EXPECT_LE(served["heavy"], 70);
+
+  // back to default weight, both tables get the same share again
+  schedule.SetTableWeight("heavy", 0);
+  served.clear();
+  RunRpcs(&schedule, 40, &served);
+  EXPECT_GE(served["light"], 15);
+  EXPECT_LE(served["light"], 25);
+  RunRpcs(&schedule, 80, &served);
+}
+
+}  // namespace tabletnode
+}  // namespace tera
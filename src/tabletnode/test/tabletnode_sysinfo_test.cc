@@ -28,5 +28,63 @@ TEST_F(TabletNodeSysInfoTest, ToString) {
   SetCurrentTime();
   AddExtraInfo("read", 100);
 }
+
+static void AddTablet(TabletMetaList* list, const std::string& path, uint32_t read_rows) {
+  list->add_meta()->set_path(path);
+  list->add_counter()->set_read_rows(read_rows);
+}
+
+TEST_F(TabletNodeSysInfoTest, GetTabletMetaDelta) {
+  TabletMetaList delta;
+  google::protobuf::RepeatedPtrField<std::string> removed;
+  uint64_t version = 0;
+
+  {
+    MutexLock lock(&mutex_);
+    AddTablet(tablet_list_.get(), "t/tablet01", 1);
+    AddTablet(tablet_list_.get(), "t/tablet02", 2);
+    UpdateTabletMetaVersion();
+  }
+  // unknown version gets full list
+  EXPECT_FALSE(GetTabletMetaDelta(0, &delta, &removed, &version));
+  EXPECT_EQ(delta.meta_size(), 2);
+  uint64_t v1 = version;
+
+  // nothing changed
+  {
+    MutexLock lock(&mutex_);
+    UpdateTabletMetaVersion();
+  }
+  delta.Clear();
+  EXPECT_TRUE(GetTabletMetaDelta(v1, &delta, &removed, &version));
+  EXPECT_EQ(version, v1);
+  EXPECT_EQ(delta.meta_size(), 0);
+  EXPECT_EQ(removed.size(), 0);
+
+  // tablet01 counter changed, tablet02 unloaded, tablet03 loaded
+  {
+    MutexLock lock(&mutex_);
+    tablet_list_->Clear();
+    AddTablet(tablet_list_.get(), "t/tablet01", 10);
+    AddTablet(tablet_list_.get(), "t/tablet03", 3);
+    UpdateTabletMetaVersion();
+  }
+  delta.Clear();
+  EXPECT_TRUE(GetTabletMetaDelta(v1, &delta, &removed, &version));
+  EXPECT_GT(version, v1);
+  ASSERT_EQ(delta.meta_size(), 2);
+  EXPECT_EQ(delta.meta(0).path(), "t/tablet01");
+  EXPECT_EQ(delta.counter(0).read_rows(), 10u);
+  EXPECT_EQ(delta.meta(1).path(), "t/tablet03");
+  ASSERT_EQ(removed.size(), 1);
+  EXPECT_EQ(removed.Get(0), "t/tablet02");
+
+  // acked the latest version
+  delta.Clear();
+  removed.Clear();
+  EXPECT_TRUE(GetTabletMetaDelta(version, &delta, &removed, &version));
+  EXPECT_EQ(delta.meta_size(), 0);
+  EXPECT_EQ(removed.size(), 0);
+}
 }  // namespace tabletnode
 }  // namespace tera
@@ -59,7 +59,14 @@ DEFINE_string(tera_auth_token, "",
 
 DEFINE_bool(tera_quota_enabled, false, "quota enable or not");
 DEFINE_string(tera_quota_limiter_type, "general_quota_limiter",
-              "quota_limiter for generic purpose");
+              "quota_limiter for generic purpose, general_quota_limiter or "
+              "token_bucket_quota_limiter");
+DEFINE_double(tera_quota_burst_ratio, 1.0,
+              "token_bucket_quota_limiter: a table accrues unused quota up to "
+              "burst_ratio times of its limit");
+DEFINE_int64(tera_quota_credit_pool_sec, 1,
+             "token_bucket_quota_limiter: tables on a tabletnode share unused quota "
+             "of at most this many seconds of their total rate, 0 to disable borrowing");
 DEFINE_int64(tera_quota_normal_estimate_value, 1024,
              "default estimate value per read/scan request is 1KB");
 DEFINE_double(tera_quota_adjust_estimate_ratio, 0.9,
@@ -129,6 +136,12 @@ DEFINE_int32(observer_rowlock_client_thread_num, 20, "rowlock client thread numb
 DEFINE_int32(observer_random_access_thread_num, 20, "async read and write thread number");
 DEFINE_int64(observer_update_table_info_period_s, 60,
              "the period of update table info for select key to observe");
+DEFINE_int64(observer_empty_scan_min_backoff_ms, 100,
+             "(ms) first back-off of a scan range that holds no notify cell");
+DEFINE_int64(observer_empty_scan_max_backoff_ms, 0,
+             "(ms) max back-off of a scan range that keeps holding no notify cell, "
+             "also bounds the delay to observe notifies written by other clients, "
+             "0 to always rescan");
 
 //////// rowlock server ////////
 DEFINE_bool(rowlock_rpc_limit_enabled, false, "enable the rpc traffic limit in sdk");
@@ -150,9 +163,12 @@ DEFINE_int32(rowlock_server_node_num, 1, "number of rowlock servers in cluster")
 
 DEFINE_int32(rowlock_db_ttl, 600000, "(ms) timeout for an unlocked lock, 10min");
 DEFINE_int32(rowlock_timing_wheel_patch_num, 600,
-             "the number of timing wheel, every patch_num step the oldest data "
-             "will be cleared");
+             "the number of epochs in rowlock_db_ttl, a lock expires after patch_num "
+             "epochs");
 DEFINE_int32(rowlock_db_sharding_number, 1024, "sharding number, enhance concurrency");
+DEFINE_int32(rowlock_db_slot_number, 4096,
+             "lock slots of each rowlock db shard, at most this number of rows "
+             "can be locked in a shard");
 DEFINE_string(rowlock_fake_root_path, "../fakezk/rowlock", "one box fake zk root path");
 DEFINE_int32(rowlock_thread_max_num, 20, "the max thread number of rowlock server");
 DEFINE_int32(rowlock_client_max_fail_times, 5, "client max failure times");
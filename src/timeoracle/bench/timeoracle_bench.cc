@@ -1,18 +1,25 @@
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include "sdk/sdk_zk.h"
 
+#include "common/timer.h"
 #include "sdk/timeoracle_client_impl.h"
 #include <thread>
 
 DEFINE_int64(client_thread_num, 10, "");
+DEFINE_bool(batch, false, "get timestamps through a TimestampBatcher shared by all threads");
+DEFINE_int32(batch_max_size, 1024, "max timestamps got by one batched rpc");
+DEFINE_int64(batch_window_us, 0, "time to wait for more requests before a batched rpc");
 
 using namespace tera;
 using namespace tera::timeoracle;
 
 std::shared_ptr<common::ThreadPool> g_thread_pool;
+std::unique_ptr<TimestampBatcher> g_batcher;
+std::atomic<int64_t> g_timestamp_count(0);
 
 void worker() {
   tera::sdk::ClusterFinder* cluster_finder = sdk::NewTimeoracleClusterFinder();
@@ -23,28 +30,50 @@ void worker() {
   tera::timeoracle::TimeoracleClientImpl client(g_thread_pool.get(), cluster_finder);
 
   while (true) {
-    int64_t st = client.GetTimestamp(1);
+    int64_t st = g_batcher ? g_batcher->GetTimestamp() : client.GetTimestamp(1);
     if (st <= 0) {
       std::cout << "rpc failed" << std::endl;
       ThisThread::Sleep(200);
+    } else {
+      ++g_timestamp_count;
     }
   }
 }
 
+void reporter() {
+  int64_t last_count = 0;
+  int64_t last_us = get_micros();
+  while (true) {
+    ThisThread::Sleep(1000);
+    int64_t count = g_timestamp_count.load();
+    int64_t now_us = get_micros();
+    std::cout << "timestamps/s: " << (count - last_count) * 1000000 / (now_us - last_us)
+              << (FLAGS_batch ? " (batched)" : "") << std::endl;
+    last_count = count;
+    last_us = now_us;
+  }
+}
+
 int main(int argc, char** argv) {
   if (argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "help")) {
-    std::cout << argv[0] << " --client_thread_num=<Thread Num> \n"
+    std::cout << argv[0] << " --client_thread_num=<Thread Num> [--batch --batch_max_size=<Size> "
+                            "--batch_window_us=<Us>]\n"
               << "    and zk/ins configures should be set in tera.flag or via "
                  "command line" << std::endl;
     return 0;
   }
   ::google::ParseCommandLineFlags(&argc, &argv, true);
   g_thread_pool.reset(new common::ThreadPool(FLAGS_client_thread_num + 1));
+  if (FLAGS_batch) {
+    g_batcher.reset(new TimestampBatcher(g_thread_pool.get(), sdk::NewTimeoracleClusterFinder(),
+                                         FLAGS_batch_max_size, FLAGS_batch_window_us));
+  }
 
   std::vector<std::thread> thread_list;
   for (int64_t i = 0; i < FLAGS_client_thread_num; ++i) {
     thread_list.push_back(std::thread(&worker));
   }
+  thread_list.push_back(std::thread(&reporter));
 
   for (auto& th : thread_list) {
     th.join();